@@ -0,0 +1,606 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/AnKi.h>
+#include <anki/core/StagingGpuMemoryManager.h>
+#include <cstdio>
+
+using namespace anki;
+
+/// The parameters of the procedural workload.
+class BenchWorkload
+{
+public:
+	U32 m_modelNodeCount = 512;
+	U32 m_pointLightCount = 128;
+	U32 m_spotLightCount = 64;
+	U32 m_occluderCount = 32;
+	U32 m_hierarchyDepth = 4; ///< The model nodes are grouped in chains of that length. The roots are animated.
+	U32 m_frameCount = 256;
+	U32 m_warmupFrameCount = 16;
+	U32 m_seed = 0x2020;
+	F32 m_sceneExtend = 100.0f;
+	CString m_modelFilename = "assets/column_walls.ankimdl";
+	CString m_occluderFilename = "assets/column.ankimesh";
+
+	DynamicArrayAuto<U32> m_threadCounts;
+	CString m_outFilename;
+
+	BenchWorkload(HeapAllocator<U8> alloc)
+		: m_threadCounts(alloc)
+	{
+	}
+};
+
+/// Minimum, average and maximum of a stage.
+class BenchStageStats
+{
+public:
+	Second m_min = MAX_F64;
+	Second m_max = 0.0;
+	Second m_total = 0.0;
+	U32 m_count = 0;
+
+	void add(Second t)
+	{
+		m_min = min(m_min, t);
+		m_max = max(m_max, t);
+		m_total += t;
+		++m_count;
+	}
+
+	Second getAverage() const
+	{
+		return (m_count) ? m_total / Second(m_count) : 0.0;
+	}
+};
+
+/// Stages of the benchmark.
+enum class BenchStage : U8
+{
+	SCENE_UPDATE,
+	VISIBILITY,
+	CLUSTER_BIN,
+	FRAME,
+
+	COUNT,
+	FIRST = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(BenchStage, inline)
+
+static const Array<const char*, U32(BenchStage::COUNT)> BENCH_STAGE_NAMES = {
+	{"sceneUpdate", "visibility", "clusterBin", "frame"}};
+
+/// Allocation callback that keeps track of the memory of a single run.
+class BenchMemStats
+{
+public:
+	Atomic<PtrSize> m_allocatedMem = {0};
+	Atomic<PtrSize> m_peakMem = {0};
+	Atomic<U64> m_allocCount = {0};
+	Atomic<U64> m_freeCount = {0};
+
+	static void* allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment);
+};
+
+void* BenchMemStats::allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment)
+{
+	ANKI_ASSERT(userData);
+	BenchMemStats& self = *static_cast<BenchMemStats*>(userData);
+
+	static const PtrSize MAX_ALIGNMENT = 64;
+
+	struct alignas(MAX_ALIGNMENT) Header
+	{
+		PtrSize m_allocatedSize;
+		Array<U8, MAX_ALIGNMENT - sizeof(PtrSize)> _m_padding;
+	};
+	static_assert(sizeof(Header) == MAX_ALIGNMENT, "See file");
+
+	if(ptr == nullptr)
+	{
+		ANKI_ASSERT(alignment > 0 && alignment <= MAX_ALIGNMENT);
+
+		Header* allocation = static_cast<Header*>(allocAligned(nullptr, nullptr, sizeof(Header) + size, MAX_ALIGNMENT));
+		allocation->m_allocatedSize = size;
+
+		const PtrSize newMem = self.m_allocatedMem.fetchAdd(size) + size;
+		self.m_peakMem.max(newMem);
+
+		self.m_allocCount.fetchAdd(1);
+		return allocation + 1;
+	}
+	else
+	{
+		Header* allocation = static_cast<Header*>(ptr) - 1;
+		self.m_allocatedMem.fetchSub(allocation->m_allocatedSize);
+		self.m_freeCount.fetchAdd(1);
+		allocAligned(nullptr, allocation, 0, 0);
+		return nullptr;
+	}
+}
+
+/// Small deterministic generator so the scenes are the same across runs and platforms.
+class BenchRandom
+{
+public:
+	U32 m_state;
+
+	BenchRandom(U32 seed)
+		: m_state((seed) ? seed : 1)
+	{
+	}
+
+	U32 next()
+	{
+		// xorshift32
+		m_state ^= m_state << 13;
+		m_state ^= m_state >> 17;
+		m_state ^= m_state << 5;
+		return m_state;
+	}
+
+	F32 nextRange(F32 min, F32 max)
+	{
+		return min + (max - min) * (F32(next()) / F32(MAX_U32));
+	}
+
+	Vec4 nextPosition(F32 extend)
+	{
+		return Vec4(nextRange(-extend, extend), nextRange(0.0f, extend * 0.1f), nextRange(-extend, extend), 0.0f);
+	}
+};
+
+/// Headless application that runs the CPU side of the frame on procedurally generated scenes.
+class BenchApp : public App
+{
+public:
+	~BenchApp()
+	{
+		getAllocator().deleteInstance(m_workload);
+	}
+
+	Error init(int argc, char* argv[]);
+
+	Error run();
+
+private:
+	class RunResult
+	{
+	public:
+		U32 m_threadCount = 0;
+		Array<BenchStageStats, U32(BenchStage::COUNT)> m_stages;
+		U32 m_sceneNodeCount = 0;
+		U32 m_visibleRenderableCount = 0;
+		U32 m_visiblePointLightCount = 0;
+		U32 m_visibleSpotLightCount = 0;
+		PtrSize m_sceneMem = 0;
+		PtrSize m_peakMem = 0;
+		U64 m_allocsPerFrame = 0;
+	};
+
+	ConfigSet m_config;
+	BenchWorkload* m_workload = nullptr;
+
+	Error parseArguments(int argc, char* argv[]);
+
+	Error populateScene(SceneGraph& scene, DynamicArrayAuto<SceneNode*>& animatedNodes);
+
+	Error runSingle(U32 threadCount, RunResult& result);
+
+	Error printResults(ConstWeakArray<RunResult> results);
+};
+
+static Error parseU32Argument(int argc, char* argv[], int& i, U32& out)
+{
+	if(i + 1 >= argc)
+	{
+		ANKI_LOGE("Missing value after %s", argv[i]);
+		return Error::USER_DATA;
+	}
+
+	++i;
+	return CString(argv[i]).toNumber(out);
+}
+
+Error BenchApp::parseArguments(int argc, char* argv[])
+{
+	BenchWorkload& w = *m_workload;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		const CString arg = argv[i];
+		if(arg == "-nodes")
+		{
+			ANKI_CHECK(parseU32Argument(argc, argv, i, w.m_modelNodeCount));
+		}
+		else if(arg == "-pointLights")
+		{
+			ANKI_CHECK(parseU32Argument(argc, argv, i, w.m_pointLightCount));
+		}
+		else if(arg == "-spotLights")
+		{
+			ANKI_CHECK(parseU32Argument(argc, argv, i, w.m_spotLightCount));
+		}
+		else if(arg == "-occluders")
+		{
+			ANKI_CHECK(parseU32Argument(argc, argv, i, w.m_occluderCount));
+		}
+		else if(arg == "-hierarchyDepth")
+		{
+			ANKI_CHECK(parseU32Argument(argc, argv, i, w.m_hierarchyDepth));
+			w.m_hierarchyDepth = max(w.m_hierarchyDepth, 1u);
+		}
+		else if(arg == "-frames")
+		{
+			ANKI_CHECK(parseU32Argument(argc, argv, i, w.m_frameCount));
+		}
+		else if(arg == "-warmupFrames")
+		{
+			ANKI_CHECK(parseU32Argument(argc, argv, i, w.m_warmupFrameCount));
+		}
+		else if(arg == "-seed")
+		{
+			ANKI_CHECK(parseU32Argument(argc, argv, i, w.m_seed));
+		}
+		else if(arg == "-threads")
+		{
+			// Comma separated list of thread counts
+			if(i + 1 >= argc)
+			{
+				ANKI_LOGE("Missing value after -threads");
+				return Error::USER_DATA;
+			}
+
+			++i;
+			StringListAuto list(getAllocator());
+			list.splitString(argv[i], ',');
+			for(const String& s : list)
+			{
+				U32 count;
+				ANKI_CHECK(s.toCString().toNumber(count));
+				w.m_threadCounts.emplaceBack(max(count, 1u));
+			}
+		}
+		else if(arg == "-model")
+		{
+			if(i + 1 >= argc)
+			{
+				ANKI_LOGE("Missing value after -model");
+				return Error::USER_DATA;
+			}
+
+			w.m_modelFilename = argv[++i];
+		}
+		else if(arg == "-out")
+		{
+			if(i + 1 >= argc)
+			{
+				ANKI_LOGE("Missing value after -out");
+				return Error::USER_DATA;
+			}
+
+			w.m_outFilename = argv[++i];
+		}
+		else if(arg == "-cfg")
+		{
+			// Handled by the ConfigSet
+			i += 2;
+		}
+		else
+		{
+			ANKI_LOGE("Unknown argument: %s", arg.cstr());
+			return Error::USER_DATA;
+		}
+	}
+
+	if(w.m_threadCounts.getSize() == 0)
+	{
+		w.m_threadCounts.emplaceBack(m_config.getNumberU32(ConfigOption::core_mainThreadCount));
+	}
+
+	return Error::NONE;
+}
+
+Error BenchApp::init(int argc, char* argv[])
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	StringAuto dataPaths(alloc);
+	dataPaths.sprintf("%s:%s/samples/simple_scene", ANKI_SOURCE_DIRECTORY, ANKI_SOURCE_DIRECTORY);
+
+	m_config = DefaultConfigSet::get();
+	m_config.set(ConfigOption::rsrc_dataPaths, dataPaths);
+	m_config.set(ConfigOption::width, 256);
+	m_config.set(ConfigOption::height, 256);
+	m_config.set(ConfigOption::window_fullscreen, 0);
+	m_config.set(ConfigOption::gr_debugContext, 0);
+	ANKI_CHECK(m_config.setFromCommandLineArguments(argc, argv));
+
+	ANKI_CHECK(App::init(m_config, allocAligned, nullptr));
+
+	m_workload = getAllocator().newInstance<BenchWorkload>(getAllocator());
+	ANKI_CHECK(parseArguments(argc, argv));
+
+	return Error::NONE;
+}
+
+Error BenchApp::populateScene(SceneGraph& scene, DynamicArrayAuto<SceneNode*>& animatedNodes)
+{
+	const BenchWorkload& w = *m_workload;
+	BenchRandom rand(w.m_seed);
+	StringAuto name(getAllocator());
+
+	// Model nodes. Group them in chains and animate the roots of the chains
+	SceneNode* parent = nullptr;
+	for(U32 i = 0; i < w.m_modelNodeCount; ++i)
+	{
+		ModelNode* node;
+		name.destroy();
+		name.sprintf("model%u", i);
+		ANKI_CHECK(scene.newSceneNode<ModelNode>(name.toCString(), node, w.m_modelFilename));
+
+		MoveComponent& move = node->getComponent<MoveComponent>();
+		if((i % w.m_hierarchyDepth) == 0)
+		{
+			move.setLocalOrigin(rand.nextPosition(w.m_sceneExtend));
+			animatedNodes.emplaceBack(node);
+		}
+		else
+		{
+			ANKI_ASSERT(parent);
+			parent->addChild(node);
+			move.setLocalOrigin(Vec4(0.0f, 0.0f, rand.nextRange(2.0f, 5.0f), 0.0f));
+		}
+
+		parent = node;
+	}
+
+	// Point lights
+	for(U32 i = 0; i < w.m_pointLightCount; ++i)
+	{
+		PointLightNode* node;
+		name.destroy();
+		name.sprintf("plight%u", i);
+		ANKI_CHECK(scene.newSceneNode<PointLightNode>(name.toCString(), node));
+
+		LightComponent& lc = node->getComponent<LightComponent>();
+		lc.setRadius(rand.nextRange(2.0f, 10.0f));
+		lc.setDiffuseColor(Vec4(rand.nextRange(0.5f, 2.0f), rand.nextRange(0.5f, 2.0f), rand.nextRange(0.5f, 2.0f), 1.0f));
+		lc.setShadowEnabled(false);
+
+		node->getComponent<MoveComponent>().setLocalOrigin(rand.nextPosition(w.m_sceneExtend));
+		animatedNodes.emplaceBack(node);
+	}
+
+	// Spot lights
+	for(U32 i = 0; i < w.m_spotLightCount; ++i)
+	{
+		SpotLightNode* node;
+		name.destroy();
+		name.sprintf("slight%u", i);
+		ANKI_CHECK(scene.newSceneNode<SpotLightNode>(name.toCString(), node));
+
+		LightComponent& lc = node->getComponent<LightComponent>();
+		lc.setDistance(rand.nextRange(5.0f, 20.0f));
+		lc.setOuterAngle(toRad(45.0f));
+		lc.setInnerAngle(toRad(15.0f));
+		lc.setDiffuseColor(Vec4(rand.nextRange(0.5f, 2.0f), rand.nextRange(0.5f, 2.0f), rand.nextRange(0.5f, 2.0f), 1.0f));
+		lc.setShadowEnabled(false);
+
+		MoveComponent& move = node->getComponent<MoveComponent>();
+		move.setLocalOrigin(rand.nextPosition(w.m_sceneExtend));
+		move.rotateLocalX(toRad(-rand.nextRange(10.0f, 80.0f)));
+		animatedNodes.emplaceBack(node);
+	}
+
+	// Occluders
+	for(U32 i = 0; i < w.m_occluderCount; ++i)
+	{
+		OccluderNode* node;
+		name.destroy();
+		name.sprintf("occluder%u", i);
+		ANKI_CHECK(scene.newSceneNode<OccluderNode>(name.toCString(), node, w.m_occluderFilename));
+
+		node->getComponent<MoveComponent>().setLocalOrigin(rand.nextPosition(w.m_sceneExtend));
+	}
+
+	// Put the camera in the middle of the scene looking at the horizon
+	MoveComponent& camMove = scene.getActiveCameraNode().getComponent<MoveComponent>();
+	camMove.setLocalOrigin(Vec4(0.0f, w.m_sceneExtend * 0.05f, w.m_sceneExtend * 0.5f, 0.0f));
+
+	return Error::NONE;
+}
+
+Error BenchApp::runSingle(U32 threadCount, RunResult& result)
+{
+	const BenchWorkload& w = *m_workload;
+	result.m_threadCount = threadCount;
+
+	// All the allocations of the run go through that
+	BenchMemStats memStats;
+
+	ThreadHive hive(threadCount, getAllocator(), true);
+	Timestamp timestamp = 1;
+
+	SceneGraph* scene = getAllocator().newInstance<SceneGraph>();
+	Error err = scene->init(BenchMemStats::allocCallback,
+		&memStats,
+		&hive,
+		&getResourceManager(),
+		&getInput(),
+		&getScriptManager(),
+		&timestamp,
+		m_config);
+
+	DynamicArrayAuto<SceneNode*> animatedNodes(getAllocator());
+	if(!err)
+	{
+		err = populateScene(*scene, animatedNodes);
+	}
+
+	ClusterBin clusterBin;
+	clusterBin.init(HeapAllocator<U8>(BenchMemStats::allocCallback, &memStats),
+		&getGrManager(),
+		m_config.getNumberU32(ConfigOption::r_clusterSizeX),
+		m_config.getNumberU32(ConfigOption::r_clusterSizeY),
+		m_config.getNumberU32(ConfigOption::r_clusterSizeZ),
+		m_config);
+	StackAllocator<U8> tempAlloc(BenchMemStats::allocCallback, &memStats, 1024 * 1024, 1.0f);
+
+	StagingGpuMemoryManager& stagingMem = getStagingGpuMemoryManager();
+
+	result.m_sceneNodeCount = scene->getSceneNodesCount();
+	result.m_sceneMem = memStats.m_allocatedMem.load();
+
+	U64 allocCountBegin = 0;
+	const F32 angle = toRad(1.0f);
+	const U32 totalFrameCount = w.m_warmupFrameCount + w.m_frameCount;
+	Second prevUpdateTime = HighRezTimer::getCurrentTime();
+	for(U32 frame = 0; frame < totalFrameCount && !err; ++frame)
+	{
+		const Bool warmup = frame < w.m_warmupFrameCount;
+		if(frame == w.m_warmupFrameCount)
+		{
+			allocCountBegin = memStats.m_allocCount.load();
+		}
+
+		// Animate
+		for(SceneNode* node : animatedNodes)
+		{
+			node->getComponent<MoveComponent>().rotateLocalY(angle);
+		}
+
+		Array<Second, U32(BenchStage::COUNT) + 1> timestamps;
+		timestamps[0] = HighRezTimer::getCurrentTime();
+
+		err = scene->update(prevUpdateTime, timestamps[0]);
+		prevUpdateTime = timestamps[0];
+		timestamps[1] = HighRezTimer::getCurrentTime();
+
+		RenderQueue rqueue;
+		scene->doVisibilityTests(rqueue);
+		timestamps[2] = HighRezTimer::getCurrentTime();
+
+		tempAlloc.getMemoryPool().reset();
+		ClusterBinIn cin;
+		cin.m_threadHive = &hive;
+		cin.m_tempAlloc = tempAlloc;
+		cin.m_renderQueue = &rqueue;
+		cin.m_stagingMem = &stagingMem;
+		cin.m_shadowsEnabled = false;
+		ClusterBinOut clusterOut;
+		clusterBin.bin(cin, clusterOut);
+		timestamps[3] = HighRezTimer::getCurrentTime();
+
+		stagingMem.endFrame();
+		++timestamp;
+
+		if(!warmup)
+		{
+			for(BenchStage stage = BenchStage::FIRST; stage < BenchStage::FRAME; ++stage)
+			{
+				result.m_stages[stage].add(timestamps[U32(stage) + 1] - timestamps[stage]);
+			}
+
+			result.m_stages[BenchStage::FRAME].add(timestamps[3] - timestamps[0]);
+
+			result.m_visibleRenderableCount = rqueue.m_renderables.getSize();
+			result.m_visiblePointLightCount = rqueue.m_pointLights.getSize();
+			result.m_visibleSpotLightCount = rqueue.m_spotLights.getSize();
+		}
+	}
+
+	result.m_peakMem = memStats.m_peakMem.load();
+	result.m_allocsPerFrame = (w.m_frameCount) ? (memStats.m_allocCount.load() - allocCountBegin) / w.m_frameCount : 0;
+
+	getAllocator().deleteInstance(scene);
+
+	return err;
+}
+
+Error BenchApp::printResults(ConstWeakArray<RunResult> results)
+{
+	StringAuto out(getAllocator());
+	out.create("threads,stage,minMs,avgMs,maxMs,sceneNodes,visibleRenderables,visiblePointLights,visibleSpotLights,"
+			   "sceneMemBytes,peakMemBytes,allocsPerFrame\n");
+
+	for(const RunResult& r : results)
+	{
+		for(BenchStage stage = BenchStage::FIRST; stage < BenchStage::COUNT; ++stage)
+		{
+			const BenchStageStats& s = r.m_stages[stage];
+
+			StringAuto line(getAllocator());
+			line.sprintf("%u,%s,%.4f,%.4f,%.4f,%u,%u,%u,%u,%zu,%zu,%" PRIu64 "\n",
+				r.m_threadCount,
+				BENCH_STAGE_NAMES[stage],
+				(s.m_count) ? s.m_min * 1000.0 : 0.0,
+				s.getAverage() * 1000.0,
+				s.m_max * 1000.0,
+				r.m_sceneNodeCount,
+				r.m_visibleRenderableCount,
+				r.m_visiblePointLightCount,
+				r.m_visibleSpotLightCount,
+				r.m_sceneMem,
+				r.m_peakMem,
+				r.m_allocsPerFrame);
+
+			out.append(line);
+		}
+	}
+
+	if(m_workload->m_outFilename)
+	{
+		File file;
+		ANKI_CHECK(file.open(m_workload->m_outFilename, FileOpenFlag::WRITE));
+		ANKI_CHECK(file.writeText("%s", out.cstr()));
+	}
+	else
+	{
+		printf("%s", out.cstr());
+		fflush(stdout);
+	}
+
+	return Error::NONE;
+}
+
+Error BenchApp::run()
+{
+	const BenchWorkload& w = *m_workload;
+
+	DynamicArrayAuto<RunResult> results(getAllocator(), w.m_threadCounts.getSize());
+	for(U32 i = 0; i < w.m_threadCounts.getSize(); ++i)
+	{
+		ANKI_LOGI("Running benchmark with %u threads", w.m_threadCounts[i]);
+		ANKI_CHECK(runSingle(w.m_threadCounts[i], results[i]));
+	}
+
+	ANKI_CHECK(printResults(results));
+
+	return Error::NONE;
+}
+
+int main(int argc, char* argv[])
+{
+	Error err = Error::NONE;
+
+	BenchApp* app = new BenchApp;
+	err = app->init(argc, argv);
+
+	if(!err)
+	{
+		err = app->run();
+	}
+
+	delete app;
+
+	if(err)
+	{
+		ANKI_LOGE("Benchmark failed");
+		return 1;
+	}
+
+	return 0;
+}
@@ -22,6 +22,7 @@
 #define ANKI_OPTIMIZE ${ANKI_OPTIMIZE}
 #define ANKI_TESTS ${ANKI_TESTS}
 #define ANKI_ENABLE_TRACE ${_ANKI_ENABLE_TRACE}
+#define ANKI_ENABLE_MEMORY_TRACKING ${_ANKI_ENABLE_MEMORY_TRACKING}
 #define ANKI_SOURCE_DIRECTORY "${CMAKE_CURRENT_SOURCE_DIR}"
 
 // Compiler
@@ -141,8 +142,9 @@
 #endif
 
 // Graphics backend
-#define ANKI_GR_BACKEND_GL 0
-#define ANKI_GR_BACKEND_VULKAN 1
+#define ANKI_GR_BACKEND_GL ${_ANKI_GR_BACKEND_GL}
+#define ANKI_GR_BACKEND_VULKAN ${_ANKI_GR_BACKEND_VULKAN}
+#define ANKI_GR_BACKEND_NULL ${_ANKI_GR_BACKEND_NULL}
 
 // Some compiler attributes
 #if ANKI_COMPILER_GCC_COMPATIBLE
@@ -6,5 +6,6 @@
 #pragma once
 
 #include <anki/shader_compiler/ShaderProgramCompiler.h>
+#include <anki/shader_compiler/SpirvCache.h>
 
 /// @defgroup shader_compiler Shader compiler
@@ -16,6 +16,7 @@
 #include <anki/util/Enum.h>
 #include <anki/util/File.h>
 #include <anki/util/Filesystem.h>
+#include <anki/util/MappedFile.h>
 #include <anki/util/Functions.h>
 #include <anki/util/Hash.h>
 #include <anki/util/HighRezTimer.h>
@@ -36,6 +37,7 @@
 #include <anki/util/Visitor.h>
 #include <anki/util/INotify.h>
 #include <anki/util/SparseArray.h>
+#include <anki/util/ConcurrentPointerMap.h>
 #include <anki/util/ObjectAllocator.h>
 #include <anki/util/Tracer.h>
 #include <anki/util/Serializer.h>
@@ -0,0 +1,104 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/collision/ConvexVolumeGroup.h>
+
+namespace anki
+{
+
+ConvexVolumeGroup::ConvexVolumeGroup()
+{
+	// Planes that nothing can be in front of
+	for(U32 i = 0; i < MAX_PLANES; ++i)
+	{
+		m_normalsX[i] = Vec4(0.0f);
+		m_normalsY[i] = Vec4(0.0f);
+		m_normalsZ[i] = Vec4(0.0f);
+		m_offsets[i] = Vec4(1.0f);
+	}
+}
+
+void ConvexVolumeGroup::setVolume(U32 volumeIdx, ConstWeakArray<Plane> planes)
+{
+	ANKI_ASSERT(volumeIdx < MAX_VOLUMES);
+	ANKI_ASSERT(planes.getSize() <= MAX_PLANES);
+
+	for(U32 i = 0; i < MAX_PLANES; ++i)
+	{
+		if(i < planes.getSize())
+		{
+			m_normalsX[i][volumeIdx] = planes[i].getNormal().x();
+			m_normalsY[i][volumeIdx] = planes[i].getNormal().y();
+			m_normalsZ[i][volumeIdx] = planes[i].getNormal().z();
+			m_offsets[i][volumeIdx] = planes[i].getOffset();
+		}
+		else
+		{
+			// Pad with planes that everything is in front of
+			m_normalsX[i][volumeIdx] = 0.0f;
+			m_normalsY[i][volumeIdx] = 0.0f;
+			m_normalsZ[i][volumeIdx] = 0.0f;
+			m_offsets[i][volumeIdx] = -1.0f;
+		}
+	}
+}
+
+U32 ConvexVolumeGroup::testAabb(const Aabb& aabb) const
+{
+	// The AABB is behind a plane if the corner that is the furthest along the normal is behind it
+#if ANKI_SIMD_SSE
+	const __m128 minX = _mm_set1_ps(aabb.getMin().x());
+	const __m128 minY = _mm_set1_ps(aabb.getMin().y());
+	const __m128 minZ = _mm_set1_ps(aabb.getMin().z());
+	const __m128 maxX = _mm_set1_ps(aabb.getMax().x());
+	const __m128 maxY = _mm_set1_ps(aabb.getMax().y());
+	const __m128 maxZ = _mm_set1_ps(aabb.getMax().z());
+
+	__m128 outside = _mm_setzero_ps();
+	for(U32 i = 0; i < MAX_PLANES; ++i)
+	{
+		const __m128 nx = m_normalsX[i].getSimd();
+		const __m128 ny = m_normalsY[i].getSimd();
+		const __m128 nz = m_normalsZ[i].getSimd();
+
+		__m128 dist = _mm_max_ps(_mm_mul_ps(nx, minX), _mm_mul_ps(nx, maxX));
+		dist = _mm_add_ps(dist, _mm_max_ps(_mm_mul_ps(ny, minY), _mm_mul_ps(ny, maxY)));
+		dist = _mm_add_ps(dist, _mm_max_ps(_mm_mul_ps(nz, minZ), _mm_mul_ps(nz, maxZ)));
+		dist = _mm_sub_ps(dist, m_offsets[i].getSimd());
+
+		outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_setzero_ps()));
+	}
+
+	return ~U32(_mm_movemask_ps(outside)) & ((1u << MAX_VOLUMES) - 1u);
+#else
+	U32 mask = 0;
+	for(U32 volume = 0; volume < MAX_VOLUMES; ++volume)
+	{
+		Bool outside = false;
+		for(U32 i = 0; i < MAX_PLANES && !outside; ++i)
+		{
+			const F32 nx = m_normalsX[i][volume];
+			const F32 ny = m_normalsY[i][volume];
+			const F32 nz = m_normalsZ[i][volume];
+
+			F32 dist = max(nx * aabb.getMin().x(), nx * aabb.getMax().x());
+			dist += max(ny * aabb.getMin().y(), ny * aabb.getMax().y());
+			dist += max(nz * aabb.getMin().z(), nz * aabb.getMax().z());
+			dist -= m_offsets[i][volume];
+
+			outside = dist < 0.0f;
+		}
+
+		if(!outside)
+		{
+			mask |= 1u << volume;
+		}
+	}
+
+	return mask;
+#endif
+}
+
+} // end namespace anki
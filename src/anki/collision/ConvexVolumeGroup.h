@@ -0,0 +1,45 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/collision/Plane.h>
+#include <anki/collision/Aabb.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup collision
+/// @{
+
+/// The planes of up to 4 convex volumes (eg frustums) stored as a structure of arrays. It's used to test a primitive
+/// against all the volumes at once.
+class ConvexVolumeGroup
+{
+public:
+	static constexpr U32 MAX_VOLUMES = 4;
+	static constexpr U32 MAX_PLANES = U32(FrustumPlaneType::COUNT);
+
+	/// Nothing is inside an empty group.
+	ConvexVolumeGroup();
+
+	/// Set the planes of a volume. A primitive is inside the volume if it's in front of or it intersects all planes.
+	void setVolume(U32 volumeIdx, ConstWeakArray<Plane> planes);
+
+	/// Test an AABB against all volumes. It gives the same results as testing every plane with testPlane().
+	/// @return A mask with one bit for every volume the AABB is inside of or intersects.
+	U32 testAabb(const Aabb& aabb) const;
+
+private:
+	/// The components of the planes. Each Vec4 holds the same plane of all the volumes.
+	Array<Vec4, MAX_PLANES> m_normalsX;
+	Array<Vec4, MAX_PLANES> m_normalsY;
+	Array<Vec4, MAX_PLANES> m_normalsZ;
+	Array<Vec4, MAX_PLANES> m_offsets;
+};
+/// @}
+
+} // end namespace anki
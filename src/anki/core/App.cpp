@@ -12,6 +12,7 @@
 #include <anki/util/ThreadHive.h>
 #include <anki/util/Tracer.h>
 #include <anki/core/CoreTracer.h>
+#include <anki/core/CoreProfiler.h>
 #include <anki/core/DeveloperConsole.h>
 #include <anki/core/NativeWindow.h>
 #include <anki/input/Input.h>
@@ -27,6 +28,7 @@
 #include <anki/ui/UiManager.h>
 #include <anki/ui/Canvas.h>
 #include <anki/shader_compiler/ShaderProgramCompiler.h>
+#include <anki/shader_compiler/SpirvCache.h>
 
 #if ANKI_OS_ANDROID
 #	include <android_native_app_glue.h>
@@ -82,10 +84,17 @@ public:
 	PtrSize m_allocatedCpuMem = 0;
 	U64 m_allocCount = 0;
 	U64 m_freeCount = 0;
+	MemoryTrackerSnapshot m_memSnapshot;
 
 	U64 m_vkCpuMem = 0;
 	U64 m_vkGpuMem = 0;
+	U64 m_vkUnusedGpuMem = 0;
 	U32 m_vkCmdbCount = 0;
+	U32 m_vkPipelineCount = 0;
+	U32 m_vkPipelineHitchCount = 0;
+	U32 m_vkPendingPipelineCount = 0;
+	U32 m_vkDescriptorSetAllocationCount = 0;
+	U32 m_vkDescriptorWriteCount = 0;
 
 	PtrSize m_drawableCount = 0;
 
@@ -136,12 +145,25 @@ public:
 			labelBytes(m_allocatedCpuMem, "Total CPU");
 			labelUint(m_allocCount, "Total allocations");
 			labelUint(m_freeCount, "Total frees");
+			for(MemoryTag tag = MemoryTag::FIRST; tag < MemoryTag::COUNT; ++tag)
+			{
+				if(m_memSnapshot.m_tags[tag].m_memoryUsage > 0)
+				{
+					labelBytes(m_memSnapshot.m_tags[tag].m_memoryUsage, MemoryTracker::getTagName(tag));
+				}
+			}
 			labelBytes(m_vkCpuMem, "Vulkan CPU");
 			labelBytes(m_vkGpuMem, "Vulkan GPU");
+			labelBytes(m_vkUnusedGpuMem, "Vulkan GPU unused");
 
 			ImGui::Text("----");
 			ImGui::Text("Vulkan:");
 			labelUint(m_vkCmdbCount, "Cmd buffers");
+			labelUint(m_vkPipelineCount, "Pipelines");
+			labelUint(m_vkPipelineHitchCount, "Pipeline hitches");
+			labelUint(m_vkPendingPipelineCount, "Pending pipelines");
+			labelUint(m_vkDescriptorSetAllocationCount, "DS allocations");
+			labelUint(m_vkDescriptorWriteCount, "Descriptor writes");
 
 			ImGui::Text("----");
 			ImGui::Text("Other:");
@@ -287,10 +309,17 @@ void App::cleanup()
 
 #if ANKI_ENABLE_TRACE
 	m_heapAlloc.deleteInstance(m_coreTracer);
+	m_heapAlloc.deleteInstance(m_coreProfiler);
 #endif
 
 	m_settingsDir.destroy(m_heapAlloc);
 	m_cacheDir.destroy(m_heapAlloc);
+
+	if(m_ownsMemoryTracker)
+	{
+		MemoryTrackerSingleton::destroy();
+		m_ownsMemoryTracker = false;
+	}
 }
 
 Error App::init(const ConfigSet& config, AllocAlignedCallback allocCb, void* allocCbUserData)
@@ -308,10 +337,18 @@ Error App::init(const ConfigSet& config, AllocAlignedCallback allocCb, void* all
 Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb, void* allocCbUserData)
 {
 	ConfigSet config = config_;
-	m_displayStats = config.getNumberU32("core_displayStats");
+	m_displayStats = config.getNumberU32(ConfigOption::core_displayStats);
+
+	// Create the memory tracker before the subsystems create their memory pools
+	if(!MemoryTrackerSingleton::isInitialized())
+	{
+		MemoryTrackerSingleton::init();
+		m_ownsMemoryTracker = true;
+	}
 
 	initMemoryCallbacks(allocCb, allocCbUserData);
 	m_heapAlloc = HeapAllocator<U8>(m_allocCb, m_allocCbData);
+	m_heapAlloc.getMemoryPool().setMemoryTag(MemoryTag::CORE);
 
 	ANKI_CHECK(initDirs(config));
 
@@ -346,7 +383,7 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 		__DATE__,
 		ANKI_REVISION);
 
-	m_timerTick = 1.0 / F32(config.getNumberU32("core_targetFps")); // in sec. 1.0 / period
+	m_timerTick = 1.0 / F32(config.getNumberU32(ConfigOption::core_targetFps)); // in sec. 1.0 / period
 
 // Check SIMD support
 #if ANKI_SIMD_SSE && ANKI_COMPILER_GCC_COMPATIBLE
@@ -357,7 +394,7 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	}
 #endif
 
-	ANKI_CORE_LOGI("Number of main threads: %u", config.getNumberU32("core_mainThreadCount"));
+	ANKI_CORE_LOGI("Number of main threads: %u", config.getNumberU32(ConfigOption::core_mainThreadCount));
 
 	//
 	// Core tracer
@@ -365,17 +402,21 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 #if ANKI_ENABLE_TRACE
 	m_coreTracer = m_heapAlloc.newInstance<CoreTracer>();
 	ANKI_CHECK(m_coreTracer->init(m_heapAlloc, m_settingsDir));
+
+	m_coreProfiler = m_heapAlloc.newInstance<CoreProfiler>();
+	ANKI_CHECK(m_coreProfiler->init(m_heapAlloc, config.getNumberU32(ConfigOption::core_profilerFrameWindow)));
+	m_coreTracer->setProfiler(m_coreProfiler);
 #endif
 
 	//
 	// Window
 	//
 	NativeWindowInitInfo nwinit;
-	nwinit.m_width = config.getNumberU32("width");
-	nwinit.m_height = config.getNumberU32("height");
+	nwinit.m_width = config.getNumberU32(ConfigOption::width);
+	nwinit.m_height = config.getNumberU32(ConfigOption::height);
 	nwinit.m_depthBits = 0;
 	nwinit.m_stencilBits = 0;
-	nwinit.m_fullscreenDesktopRez = config.getBool("window_fullscreen");
+	nwinit.m_fullscreenDesktopRez = config.getBool(ConfigOption::window_fullscreen);
 	m_window = m_heapAlloc.newInstance<NativeWindow>();
 
 	ANKI_CHECK(m_window->init(nwinit, m_heapAlloc));
@@ -389,7 +430,8 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	//
 	// ThreadPool
 	//
-	m_threadHive = m_heapAlloc.newInstance<ThreadHive>(config.getNumberU32("core_mainThreadCount"), m_heapAlloc, true);
+	m_threadHive =
+		m_heapAlloc.newInstance<ThreadHive>(config.getNumberU32(ConfigOption::core_mainThreadCount), m_heapAlloc, true);
 
 	//
 	// Graphics API
@@ -449,8 +491,8 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	//
 	if(nwinit.m_fullscreenDesktopRez)
 	{
-		config.set("width", m_window->getWidth());
-		config.set("height", m_window->getHeight());
+		config.set(ConfigOption::width, m_window->getWidth());
+		config.set(ConfigOption::height, m_window->getHeight());
 	}
 
 	m_renderer = m_heapAlloc.newInstance<MainRenderer>();
@@ -481,6 +523,7 @@ Error App::initInternal(const ConfigSet& config_, AllocAlignedCallback allocCb,
 	//
 	ANKI_CHECK(m_ui->newInstance<StatsUi>(m_statsUi));
 	ANKI_CHECK(m_ui->newInstance<DeveloperConsole>(m_console, m_allocCb, m_allocCbData, m_script));
+	static_cast<DeveloperConsole&>(*m_console).setProfiler(getProfiler());
 
 	ANKI_CORE_LOGI("Application initialized");
 
@@ -510,7 +553,7 @@ Error App::initDirs(const ConfigSet& cfg)
 	m_cacheDir.sprintf(m_heapAlloc, "%s/cache", &m_settingsDir[0]);
 
 	const Bool cacheDirExists = directoryExists(m_cacheDir.toCString());
-	if(cfg.getBool("core_clearCaches") && cacheDirExists)
+	if(cfg.getBool(ConfigOption::core_clearCaches) && cacheDirExists)
 	{
 		ANKI_CORE_LOGI("Will delete the cache dir and start fresh: %s", &m_cacheDir[0]);
 		ANKI_CHECK(removeDirectory(m_cacheDir.toCString(), m_heapAlloc));
@@ -602,6 +645,13 @@ Error App::mainLoop()
 			// Now resume the loader
 			m_resources->getAsyncLoader().resume();
 
+			// Release the least recently used GPU caches if the GPU memory is over the budget
+			GpuMemoryBudget& gpuMemBudget = m_resources->getGpuMemoryBudget();
+			if(gpuMemBudget.getBudget() > 0)
+			{
+				gpuMemBudget.endFrame(m_gr->getStats().m_gpuMemory);
+			}
+
 			// Sleep
 			const Second endTime = HighRezTimer::getCurrentTime();
 			const Second frameTime = endTime - startTime;
@@ -625,11 +675,18 @@ Error App::mainLoop()
 				statsUi.m_allocatedCpuMem = m_memStats.m_allocatedMem.load();
 				statsUi.m_allocCount = m_memStats.m_allocCount.load();
 				statsUi.m_freeCount = m_memStats.m_freeCount.load();
+				MemoryTrackerSingleton::get().getSnapshot(statsUi.m_memSnapshot);
 
 				GrManagerStats grStats = m_gr->getStats();
 				statsUi.m_vkCpuMem = grStats.m_cpuMemory;
 				statsUi.m_vkGpuMem = grStats.m_gpuMemory;
+				statsUi.m_vkUnusedGpuMem = grStats.m_unusedGpuMemory;
 				statsUi.m_vkCmdbCount = grStats.m_commandBufferCount;
+				statsUi.m_vkPipelineCount = grStats.m_pipelineCount;
+				statsUi.m_vkPipelineHitchCount = grStats.m_pipelineHitchCount;
+				statsUi.m_vkPendingPipelineCount = grStats.m_pendingPipelineCount;
+				statsUi.m_vkDescriptorSetAllocationCount = grStats.m_descriptorSetAllocationCount;
+				statsUi.m_vkDescriptorWriteCount = grStats.m_descriptorWriteCount;
 
 				statsUi.m_drawableCount = rqueue.countAllRenderables();
 			}
@@ -720,147 +777,290 @@ Error App::compileAllShaders()
 	U64 gpuHash = computeHash(&caps, sizeof(caps));
 	gpuHash = appendHash(&limits, sizeof(limits), gpuHash);
 	gpuHash = appendHash(&SHADER_BINARY_VERSION, sizeof(SHADER_BINARY_VERSION), gpuHash);
+	const U64 shaderHeaderHash = ShaderProgramParser::getShaderHeaderHash();
+	gpuHash = appendHash(&shaderHeaderHash, sizeof(shaderHeaderHash), gpuHash);
 
-	ANKI_CHECK(m_resourceFs->iterateAllFilenames([&](CString fname) -> Error {
-		// Check file extension
-		StringAuto extension(m_heapAlloc);
-		getFilepathExtension(fname, extension);
-		if(extension.getLength() != 8 || extension != "ankiprog")
+	// Load interface
+	class FSystem : public ShaderProgramFilesystemInterface
+	{
+	public:
+		ResourceFilesystem* m_fsystem = nullptr;
+
+		Error readAllText(CString filename, StringAuto& txt) final
 		{
+			ResourceFilePtr file;
+			ANKI_CHECK(m_fsystem->openFile(filename, file));
+			ANKI_CHECK(file->readAllText(txt));
 			return Error::NONE;
 		}
+	} fsystem;
+	fsystem.m_fsystem = m_resourceFs;
 
-		// Get some filenames
-		StringAuto baseFname(m_heapAlloc);
-		getFilepathFilename(fname, baseFname);
-		StringAuto metaFname(m_heapAlloc);
-		metaFname.sprintf("%s/%smeta", m_cacheDir.cstr(), baseFname.cstr());
+	// Skip and store interface. One per program
+	class Program : public ShaderProgramPostParseInterface, public ShaderProgramPostCompileInterface
+	{
+	public:
+		U64 m_metafileHash = 0;
+		U64 m_newHash = 0;
+		U64 m_gpuHash = 0;
+		StringAuto m_fname;
+		StringAuto m_metaFname;
+		StringAuto m_storeFname;
+		ShaderProgramBinaryWrapper m_binary;
+		ShaderProgramUsedMutations m_usedMutations; ///< If it's not empty compile only the variants of those mutations.
+
+		Program(HeapAllocator<U8> alloc)
+			: m_fname(alloc)
+			, m_metaFname(alloc)
+			, m_storeFname(alloc)
+			, m_binary(alloc)
+			, m_usedMutations(alloc)
+		{
+		}
 
-		// Get the hash from the meta file
-		U64 metafileHash = 0;
-		if(fileExists(metaFname))
+		Bool skipVariant(U64 mutationHash) final
 		{
-			File metaFile;
-			ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::READ | FileOpenFlag::BINARY));
-			ANKI_CHECK(metaFile.read(&metafileHash, sizeof(metafileHash)));
+			return m_usedMutations.getMutationHashes().getSize() > 0 && !m_usedMutations.contains(mutationHash);
 		}
 
-		// Load interface
-		class FSystem : public ShaderProgramFilesystemInterface
+		Bool skipCompilation(U64 hash) final
 		{
-		public:
-			ResourceFilesystem* m_fsystem = nullptr;
+			ANKI_ASSERT(hash != 0);
+			const Array<U64, 2> hashes = {{hash, m_gpuHash}};
+			const U64 finalHash = computeHash(hashes.getBegin(), hashes.getSizeInBytes());
 
-			Error readAllText(CString filename, StringAuto& txt) final
+			m_newHash = finalHash;
+			const Bool skip = finalHash == m_metafileHash;
+
+			if(!skip)
 			{
-				ResourceFilePtr file;
-				ANKI_CHECK(m_fsystem->openFile(filename, file));
-				ANKI_CHECK(file->readAllText(txt));
-				return Error::NONE;
+				ANKI_CORE_LOGI("\t%s", m_fname.cstr());
 			}
-		} fsystem;
-		fsystem.m_fsystem = m_resourceFs;
 
-		// Skip interface
-		class Skip : public ShaderProgramPostParseInterface
+			return skip;
+		}
+
+		Error programCompiled(const ShaderProgramBinaryWrapper& binary) final
 		{
-		public:
-			U64 m_metafileHash;
-			U64 m_newHash;
-			U64 m_gpuHash;
-			CString m_fname;
+			ANKI_ASSERT(&binary == &m_binary);
 
-			Bool skipCompilation(U64 hash)
-			{
-				ANKI_ASSERT(hash != 0);
-				const Array<U64, 2> hashes = {{hash, m_gpuHash}};
-				const U64 finalHash = computeHash(hashes.getBegin(), hashes.getSizeInBytes());
+			// Save the binary to the cache
+			ANKI_CHECK(binary.serializeToFile(m_storeFname));
 
-				m_newHash = finalHash;
-				const Bool skip = finalHash == m_metafileHash;
+			// Update the meta file. Store the dependencies as well so the next run can skip the parsing
+			const ShaderProgramBinary& bin = binary.getBinary();
+			const U32 depCount = bin.m_dependencies.getSize();
+			File metaFile;
+			ANKI_CHECK(metaFile.open(m_metaFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+			ANKI_CHECK(metaFile.write(&m_newHash, sizeof(m_newHash)));
+			ANKI_CHECK(metaFile.write(&m_gpuHash, sizeof(m_gpuHash)));
+			ANKI_CHECK(metaFile.write(&depCount, sizeof(depCount)));
+			ANKI_CHECK(metaFile.write(bin.m_dependencies.getBegin(), bin.m_dependencies.getSizeInBytes()));
 
-				if(!skip)
-				{
-					ANKI_CORE_LOGI("\t%s", m_fname.cstr());
-				}
+			return Error::NONE;
+		}
+	};
+
+	// Threading interface
+	class TaskManager : public ShaderProgramAsyncTaskInterface
+	{
+	public:
+		ThreadHive* m_hive = nullptr;
+		HeapAllocator<U8> m_alloc;
 
-				return skip;
+		void enqueueTask(void (*callback)(void* userData), void* userData)
+		{
+			struct Ctx
+			{
+				void (*m_callback)(void* userData);
+				void* m_userData;
+				HeapAllocator<U8> m_alloc;
 			};
-		} skip;
-		skip.m_metafileHash = metafileHash;
-		skip.m_newHash = 0;
-		skip.m_gpuHash = gpuHash;
-		skip.m_fname = fname;
-
-		// Threading interface
-		class TaskManager : public ShaderProgramAsyncTaskInterface
+			Ctx* ctx = m_alloc.newInstance<Ctx>();
+			ctx->m_callback = callback;
+			ctx->m_userData = userData;
+			ctx->m_alloc = m_alloc;
+
+			m_hive->submitTask(
+				[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
+					Ctx* ctx = static_cast<Ctx*>(userData);
+					ctx->m_callback(ctx->m_userData);
+					auto alloc = ctx->m_alloc;
+					alloc.deleteInstance(ctx);
+				},
+				ctx);
+		}
+
+		Error joinTasks()
+		{
+			m_hive->waitAllTasks();
+			return Error::NONE;
+		}
+	} taskManager;
+	taskManager.m_hive = m_threadHive;
+	taskManager.m_alloc = m_heapAlloc;
+
+	// The SPIR-V cache makes sure that only the stages whose preprocessed source changed will be compiled
+	SpirvCache spirvCache;
+	StringAuto spirvCacheDir(m_heapAlloc);
+	spirvCacheDir.sprintf("%s/spirv", m_cacheDir.cstr());
+	ANKI_CHECK(spirvCache.init(m_heapAlloc, spirvCacheDir));
+
+	// Parse all programs first. The compiler will then compile the variants of all of them in parallel
+	ShaderProgramBatchCompiler compiler(fsystem, m_heapAlloc, caps, limits);
+	compiler.setSpirvCache(&spirvCache);
+	DynamicArrayAuto<Program*> programs(m_heapAlloc);
+	HashMapAuto<U64, U64> fileHashes(m_heapAlloc); // Filename hash to contents hash. Avoids re-reading the includes
+	U32 upToDateCount = 0;
+
+	// Check if none of the files that a program was built from changed. If so there is no need to parse it
+	auto programIsUpToDate = [&](CString metaFname, U64 programGpuHash) -> Bool {
+		File metaFile;
+		if(metaFile.open(metaFname, FileOpenFlag::READ | FileOpenFlag::BINARY))
+		{
+			return false;
+		}
+
+		// Older meta files have only the hash
+		U64 hash, oldGpuHash;
+		U32 depCount;
+		const PtrSize headerSize = sizeof(hash) + sizeof(oldGpuHash) + sizeof(depCount);
+		if(metaFile.getSize() < headerSize)
 		{
-		public:
-			ThreadHive* m_hive = nullptr;
-			HeapAllocator<U8> m_alloc;
+			return false;
+		}
+
+		if(metaFile.read(&hash, sizeof(hash)) || metaFile.read(&oldGpuHash, sizeof(oldGpuHash))
+			|| metaFile.read(&depCount, sizeof(depCount)))
+		{
+			return false;
+		}
+
+		if(oldGpuHash != programGpuHash || depCount == 0
+			|| metaFile.getSize() != headerSize + depCount * sizeof(ShaderProgramBinaryDependency))
+		{
+			return false;
+		}
+
+		for(U32 i = 0; i < depCount; ++i)
+		{
+			ShaderProgramBinaryDependency dep;
+			if(metaFile.read(&dep, sizeof(dep)))
+			{
+				return false;
+			}
 
-			void enqueueTask(void (*callback)(void* userData), void* userData)
+			dep.m_filename.getBack() = '\0';
+			const CString depFname = &dep.m_filename[0];
+			const U64 fnameHash = depFname.computeHash();
+
+			auto it = fileHashes.find(fnameHash);
+			if(it == fileHashes.getEnd())
 			{
-				struct Ctx
+				StringAuto txt(m_heapAlloc);
+				if(fsystem.readAllText(depFname, txt))
 				{
-					void (*m_callback)(void* userData);
-					void* m_userData;
-					HeapAllocator<U8> m_alloc;
-				};
-				Ctx* ctx = m_alloc.newInstance<Ctx>();
-				ctx->m_callback = callback;
-				ctx->m_userData = userData;
-				ctx->m_alloc = m_alloc;
-
-				m_hive->submitTask(
-					[](void* userData, U32 threadId, ThreadHive& hive, ThreadHiveSemaphore* signalSemaphore) {
-						Ctx* ctx = static_cast<Ctx*>(userData);
-						ctx->m_callback(ctx->m_userData);
-						auto alloc = ctx->m_alloc;
-						alloc.deleteInstance(ctx);
-					},
-					ctx);
+					return false;
+				}
+
+				it = fileHashes.emplace(fnameHash, ShaderProgramParserFile::computeFileHash(txt.toCString()));
 			}
 
-			Error joinTasks()
+			if(*it != dep.m_hash)
 			{
-				m_hive->waitAllTasks();
-				return Error::NONE;
+				return false;
 			}
-		} taskManager;
-		taskManager.m_hive = m_threadHive;
-		taskManager.m_alloc = m_heapAlloc;
+		}
 
-		// Compile
-		ShaderProgramBinaryWrapper binary(m_heapAlloc);
-		ANKI_CHECK(compileShaderProgram(fname, fsystem, &skip, &taskManager, m_heapAlloc, caps, limits, binary));
+		return true;
+	};
 
-		const Bool cachedBinIsUpToDate = metafileHash == skip.m_newHash;
-		if(!cachedBinIsUpToDate)
+	Error err = m_resourceFs->iterateAllFilenames([&](CString fname) -> Error {
+		// Check file extension
+		StringAuto extension(m_heapAlloc);
+		getFilepathExtension(fname, extension);
+		if(extension.getLength() != 8 || extension != "ankiprog")
 		{
-			++shadersCompileCount;
+			return Error::NONE;
 		}
 
-		// Update the meta file
-		if(!cachedBinIsUpToDate)
+		Program* program = m_heapAlloc.newInstance<Program>(m_heapAlloc);
+		programs.emplaceBack(program);
+
+		// Get some filenames
+		StringAuto baseFname(m_heapAlloc);
+		getFilepathFilename(fname, baseFname);
+		program->m_fname.create(fname);
+		program->m_metaFname.sprintf("%s/%smeta", m_cacheDir.cstr(), baseFname.cstr());
+		program->m_storeFname.sprintf("%s/%sbin", m_cacheDir.cstr(), baseFname.cstr());
+		program->m_gpuHash = gpuHash;
+
+		// Get the mutations that were used the last times. The ShaderProgramResource will compile the rest on demand
+		StringAuto usedMutationsFname(m_heapAlloc);
+		usedMutationsFname.sprintf("%s/%svariants", m_cacheDir.cstr(), baseFname.cstr());
+		if(m_resources->getLazyShaderVariants())
+		{
+			ANKI_CHECK(program->m_usedMutations.load(usedMutationsFname));
+
+			// Re-compile if the used mutations change
+			const ConstWeakArray<U64> hashes = program->m_usedMutations.getMutationHashes();
+			if(hashes.getSize() > 0)
+			{
+				program->m_gpuHash = appendHash(hashes.getBegin(), hashes.getSizeInBytes(), program->m_gpuHash);
+			}
+		}
+
+		// Skip the program if nothing it depends on changed
+		if(fileExists(program->m_storeFname) && programIsUpToDate(program->m_metaFname, program->m_gpuHash))
+		{
+			++upToDateCount;
+			return Error::NONE;
+		}
+
+		// Get the hash from the meta file
+		if(fileExists(program->m_metaFname))
 		{
 			File metaFile;
-			ANKI_CHECK(metaFile.open(metaFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
-			ANKI_CHECK(metaFile.write(&skip.m_newHash, sizeof(skip.m_newHash)));
+			ANKI_CHECK(metaFile.open(program->m_metaFname, FileOpenFlag::READ | FileOpenFlag::BINARY));
+			if(metaFile.getSize() >= sizeof(program->m_metafileHash))
+			{
+				ANKI_CHECK(metaFile.read(&program->m_metafileHash, sizeof(program->m_metafileHash)));
+			}
 		}
 
-		// Save the binary to the cache
+		ANKI_CHECK(compiler.addProgram(fname, program, program, program->m_binary));
+
+		const Bool cachedBinIsUpToDate = program->m_metafileHash == program->m_newHash;
 		if(!cachedBinIsUpToDate)
 		{
-			StringAuto storeFname(m_heapAlloc);
-			storeFname.sprintf("%s/%sbin", m_cacheDir.cstr(), baseFname.cstr());
-			ANKI_CHECK(binary.serializeToFile(storeFname));
+			++shadersCompileCount;
 		}
 
 		return Error::NONE;
-	}));
+	});
+
+	// Compile. The binaries are stored as soon as each program is done
+	if(!err)
+	{
+		err = compiler.compile(&taskManager);
+	}
+
+	for(Program* program : programs)
+	{
+		m_heapAlloc.deleteInstance(program);
+	}
 
-	ANKI_CORE_LOGI("Compiled %u shader programs", shadersCompileCount);
+	ANKI_CHECK(err);
+
+	ANKI_CORE_LOGI("Compiled %u shader programs, %u were up to date without parsing. Parsing took %.3fms. "
+				   "Parsed file cache hits %u, misses %u. SPIR-V cache hits %u, misses %u",
+		shadersCompileCount,
+		upToDateCount,
+		compiler.getParseTime() * 1000.0,
+		compiler.getParserCache().getHitCount(),
+		compiler.getParserCache().getMissCount(),
+		spirvCache.getHitCount(),
+		spirvCache.getMissCount());
 	return Error::NONE;
 }
 
@@ -23,6 +23,7 @@ extern android_app* gAndroidApp;
 
 // Forward
 class CoreTracer;
+class CoreProfiler;
 class ConfigSet;
 class ThreadHive;
 class NativeWindow;
@@ -133,6 +134,16 @@ public:
 		return *m_physics;
 	}
 
+	StagingGpuMemoryManager& getStagingGpuMemoryManager()
+	{
+		return *m_stagingMem;
+	}
+
+	GrManager& getGrManager()
+	{
+		return *m_gr;
+	}
+
 	HeapAllocator<U8> getAllocator() const
 	{
 		return m_heapAlloc;
@@ -148,6 +159,16 @@ public:
 		return m_displayStats;
 	}
 
+	/// Get the hierarchical CPU profiler. It's nullptr if tracing is not compiled in.
+	const CoreProfiler* getProfiler() const
+	{
+#if ANKI_ENABLE_TRACE
+		return m_coreProfiler;
+#else
+		return nullptr;
+#endif
+	}
+
 	void setDisplayDeveloperConsole(Bool display)
 	{
 		m_consoleEnabled = display;
@@ -169,6 +190,7 @@ private:
 	// Sybsystems
 #if ANKI_ENABLE_TRACE
 	CoreTracer* m_coreTracer = nullptr;
+	CoreProfiler* m_coreProfiler = nullptr;
 #endif
 	NativeWindow* m_window = nullptr;
 	Input* m_input = nullptr;
@@ -185,6 +207,7 @@ private:
 	// Misc
 	UiImmediateModeBuilderPtr m_statsUi;
 	Bool m_displayStats = false;
+	Bool m_ownsMemoryTracker = false;
 	UiImmediateModeBuilderPtr m_console;
 	Bool m_consoleEnabled = false;
 	Timestamp m_globalTimestamp = 1;
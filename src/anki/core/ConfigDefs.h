@@ -15,4 +15,5 @@ ANKI_CONFIG_OPTION(core_targetFps, 60u, 30u, MAX_U32, "Target FPS")
 ANKI_CONFIG_OPTION(core_mainThreadCount, max(2u, getCpuCoresCount() / 2u), 2u, 1024u)
 ANKI_CONFIG_OPTION(core_displayStats, 0, 0, 1)
 ANKI_CONFIG_OPTION(core_clearCaches, 0, 0, 1)
+ANKI_CONFIG_OPTION(core_profilerFrameWindow, 128, 1, 16 * 1024, "Number of frames the profiler keeps stats for")
 ANKI_CONFIG_OPTION(window_fullscreen, 0, 0, 1)
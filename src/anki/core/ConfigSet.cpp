@@ -63,8 +63,9 @@ public:
 ConfigSet::ConfigSet()
 {
 	m_alloc = HeapAllocator<U8>(allocAligned, nullptr);
+	m_options.create(m_alloc, U32(ConfigOption::COUNT));
 
-#define ANKI_CONFIG_OPTION(name, ...) newOption(ANKI_STRINGIZE(name), __VA_ARGS__);
+#define ANKI_CONFIG_OPTION(name, ...) newOption(ConfigOption::name, ANKI_STRINGIZE(name), __VA_ARGS__);
 #include <anki/core/ConfigDefs.h>
 #include <anki/resource/ConfigDefs.h>
 #include <anki/renderer/ConfigDefs.h>
@@ -74,6 +75,11 @@ ConfigSet::ConfigSet()
 }
 
 ConfigSet::~ConfigSet()
+{
+	destroy();
+}
+
+void ConfigSet::destroy()
 {
 	for(Option& o : m_options)
 	{
@@ -83,16 +89,25 @@ ConfigSet::~ConfigSet()
 	}
 
 	m_options.destroy(m_alloc);
+	m_optionNameMap.destroy(m_alloc);
 }
 
 ConfigSet& ConfigSet::operator=(const ConfigSet& b)
 {
+	if(this == &b)
+	{
+		return *this;
+	}
+
+	destroy();
 	m_alloc = b.m_alloc; // Not a copy but we are fine
+	m_options.create(m_alloc, b.m_options.getSize());
 
-	for(const Option& o : b.m_options)
+	for(ConfigOption idx = ConfigOption::FIRST; idx < ConfigOption::COUNT; ++idx)
 	{
-		Option newO;
-		newO.m_name.create(m_alloc, o.m_name.toCString());
+		const Option& o = b.m_options[U32(idx)];
+		Option& newO = newOptionCommon(idx, o.m_name.toCString(), o.m_helpMsg.toCString());
+
 		if(o.m_type == Option::STRING)
 		{
 			newO.m_str.create(m_alloc, o.m_str.toCString());
@@ -104,181 +119,165 @@ ConfigSet& ConfigSet::operator=(const ConfigSet& b)
 		newO.m_minUnsigned = o.m_minUnsigned;
 		newO.m_maxUnsigned = o.m_maxUnsigned;
 		newO.m_type = o.m_type;
-
-		m_options.emplaceBack(m_alloc, std::move(newO));
 	}
 
 	return *this;
 }
 
-ConfigSet::Option* ConfigSet::tryFind(CString optionName)
+Bool ConfigSet::tryFind(CString name, ConfigOption& option) const
 {
-	for(List<Option>::Iterator it = m_options.getBegin(); it != m_options.getEnd(); ++it)
+	auto it = m_optionNameMap.find(name);
+	if(it != m_optionNameMap.getEnd() && m_options[U32(*it)].m_name == name)
 	{
-		if((*it).m_name == optionName)
-		{
-			return &(*it);
-		}
+		option = *it;
+		return true;
 	}
 
-	return nullptr;
+	return false;
 }
 
-const ConfigSet::Option* ConfigSet::tryFind(CString optionName) const
+CString ConfigSet::getOptionName(ConfigOption option) const
 {
-	for(List<Option>::ConstIterator it = m_options.getBegin(); it != m_options.getEnd(); ++it)
-	{
-		if((*it).m_name == optionName)
-		{
-			return &(*it);
-		}
-	}
-
-	return nullptr;
+	return m_options[U32(option)].m_name.toCString();
 }
 
-void ConfigSet::newOption(CString optionName, CString value, CString helpMsg)
+ConfigSet::Option& ConfigSet::newOptionCommon(ConfigOption option, CString optionName, CString helpMsg)
 {
-	ANKI_ASSERT(!tryFind(optionName));
-
-	Option o;
+	Option& o = m_options[U32(option)];
+	ANKI_ASSERT(o.m_type == Option::NONE);
 	o.m_name.create(m_alloc, optionName);
-	o.m_str.create(m_alloc, value);
-	o.m_type = Option::STRING;
 	if(!helpMsg.isEmpty())
 	{
 		o.m_helpMsg.create(m_alloc, helpMsg);
 	}
 
-	m_options.emplaceBack(m_alloc, std::move(o));
+	// The key points to the name of the option so it stays valid as long as the option
+	ANKI_ASSERT(m_optionNameMap.find(o.m_name.toCString()) == m_optionNameMap.getEnd() && "Name or hash collision");
+	m_optionNameMap.emplace(m_alloc, o.m_name.toCString(), option);
+
+	return o;
 }
 
-void ConfigSet::newOptionInternal(CString optionName, F64 value, F64 minValue, F64 maxValue, CString helpMsg)
+void ConfigSet::newOption(ConfigOption option, CString optionName, CString value, CString helpMsg)
+{
+	Option& o = newOptionCommon(option, optionName, helpMsg);
+	o.m_str.create(m_alloc, value);
+	o.m_type = Option::STRING;
+}
+
+void ConfigSet::newOptionInternal(
+	ConfigOption option, CString optionName, F64 value, F64 minValue, F64 maxValue, CString helpMsg)
 {
-	ANKI_ASSERT(!tryFind(optionName));
 	ANKI_ASSERT(value >= minValue && value <= maxValue && minValue <= maxValue);
 
-	Option o;
-	o.m_name.create(m_alloc, optionName);
+	Option& o = newOptionCommon(option, optionName, helpMsg);
 	o.m_float = value;
 	o.m_minFloat = minValue;
 	o.m_maxFloat = maxValue;
 	o.m_type = Option::FLOAT;
-	if(!helpMsg.isEmpty())
-	{
-		o.m_helpMsg.create(m_alloc, helpMsg);
-	}
-
-	m_options.emplaceBack(m_alloc, std::move(o));
 }
 
-void ConfigSet::newOptionInternal(CString optionName, U64 value, U64 minValue, U64 maxValue, CString helpMsg)
+void ConfigSet::newOptionInternal(
+	ConfigOption option, CString optionName, U64 value, U64 minValue, U64 maxValue, CString helpMsg)
 {
-	ANKI_ASSERT(!tryFind(optionName));
 	ANKI_ASSERT(value >= minValue && value <= maxValue && minValue <= maxValue);
 
-	Option o;
-	o.m_name.create(m_alloc, optionName);
+	Option& o = newOptionCommon(option, optionName, helpMsg);
 	o.m_unsigned = value;
 	o.m_minUnsigned = minValue;
 	o.m_maxUnsigned = maxValue;
 	o.m_type = Option::UNSIGNED;
-	if(!helpMsg.isEmpty())
-	{
-		o.m_helpMsg.create(m_alloc, helpMsg);
-	}
-
-	m_options.emplaceBack(m_alloc, std::move(o));
 }
 
-void ConfigSet::set(CString optionName, CString value)
+void ConfigSet::set(ConfigOption option, CString value)
 {
-	Option& o = find(optionName);
+	Option& o = m_options[U32(option)];
 	ANKI_ASSERT(o.m_type == Option::STRING);
 	o.m_str.destroy(m_alloc);
 	o.m_str.create(m_alloc, value);
 }
 
-void ConfigSet::setInternal(CString optionName, F64 value)
+void ConfigSet::setInternal(ConfigOption option, F64 value)
 {
-	Option& o = find(optionName);
+	Option& o = m_options[U32(option)];
 	ANKI_ASSERT(o.m_type == Option::FLOAT);
 	ANKI_ASSERT(value >= o.m_minFloat);
 	ANKI_ASSERT(value <= o.m_maxFloat);
 	o.m_float = value;
 }
 
-void ConfigSet::setInternal(CString optionName, U64 value)
+void ConfigSet::setInternal(ConfigOption option, U64 value)
 {
-	Option& o = find(optionName);
+	Option& o = m_options[U32(option)];
 	ANKI_ASSERT(o.m_type == Option::UNSIGNED);
 	ANKI_ASSERT(value >= o.m_minUnsigned);
 	ANKI_ASSERT(value <= o.m_maxUnsigned);
 	o.m_unsigned = value;
 }
 
-F64 ConfigSet::getNumberF64(CString optionName) const
+F64 ConfigSet::getNumberF64(ConfigOption option) const
 {
-	const Option& option = find(optionName);
-	ANKI_ASSERT(option.m_type == Option::FLOAT);
-	return option.m_float;
+	const Option& o = m_options[U32(option)];
+	ANKI_ASSERT(o.m_type == Option::FLOAT);
+	return o.m_float;
 }
 
-F32 ConfigSet::getNumberF32(CString optionName) const
+F32 ConfigSet::getNumberF32(ConfigOption option) const
 {
-	return F32(getNumberF64(optionName));
+	return F32(getNumberF64(option));
 }
 
-U64 ConfigSet::getNumberU64(CString optionName) const
+U64 ConfigSet::getNumberU64(ConfigOption option) const
 {
-	const Option& option = find(optionName);
-	ANKI_ASSERT(option.m_type == Option::UNSIGNED);
-	return option.m_unsigned;
+	const Option& o = m_options[U32(option)];
+	ANKI_ASSERT(o.m_type == Option::UNSIGNED);
+	return o.m_unsigned;
 }
 
-U32 ConfigSet::getNumberU32(CString optionName) const
+U32 ConfigSet::getNumberU32(ConfigOption option) const
 {
-	const U64 out = getNumberU64(optionName);
+	const U64 out = getNumberU64(option);
 	if(out > MAX_U32)
 	{
-		ANKI_CORE_LOGW("Option is out of U32 range: %s", optionName.cstr());
+		ANKI_CORE_LOGW("Option is out of U32 range: %s", getOptionName(option).cstr());
 	}
 	return U32(out);
 }
 
-U16 ConfigSet::getNumberU16(CString optionName) const
+U16 ConfigSet::getNumberU16(ConfigOption option) const
 {
-	const U64 out = getNumberU64(optionName);
+	const U64 out = getNumberU64(option);
 	if(out > MAX_U16)
 	{
-		ANKI_CORE_LOGW("Option is out of U16 range: %s", optionName.cstr());
+		ANKI_CORE_LOGW("Option is out of U16 range: %s", getOptionName(option).cstr());
 	}
 	return U16(out);
 }
 
-U8 ConfigSet::getNumberU8(CString optionName) const
+U8 ConfigSet::getNumberU8(ConfigOption option) const
 {
-	const U64 out = getNumberU64(optionName);
+	const U64 out = getNumberU64(option);
 	if(out > MAX_U8)
 	{
-		ANKI_CORE_LOGW("Option is out of U8 range: %s", optionName.cstr());
+		ANKI_CORE_LOGW("Option is out of U8 range: %s", getOptionName(option).cstr());
 	}
 	return U8(out);
 }
 
-Bool ConfigSet::getBool(CString optionName) const
+Bool ConfigSet::getBool(ConfigOption option) const
 {
-	const U64 val = getNumberU64(optionName);
+	const U64 val = getNumberU64(option);
 	if((val & ~U64(1)) != 0)
 	{
-		ANKI_CORE_LOGW("Expecting 0 or 1 for the config option \"%s\". Will mask out extra bits", optionName.cstr());
+		ANKI_CORE_LOGW("Expecting 0 or 1 for the config option \"%s\". Will mask out extra bits",
+			getOptionName(option).cstr());
 	}
 	return val & 1;
 }
 
-CString ConfigSet::getString(CString optionName) const
+CString ConfigSet::getString(ConfigOption option) const
 {
-	const Option& o = find(optionName);
+	const Option& o = m_options[U32(option)];
 	ANKI_ASSERT(o.m_type == Option::STRING);
 	return o.m_str.toCString();
 }
@@ -397,13 +396,15 @@ Error ConfigSet::setFromCommandLineArguments(U32 cmdLineArgsCount, char* cmdLine
 			++i;
 			arg = cmdLineArgs[i];
 			ANKI_ASSERT(arg);
-			Option* option = tryFind(arg);
-			if(option == nullptr)
+			ConfigOption optionIdx;
+			if(!tryFind(arg, optionIdx))
 			{
 				ANKI_CORE_LOGE("Option name following -cfg not found: %s", arg);
 				return Error::USER_DATA;
 			}
 
+			Option* option = &m_options[U32(optionIdx)];
+
 			// Set the value
 			++i;
 			arg = cmdLineArgs[i];
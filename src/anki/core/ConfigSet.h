@@ -6,8 +6,10 @@
 #pragma once
 
 #include <anki/core/Common.h>
-#include <anki/util/List.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/HashMap.h>
 #include <anki/util/String.h>
+#include <anki/util/Enum.h>
 
 namespace anki
 {
@@ -15,6 +17,23 @@ namespace anki
 /// @addtogroup core
 /// @{
 
+/// Compile-time handles of all the options declared in the ConfigDefs.h files. Use them instead of the option names
+/// where possible. They skip the name lookup and a typo becomes a compile error.
+enum class ConfigOption : U32
+{
+#define ANKI_CONFIG_OPTION(name, ...) name,
+#include <anki/core/ConfigDefs.h>
+#include <anki/resource/ConfigDefs.h>
+#include <anki/renderer/ConfigDefs.h>
+#include <anki/scene/ConfigDefs.h>
+#include <anki/gr/ConfigDefs.h>
+#undef ANKI_CONFIG_OPTION
+
+	COUNT,
+	FIRST = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(ConfigOption, inline)
+
 /// A storage of configuration variables.
 class ConfigSet
 {
@@ -34,33 +53,94 @@ public:
 
 	/// @name Set the value of an option.
 	/// @{
-	void set(CString option, CString value);
+	void set(ConfigOption option, CString value);
 
 	template<typename T, ANKI_ENABLE(std::is_integral<T>::value)>
-	void set(CString option, T value)
+	void set(ConfigOption option, T value)
 	{
 		setInternal(option, U64(value));
 	}
 
 	template<typename T, ANKI_ENABLE(std::is_floating_point<T>::value)>
-	void set(CString option, T value)
+	void set(ConfigOption option, T value)
 	{
 		setInternal(option, F64(value));
 	}
+
+	void set(CString option, CString value)
+	{
+		set(find(option), value);
+	}
+
+	template<typename T, ANKI_ENABLE(std::is_arithmetic<T>::value)>
+	void set(CString option, T value)
+	{
+		set(find(option), value);
+	}
 	/// @}
 
-	/// @name Find an option and return its value.
+	/// @name Return the value of an option.
 	/// @{
-	F64 getNumberF64(CString option) const;
-	F32 getNumberF32(CString option) const;
-	U64 getNumberU64(CString option) const;
-	U32 getNumberU32(CString option) const;
-	U16 getNumberU16(CString option) const;
-	U8 getNumberU8(CString option) const;
-	Bool getBool(CString option) const;
-	CString getString(CString option) const;
+	F64 getNumberF64(ConfigOption option) const;
+	F32 getNumberF32(ConfigOption option) const;
+	U64 getNumberU64(ConfigOption option) const;
+	U32 getNumberU32(ConfigOption option) const;
+	U16 getNumberU16(ConfigOption option) const;
+	U8 getNumberU8(ConfigOption option) const;
+	Bool getBool(ConfigOption option) const;
+	CString getString(ConfigOption option) const;
+	/// @}
+
+	/// @name Find an option using its name and return its value. Slower than the ConfigOption variants.
+	/// @{
+	F64 getNumberF64(CString option) const
+	{
+		return getNumberF64(find(option));
+	}
+
+	F32 getNumberF32(CString option) const
+	{
+		return getNumberF32(find(option));
+	}
+
+	U64 getNumberU64(CString option) const
+	{
+		return getNumberU64(find(option));
+	}
+
+	U32 getNumberU32(CString option) const
+	{
+		return getNumberU32(find(option));
+	}
+
+	U16 getNumberU16(CString option) const
+	{
+		return getNumberU16(find(option));
+	}
+
+	U8 getNumberU8(CString option) const
+	{
+		return getNumberU8(find(option));
+	}
+
+	Bool getBool(CString option) const
+	{
+		return getBool(find(option));
+	}
+
+	CString getString(CString option) const
+	{
+		return getString(find(option));
+	}
 	/// @}
 
+	/// Find the handle of an option using its name. Useful for the console and the command line.
+	/// @return True if the option was found.
+	Bool tryFind(CString name, ConfigOption& option) const;
+
+	/// Get the name of an option.
+	CString getOptionName(ConfigOption option) const;
+
 	ANKI_USE_RESULT Error loadFromFile(CString filename);
 
 	ANKI_USE_RESULT Error saveToFile(CString filename) const;
@@ -71,47 +151,46 @@ private:
 	class Option;
 
 	HeapAllocator<U8> m_alloc;
-	List<Option> m_options;
-
-	Option* tryFind(CString name);
-	const Option* tryFind(CString name) const;
+	DynamicArray<Option> m_options; ///< Indexed by ConfigOption.
+	HashMap<CString, ConfigOption> m_optionNameMap; ///< Points to the names of the m_options.
 
-	Option& find(CString name)
+	ConfigOption find(CString name) const
 	{
-		Option* o = tryFind(name);
-		ANKI_ASSERT(o && "Couldn't find config option");
-		return *o;
+		ConfigOption option = ConfigOption::COUNT;
+		const Bool found = tryFind(name, option);
+		(void)found;
+		ANKI_ASSERT(found && "Couldn't find config option");
+		return option;
 	}
 
-	const Option& find(CString name) const
-	{
-		const Option* o = tryFind(name);
-		ANKI_ASSERT(o && "Couldn't find config option");
-		return *o;
-	}
-
-	void setInternal(CString option, F64 value);
-	void setInternal(CString option, U64 value);
+	void setInternal(ConfigOption option, F64 value);
+	void setInternal(ConfigOption option, U64 value);
 
 	/// @name Create new options.
 	/// @{
-	void newOption(CString optionName, CString value, CString helpMsg);
+	void newOption(ConfigOption option, CString optionName, CString value, CString helpMsg);
 
 	template<typename T, ANKI_ENABLE(std::is_integral<T>::value)>
-	void newOption(CString optionName, T value, T minValue, T maxValue, CString helpMsg = "")
+	void newOption(ConfigOption option, CString optionName, T value, T minValue, T maxValue, CString helpMsg = "")
 	{
-		newOptionInternal(optionName, U64(value), U64(minValue), U64(maxValue), helpMsg);
+		newOptionInternal(option, optionName, U64(value), U64(minValue), U64(maxValue), helpMsg);
 	}
 
 	template<typename T, ANKI_ENABLE(std::is_floating_point<T>::value)>
-	void newOption(CString optionName, T value, T minValue, T maxValue, CString helpMsg = "")
+	void newOption(ConfigOption option, CString optionName, T value, T minValue, T maxValue, CString helpMsg = "")
 	{
-		newOptionInternal(optionName, F64(value), F64(minValue), F64(maxValue), helpMsg);
+		newOptionInternal(option, optionName, F64(value), F64(minValue), F64(maxValue), helpMsg);
 	}
 	/// @}
 
-	void newOptionInternal(CString optionName, U64 value, U64 minValue, U64 maxValue, CString helpMsg);
-	void newOptionInternal(CString optionName, F64 value, F64 minValue, F64 maxValue, CString helpMsg);
+	void newOptionInternal(
+		ConfigOption option, CString optionName, U64 value, U64 minValue, U64 maxValue, CString helpMsg);
+	void newOptionInternal(
+		ConfigOption option, CString optionName, F64 value, F64 minValue, F64 maxValue, CString helpMsg);
+
+	Option& newOptionCommon(ConfigOption option, CString optionName, CString helpMsg);
+
+	void destroy();
 };
 
 /// The default config set. Copy that to your own to override.
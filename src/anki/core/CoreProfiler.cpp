@@ -0,0 +1,318 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/core/CoreProfiler.h>
+#include <anki/util/File.h>
+#include <anki/util/Logger.h>
+#include <algorithm>
+
+namespace anki
+{
+
+class CoreProfiler::Event
+{
+public:
+	CString m_name;
+	Second m_start;
+	Second m_duration;
+	ThreadId m_tid;
+};
+
+class CoreProfiler::Scope
+{
+public:
+	CString m_name;
+	U32 m_parent;
+	U32 m_depth;
+
+	/// Ring buffer with the per-frame time of the scope.
+	DynamicArray<Second> m_history;
+	U32 m_historyCount = 0;
+	U32 m_historyNext = 0;
+
+	Second m_frameTime = 0.0;
+	U32 m_frameCallCount = 0;
+
+	Second m_lastFrameTime = 0.0;
+	U32 m_lastFrameCallCount = 0;
+};
+
+static U64 computeScopeKey(const char* name, PtrSize nameLength, U32 parent)
+{
+	const U64 hash = computeHash(&parent, sizeof(parent));
+	return appendHash(name, nameLength, hash);
+}
+
+CoreProfiler::~CoreProfiler()
+{
+	for(Scope& scope : m_scopes)
+	{
+		scope.m_history.destroy(m_alloc);
+	}
+
+	m_scopes.destroy(m_alloc);
+	m_scopeMap.destroy(m_alloc);
+	m_frameEvents.destroy(m_alloc);
+}
+
+Error CoreProfiler::init(GenericMemoryPoolAllocator<U8> alloc, U32 frameWindow)
+{
+	ANKI_ASSERT(frameWindow > 0);
+	m_alloc = alloc;
+	m_frameWindow = frameWindow;
+	return Error::NONE;
+}
+
+void CoreProfiler::addEvents(ThreadId tid, ConstWeakArray<TracerEvent> events)
+{
+	if(events.getSize() == 0)
+	{
+		return;
+	}
+
+	const U32 newCount = m_frameEventCount + events.getSize();
+	if(newCount > m_frameEvents.getSize())
+	{
+		m_frameEvents.resize(m_alloc, max(newCount, m_frameEvents.getSize() * 2));
+	}
+
+	for(const TracerEvent& in : events)
+	{
+		Event& out = m_frameEvents[m_frameEventCount++];
+		out.m_name = in.m_name;
+		out.m_start = in.m_start;
+		out.m_duration = in.m_duration;
+		out.m_tid = tid;
+	}
+}
+
+U32 CoreProfiler::getOrCreateScope(CString name, U32 parent)
+{
+	const U64 key = computeScopeKey(name.cstr(), name.getLength(), parent);
+
+	auto it = m_scopeMap.find(key);
+	if(it != m_scopeMap.getEnd())
+	{
+		return *it;
+	}
+
+	const U32 idx = m_scopes.getSize();
+	Scope& scope = *m_scopes.emplaceBack(m_alloc);
+	scope.m_name = name;
+	scope.m_parent = parent;
+	scope.m_depth = (parent == MAX_U32) ? 0 : m_scopes[parent].m_depth + 1;
+	scope.m_history.create(m_alloc, m_frameWindow, 0.0);
+
+	m_scopeMap.emplace(m_alloc, key, idx);
+	return idx;
+}
+
+void CoreProfiler::endFrame(U64 frame)
+{
+	// Sort the events per thread and in a way that parents come before their children
+	std::sort(m_frameEvents.getBegin(),
+		m_frameEvents.getBegin() + m_frameEventCount,
+		[](const Event& a, const Event& b) {
+			if(a.m_tid != b.m_tid)
+			{
+				return a.m_tid < b.m_tid;
+			}
+
+			return (a.m_start != b.m_start) ? a.m_start < b.m_start : a.m_duration > b.m_duration;
+		});
+
+	// Walk the events and re-construct the hierarchy using a stack of the currently open scopes
+	class StackEntry
+	{
+	public:
+		U32 m_scope;
+		Second m_end;
+	};
+
+	Array<StackEntry, MAX_SCOPE_DEPTH> stack;
+	U32 stackSize = 0;
+	ThreadId crntTid = 0;
+	for(U32 i = 0; i < m_frameEventCount; ++i)
+	{
+		const Event& event = m_frameEvents[i];
+
+		if(i == 0 || event.m_tid != crntTid)
+		{
+			crntTid = event.m_tid;
+			stackSize = 0;
+		}
+
+		while(stackSize > 0 && event.m_start >= stack[stackSize - 1].m_end)
+		{
+			--stackSize;
+		}
+
+		if(ANKI_UNLIKELY(stackSize == MAX_SCOPE_DEPTH))
+		{
+			ANKI_CORE_LOGW("Profiler scopes are nested too deep. Ignoring event: %s", event.m_name.cstr());
+			continue;
+		}
+
+		const U32 parent = (stackSize > 0) ? stack[stackSize - 1].m_scope : MAX_U32;
+		const U32 scopeIdx = getOrCreateScope(event.m_name, parent);
+
+		Scope& scope = m_scopes[scopeIdx];
+		scope.m_frameTime += event.m_duration;
+		++scope.m_frameCallCount;
+
+		stack[stackSize].m_scope = scopeIdx;
+		stack[stackSize].m_end = event.m_start + event.m_duration;
+		++stackSize;
+	}
+
+	m_frameEventCount = 0;
+
+	// Update the rolling stats. Only the frames that a scope appeared are taken into account
+	for(Scope& scope : m_scopes)
+	{
+		scope.m_lastFrameTime = scope.m_frameTime;
+		scope.m_lastFrameCallCount = scope.m_frameCallCount;
+
+		if(scope.m_frameCallCount > 0)
+		{
+			scope.m_history[scope.m_historyNext] = scope.m_frameTime;
+			scope.m_historyNext = (scope.m_historyNext + 1) % m_frameWindow;
+			scope.m_historyCount = min(scope.m_historyCount + 1, m_frameWindow);
+		}
+
+		scope.m_frameTime = 0.0;
+		scope.m_frameCallCount = 0;
+	}
+
+	m_lastFrame = frame;
+}
+
+void CoreProfiler::getScopeStats(U32 scopeIdx, CoreProfilerScopeStats& stats) const
+{
+	const Scope& scope = m_scopes[scopeIdx];
+
+	stats.m_name = scope.m_name;
+	stats.m_parent = scope.m_parent;
+	stats.m_depth = scope.m_depth;
+	stats.m_lastFrame = scope.m_lastFrameTime;
+	stats.m_lastFrameCallCount = scope.m_lastFrameCallCount;
+	stats.m_sampleCount = scope.m_historyCount;
+
+	if(scope.m_historyCount == 0)
+	{
+		stats.m_min = stats.m_avg = stats.m_max = stats.m_p99 = 0.0;
+		return;
+	}
+
+	DynamicArrayAuto<Second> sorted(m_alloc, scope.m_historyCount);
+	memcpy(&sorted[0], &scope.m_history[0], sorted.getSizeInBytes());
+	std::sort(sorted.getBegin(), sorted.getEnd());
+
+	Second sum = 0.0;
+	for(Second s : sorted)
+	{
+		sum += s;
+	}
+
+	const U32 p99Idx = min((99 * sorted.getSize() + 99) / 100, sorted.getSize()) - 1;
+
+	stats.m_min = sorted.getFront();
+	stats.m_max = sorted.getBack();
+	stats.m_avg = sum / F64(sorted.getSize());
+	stats.m_p99 = sorted[p99Idx];
+}
+
+Bool CoreProfiler::findScope(CString path, U32& scopeIdx) const
+{
+	if(path.isEmpty())
+	{
+		return false;
+	}
+
+	U32 parent = MAX_U32;
+	const char* begin = path.cstr();
+	const char* const end = begin + path.getLength();
+	while(begin < end)
+	{
+		const char* tokenEnd = begin;
+		while(tokenEnd < end && *tokenEnd != '/')
+		{
+			++tokenEnd;
+		}
+
+		auto it = m_scopeMap.find(computeScopeKey(begin, PtrSize(tokenEnd - begin), parent));
+		if(it == m_scopeMap.getEnd())
+		{
+			return false;
+		}
+
+		parent = *it;
+		begin = tokenEnd + 1;
+	}
+
+	scopeIdx = parent;
+	return true;
+}
+
+void CoreProfiler::getScopesDepthFirstInternal(U32 parent, DynamicArrayAuto<U32>& scopeIndices) const
+{
+	for(U32 i = 0; i < m_scopes.getSize(); ++i)
+	{
+		if(m_scopes[i].m_parent == parent)
+		{
+			scopeIndices.emplaceBack(i);
+			getScopesDepthFirstInternal(i, scopeIndices);
+		}
+	}
+}
+
+void CoreProfiler::getScopesDepthFirst(DynamicArrayAuto<U32>& scopeIndices) const
+{
+	scopeIndices.destroy();
+	getScopesDepthFirstInternal(MAX_U32, scopeIndices);
+}
+
+void CoreProfiler::getReport(StringAuto& report) const
+{
+	report.destroy();
+	report.sprintf("Frame %" PRIu64 " (stats over %u frames, times in ms)\n", m_lastFrame, m_frameWindow);
+
+	DynamicArrayAuto<U32> scopeIndices(m_alloc);
+	getScopesDepthFirst(scopeIndices);
+
+	for(U32 scopeIdx : scopeIndices)
+	{
+		CoreProfilerScopeStats stats;
+		getScopeStats(scopeIdx, stats);
+
+		StringAuto line(m_alloc);
+		line.sprintf("%*s%s: last %.3f (%u calls), min %.3f, avg %.3f, max %.3f, p99 %.3f\n",
+			I32(stats.m_depth * 2),
+			"",
+			stats.m_name.cstr(),
+			stats.m_lastFrame * 1000.0,
+			stats.m_lastFrameCallCount,
+			stats.m_min * 1000.0,
+			stats.m_avg * 1000.0,
+			stats.m_max * 1000.0,
+			stats.m_p99 * 1000.0);
+
+		report.append(line);
+	}
+}
+
+Error CoreProfiler::writeReport(CString filename) const
+{
+	StringAuto report(m_alloc);
+	getReport(report);
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::WRITE));
+	ANKI_CHECK(file.writeText("%s", report.cstr()));
+
+	return Error::NONE;
+}
+
+} // end namespace anki
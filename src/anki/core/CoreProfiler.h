@@ -0,0 +1,110 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/core/Common.h>
+#include <anki/util/Tracer.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/String.h>
+
+namespace anki
+{
+
+/// @addtogroup core
+/// @{
+
+/// The statistics of a single profiler scope.
+/// @memberof CoreProfiler
+class CoreProfilerScopeStats
+{
+public:
+	CString m_name;
+	U32 m_parent = MAX_U32; ///< Index of the parent scope. MAX_U32 if it's a root.
+	U32 m_depth = 0;
+
+	Second m_lastFrame = 0.0; ///< The time spent in the scope in the last frame.
+	Second m_min = 0.0;
+	Second m_avg = 0.0;
+	Second m_max = 0.0;
+	Second m_p99 = 0.0;
+
+	U32 m_lastFrameCallCount = 0;
+	U32 m_sampleCount = 0; ///< Number of frames the stats were computed from.
+};
+
+/// A hierarchical CPU profiler. It sits on top of the tracer and re-constructs the scope hierarchy from the nesting of
+/// the ANKI_TRACE_SCOPED_EVENT events of each thread. It keeps the time of every scope for a rolling window of frames.
+class CoreProfiler
+{
+public:
+	CoreProfiler() = default;
+
+	~CoreProfiler();
+
+	/// @param frameWindow The number of frames to keep stats for.
+	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, U32 frameWindow);
+
+	/// Feed events of a single thread. It can be called multiple times per frame.
+	void addEvents(ThreadId tid, ConstWeakArray<TracerEvent> events);
+
+	/// Process all the events of the frame and update the rolling stats.
+	void endFrame(U64 frame);
+
+	U32 getScopeCount() const
+	{
+		return m_scopes.getSize();
+	}
+
+	/// Compute the rolling stats of a scope.
+	void getScopeStats(U32 scopeIdx, CoreProfilerScopeStats& stats) const;
+
+	/// Find a scope using its path. The path has the form "FRAME/SCENE_UPDATE/SCENE_PHYSICS_UPDATE".
+	/// @return True if the scope was found.
+	Bool findScope(CString path, U32& scopeIdx) const;
+
+	/// Get the scopes sorted depth first. Useful for printing.
+	void getScopesDepthFirst(DynamicArrayAuto<U32>& scopeIndices) const;
+
+	/// Write a report of the last frame with the rolling stats.
+	void getReport(StringAuto& report) const;
+
+	/// Same as getReport() but writes it to a file.
+	ANKI_USE_RESULT Error writeReport(CString filename) const;
+
+	U64 getLastFrame() const
+	{
+		return m_lastFrame;
+	}
+
+	U32 getFrameWindow() const
+	{
+		return m_frameWindow;
+	}
+
+private:
+	static constexpr U32 MAX_SCOPE_DEPTH = 64;
+
+	class Event;
+	class Scope;
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+
+	DynamicArray<Scope> m_scopes;
+	HashMap<U64, U32> m_scopeMap; ///< Key is a hash of the parent scope and the name of the scope.
+
+	DynamicArray<Event> m_frameEvents;
+	U32 m_frameEventCount = 0;
+
+	U32 m_frameWindow = 0;
+	U64 m_lastFrame = 0;
+
+	U32 getOrCreateScope(CString name, U32 parent);
+
+	void getScopesDepthFirstInternal(U32 parent, DynamicArrayAuto<U32>& scopeIndices) const;
+};
+/// @}
+
+} // end namespace anki
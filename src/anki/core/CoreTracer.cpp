@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/core/CoreTracer.h>
+#include <anki/core/CoreProfiler.h>
 #include <anki/util/DynamicArray.h>
 #include <anki/util/Tracer.h>
 #include <anki/math/Functions.h>
@@ -316,6 +317,11 @@ void CoreTracer::flushFrame(U64 frame)
 			Ctx& ctx = *static_cast<Ctx*>(ud);
 			CoreTracer& self = *ctx.m_self;
 
+			if(self.m_profiler)
+			{
+				self.m_profiler->addEvents(tid, events);
+			}
+
 			ThreadWorkItem* item = self.m_alloc.newInstance<ThreadWorkItem>(self.m_alloc);
 			item->m_tid = tid;
 			item->m_frame = ctx.m_frame;
@@ -337,6 +343,11 @@ void CoreTracer::flushFrame(U64 frame)
 			self.m_cvar.notifyOne();
 		},
 		&ctx);
+
+	if(m_profiler)
+	{
+		m_profiler->endFrame(frame);
+	}
 }
 
 Error CoreTracer::writeCountersForReal()
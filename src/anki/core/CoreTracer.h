@@ -14,6 +14,9 @@
 namespace anki
 {
 
+// Forward
+class CoreProfiler;
+
 /// @addtogroup core
 /// @{
 
@@ -31,6 +34,12 @@ public:
 	/// It will flush everything.
 	void flushFrame(U64 frame);
 
+	/// Set a profiler that will also be fed with the events of every frame.
+	void setProfiler(CoreProfiler* profiler)
+	{
+		m_profiler = profiler;
+	}
+
 private:
 	class ThreadWorkItem;
 	class PerFrameCounters;
@@ -49,6 +58,8 @@ private:
 	File m_countersCsvFile;
 	Bool m_quit = false;
 
+	CoreProfiler* m_profiler = nullptr;
+
 	Error threadWorker();
 
 	Error writeEvents(ThreadWorkItem& item);
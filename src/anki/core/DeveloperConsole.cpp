@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/core/DeveloperConsole.h>
+#include <anki/core/CoreProfiler.h>
 
 namespace anki
 {
@@ -47,6 +48,18 @@ void DeveloperConsole::build(CanvasPtr ctx)
 	ImGui::SetWindowPos(Vec2(0.0f, 0.0f));
 	ImGui::SetWindowSize(Vec2(F32(ctx->getWidth()), F32(ctx->getHeight()) * (2.0f / 3.0f)));
 
+	// Profiler stats
+	if(m_profiler && ImGui::CollapsingHeader("Profiler"))
+	{
+		buildProfilerStats();
+	}
+
+	// Memory stats
+	if(ImGui::CollapsingHeader("Memory"))
+	{
+		buildMemoryStats();
+	}
+
 	// Push the items
 	const F32 footerHeightToPreserve = ImGui::GetStyle().ItemSpacing.y + ImGui::GetFrameHeightWithSpacing();
 	ImGui::BeginChild("ScrollingRegion",
@@ -119,6 +132,79 @@ void DeveloperConsole::build(CanvasPtr ctx)
 	ctx->popFont();
 }
 
+void DeveloperConsole::buildProfilerStats()
+{
+	ANKI_ASSERT(m_profiler);
+
+	ImGui::Text("Frame %" PRIu64 ", stats over %u frames (min/avg/max/p99 in ms)",
+		m_profiler->getLastFrame(),
+		m_profiler->getFrameWindow());
+
+	DynamicArrayAuto<U32> scopeIndices(m_alloc);
+	m_profiler->getScopesDepthFirst(scopeIndices);
+
+	for(U32 scopeIdx : scopeIndices)
+	{
+		CoreProfilerScopeStats stats;
+		m_profiler->getScopeStats(scopeIdx, stats);
+
+		ImGui::Text("%*s%s: %.3f/%.3f/%.3f/%.3f",
+			I32(stats.m_depth * 2),
+			"",
+			stats.m_name.cstr(),
+			stats.m_min * 1000.0,
+			stats.m_avg * 1000.0,
+			stats.m_max * 1000.0,
+			stats.m_p99 * 1000.0);
+	}
+}
+
+void DeveloperConsole::buildMemoryStats()
+{
+	MemoryTrackerSnapshot crnt;
+	MemoryTrackerSingleton::get().getSnapshot(crnt);
+
+	if(ImGui::Button("Snapshot"))
+	{
+		m_memSnapshot = crnt;
+		m_memSnapshotTaken = true;
+	}
+
+	ImGui::SameLine();
+	if(ImGui::Button("Reset peaks"))
+	{
+		MemoryTrackerSingleton::get().resetPeaks();
+	}
+
+	ImGui::Text("(memory/peak in KB%s)", (m_memSnapshotTaken) ? ", diff since snapshot" : "");
+
+	for(MemoryTag tag = MemoryTag::FIRST; tag < MemoryTag::COUNT; ++tag)
+	{
+		const MemoryTagStats& stats = crnt.m_tags[tag];
+
+		if(m_memSnapshotTaken)
+		{
+			const MemoryTagStatsDiff diff = crnt.diff(m_memSnapshot, tag);
+			ImGui::Text("%-10s %10.1f/%10.1f, %+.1fKB, %" PRIu64 " allocations, %" PRIi64 " live",
+				MemoryTracker::getTagName(tag),
+				F64(stats.m_memoryUsage) / 1024.0,
+				F64(stats.m_peakMemoryUsage) / 1024.0,
+				F64(diff.m_memoryUsage) / 1024.0,
+				diff.m_allocationCount,
+				diff.getLiveAllocationCount());
+		}
+		else
+		{
+			ImGui::Text("%-10s %10.1f/%10.1f, %" PRIu64 " allocations, %" PRIu64 " frees",
+				MemoryTracker::getTagName(tag),
+				F64(stats.m_memoryUsage) / 1024.0,
+				F64(stats.m_peakMemoryUsage) / 1024.0,
+				stats.m_allocationCount,
+				stats.m_freeCount);
+		}
+	}
+}
+
 void DeveloperConsole::newLogItem(const LoggerMessageInfo& inf)
 {
 	LogItem* newLogItem;
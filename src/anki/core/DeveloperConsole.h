@@ -13,6 +13,9 @@
 namespace anki
 {
 
+// Forward
+class CoreProfiler;
+
 /// @addtogroup core
 /// @{
 
@@ -31,6 +34,12 @@ public:
 
 	void build(CanvasPtr ctx) override;
 
+	/// Set a profiler to display its stats in the console. Can be nullptr.
+	void setProfiler(const CoreProfiler* profiler)
+	{
+		m_profiler = profiler;
+	}
+
 private:
 	static constexpr U MAX_LOG_ITEMS = 64;
 
@@ -56,8 +65,17 @@ private:
 
 	ScriptEnvironment m_scriptEnv;
 
+	const CoreProfiler* m_profiler = nullptr;
+
+	MemoryTrackerSnapshot m_memSnapshot; ///< The snapshot the memory stats are compared against.
+	Bool m_memSnapshotTaken = false;
+
 	void newLogItem(const LoggerMessageInfo& inf);
 
+	void buildProfilerStats();
+
+	void buildMemoryStats();
+
 	static void loggerCallback(void* userData, const LoggerMessageInfo& info)
 	{
 		static_cast<DeveloperConsole*>(userData)->newLogItem(info);
@@ -4,24 +4,32 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/core/NativeWindow.h>
+#include <anki/util/Logger.h>
 
 namespace anki
 {
 
-NativeWindow::~NativeWindow
+/// A window that doesn't present anything. Used for headless runs.
+class NativeWindowImpl
 {
-}
+};
 
-void NativeWindow::create(NativeWindowInitInfo&)
+Error NativeWindow::init(NativeWindowInitInfo& init, HeapAllocator<U8>& alloc)
 {
-}
+	m_alloc = alloc;
+	m_impl = m_alloc.newInstance<NativeWindowImpl>();
 
-void NativeWindow::destroy()
-{
+	m_width = init.m_width;
+	m_height = init.m_height;
+
+	ANKI_CORE_LOGI("Dummy window created");
+	return Error::NONE;
 }
 
-void NativeWindow::swapBuffers()
+void NativeWindow::destroy()
 {
+	m_alloc.deleteInstance(m_impl);
+	m_impl = nullptr;
 }
 
 } // end namespace anki
@@ -26,10 +26,14 @@ Error StagingGpuMemoryManager::init(GrManager* gr, const ConfigSet& cfg)
 {
 	m_gr = gr;
 
-	m_perFrameBuffers[StagingGpuMemoryType::UNIFORM].m_size = cfg.getNumberU32("core_uniformPerFrameMemorySize");
-	m_perFrameBuffers[StagingGpuMemoryType::STORAGE].m_size = cfg.getNumberU32("core_storagePerFrameMemorySize");
-	m_perFrameBuffers[StagingGpuMemoryType::VERTEX].m_size = cfg.getNumberU32("core_vertexPerFrameMemorySize");
-	m_perFrameBuffers[StagingGpuMemoryType::TEXTURE].m_size = cfg.getNumberU32("core_textureBufferPerFrameMemorySize");
+	m_perFrameBuffers[StagingGpuMemoryType::UNIFORM].m_size =
+		cfg.getNumberU32(ConfigOption::core_uniformPerFrameMemorySize);
+	m_perFrameBuffers[StagingGpuMemoryType::STORAGE].m_size =
+		cfg.getNumberU32(ConfigOption::core_storagePerFrameMemorySize);
+	m_perFrameBuffers[StagingGpuMemoryType::VERTEX].m_size =
+		cfg.getNumberU32(ConfigOption::core_vertexPerFrameMemorySize);
+	m_perFrameBuffers[StagingGpuMemoryType::TEXTURE].m_size =
+		cfg.getNumberU32(ConfigOption::core_textureBufferPerFrameMemorySize);
 
 	initBuffer(StagingGpuMemoryType::UNIFORM,
 		gr->getDeviceCapabilities().m_uniformBufferBindOffsetAlignment,
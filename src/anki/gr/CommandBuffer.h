@@ -222,6 +222,11 @@ public:
 	/// Set the line width. By default it's undefined.
 	void setLineWidth(F32 lineWidth);
 
+	/// Allow the next drawcalls to be skipped while their pipelines are created in the background (see
+	/// gr_asyncPipelineCreation). Use it for drawcalls that the frame can do without for a few frames (eg the
+	/// renderables). The rest wait for their pipelines. By default it's false.
+	void setSkippableDrawcalls(Bool skippable);
+
 	/// Bind texture and sample.
 	/// @param set The set to bind to.
 	/// @param binding The binding to bind to.
@@ -45,6 +45,13 @@ static void getFormatInfo(Format fmt, U& texelComponents, U& texelBytes, U& bloc
 	case Format::R8G8B8_UINT:
 	case Format::R8G8B8_UNORM:
 	case Format::R8G8B8_USCALED:
+	case Format::B8G8R8_SINT:
+	case Format::B8G8R8_SNORM:
+	case Format::B8G8R8_SRGB:
+	case Format::B8G8R8_SSCALED:
+	case Format::B8G8R8_UINT:
+	case Format::B8G8R8_UNORM:
+	case Format::B8G8R8_USCALED:
 		texelComponents = 3;
 		texelBytes = texelComponents * 1;
 		break;
@@ -55,6 +62,20 @@ static void getFormatInfo(Format fmt, U& texelComponents, U& texelBytes, U& bloc
 	case Format::R8G8B8A8_UINT:
 	case Format::R8G8B8A8_UNORM:
 	case Format::R8G8B8A8_USCALED:
+	case Format::B8G8R8A8_SINT:
+	case Format::B8G8R8A8_SNORM:
+	case Format::B8G8R8A8_SRGB:
+	case Format::B8G8R8A8_SSCALED:
+	case Format::B8G8R8A8_UINT:
+	case Format::B8G8R8A8_UNORM:
+	case Format::B8G8R8A8_USCALED:
+	case Format::A8B8G8R8_SINT_PACK32:
+	case Format::A8B8G8R8_SNORM_PACK32:
+	case Format::A8B8G8R8_SRGB_PACK32:
+	case Format::A8B8G8R8_SSCALED_PACK32:
+	case Format::A8B8G8R8_UINT_PACK32:
+	case Format::A8B8G8R8_UNORM_PACK32:
+	case Format::A8B8G8R8_USCALED_PACK32:
 		texelComponents = 4;
 		texelBytes = texelComponents * 1;
 		break;
@@ -169,7 +190,13 @@ static void getFormatInfo(Format fmt, U& texelComponents, U& texelBytes, U& bloc
 		texelComponents = 1;
 		texelBytes = texelComponents * 2;
 		break;
+	case Format::S8_UINT:
+		texelComponents = 1;
+		texelBytes = texelComponents * 1;
+		break;
+	case Format::D16_UNORM_S8_UINT:
 	case Format::D24_UNORM_S8_UINT:
+	case Format::X8_D24_UNORM_PACK32:
 		texelComponents = 1;
 		texelBytes = texelComponents * 4;
 		break;
@@ -177,6 +204,10 @@ static void getFormatInfo(Format fmt, U& texelComponents, U& texelBytes, U& bloc
 		texelComponents = 1;
 		texelBytes = texelComponents * 4;
 		break;
+	case Format::D32_SFLOAT_S8_UINT:
+		texelComponents = 1;
+		texelBytes = texelComponents * 8;
+		break;
 	default:
 		ANKI_ASSERT(0);
 	}
@@ -12,5 +12,14 @@ ANKI_CONFIG_OPTION(gr_rayTracing, 0, 0, 1, "Try enabling ray tracing")
 
 // Vulkan
 ANKI_CONFIG_OPTION(gr_diskShaderCacheMaxSize, 128_MB, 1_MB, 1_GB)
+ANKI_CONFIG_OPTION(gr_asyncPipelineCreation,
+	0,
+	0,
+	1,
+	"Create the missing pipelines of the skippable drawcalls (eg the renderables) in the background and skip the "
+	"drawcalls until then")
+ANKI_CONFIG_OPTION(
+	gr_pipelinePrewarm, 1, 0, 1, "Create at load time the pipelines that were used in the previous runs")
+ANKI_CONFIG_OPTION(gr_pipelineCreationThreadCount, 2, 1, 16)
 ANKI_CONFIG_OPTION(gr_vkminor, 2, 2, 2)
 ANKI_CONFIG_OPTION(gr_vkmajor, 1, 1, 1)
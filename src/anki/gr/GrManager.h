@@ -38,7 +38,17 @@ class GrManagerStats
 public:
 	PtrSize m_cpuMemory = 0;
 	PtrSize m_gpuMemory = 0;
+	PtrSize m_unusedGpuMemory = 0; ///< The GPU memory of the allocated chunks that is not used by any allocation.
 	U32 m_commandBufferCount = 0;
+
+	U32 m_pipelineCount = 0; ///< The graphics pipelines that were created.
+	U32 m_pipelineHitchCount = 0; ///< The graphics pipelines that were created while recording commands.
+	U32 m_prewarmedPipelineCount = 0; ///< The graphics pipelines that were created using the states of previous runs.
+	U32 m_pendingPipelineCount = 0; ///< The graphics pipelines that are created in the background.
+	Second m_pipelineCreationTime = 0.0; ///< The total time spent creating graphics pipelines.
+
+	U32 m_descriptorSetAllocationCount = 0; ///< The descriptor sets that were allocated or recycled in the last frame.
+	U32 m_descriptorWriteCount = 0; ///< The descriptors that were written in the last frame.
 };
 
 /// The graphics manager, owner of all graphics objects.
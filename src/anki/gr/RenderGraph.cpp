@@ -9,6 +9,7 @@
 #include <anki/gr/Sampler.h>
 #include <anki/gr/Framebuffer.h>
 #include <anki/gr/CommandBuffer.h>
+#include <anki/gr/utils/TransientResourceAliasing.h>
 #include <anki/util/Tracer.h>
 #include <anki/util/BitSet.h>
 #include <anki/util/File.h>
@@ -25,6 +26,31 @@ static inline U32 getTextureSurfOrVolCount(const TexturePtr& tex)
 	return tex->getMipmapCount() * tex->getLayerCount() * (textureTypeIsCube(tex->getTextureType()) ? 6 : 1);
 }
 
+static inline U32 getTextureSurfOrVolCount(const TextureInitInfo& init)
+{
+	return init.m_mipmapCount * init.m_layerCount * (textureTypeIsCube(init.m_type) ? 6 : 1);
+}
+
+static PtrSize computeTextureMemorySize(const TextureInitInfo& init)
+{
+	PtrSize size = 0;
+	for(U32 mip = 0; mip < init.m_mipmapCount; ++mip)
+	{
+		const U32 width = max(init.m_width >> mip, 1u);
+		const U32 height = max(init.m_height >> mip, 1u);
+		if(init.m_type == TextureType::_3D)
+		{
+			size += computeVolumeSize(width, height, max(init.m_depth >> mip, 1u), init.m_format);
+		}
+		else
+		{
+			size += computeSurfaceSize(width, height, init.m_format);
+		}
+	}
+
+	return size * init.m_layerCount * (textureTypeIsCube(init.m_type) ? 6 : 1) * init.m_samples;
+}
+
 /// Contains some extra things for render targets.
 class RenderGraph::RT
 {
@@ -32,6 +58,8 @@ public:
 	DynamicArray<TextureUsageBit> m_surfOrVolUsages;
 	DynamicArray<U16> m_lastBatchThatTransitionedIt;
 	TexturePtr m_texture; ///< Hold a reference.
+	/// The RT that tracks the usages of the texture. It's another RT if the texture is shared by transient RTs.
+	U32 m_usageTrackerIdx;
 	Bool m_imported;
 };
 
@@ -253,6 +281,13 @@ RenderGraph::~RenderGraph()
 	}
 
 	m_importedRenderTargets.destroy(getAllocator());
+
+	for(CompiledGraphCacheEntry& entry : m_compiledGraphCache)
+	{
+		destroyCompiledGraphCacheEntry(entry);
+	}
+
+	m_compiledGraphCache.destroy(getAllocator());
 }
 
 RenderGraph* RenderGraph::newInstance(GrManager* manager)
@@ -379,25 +414,18 @@ TexturePtr RenderGraph::getOrCreateRenderTarget(const TextureInitInfo& initInf,
 }
 
 FramebufferPtr RenderGraph::getOrCreateFramebuffer(
-	const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles, CString name, Bool& drawsToPresentable)
+	const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles, CString name)
 {
 	ANKI_ASSERT(rtHandles);
 	U64 hash = fbDescr.m_hash;
 	ANKI_ASSERT(hash > 0);
 
-	drawsToPresentable = false;
-
 	// Create a hash that includes the render targets
 	Array<U64, MAX_COLOR_ATTACHMENTS + 1> uuids;
 	U count = 0;
 	for(U i = 0; i < fbDescr.m_colorAttachmentCount; ++i)
 	{
 		uuids[count++] = m_ctx->m_rts[rtHandles[i].m_idx].m_texture->getUuid();
-
-		if(!!(m_ctx->m_rts[rtHandles[i].m_idx].m_texture->getTextureUsage() & TextureUsageBit::PRESENT))
-		{
-			drawsToPresentable = true;
-		}
 	}
 
 	if(!!fbDescr.m_depthStencilAttachment.m_aspect)
@@ -620,22 +648,13 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 		}
 		else
 		{
-			// Need to create new
-
-			// Create a new TextureInitInfo with the derived usage
-			TextureInitInfo initInf = inRt.m_initInfo;
-			initInf.m_usage = inRt.m_usageDerivedByDeps;
-			ANKI_ASSERT(initInf.m_usage != TextureUsageBit::NONE);
-
-			// Create the new hash
-			const U64 hash = appendHash(&initInf.m_usage, sizeof(initInf.m_usage), inRt.m_hash);
-
-			// Get or create the texture
-			outRt.m_texture = getOrCreateRenderTarget(initInf, hash);
+			// The texture will be created when the lifetimes of the RTs are known
+			ANKI_ASSERT(inRt.m_usageDerivedByDeps != TextureUsageBit::NONE);
 		}
 
 		// Init the usage
-		const U32 surfOrVolumeCount = getTextureSurfOrVolCount(outRt.m_texture);
+		const U32 surfOrVolumeCount =
+			(imported) ? getTextureSurfOrVolCount(outRt.m_texture) : getTextureSurfOrVolCount(inRt.m_initInfo);
 		outRt.m_surfOrVolUsages.create(alloc, surfOrVolumeCount, TextureUsageBit::NONE);
 		if(imported && inRt.m_importedAndUndefinedUsage)
 		{
@@ -664,6 +683,7 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 		}
 
 		outRt.m_lastBatchThatTransitionedIt.create(alloc, surfOrVolumeCount, MAX_U16);
+		outRt.m_usageTrackerIdx = rtIdx;
 		outRt.m_imported = imported;
 	}
 
@@ -681,7 +701,7 @@ RenderGraph::BakeContext* RenderGraph::newContext(const RenderGraphDescription&
 	return ctx;
 }
 
-void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+void RenderGraph::initRenderPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
 {
 	BakeContext& ctx = *m_ctx;
 	const U32 passCount = descr.m_passes.getSize();
@@ -709,7 +729,7 @@ void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr
 			memcpy(&inf, &inDep.m_texture, sizeof(inf));
 		}
 
-		// Create command buffers and framebuffer
+		// Will the pass draw to the swapchain? Only imported RTs can be presentable
 		if(inPass.m_type == RenderPassDescriptionBase::Type::GRAPHICS)
 		{
 			const GraphicsRenderPassDescription& graphicsPass =
@@ -717,12 +737,16 @@ void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr
 
 			if(graphicsPass.hasFramebuffer())
 			{
-				Bool drawsToPresentable;
-				outPass.fb() = getOrCreateFramebuffer(
-					graphicsPass.m_fbDescr, &graphicsPass.m_rtHandles[0], inPass.m_name.cstr(), drawsToPresentable);
+				for(U32 i = 0; i < graphicsPass.m_fbDescr.m_colorAttachmentCount; ++i)
+				{
+					const RT& rt = ctx.m_rts[graphicsPass.m_rtHandles[i].m_idx];
+					if(rt.m_imported && !!(rt.m_texture->getTextureUsage() & TextureUsageBit::PRESENT))
+					{
+						outPass.m_drawsToPresentable = true;
+					}
+				}
 
 				outPass.m_fbRenderArea = graphicsPass.m_fbRenderArea;
-				outPass.m_drawsToPresentable = drawsToPresentable;
 			}
 			else
 			{
@@ -733,6 +757,18 @@ void RenderGraph::initRenderPassesAndSetDeps(const RenderGraphDescription& descr
 		{
 			ANKI_ASSERT(inPass.m_secondLevelCmdbsCount == 0 && "Can't have second level cmdbs");
 		}
+	}
+}
+
+void RenderGraph::setPassDependencies(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
+{
+	BakeContext& ctx = *m_ctx;
+	const U32 passCount = descr.m_passes.getSize();
+
+	for(U32 passIdx = 0; passIdx < passCount; ++passIdx)
+	{
+		const RenderPassDescriptionBase& inPass = *descr.m_passes[passIdx];
+		Pass& outPass = ctx.m_passes[passIdx];
 
 		// Set dependencies by checking all previous subpasses.
 		U32 prevPassIdx = passIdx;
@@ -754,14 +790,11 @@ void RenderGraph::initBatches()
 	U passesAssignedToBatchCount = 0;
 	const U passCount = m_ctx->m_passes.getSize();
 	ANKI_ASSERT(passCount > 0);
-	Bool setTimestamp = m_ctx->m_gatherStatistics;
 	while(passesAssignedToBatchCount < passCount)
 	{
 		m_ctx->m_batches.emplaceBack(m_ctx->m_alloc);
 		Batch& batch = m_ctx->m_batches.getBack();
 
-		Bool drawsToPresentable = false;
-
 		for(U32 i = 0; i < passCount; ++i)
 		{
 			if(!m_ctx->m_passIsInBatch.get(i) && !passHasUnmetDependencies(*m_ctx, i))
@@ -769,12 +802,32 @@ void RenderGraph::initBatches()
 				// Add to the batch
 				++passesAssignedToBatchCount;
 				batch.m_passIndices.emplaceBack(m_ctx->m_alloc, i);
-
-				// Will batch draw to the swapchain?
-				drawsToPresentable = drawsToPresentable || m_ctx->m_passes[i].m_drawsToPresentable;
 			}
 		}
 
+		// Mark batch's passes done
+		for(U32 passIdx : m_ctx->m_batches.getBack().m_passIndices)
+		{
+			m_ctx->m_passIsInBatch.set(passIdx);
+			m_ctx->m_passes[passIdx].m_batchIdx = m_ctx->m_batches.getSize() - 1;
+		}
+	}
+}
+
+void RenderGraph::initBatchCommandBuffers()
+{
+	ANKI_ASSERT(m_ctx);
+
+	Bool setTimestamp = m_ctx->m_gatherStatistics;
+	for(Batch& batch : m_ctx->m_batches)
+	{
+		// Will batch draw to the swapchain?
+		Bool drawsToPresentable = false;
+		for(U32 passIdx : batch.m_passIndices)
+		{
+			drawsToPresentable = drawsToPresentable || m_ctx->m_passes[passIdx].m_drawsToPresentable;
+		}
+
 		// Get or create cmdb for the batch.
 		// Create a new cmdb if the batch is writing to swapchain. This will help Vulkan to have a dependency of the
 		// swap chain image acquire to the 2nd command buffer instead of adding it to a single big cmdb.
@@ -804,14 +857,106 @@ void RenderGraph::initBatches()
 		{
 			batch.m_cmdb = m_ctx->m_graphicsCmdbs.getBack().get();
 		}
+	}
+}
 
-		// Mark batch's passes done
-		for(U32 passIdx : m_ctx->m_batches.getBack().m_passIndices)
+void RenderGraph::initTransientRenderTargets(const RenderGraphDescription& descr)
+{
+	ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_TRANSIENT_RTS);
+	BakeContext& ctx = *m_ctx;
+	const U32 rtCount = ctx.m_rts.getSize();
+
+	// Gather the transient RTs
+	Array<TransientResourceLifetime, MAX_RENDER_GRAPH_RENDER_TARGETS> lifetimes;
+	Array<U32, MAX_RENDER_GRAPH_RENDER_TARGETS> rtToTransientIdx;
+	U32 transientCount = 0;
+	for(U32 rtIdx = 0; rtIdx < rtCount; ++rtIdx)
+	{
+		rtToTransientIdx[rtIdx] = MAX_U32;
+		if(ctx.m_rts[rtIdx].m_imported)
 		{
-			m_ctx->m_passIsInBatch.set(passIdx);
-			m_ctx->m_passes[passIdx].m_batchIdx = m_ctx->m_batches.getSize() - 1;
+			continue;
+		}
+
+		const RenderGraphDescription::RT& inRt = descr.m_renderTargets[rtIdx];
+		TransientResourceLifetime& lifetime = lifetimes[transientCount];
+		lifetime.m_aliasingKey =
+			appendHash(&inRt.m_usageDerivedByDeps, sizeof(inRt.m_usageDerivedByDeps), inRt.m_hash);
+		lifetime.m_size = computeTextureMemorySize(inRt.m_initInfo);
+
+		rtToTransientIdx[rtIdx] = transientCount++;
+	}
+
+	if(transientCount == 0)
+	{
+		return;
+	}
+
+	// Find the lifetimes in batches
+	for(U32 batchIdx = 0; batchIdx < ctx.m_batches.getSize(); ++batchIdx)
+	{
+		for(U32 passIdx : ctx.m_batches[batchIdx].m_passIndices)
+		{
+			for(const RenderPassDependency& dep : descr.m_passes[passIdx]->m_rtDeps)
+			{
+				const U32 transientIdx = rtToTransientIdx[dep.m_texture.m_handle.m_idx];
+				if(transientIdx != MAX_U32)
+				{
+					TransientResourceLifetime& lifetime = lifetimes[transientIdx];
+					lifetime.m_firstUse = min(lifetime.m_firstUse, batchIdx);
+					lifetime.m_lastUse = max(lifetime.m_lastUse, batchIdx);
+				}
+			}
 		}
 	}
+
+	// Find the RTs that can share textures
+	const ConstWeakArray<TransientResourceLifetime> lifetimesArr(&lifetimes[0], transientCount);
+	Array<TransientResourceAllocation, MAX_RENDER_GRAPH_RENDER_TARGETS> allocations;
+	Array<U32, MAX_RENDER_GRAPH_RENDER_TARGETS> transientToAllocationIdx;
+	const U32 allocationCount = planTransientResourceAliasing(lifetimesArr,
+		WeakArray<TransientResourceAllocation>(&allocations[0], transientCount),
+		WeakArray<U32>(&transientToAllocationIdx[0], transientCount));
+
+	// Get or create one texture per allocation. The first RT of an allocation tracks the usages of the texture
+	Array<U32, MAX_RENDER_GRAPH_RENDER_TARGETS> allocationFirstRt;
+	for(U32 i = 0; i < allocationCount; ++i)
+	{
+		allocationFirstRt[i] = MAX_U32;
+	}
+
+	for(U32 rtIdx = 0; rtIdx < rtCount; ++rtIdx)
+	{
+		const U32 transientIdx = rtToTransientIdx[rtIdx];
+		if(transientIdx == MAX_U32)
+		{
+			continue;
+		}
+
+		RT& outRt = ctx.m_rts[rtIdx];
+		const U32 allocationIdx = transientToAllocationIdx[transientIdx];
+		if(allocationFirstRt[allocationIdx] == MAX_U32)
+		{
+			// Create a new TextureInitInfo with the derived usage
+			const RenderGraphDescription::RT& inRt = descr.m_renderTargets[rtIdx];
+			TextureInitInfo initInf = inRt.m_initInfo;
+			initInf.m_usage = inRt.m_usageDerivedByDeps;
+
+			outRt.m_texture = getOrCreateRenderTarget(initInf, lifetimes[transientIdx].m_aliasingKey);
+			allocationFirstRt[allocationIdx] = rtIdx;
+		}
+		else
+		{
+			// Alias the texture of a previous RT
+			const RT& firstRt = ctx.m_rts[allocationFirstRt[allocationIdx]];
+			outRt.m_texture = firstRt.m_texture;
+			outRt.m_usageTrackerIdx = firstRt.m_usageTrackerIdx;
+		}
+	}
+
+	ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_TRANSIENT_MEMORY, computeTransientResourceMemory(lifetimesArr));
+	ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_ALIASED_TRANSIENT_MEMORY,
+		computeTransientResourceMemory(ConstWeakArray<TransientResourceAllocation>(&allocations[0], allocationCount)));
 }
 
 void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
@@ -833,6 +978,9 @@ void RenderGraph::initGraphicsPasses(const RenderGraphDescription& descr, StackA
 
 			if(graphicsPass.hasFramebuffer())
 			{
+				outPass.fb() =
+					getOrCreateFramebuffer(graphicsPass.m_fbDescr, &graphicsPass.m_rtHandles[0], inPass.m_name.cstr());
+
 				// Init the usage bits
 				TextureUsageBit usage;
 				for(U i = 0; i < graphicsPass.m_fbDescr.m_colorAttachmentCount; ++i)
@@ -912,7 +1060,7 @@ void RenderGraph::setTextureBarrier(Batch& batch, const RenderPassDependency& de
 	const U32 batchIdx = U32(&batch - &ctx.m_batches[0]);
 	const U32 rtIdx = dep.m_texture.m_handle.m_idx;
 	const TextureUsageBit depUsage = dep.m_texture.m_usage;
-	RT& rt = ctx.m_rts[rtIdx];
+	RT& rt = ctx.m_rts[ctx.m_rts[rtIdx].m_usageTrackerIdx];
 
 	iterateSurfsOrVolumes(
 		rt.m_texture, dep.m_texture.m_subresource, [&](U32 surfOrVolIdx, const TextureSurfaceInfo& surf) {
@@ -1053,25 +1201,282 @@ void RenderGraph::setBatchBarriers(const RenderGraphDescription& descr)
 	} // For all batches
 }
 
+U64 RenderGraph::computeGraphHash(const RenderGraphDescription& descr) const
+{
+	ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_HASH);
+	const BakeContext& ctx = *m_ctx;
+
+	const Array<U32, 3> counts = {descr.m_passes.getSize(), ctx.m_rts.getSize(), ctx.m_buffers.getSize()};
+	U64 hash = computeHash(&counts[0], sizeof(counts));
+
+	// The passes and their dependencies
+	ANKI_BEGIN_PACKED_STRUCT
+	struct HashedDependency
+	{
+		U32 m_idx;
+		U64 m_usage;
+		TextureSubresourceInfo m_subresource;
+	};
+	ANKI_END_PACKED_STRUCT
+
+	for(U32 passIdx = 0; passIdx < descr.m_passes.getSize(); ++passIdx)
+	{
+		const RenderPassDescriptionBase& pass = *descr.m_passes[passIdx];
+
+		const Array<U32, 3> passInfo = {
+			pass.m_rtDeps.getSize(), pass.m_buffDeps.getSize(), ctx.m_passes[passIdx].m_drawsToPresentable};
+		hash = appendHash(&passInfo[0], sizeof(passInfo), hash);
+
+		for(const RenderPassDependency& dep : pass.m_rtDeps)
+		{
+			HashedDependency hdep;
+			hdep.m_idx = dep.m_texture.m_handle.m_idx;
+			hdep.m_usage = U64(dep.m_texture.m_usage);
+			hdep.m_subresource = dep.m_texture.m_subresource;
+			hash = appendHash(&hdep, sizeof(hdep), hash);
+		}
+
+		for(const RenderPassDependency& dep : pass.m_buffDeps)
+		{
+			HashedDependency hdep;
+			hdep.m_idx = dep.m_buffer.m_handle.m_idx;
+			hdep.m_usage = U64(dep.m_buffer.m_usage);
+			hdep.m_subresource = TextureSubresourceInfo();
+			hash = appendHash(&hdep, sizeof(hdep), hash);
+		}
+	}
+
+	// The layout and the initial usages of the render targets. The initial usages of the imported RTs may change
+	for(U32 rtIdx = 0; rtIdx < ctx.m_rts.getSize(); ++rtIdx)
+	{
+		const RT& rt = ctx.m_rts[rtIdx];
+		if(rt.m_imported)
+		{
+			const Array<U32, 3> texInfo = {rt.m_texture->getMipmapCount(),
+				rt.m_texture->getLayerCount(),
+				textureTypeIsCube(rt.m_texture->getTextureType())};
+			hash = appendHash(&texInfo[0], sizeof(texInfo), hash);
+		}
+		else
+		{
+			// The descriptor of the RT. It also determines the aliasing of the transient RTs
+			const RenderGraphDescription::RT& inRt = descr.m_renderTargets[rtIdx];
+			hash = appendHash(&inRt.m_hash, sizeof(inRt.m_hash), hash);
+			hash = appendHash(&inRt.m_usageDerivedByDeps, sizeof(inRt.m_usageDerivedByDeps), hash);
+		}
+
+		hash = appendHash(&rt.m_surfOrVolUsages[0], rt.m_surfOrVolUsages.getSizeInBytes(), hash);
+	}
+
+	// The initial usages of the buffers
+	for(const Buffer& buff : ctx.m_buffers)
+	{
+		hash = appendHash(&buff.m_usage, sizeof(buff.m_usage), hash);
+	}
+
+	return hash;
+}
+
+void RenderGraph::storeCompiledGraph(U64 hash)
+{
+	const BakeContext& ctx = *m_ctx;
+	GrAllocator<U8> alloc = getAllocator();
+	const U32 batchCount = ctx.m_batches.getSize();
+
+	ANKI_ASSERT(m_compiledGraphCache.find(hash) == m_compiledGraphCache.getEnd());
+	CompiledGraphCacheEntry& entry = *m_compiledGraphCache.emplace(alloc, hash);
+	entry.m_hash = hash;
+	entry.m_lastUsedVersion = m_version;
+
+	// Batches and barriers
+	U32 barrierCount = 0;
+	for(const Batch& batch : ctx.m_batches)
+	{
+		barrierCount += batch.m_barriersBefore.getSize();
+	}
+
+	entry.m_batchPassIndices.create(alloc, ctx.m_passes.getSize());
+	entry.m_batchFirstPassIndex.create(alloc, batchCount + 1);
+	entry.m_batchFirstBarrier.create(alloc, batchCount + 1);
+	if(barrierCount > 0)
+	{
+		entry.m_barriers.resizeStorage(alloc, barrierCount);
+	}
+
+	U32 passCount = 0;
+	for(U32 batchIdx = 0; batchIdx < batchCount; ++batchIdx)
+	{
+		const Batch& batch = ctx.m_batches[batchIdx];
+		entry.m_batchFirstPassIndex[batchIdx] = passCount;
+		entry.m_batchFirstBarrier[batchIdx] = entry.m_barriers.getSize();
+
+		for(U32 passIdx : batch.m_passIndices)
+		{
+			entry.m_batchPassIndices[passCount++] = passIdx;
+		}
+
+		for(const Barrier& barrier : batch.m_barriersBefore)
+		{
+			entry.m_barriers.emplaceBack(alloc, barrier);
+		}
+	}
+
+	ANKI_ASSERT(passCount == ctx.m_passes.getSize());
+	entry.m_batchFirstPassIndex[batchCount] = passCount;
+	entry.m_batchFirstBarrier[batchCount] = entry.m_barriers.getSize();
+
+	// Final usages
+	U32 surfOrVolCount = 0;
+	for(const RT& rt : ctx.m_rts)
+	{
+		surfOrVolCount += rt.m_surfOrVolUsages.getSize();
+	}
+
+	entry.m_rtFinalUsages.create(alloc, surfOrVolCount);
+	surfOrVolCount = 0;
+	for(const RT& rt : ctx.m_rts)
+	{
+		for(TextureUsageBit usage : rt.m_surfOrVolUsages)
+		{
+			entry.m_rtFinalUsages[surfOrVolCount++] = usage;
+		}
+	}
+
+	entry.m_buffFinalUsages.create(alloc, ctx.m_buffers.getSize());
+	for(U32 buffIdx = 0; buffIdx < ctx.m_buffers.getSize(); ++buffIdx)
+	{
+		entry.m_buffFinalUsages[buffIdx] = ctx.m_buffers[buffIdx].m_usage;
+	}
+}
+
+Bool RenderGraph::restoreCompiledGraph(U64 hash)
+{
+	auto it = m_compiledGraphCache.find(hash);
+	if(it == m_compiledGraphCache.getEnd())
+	{
+		return false;
+	}
+
+	BakeContext& ctx = *m_ctx;
+	CompiledGraphCacheEntry& entry = *it;
+	entry.m_lastUsedVersion = m_version;
+	ANKI_ASSERT(entry.m_batchPassIndices.getSize() == ctx.m_passes.getSize());
+	ANKI_ASSERT(entry.m_buffFinalUsages.getSize() == ctx.m_buffers.getSize());
+
+	// Batches and barriers
+	const U32 batchCount = entry.m_batchFirstPassIndex.getSize() - 1;
+	ctx.m_batches.create(ctx.m_alloc, batchCount);
+	for(U32 batchIdx = 0; batchIdx < batchCount; ++batchIdx)
+	{
+		Batch& batch = ctx.m_batches[batchIdx];
+
+		const U32 firstPass = entry.m_batchFirstPassIndex[batchIdx];
+		const U32 passCount = entry.m_batchFirstPassIndex[batchIdx + 1] - firstPass;
+		batch.m_passIndices.create(ctx.m_alloc, passCount);
+		for(U32 i = 0; i < passCount; ++i)
+		{
+			const U32 passIdx = entry.m_batchPassIndices[firstPass + i];
+			batch.m_passIndices[i] = passIdx;
+			ctx.m_passIsInBatch.set(passIdx);
+			ctx.m_passes[passIdx].m_batchIdx = batchIdx;
+		}
+
+		const U32 firstBarrier = entry.m_batchFirstBarrier[batchIdx];
+		const U32 barrierCount = entry.m_batchFirstBarrier[batchIdx + 1] - firstBarrier;
+		if(barrierCount > 0)
+		{
+			batch.m_barriersBefore.resizeStorage(ctx.m_alloc, barrierCount);
+			for(U32 i = 0; i < barrierCount; ++i)
+			{
+				batch.m_barriersBefore.emplaceBack(ctx.m_alloc, entry.m_barriers[firstBarrier + i]);
+			}
+		}
+	}
+
+	// Final usages. They are needed to track the usages of the imported RTs between frames
+	U32 surfOrVolCount = 0;
+	for(RT& rt : ctx.m_rts)
+	{
+		for(TextureUsageBit& usage : rt.m_surfOrVolUsages)
+		{
+			usage = entry.m_rtFinalUsages[surfOrVolCount++];
+		}
+	}
+	ANKI_ASSERT(surfOrVolCount == entry.m_rtFinalUsages.getSize());
+
+	for(U32 buffIdx = 0; buffIdx < ctx.m_buffers.getSize(); ++buffIdx)
+	{
+		ctx.m_buffers[buffIdx].m_usage = entry.m_buffFinalUsages[buffIdx];
+	}
+
+	return true;
+}
+
+void RenderGraph::destroyCompiledGraphCacheEntry(CompiledGraphCacheEntry& entry)
+{
+	GrAllocator<U8> alloc = getAllocator();
+	entry.m_batchPassIndices.destroy(alloc);
+	entry.m_batchFirstPassIndex.destroy(alloc);
+	entry.m_barriers.destroy(alloc);
+	entry.m_batchFirstBarrier.destroy(alloc);
+	entry.m_rtFinalUsages.destroy(alloc);
+	entry.m_buffFinalUsages.destroy(alloc);
+}
+
 void RenderGraph::compileNewGraph(const RenderGraphDescription& descr, StackAllocator<U8>& alloc)
 {
 	ANKI_TRACE_SCOPED_EVENT(GR_RENDER_GRAPH_COMPILE);
 
+	const Second startTime = HighRezTimer::getCurrentTime();
+
 	// Init the context
 	BakeContext& ctx = *newContext(descr, alloc);
 	m_ctx = &ctx;
 
-	// Init the passes and find the dependencies between passes
-	initRenderPassesAndSetDeps(descr, alloc);
+	// Init the passes
+	initRenderPasses(descr, alloc);
 
-	// Walk the graph and create pass batches
-	initBatches();
+	// If the topology is the same as in a previous frame reuse the batches and the barriers of that frame
+	const U64 hash = computeGraphHash(descr);
+	const Bool cacheHit = !ANKI_DBG_RENDER_GRAPH && restoreCompiledGraph(hash);
+	if(!cacheHit)
+	{
+		// Find the dependencies between passes
+		setPassDependencies(descr, alloc);
+
+		// Walk the graph and create pass batches
+		initBatches();
+	}
+
+	// Now that the lifetimes of the RTs are known create the textures of the transient RTs
+	initTransientRenderTargets(descr);
+
+	// Create the command buffers of the batches
+	initBatchCommandBuffers();
 
 	// Now that we know the batches every pass belongs init the graphics passes
 	initGraphicsPasses(descr, alloc);
 
-	// Create barriers between batches
-	setBatchBarriers(descr);
+	if(!cacheHit)
+	{
+		// Create barriers between batches
+		setBatchBarriers(descr);
+
+		storeCompiledGraph(hash);
+	}
+
+	const U64 elapsedUs = U64((HighRezTimer::getCurrentTime() - startTime) * 1000000.0);
+	if(cacheHit)
+	{
+		ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_CACHE_HITS, 1);
+		ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_CACHE_HIT_COMPILE_TIME_US, elapsedUs);
+	}
+	else
+	{
+		ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_CACHE_MISSES, 1);
+		ANKI_TRACE_INC_COUNTER(GR_RENDER_GRAPH_CACHE_MISS_COMPILE_TIME_US, elapsedUs);
+	}
+	(void)elapsedUs;
 
 #if ANKI_DBG_RENDER_GRAPH
 	if(dumpDependencyDotFile(descr, ctx, "./"))
@@ -1282,6 +1687,25 @@ void RenderGraph::periodicCleanup()
 	{
 		ANKI_GR_LOGI("Cleaned %u render targets", rtsCleanedCount);
 	}
+
+	// Remove the compiled graphs that haven't been used for a while. Gather the hashes first because erasing
+	// invalidates the iterators
+	DynamicArrayAuto<U64> hashesToErase(getAllocator());
+	for(CompiledGraphCacheEntry& entry : m_compiledGraphCache)
+	{
+		if(m_version - entry.m_lastUsedVersion >= PERIODIC_CLEANUP_EVERY)
+		{
+			destroyCompiledGraphCacheEntry(entry);
+			hashesToErase.emplaceBack(entry.m_hash);
+		}
+	}
+
+	for(U64 hash : hashesToErase)
+	{
+		auto it = m_compiledGraphCache.find(hash);
+		ANKI_ASSERT(it != m_compiledGraphCache.getEnd());
+		m_compiledGraphCache.erase(getAllocator(), it);
+	}
 }
 
 void RenderGraph::getStatistics(RenderGraphStatistics& statistics) const
@@ -543,6 +543,7 @@ public:
 /// - Command buffer creation for primary and secondary command buffers.
 /// - Framebuffer creation.
 /// - Render target creation (optional since textures can be imported as well).
+/// - Aliasing of render targets that are not used at the same time.
 ///
 /// It accepts a description of the frame's render passes (compute and graphics), compiles that description to calculate
 /// dependencies and then populates command buffers with the help of multiple RenderPassWorkCallback.
@@ -619,9 +620,25 @@ private:
 		DynamicArray<TextureUsageBit> m_surfOrVolLastUsages; ///< Last TextureUsageBit of the imported RT.
 	};
 
+	/// The parts of a compiled graph that depend only on the topology of the RenderGraphDescription. They are reused
+	/// in the frames that have the same topology.
+	class CompiledGraphCacheEntry
+	{
+	public:
+		DynamicArray<U32> m_batchPassIndices; ///< The pass indices of all the batches.
+		DynamicArray<U32> m_batchFirstPassIndex; ///< Where the passes of every batch start. One more than the batches.
+		DynamicArray<Barrier> m_barriers; ///< The barriers of all the batches.
+		DynamicArray<U32> m_batchFirstBarrier; ///< Where the barriers of every batch start. One more than the batches.
+		DynamicArray<TextureUsageBit> m_rtFinalUsages; ///< The usages of all the RT surfaces after the last batch.
+		DynamicArray<BufferUsageBit> m_buffFinalUsages; ///< The usages of the buffers after the last batch.
+		U64 m_hash = 0; ///< The key of the entry in the cache.
+		U64 m_lastUsedVersion = 0;
+	};
+
 	HashMap<U64, RenderTargetCacheEntry> m_renderTargetCache; ///< Non-imported render targets.
 	HashMap<U64, FramebufferPtr> m_fbCache; ///< Framebuffer cache.
 	HashMap<U64, ImportedRenderTargetInfo> m_importedRenderTargets;
+	HashMap<U64, CompiledGraphCacheEntry> m_compiledGraphCache;
 
 	BakeContext* m_ctx = nullptr;
 	U64 m_version = 0;
@@ -642,16 +659,32 @@ private:
 	static ANKI_USE_RESULT RenderGraph* newInstance(GrManager* manager);
 
 	BakeContext* newContext(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
-	void initRenderPassesAndSetDeps(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	void initRenderPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
+	void setPassDependencies(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
 	void initBatches();
+	void initBatchCommandBuffers();
+	void initTransientRenderTargets(const RenderGraphDescription& descr);
 	void initGraphicsPasses(const RenderGraphDescription& descr, StackAllocator<U8>& alloc);
 	void setBatchBarriers(const RenderGraphDescription& descr);
 
+	/// @name Compiled graph cache
+	/// @{
+
+	/// Compute a hash of everything the batches and the barriers depend on.
+	U64 computeGraphHash(const RenderGraphDescription& descr) const;
+
+	/// Copy the batches and the barriers of the current context to the cache.
+	void storeCompiledGraph(U64 hash);
+
+	/// Restore the batches and the barriers from the cache. Returns false if the graph is not in the cache.
+	Bool restoreCompiledGraph(U64 hash);
+
+	void destroyCompiledGraphCacheEntry(CompiledGraphCacheEntry& entry);
+	/// @}
+
 	TexturePtr getOrCreateRenderTarget(const TextureInitInfo& initInf, U64 hash);
-	FramebufferPtr getOrCreateFramebuffer(const FramebufferDescription& fbDescr,
-		const RenderTargetHandle* rtHandles,
-		CString name,
-		Bool& drawsToPresentableTex);
+	FramebufferPtr getOrCreateFramebuffer(
+		const FramebufferDescription& fbDescr, const RenderTargetHandle* rtHandles, CString name);
 
 	/// Every N number of frames clean unused cached items.
 	void periodicCleanup();
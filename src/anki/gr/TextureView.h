@@ -91,6 +91,11 @@ public:
 		return m_subresource;
 	}
 
+	/// Get the index of the view in the bindless descriptor set when it's sampled. It will add the view to the set if
+	/// it's not already there. Use it to register the textures before the rendering.
+	/// @note Thread-safe.
+	U32 getOrCreateBindlessTextureIndex();
+
 protected:
 	TextureType m_texType = TextureType::COUNT;
 	TextureSubresourceInfo m_subresource;
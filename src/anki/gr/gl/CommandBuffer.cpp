@@ -508,6 +508,11 @@ void CommandBuffer::setAlphaToCoverage(Bool enable)
 	ANKI_ASSERT(!"TODO");
 }
 
+void CommandBuffer::setSkippableDrawcalls(Bool skippable)
+{
+	// Nothing is skipped, there are no pipelines
+}
+
 void CommandBuffer::setColorChannelWriteMask(U32 attachment, ColorBit mask)
 {
 	class Cmd final : public GlCommand
@@ -37,6 +37,7 @@ GrManager::~GrManager()
 Error GrManager::newInstance(GrManagerInitInfo& init, GrManager*& gr)
 {
 	auto alloc = GrAllocator<U8>(init.m_allocCallback, init.m_allocCallbackUserData);
+	alloc.getMemoryPool().setMemoryTag(MemoryTag::GR);
 
 	GrManagerImpl* impl = alloc.newInstance<GrManagerImpl>();
 	Error err = impl->init(init, alloc);
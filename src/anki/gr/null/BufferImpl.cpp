@@ -0,0 +1,65 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/BufferImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+
+namespace anki
+{
+
+BufferImpl::~BufferImpl()
+{
+#if ANKI_EXTRA_CHECKS
+	ANKI_ASSERT(!m_mapped);
+#endif
+
+	if(m_mem)
+	{
+		getAllocator().getMemoryPool().free(m_mem);
+		static_cast<GrManagerImpl&>(getManager()).updateHostMemory(m_size, false);
+	}
+}
+
+Error BufferImpl::init(const BufferInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+
+	m_size = inf.m_size;
+	m_usage = inf.m_usage;
+	m_access = inf.m_access;
+
+	m_mem = static_cast<U8*>(getAllocator().getMemoryPool().allocate(m_size, 16));
+	if(ANKI_UNLIKELY(m_mem == nullptr))
+	{
+		ANKI_NULL_LOGE("Out of memory while creating buffer: %s", getName().cstr());
+		return Error::OUT_OF_MEMORY;
+	}
+
+	static_cast<GrManagerImpl&>(getManager()).updateHostMemory(m_size, true);
+
+	if(inf.m_exposeGpuAddress)
+	{
+		m_gpuAddress = ptrToNumber(m_mem);
+	}
+
+	return Error::NONE;
+}
+
+void* BufferImpl::map(PtrSize offset, PtrSize range, BufferMapAccessBit access)
+{
+	ANKI_ASSERT(m_mem);
+	ANKI_ASSERT(access != BufferMapAccessBit::NONE);
+	ANKI_ASSERT((access & m_access) != BufferMapAccessBit::NONE);
+	ANKI_ASSERT(rangeValid(offset, range));
+
+#if ANKI_EXTRA_CHECKS
+	ANKI_ASSERT(!m_mapped);
+	m_mapped = true;
+#endif
+
+	return m_mem + offset;
+}
+
+} // end namespace anki
@@ -0,0 +1,452 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/CommandBuffer.h>
+#include <anki/gr/null/CommandBufferImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+#include <anki/gr/AccelerationStructure.h>
+
+namespace anki
+{
+
+CommandBuffer* CommandBuffer::newInstance(GrManager* manager, const CommandBufferInitInfo& init)
+{
+	CommandBufferImpl* impl = manager->getAllocator().newInstance<CommandBufferImpl>(manager, init.getName());
+	const Error err = impl->init(init);
+	if(err)
+	{
+		manager->getAllocator().deleteInstance(impl);
+		impl = nullptr;
+	}
+	return impl;
+}
+
+void CommandBuffer::flush(FencePtr* fence)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.endRecording(fence);
+}
+
+void CommandBuffer::bindVertexBuffer(
+	U32 binding, BufferPtr buff, PtrSize offset, PtrSize stride, VertexStepRate stepRate)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(stride > 0);
+	self.bindVertexBuffer(binding, buff, offset);
+}
+
+void CommandBuffer::setVertexAttribute(U32 location, U32 buffBinding, Format fmt, PtrSize relativeOffset)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(location < MAX_VERTEX_ATTRIBUTES && buffBinding < MAX_VERTEX_ATTRIBUTES);
+	self.setState();
+}
+
+void CommandBuffer::bindIndexBuffer(BufferPtr buff, PtrSize offset, IndexType type)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindIndexBuffer(buff, offset);
+}
+
+void CommandBuffer::setPrimitiveRestart(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setViewport(U32 minx, U32 miny, U32 width, U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(width > 0 && height > 0);
+	self.setState();
+}
+
+void CommandBuffer::setScissor(U32 minx, U32 miny, U32 width, U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(width > 0 && height > 0);
+	self.setState();
+}
+
+void CommandBuffer::setFillMode(FillMode mode)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setCullMode(FaceSelectionBit mode)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setPolygonOffset(F32 factor, F32 units)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setStencilOperations(FaceSelectionBit face,
+	StencilOperation stencilFail,
+	StencilOperation stencilPassDepthFail,
+	StencilOperation stencilPassDepthPass)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setStencilCompareOperation(FaceSelectionBit face, CompareOperation comp)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setStencilCompareMask(FaceSelectionBit face, U32 mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setStencilWriteMask(FaceSelectionBit face, U32 mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setStencilReference(FaceSelectionBit face, U32 ref)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setDepthWrite(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setDepthCompareOperation(CompareOperation op)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setAlphaToCoverage(Bool enable)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setColorChannelWriteMask(U32 attachment, ColorBit mask)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setColorAttachmentState(attachment);
+}
+
+void CommandBuffer::setBlendFactors(
+	U32 attachment, BlendFactor srcRgb, BlendFactor dstRgb, BlendFactor srcA, BlendFactor dstA)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setColorAttachmentState(attachment);
+}
+
+void CommandBuffer::setBlendOperation(U32 attachment, BlendOperation funcRgb, BlendOperation funcA)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setColorAttachmentState(attachment);
+}
+
+void CommandBuffer::bindTextureAndSampler(
+	U32 set, U32 binding, TextureViewPtr texView, SamplerPtr sampler, TextureUsageBit usage, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(sampler.isCreated());
+	self.bindTexture(set, binding, texView, usage);
+}
+
+void CommandBuffer::bindTexture(U32 set, U32 binding, TextureViewPtr texView, TextureUsageBit usage, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindTexture(set, binding, texView, usage);
+}
+
+void CommandBuffer::bindSampler(U32 set, U32 binding, SamplerPtr sampler, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(sampler.isCreated());
+	self.bindResource(set, binding);
+}
+
+void CommandBuffer::bindUniformBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindBuffer(set, binding, buff, offset, range, BufferUsageBit::ALL_UNIFORM);
+}
+
+void CommandBuffer::bindStorageBuffer(U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindBuffer(set, binding, buff, offset, range, BufferUsageBit::ALL_STORAGE);
+}
+
+void CommandBuffer::bindImage(U32 set, U32 binding, TextureViewPtr img, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindImage(set, binding, img);
+}
+
+void CommandBuffer::bindAccelerationStructure(U32 set, U32 binding, AccelerationStructurePtr as, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(as.isCreated());
+	self.bindResource(set, binding);
+}
+
+void CommandBuffer::bindTextureBuffer(
+	U32 set, U32 binding, BufferPtr buff, PtrSize offset, PtrSize range, Format fmt, U32 arrayIdx)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindBuffer(set, binding, buff, offset, range, BufferUsageBit::ALL_TEXTURE);
+}
+
+void CommandBuffer::bindAllBindless(U32 set)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindResource(set, 0);
+}
+
+U32 CommandBuffer::bindBindlessTexture(TextureViewPtr tex, TextureUsageBit usage)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	return self.bindBindlessTexture(tex, usage);
+}
+
+U32 CommandBuffer::bindBindlessImage(TextureViewPtr img)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	return self.bindBindlessImage(img);
+}
+
+void CommandBuffer::bindShaderProgram(ShaderProgramPtr prog)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.bindShaderProgram(prog);
+}
+
+void CommandBuffer::beginRenderPass(FramebufferPtr fb,
+	const Array<TextureUsageBit, MAX_COLOR_ATTACHMENTS>& colorAttachmentUsages,
+	TextureUsageBit depthStencilAttachmentUsage,
+	U32 minx,
+	U32 miny,
+	U32 width,
+	U32 height)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.beginRenderPass(fb, minx, miny, width, height);
+}
+
+void CommandBuffer::endRenderPass()
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.endRenderPass();
+}
+
+void CommandBuffer::drawElements(
+	PrimitiveTopology topology, U32 count, U32 instanceCount, U32 firstIndex, U32 baseVertex, U32 baseInstance)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(count > 0 && instanceCount > 0);
+	self.drawcallCommon();
+}
+
+void CommandBuffer::drawArrays(PrimitiveTopology topology, U32 count, U32 instanceCount, U32 first, U32 baseInstance)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(count > 0 && instanceCount > 0);
+	self.drawcallCommon();
+}
+
+void CommandBuffer::drawArraysIndirect(PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.drawIndirect(drawCount, offset, buff, sizeof(DrawArraysIndirectInfo));
+}
+
+void CommandBuffer::drawElementsIndirect(PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.drawIndirect(drawCount, offset, buff, sizeof(DrawElementsIndirectInfo));
+}
+
+void CommandBuffer::dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.dispatchCompute(groupCountX, groupCountY, groupCountZ);
+}
+
+void CommandBuffer::generateMipmaps2d(TextureViewPtr texView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.generateMipmaps2d(texView);
+}
+
+void CommandBuffer::generateMipmaps3d(TextureViewPtr texView)
+{
+	ANKI_ASSERT(!"TODO");
+}
+
+void CommandBuffer::blitTextureViews(TextureViewPtr srcView, TextureViewPtr destView)
+{
+	ANKI_ASSERT(!"TODO");
+}
+
+void CommandBuffer::clearTextureView(TextureViewPtr texView, const ClearValue& clearValue)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.clearTextureView(texView);
+}
+
+void CommandBuffer::copyBufferToTextureView(BufferPtr buff, PtrSize offset, PtrSize range, TextureViewPtr texView)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.copyBufferToTextureView(buff, offset, range, texView);
+}
+
+void CommandBuffer::fillBuffer(BufferPtr buff, PtrSize offset, PtrSize size, U32 value)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.fillBuffer(buff, offset, size, value);
+}
+
+void CommandBuffer::writeOcclusionQueryResultToBuffer(OcclusionQueryPtr query, PtrSize offset, BufferPtr buff)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(query.isCreated());
+	self.writeOcclusionQueryResultToBuffer(offset, buff);
+}
+
+void CommandBuffer::copyBufferToBuffer(
+	BufferPtr src, PtrSize srcOffset, BufferPtr dst, PtrSize dstOffset, PtrSize range)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.copyBufferToBuffer(src, srcOffset, dst, dstOffset, range);
+}
+
+void CommandBuffer::buildAccelerationStructure(AccelerationStructurePtr as)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(as.isCreated());
+	self.buildAccelerationStructure();
+}
+
+void CommandBuffer::setTextureBarrier(
+	TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const TextureSubresourceInfo& subresource)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(tex->isSubresourceValid(subresource));
+	self.setTextureBarrier(tex, prevUsage, nextUsage);
+}
+
+void CommandBuffer::setTextureSurfaceBarrier(
+	TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const TextureSurfaceInfo& surf)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(tex->isSubresourceValid(TextureSubresourceInfo(surf)));
+	self.setTextureBarrier(tex, prevUsage, nextUsage);
+}
+
+void CommandBuffer::setTextureVolumeBarrier(
+	TexturePtr tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage, const TextureVolumeInfo& vol)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(tex->getTextureType() == TextureType::_3D);
+	self.setTextureBarrier(tex, prevUsage, nextUsage);
+}
+
+void CommandBuffer::setBufferBarrier(
+	BufferPtr buff, BufferUsageBit before, BufferUsageBit after, PtrSize offset, PtrSize size)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setBufferBarrier(buff, before, after, offset, size);
+}
+
+void CommandBuffer::setAccelerationStructureBarrier(
+	AccelerationStructurePtr as, AccelerationStructureUsageBit prevUsage, AccelerationStructureUsageBit nextUsage)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(as.isCreated());
+	self.setAccelerationStructureBarrier();
+}
+
+void CommandBuffer::resetOcclusionQuery(OcclusionQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(query.isCreated());
+	self.occlusionQuery();
+}
+
+void CommandBuffer::beginOcclusionQuery(OcclusionQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(query.isCreated());
+	self.occlusionQuery();
+}
+
+void CommandBuffer::endOcclusionQuery(OcclusionQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(query.isCreated());
+	self.occlusionQuery();
+}
+
+void CommandBuffer::pushSecondLevelCommandBuffer(CommandBufferPtr cmdb)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.pushSecondLevelCommandBuffer(cmdb);
+}
+
+void CommandBuffer::resetTimestampQuery(TimestampQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	ANKI_ASSERT(query.isCreated());
+	self.resetTimestampQuery();
+}
+
+void CommandBuffer::writeTimestamp(TimestampQueryPtr query)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.writeTimestamp(query);
+}
+
+Bool CommandBuffer::isEmpty() const
+{
+	ANKI_NULL_SELF_CONST(CommandBufferImpl);
+	return self.isEmpty();
+}
+
+void CommandBuffer::setPushConstants(const void* data, U32 dataSize)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setPushConstants(data, dataSize);
+}
+
+void CommandBuffer::setRasterizationOrder(RasterizationOrder order)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setLineWidth(F32 width)
+{
+	ANKI_NULL_SELF(CommandBufferImpl);
+	self.setState();
+}
+
+void CommandBuffer::setSkippableDrawcalls(Bool skippable)
+{
+	// Nothing is skipped, the pipelines are not created
+}
+
+} // end namespace anki
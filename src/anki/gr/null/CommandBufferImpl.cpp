@@ -0,0 +1,339 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/CommandBufferImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+#include <anki/gr/null/BufferImpl.h>
+#include <anki/gr/null/TextureImpl.h>
+#include <anki/gr/null/TextureViewImpl.h>
+#include <anki/gr/null/FramebufferImpl.h>
+#include <anki/gr/null/ShaderProgramImpl.h>
+#include <anki/gr/null/TimestampQueryImpl.h>
+#include <anki/gr/null/FenceImpl.h>
+
+namespace anki
+{
+
+CommandBufferImpl::~CommandBufferImpl()
+{
+	for(U32 i = 0; i < m_secondLevelCmdbCount; ++i)
+	{
+		m_secondLevelCmdbs[i].reset(nullptr);
+	}
+	m_secondLevelCmdbs.destroy(getAllocator());
+
+	static_cast<GrManagerImpl&>(getManager()).updateCommandBufferCount(false);
+}
+
+Error CommandBufferImpl::init(const CommandBufferInitInfo& init)
+{
+	static_cast<GrManagerImpl&>(getManager()).updateCommandBufferCount(true);
+
+	m_flags = init.m_flags;
+
+	if(isSecondLevel())
+	{
+		ANKI_ASSERT(init.m_framebuffer.isCreated() && "Second level command buffers need a framebuffer");
+		m_activeFb = init.m_framebuffer;
+	}
+
+	return Error::NONE;
+}
+
+void CommandBufferImpl::endRecording(FencePtr* fence)
+{
+	ANKI_ASSERT(!m_finalized);
+	ANKI_ASSERT(!m_insideRenderPass && "Forgot to end the render pass");
+	ANKI_ASSERT(!isSecondLevel() || fence == nullptr);
+	m_finalized = true;
+
+	if(fence)
+	{
+		// All the work is done on submission so the fence is signaled from the start
+		FenceImpl* impl = getAllocator().newInstance<FenceImpl>(&getManager(), "Null");
+		fence->reset(impl);
+	}
+}
+
+void CommandBufferImpl::bindVertexBuffer(U32 binding, BufferPtr buff, PtrSize offset)
+{
+	ANKI_ASSERT(binding < MAX_VERTEX_ATTRIBUTES);
+	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
+	ANKI_ASSERT(impl.usageValid(BufferUsageBit::VERTEX));
+	ANKI_ASSERT(impl.rangeValid(offset, MAX_PTR_SIZE));
+	(void)impl;
+	pushCommand(NullCommandType::BIND_VERTEX_BUFFER);
+}
+
+void CommandBufferImpl::bindIndexBuffer(BufferPtr buff, PtrSize offset)
+{
+	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
+	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDEX));
+	ANKI_ASSERT(impl.rangeValid(offset, MAX_PTR_SIZE));
+	(void)impl;
+	pushCommand(NullCommandType::BIND_INDEX_BUFFER);
+}
+
+void CommandBufferImpl::bindTexture(U32 set, U32 binding, const TextureViewPtr& texView, TextureUsageBit usage)
+{
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*texView);
+	const TextureImpl& tex = static_cast<const TextureImpl&>(*view.getTexture());
+	ANKI_ASSERT(tex.isSubresourceGoodForSampling(view.getSubresource()));
+	ANKI_ASSERT(tex.usageValid(usage));
+	(void)tex;
+	bindResource(set, binding);
+}
+
+void CommandBufferImpl::bindImage(U32 set, U32 binding, const TextureViewPtr& img)
+{
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*img);
+	ANKI_ASSERT(view.getTexture()->isSubresourceGoodForImageLoadStore(view.getSubresource()));
+	(void)view;
+	bindResource(set, binding);
+}
+
+void CommandBufferImpl::bindBuffer(
+	U32 set, U32 binding, const BufferPtr& buff, PtrSize offset, PtrSize range, BufferUsageBit usage)
+{
+	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
+	ANKI_ASSERT(!!(impl.getBufferUsage() & usage));
+	ANKI_ASSERT(impl.rangeValid(offset, range));
+	ANKI_ASSERT(isAligned(NULL_BUFFER_OFFSET_ALIGNMENT, offset));
+	(void)impl;
+	bindResource(set, binding);
+}
+
+U32 CommandBufferImpl::bindBindlessTexture(const TextureViewPtr& tex, TextureUsageBit usage)
+{
+	TextureViewImpl& view = static_cast<TextureViewImpl&>(*tex);
+	ANKI_ASSERT(view.getTexture()->isSubresourceGoodForSampling(view.getSubresource()));
+	ANKI_ASSERT(static_cast<const TextureImpl&>(*view.getTexture()).usageValid(usage));
+	pushCommand(NullCommandType::BIND_RESOURCE);
+	return view.getOrCreateBindlessIndex(false);
+}
+
+U32 CommandBufferImpl::bindBindlessImage(const TextureViewPtr& img)
+{
+	TextureViewImpl& view = static_cast<TextureViewImpl&>(*img);
+	ANKI_ASSERT(view.getTexture()->isSubresourceGoodForImageLoadStore(view.getSubresource()));
+	pushCommand(NullCommandType::BIND_RESOURCE);
+	return view.getOrCreateBindlessIndex(true);
+}
+
+void CommandBufferImpl::bindShaderProgram(const ShaderProgramPtr& prog)
+{
+	const ShaderProgramImpl& impl = static_cast<const ShaderProgramImpl&>(*prog);
+	if(impl.isCompute())
+	{
+		m_computeProg = prog;
+	}
+	else
+	{
+		m_graphicsProg = prog;
+	}
+
+	pushCommand(NullCommandType::BIND_SHADER_PROGRAM);
+}
+
+void CommandBufferImpl::beginRenderPass(const FramebufferPtr& fb, U32 minx, U32 miny, U32 width, U32 height)
+{
+	ANKI_ASSERT(!insideRenderPass());
+	ANKI_ASSERT(minx < MAX_U32 && miny < MAX_U32);
+
+	U32 fbWidth, fbHeight;
+	static_cast<const FramebufferImpl&>(*fb).getAttachmentsSize(fbWidth, fbHeight);
+	ANKI_ASSERT(width == MAX_U32 || minx + width <= fbWidth);
+	ANKI_ASSERT(height == MAX_U32 || miny + height <= fbHeight);
+	(void)fbWidth;
+	(void)fbHeight;
+
+	m_activeFb = fb;
+	m_insideRenderPass = true;
+	pushCommand(NullCommandType::BEGIN_RENDER_PASS);
+}
+
+void CommandBufferImpl::endRenderPass()
+{
+	ANKI_ASSERT(m_insideRenderPass);
+	m_insideRenderPass = false;
+	m_activeFb.reset(nullptr);
+	pushCommand(NullCommandType::END_RENDER_PASS);
+}
+
+void CommandBufferImpl::drawcallCommon()
+{
+	ANKI_ASSERT(insideRenderPass() && "Drawcalls should be inside a render pass");
+	ANKI_ASSERT(m_graphicsProg.isCreated() && "Forgot to bind a graphics program");
+	pushCommand(NullCommandType::DRAW);
+}
+
+void CommandBufferImpl::drawIndirect(U32 drawCount, PtrSize offset, const BufferPtr& buff, PtrSize drawCommandSize)
+{
+	ANKI_ASSERT(insideRenderPass());
+	ANKI_ASSERT(m_graphicsProg.isCreated());
+	ANKI_ASSERT(drawCount > 0);
+
+	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
+	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_DRAW));
+	ANKI_ASSERT((offset % 4) == 0);
+	ANKI_ASSERT(impl.rangeValid(offset, drawCommandSize * drawCount));
+	(void)impl;
+
+	pushCommand(NullCommandType::DRAW_INDIRECT);
+}
+
+void CommandBufferImpl::dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ)
+{
+	ANKI_ASSERT(m_computeProg.isCreated() && "Forgot to bind a compute program");
+	ANKI_ASSERT(!!(m_flags & CommandBufferFlag::COMPUTE_WORK));
+	ANKI_ASSERT(groupCountX > 0 && groupCountY > 0 && groupCountZ > 0);
+	outsideRenderPassCommon();
+	pushCommand(NullCommandType::DISPATCH);
+}
+
+void CommandBufferImpl::generateMipmaps2d(const TextureViewPtr& texView)
+{
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*texView);
+	ANKI_ASSERT(view.getTexture()->isSubresourceGoodForMipmapGeneration(view.getSubresource()));
+	(void)view;
+	outsideRenderPassCommon();
+	pushCommand(NullCommandType::GENERATE_MIPMAPS);
+}
+
+void CommandBufferImpl::clearTextureView(const TextureViewPtr& texView)
+{
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*texView);
+	ANKI_ASSERT(static_cast<const TextureImpl&>(*view.getTexture()).usageValid(TextureUsageBit::CLEAR));
+	(void)view;
+	outsideRenderPassCommon();
+	pushCommand(NullCommandType::CLEAR_TEXTURE_VIEW);
+}
+
+void CommandBufferImpl::copyBufferToTextureView(
+	const BufferPtr& buff, PtrSize offset, PtrSize range, const TextureViewPtr& texView)
+{
+	const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*texView);
+	const TextureImpl& tex = static_cast<const TextureImpl&>(*view.getTexture());
+	ANKI_ASSERT(tex.usageValid(TextureUsageBit::TRANSFER_DESTINATION));
+	ANKI_ASSERT(tex.isSubresourceGoodForCopyFromBuffer(view.getSubresource()));
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*buff).usageValid(BufferUsageBit::TRANSFER_SOURCE));
+	ANKI_ASSERT(static_cast<const BufferImpl&>(*buff).rangeValid(offset, range));
+	(void)tex;
+	outsideRenderPassCommon();
+	pushCommand(NullCommandType::COPY_BUFFER_TO_TEXTURE_VIEW);
+}
+
+void CommandBufferImpl::fillBuffer(const BufferPtr& buff, PtrSize offset, PtrSize size, U32 value)
+{
+	BufferImpl& impl = static_cast<BufferImpl&>(*buff);
+	ANKI_ASSERT(impl.usageValid(BufferUsageBit::TRANSFER_DESTINATION));
+	ANKI_ASSERT((offset % 4) == 0 && "Should be multiple of 4");
+	ANKI_ASSERT(impl.rangeValid(offset, size));
+	outsideRenderPassCommon();
+
+	// Do the work on the CPU. It's cheap and it keeps readbacks meaningful
+	const PtrSize end = (size == MAX_PTR_SIZE) ? impl.getSize() : offset + size;
+	U32* it = reinterpret_cast<U32*>(impl.getMemory() + offset);
+	U32* const itEnd = reinterpret_cast<U32*>(impl.getMemory() + getAlignedRoundDown(4, end));
+	while(it < itEnd)
+	{
+		*it++ = value;
+	}
+
+	pushCommand(NullCommandType::FILL_BUFFER);
+}
+
+void CommandBufferImpl::copyBufferToBuffer(
+	const BufferPtr& src, PtrSize srcOffset, const BufferPtr& dst, PtrSize dstOffset, PtrSize range)
+{
+	const BufferImpl& srcImpl = static_cast<const BufferImpl&>(*src);
+	BufferImpl& dstImpl = static_cast<BufferImpl&>(*dst);
+	ANKI_ASSERT(srcImpl.usageValid(BufferUsageBit::TRANSFER_SOURCE));
+	ANKI_ASSERT(dstImpl.usageValid(BufferUsageBit::TRANSFER_DESTINATION));
+	ANKI_ASSERT(range > 0 && range != MAX_PTR_SIZE);
+	ANKI_ASSERT(srcImpl.rangeValid(srcOffset, range));
+	ANKI_ASSERT(dstImpl.rangeValid(dstOffset, range));
+	outsideRenderPassCommon();
+
+	memmove(dstImpl.getMemory() + dstOffset, srcImpl.getMemory() + srcOffset, range);
+
+	pushCommand(NullCommandType::COPY_BUFFER_TO_BUFFER);
+}
+
+void CommandBufferImpl::writeOcclusionQueryResultToBuffer(PtrSize offset, const BufferPtr& buff)
+{
+	BufferImpl& impl = static_cast<BufferImpl&>(*buff);
+	ANKI_ASSERT(impl.usageValid(BufferUsageBit::TRANSFER_DESTINATION));
+	ANKI_ASSERT((offset % 4) == 0);
+	ANKI_ASSERT(impl.rangeValid(offset, sizeof(U32)));
+	outsideRenderPassCommon();
+
+	// Everything is visible
+	*reinterpret_cast<U32*>(impl.getMemory() + offset) = 1;
+
+	pushCommand(NullCommandType::WRITE_OCCLUSION_QUERY_RESULT);
+}
+
+void CommandBufferImpl::buildAccelerationStructure()
+{
+	outsideRenderPassCommon();
+	pushCommand(NullCommandType::BUILD_ACCELERATION_STRUCTURE);
+}
+
+void CommandBufferImpl::setTextureBarrier(const TexturePtr& tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage)
+{
+	const TextureImpl& impl = static_cast<const TextureImpl&>(*tex);
+	ANKI_ASSERT(impl.usageValid(prevUsage));
+	ANKI_ASSERT(impl.usageValid(nextUsage));
+	(void)impl;
+	outsideRenderPassCommon();
+	pushCommand(NullCommandType::BARRIER);
+}
+
+void CommandBufferImpl::setBufferBarrier(
+	const BufferPtr& buff, BufferUsageBit prevUsage, BufferUsageBit nextUsage, PtrSize offset, PtrSize size)
+{
+	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
+	ANKI_ASSERT(impl.usageValid(prevUsage));
+	ANKI_ASSERT(impl.usageValid(nextUsage));
+	ANKI_ASSERT(impl.rangeValid(offset, size));
+	(void)impl;
+	outsideRenderPassCommon();
+	pushCommand(NullCommandType::BARRIER);
+}
+
+void CommandBufferImpl::writeTimestamp(const TimestampQueryPtr& query)
+{
+	static_cast<TimestampQueryImpl&>(*query).m_timestamp = HighRezTimer::getCurrentTime();
+	pushCommand(NullCommandType::TIMESTAMP_QUERY);
+}
+
+void CommandBufferImpl::pushSecondLevelCommandBuffer(const CommandBufferPtr& cmdb)
+{
+	ANKI_ASSERT(m_insideRenderPass && "Second level command buffers should be pushed inside a render pass");
+	ANKI_ASSERT(!isSecondLevel());
+
+	const CommandBufferImpl& impl = static_cast<const CommandBufferImpl&>(*cmdb);
+	ANKI_ASSERT(impl.isSecondLevel() && impl.m_finalized);
+	ANKI_ASSERT(impl.m_activeFb == m_activeFb && "Framebuffers don't match");
+	(void)impl;
+
+	if(m_secondLevelCmdbCount == m_secondLevelCmdbs.getSize())
+	{
+		m_secondLevelCmdbs.resize(getAllocator(), max<U32>(8, m_secondLevelCmdbs.getSize() * 2));
+	}
+	m_secondLevelCmdbs[m_secondLevelCmdbCount++] = cmdb;
+
+	pushCommand(NullCommandType::PUSH_SECOND_LEVEL);
+}
+
+void CommandBufferImpl::setPushConstants(const void* data, U32 dataSize)
+{
+	ANKI_ASSERT(data && dataSize && dataSize % 16 == 0);
+	ANKI_ASSERT((m_graphicsProg.isCreated() || m_computeProg.isCreated()) && "Need a program bound first");
+	pushCommand(NullCommandType::SET_PUSH_CONSTANTS);
+}
+
+} // end namespace anki
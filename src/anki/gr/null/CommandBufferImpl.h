@@ -0,0 +1,208 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/CommandBuffer.h>
+#include <anki/gr/Framebuffer.h>
+#include <anki/gr/ShaderProgram.h>
+#include <anki/gr/null/Common.h>
+#include <anki/util/DynamicArray.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// The type of a recorded command.
+enum class NullCommandType : U8
+{
+	BIND_VERTEX_BUFFER,
+	SET_VERTEX_ATTRIBUTE,
+	BIND_INDEX_BUFFER,
+	SET_STATE, ///< All the dynamic and pipeline state setters.
+	BIND_RESOURCE, ///< All the descriptor set bindings.
+	BIND_SHADER_PROGRAM,
+	BEGIN_RENDER_PASS,
+	END_RENDER_PASS,
+	DRAW,
+	DRAW_INDIRECT,
+	DISPATCH,
+	GENERATE_MIPMAPS,
+	CLEAR_TEXTURE_VIEW,
+	COPY_BUFFER_TO_TEXTURE_VIEW,
+	FILL_BUFFER,
+	COPY_BUFFER_TO_BUFFER,
+	WRITE_OCCLUSION_QUERY_RESULT,
+	BUILD_ACCELERATION_STRUCTURE,
+	BARRIER,
+	OCCLUSION_QUERY,
+	TIMESTAMP_QUERY,
+	PUSH_SECOND_LEVEL,
+	SET_PUSH_CONSTANTS,
+
+	COUNT
+};
+
+/// Command buffer implementation. It doesn't execute anything but it validates the commands the same way the real
+/// backends do and it keeps a record of the types of the commands for testing and profiling.
+class CommandBufferImpl final : public CommandBuffer
+{
+public:
+	CommandBufferImpl(GrManager* manager, CString name)
+		: CommandBuffer(manager, name)
+	{
+	}
+
+	~CommandBufferImpl();
+
+	ANKI_USE_RESULT Error init(const CommandBufferInitInfo& init);
+
+	void endRecording(FencePtr* fence);
+
+	Bool isSecondLevel() const
+	{
+		return !!(m_flags & CommandBufferFlag::SECOND_LEVEL);
+	}
+
+	Bool isEmpty() const
+	{
+		return m_commandCount == 0;
+	}
+
+	U32 getCommandCount() const
+	{
+		return m_commandCount;
+	}
+
+	/// Get the number of commands of a specific type.
+	U32 getCommandCount(NullCommandType type) const
+	{
+		return m_commandTypeCounts[type];
+	}
+
+	void bindVertexBuffer(U32 binding, BufferPtr buff, PtrSize offset);
+
+	void bindIndexBuffer(BufferPtr buff, PtrSize offset);
+
+	void setState()
+	{
+		pushCommand(NullCommandType::SET_STATE);
+	}
+
+	void setColorAttachmentState(U32 attachment)
+	{
+		ANKI_ASSERT(attachment < MAX_COLOR_ATTACHMENTS);
+		pushCommand(NullCommandType::SET_STATE);
+	}
+
+	void bindTexture(U32 set, U32 binding, const TextureViewPtr& texView, TextureUsageBit usage);
+
+	void bindImage(U32 set, U32 binding, const TextureViewPtr& img);
+
+	void bindBuffer(U32 set, U32 binding, const BufferPtr& buff, PtrSize offset, PtrSize range, BufferUsageBit usage);
+
+	void bindResource(U32 set, U32 binding)
+	{
+		ANKI_ASSERT(set < MAX_DESCRIPTOR_SETS);
+		ANKI_ASSERT(binding < MAX_BINDINGS_PER_DESCRIPTOR_SET);
+		pushCommand(NullCommandType::BIND_RESOURCE);
+	}
+
+	U32 bindBindlessTexture(const TextureViewPtr& tex, TextureUsageBit usage);
+
+	U32 bindBindlessImage(const TextureViewPtr& img);
+
+	void bindShaderProgram(const ShaderProgramPtr& prog);
+
+	void beginRenderPass(const FramebufferPtr& fb, U32 minx, U32 miny, U32 width, U32 height);
+
+	void endRenderPass();
+
+	void drawcallCommon();
+
+	void drawIndirect(U32 drawCount, PtrSize offset, const BufferPtr& buff, PtrSize drawCommandSize);
+
+	void dispatchCompute(U32 groupCountX, U32 groupCountY, U32 groupCountZ);
+
+	void generateMipmaps2d(const TextureViewPtr& texView);
+
+	void clearTextureView(const TextureViewPtr& texView);
+
+	void copyBufferToTextureView(const BufferPtr& buff, PtrSize offset, PtrSize range, const TextureViewPtr& texView);
+
+	void fillBuffer(const BufferPtr& buff, PtrSize offset, PtrSize size, U32 value);
+
+	void copyBufferToBuffer(
+		const BufferPtr& src, PtrSize srcOffset, const BufferPtr& dst, PtrSize dstOffset, PtrSize range);
+
+	void writeOcclusionQueryResultToBuffer(PtrSize offset, const BufferPtr& buff);
+
+	void buildAccelerationStructure();
+
+	void setTextureBarrier(const TexturePtr& tex, TextureUsageBit prevUsage, TextureUsageBit nextUsage);
+
+	void setBufferBarrier(
+		const BufferPtr& buff, BufferUsageBit prevUsage, BufferUsageBit nextUsage, PtrSize offset, PtrSize size);
+
+	void setAccelerationStructureBarrier()
+	{
+		outsideRenderPassCommon();
+		pushCommand(NullCommandType::BARRIER);
+	}
+
+	void occlusionQuery()
+	{
+		pushCommand(NullCommandType::OCCLUSION_QUERY);
+	}
+
+	void writeTimestamp(const TimestampQueryPtr& query);
+
+	void resetTimestampQuery()
+	{
+		pushCommand(NullCommandType::TIMESTAMP_QUERY);
+	}
+
+	void pushSecondLevelCommandBuffer(const CommandBufferPtr& cmdb);
+
+	void setPushConstants(const void* data, U32 dataSize);
+
+private:
+	CommandBufferFlag m_flags = CommandBufferFlag::NONE;
+	Bool m_finalized = false;
+
+	U32 m_commandCount = 0;
+	Array<U32, U32(NullCommandType::COUNT)> m_commandTypeCounts = {};
+
+	FramebufferPtr m_activeFb;
+	Bool m_insideRenderPass = false;
+
+	ShaderProgramPtr m_graphicsProg;
+	ShaderProgramPtr m_computeProg;
+
+	DynamicArray<CommandBufferPtr> m_secondLevelCmdbs; ///< Hold references.
+	U32 m_secondLevelCmdbCount = 0;
+
+	void pushCommand(NullCommandType type)
+	{
+		ANKI_ASSERT(!m_finalized && "Command buffer is already finalized");
+		++m_commandCount;
+		++m_commandTypeCounts[type];
+	}
+
+	Bool insideRenderPass() const
+	{
+		return m_insideRenderPass || isSecondLevel();
+	}
+
+	void outsideRenderPassCommon() const
+	{
+		ANKI_ASSERT(!insideRenderPass() && "Command not allowed inside a render pass");
+	}
+};
+/// @}
+
+} // end namespace anki
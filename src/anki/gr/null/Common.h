@@ -0,0 +1,31 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Common.h>
+
+namespace anki
+{
+
+// Forward
+class GrManagerImpl;
+
+/// @addtogroup null
+/// @{
+
+#define ANKI_NULL_LOGI(...) ANKI_LOG("NULL", NORMAL, __VA_ARGS__)
+#define ANKI_NULL_LOGE(...) ANKI_LOG("NULL", ERROR, __VA_ARGS__)
+#define ANKI_NULL_LOGW(...) ANKI_LOG("NULL", WARNING, __VA_ARGS__)
+#define ANKI_NULL_LOGF(...) ANKI_LOG("NULL", FATAL, __VA_ARGS__)
+
+#define ANKI_NULL_SELF(class_) class_& self = *static_cast<class_*>(this)
+#define ANKI_NULL_SELF_CONST(class_) const class_& self = *static_cast<const class_*>(this)
+
+/// The fake alignment of the buffer offsets. Use something that is close to what real HW requires.
+const U32 NULL_BUFFER_OFFSET_ALIGNMENT = 256;
+/// @}
+
+} // end namespace anki
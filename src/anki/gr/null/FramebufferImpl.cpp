@@ -0,0 +1,59 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/FramebufferImpl.h>
+#include <anki/gr/null/TextureViewImpl.h>
+
+namespace anki
+{
+
+static void computeAttachmentSize(const TextureViewPtr& view, U32& width, U32& height)
+{
+	const TextureViewImpl& viewImpl = static_cast<const TextureViewImpl&>(*view);
+	const Texture& tex = *viewImpl.getTexture();
+	const U32 mip = viewImpl.getSubresource().m_firstMipmap;
+
+	width = max(1u, tex.getWidth() >> mip);
+	height = max(1u, tex.getHeight() >> mip);
+}
+
+Error FramebufferImpl::init(const FramebufferInitInfo& init)
+{
+	ANKI_ASSERT(init.isValid());
+
+	m_colorAttachmentCount = init.m_colorAttachmentCount;
+	for(U32 i = 0; i < m_colorAttachmentCount; ++i)
+	{
+		const FramebufferAttachmentInfo& att = init.m_colorAttachments[i];
+		const TextureViewImpl& view = static_cast<const TextureViewImpl&>(*att.m_textureView);
+		ANKI_ASSERT(view.getTexture()->isSubresourceGoodForFramebufferAttachment(view.getSubresource()));
+		ANKI_ASSERT(!!(view.getTexture()->getTextureUsage() & TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE));
+		(void)view;
+
+		m_colorAttachments[i] = att.m_textureView;
+
+		U32 width, height;
+		computeAttachmentSize(att.m_textureView, width, height);
+		ANKI_ASSERT((i == 0 || (width == m_width && height == m_height)) && "Attachments should have the same size");
+		m_width = width;
+		m_height = height;
+	}
+
+	if(init.m_depthStencilAttachment.m_textureView.isCreated())
+	{
+		m_depthStencilAttachment = init.m_depthStencilAttachment.m_textureView;
+
+		U32 width, height;
+		computeAttachmentSize(m_depthStencilAttachment, width, height);
+		ANKI_ASSERT((m_colorAttachmentCount == 0 || (width == m_width && height == m_height))
+					&& "Attachments should have the same size");
+		m_width = width;
+		m_height = height;
+	}
+
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -0,0 +1,71 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Framebuffer.h>
+#include <anki/gr/TextureView.h>
+#include <anki/gr/Texture.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Framebuffer implementation.
+class FramebufferImpl final : public Framebuffer
+{
+public:
+	FramebufferImpl(GrManager* manager, CString name)
+		: Framebuffer(manager, name)
+	{
+	}
+
+	~FramebufferImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const FramebufferInitInfo& init);
+
+	U32 getColorAttachmentCount() const
+	{
+		return m_colorAttachmentCount;
+	}
+
+	Bool hasDepthStencil() const
+	{
+		return m_depthStencilAttachment.isCreated();
+	}
+
+	void getAttachmentsSize(U32& width, U32& height) const
+	{
+		ANKI_ASSERT(m_width != 0 && m_height != 0);
+		width = m_width;
+		height = m_height;
+	}
+
+	const TextureViewPtr& getColorAttachment(U32 idx) const
+	{
+		ANKI_ASSERT(idx < m_colorAttachmentCount);
+		return m_colorAttachments[idx];
+	}
+
+	const TextureViewPtr& getDepthStencilAttachment() const
+	{
+		return m_depthStencilAttachment;
+	}
+
+private:
+	Array<TextureViewPtr, MAX_COLOR_ATTACHMENTS> m_colorAttachments;
+	TextureViewPtr m_depthStencilAttachment;
+	U32 m_colorAttachmentCount = 0;
+	U32 m_width = 0;
+	U32 m_height = 0;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,117 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/GrManagerImpl.h>
+#include <anki/gr/Texture.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/core/NativeWindow.h>
+
+namespace anki
+{
+
+GrManagerImpl::~GrManagerImpl()
+{
+	for(TexturePtr& tex : m_presentableTextures)
+	{
+		tex.reset(nullptr);
+	}
+
+	ANKI_ASSERT(m_commandBufferCount.load() == 0 && "Command buffers leaked");
+
+	for(DynamicArray<U32>& indices : m_freeBindlessIndices)
+	{
+		ANKI_ASSERT(m_freeBindlessIndexCount[U32(&indices - &m_freeBindlessIndices[0])] == indices.getSize()
+					&& "Forgot to release some bindless indices");
+		indices.destroy(getAllocator());
+	}
+}
+
+Error GrManagerImpl::init(const GrManagerInitInfo& init)
+{
+	ANKI_NULL_LOGI("Initializing the NULL graphics backend. Nothing will be rendered");
+
+	// Fake some reasonable limits
+	m_capabilities.m_uniformBufferBindOffsetAlignment = NULL_BUFFER_OFFSET_ALIGNMENT;
+	m_capabilities.m_uniformBufferMaxRange = 64_KB;
+	m_capabilities.m_storageBufferBindOffsetAlignment = NULL_BUFFER_OFFSET_ALIGNMENT;
+	m_capabilities.m_storageBufferMaxRange = MAX_U32;
+	m_capabilities.m_textureBufferBindOffsetAlignment = NULL_BUFFER_OFFSET_ALIGNMENT;
+	m_capabilities.m_textureBufferMaxRange = MAX_U32;
+	m_capabilities.m_gpuVendor = GpuVendor::UNKNOWN;
+	m_capabilities.m_majorApiVersion = 1;
+	m_capabilities.m_minorApiVersion = 0;
+	m_capabilities.m_rayTracingEnabled = false;
+
+	m_bindlessLimits.m_bindlessTextureCount = init.m_config->getNumberU32(ConfigOption::gr_maxBindlessTextures);
+	m_bindlessLimits.m_bindlessImageCount = init.m_config->getNumberU32(ConfigOption::gr_maxBindlessImages);
+
+	// Init the free lists of the bindless indices. The lower indices go first
+	for(U32 i = 0; i < 2; ++i)
+	{
+		const U32 count = (i == 0) ? m_bindlessLimits.m_bindlessTextureCount : m_bindlessLimits.m_bindlessImageCount;
+		m_freeBindlessIndices[i].create(getAllocator(), count);
+		m_freeBindlessIndexCount[i] = count;
+		for(U32 j = 0; j < count; ++j)
+		{
+			m_freeBindlessIndices[i][j] = count - j - 1;
+		}
+	}
+
+	// Create the presentable textures
+	const U32 width = (init.m_window) ? init.m_window->getWidth() : init.m_config->getNumberU32(ConfigOption::width);
+	const U32 height = (init.m_window) ? init.m_window->getHeight() : init.m_config->getNumberU32(ConfigOption::height);
+	for(TexturePtr& tex : m_presentableTextures)
+	{
+		TextureInitInfo texInit("SwapchainImg");
+		texInit.m_width = width;
+		texInit.m_height = height;
+		texInit.m_format = Format::B8G8R8A8_UNORM;
+		texInit.m_usage = TextureUsageBit::IMAGE_COMPUTE_WRITE | TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE
+						  | TextureUsageBit::PRESENT;
+		texInit.m_type = TextureType::_2D;
+
+		tex = newTexture(texInit);
+		if(!tex.isCreated())
+		{
+			ANKI_NULL_LOGE("Failed to create the presentable textures");
+			return Error::FUNCTION_FAILED;
+		}
+	}
+
+	return Error::NONE;
+}
+
+TexturePtr GrManagerImpl::acquireNextPresentableTexture()
+{
+	return m_presentableTextures[m_frame % MAX_FRAMES_IN_FLIGHT];
+}
+
+void GrManagerImpl::endFrame()
+{
+	++m_frame;
+}
+
+U32 GrManagerImpl::newBindlessIndex(Bool image)
+{
+	const U32 i = (image) ? 1 : 0;
+
+	LockGuard<Mutex> lock(m_bindlessMtx);
+	ANKI_ASSERT(m_freeBindlessIndexCount[i] > 0 && "Out of indices");
+	--m_freeBindlessIndexCount[i];
+	return m_freeBindlessIndices[i][m_freeBindlessIndexCount[i]];
+}
+
+void GrManagerImpl::releaseBindlessIndex(U32 idx, Bool image)
+{
+	const U32 i = (image) ? 1 : 0;
+
+	LockGuard<Mutex> lock(m_bindlessMtx);
+	ANKI_ASSERT(idx < m_freeBindlessIndices[i].getSize());
+	ANKI_ASSERT(m_freeBindlessIndexCount[i] < m_freeBindlessIndices[i].getSize());
+	m_freeBindlessIndices[i][m_freeBindlessIndexCount[i]] = idx;
+	++m_freeBindlessIndexCount[i];
+}
+
+} // end namespace anki
@@ -0,0 +1,116 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/GrManager.h>
+#include <anki/gr/Texture.h>
+#include <anki/gr/null/Common.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// A GrManager that doesn't talk to any GPU. All the objects are plain CPU objects and the command buffers only
+/// validate and record the commands. Useful to measure the CPU cost of the renderer.
+class GrManagerImpl : public GrManager
+{
+public:
+	GrManagerImpl()
+	{
+	}
+
+	~GrManagerImpl();
+
+	ANKI_USE_RESULT Error init(const GrManagerInitInfo& init);
+
+	TexturePtr acquireNextPresentableTexture();
+
+	void endFrame();
+
+	void finish()
+	{
+		// Nothing to wait for
+	}
+
+	void getStats(GrManagerStats& stats) const
+	{
+		stats.m_cpuMemory = m_hostMemory.load();
+		stats.m_gpuMemory = m_virtualGpuMemory.load();
+		stats.m_commandBufferCount = m_commandBufferCount.load();
+	}
+
+	/// @name Memory and object accounting
+	/// @{
+	void updateHostMemory(PtrSize size, Bool allocate)
+	{
+		if(allocate)
+		{
+			m_hostMemory.fetchAdd(size);
+		}
+		else
+		{
+			m_hostMemory.fetchSub(size);
+		}
+	}
+
+	void updateVirtualGpuMemory(PtrSize size, Bool allocate)
+	{
+		if(allocate)
+		{
+			m_virtualGpuMemory.fetchAdd(size);
+		}
+		else
+		{
+			m_virtualGpuMemory.fetchSub(size);
+		}
+	}
+
+	void updateCommandBufferCount(Bool create)
+	{
+		if(create)
+		{
+			m_commandBufferCount.fetchAdd(1);
+		}
+		else
+		{
+			m_commandBufferCount.fetchSub(1);
+		}
+	}
+	/// @}
+
+	/// Get a new index in the bindless descriptor set.
+	/// @note It's thread-safe.
+	U32 newBindlessIndex(Bool image);
+
+	/// Give back an index of the bindless descriptor set.
+	/// @note It's thread-safe.
+	void releaseBindlessIndex(U32 idx, Bool image);
+
+	U64 getFrame() const
+	{
+		return m_frame;
+	}
+
+private:
+	Array<TexturePtr, MAX_FRAMES_IN_FLIGHT> m_presentableTextures;
+	U64 m_frame = 0;
+
+	Atomic<PtrSize> m_hostMemory = {0};
+	Atomic<PtrSize> m_virtualGpuMemory = {0};
+	Atomic<U32> m_commandBufferCount = {0};
+
+	/// The free indices of the bindless textures (0) and images (1). Like a stack.
+	Array<DynamicArray<U32>, 2> m_freeBindlessIndices;
+	Array<U32, 2> m_freeBindlessIndexCount = {{0, 0}};
+	Mutex m_bindlessMtx;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,40 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Sampler.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Sampler implementation.
+class SamplerImpl final : public Sampler
+{
+public:
+	SamplerInitInfo m_init;
+
+	SamplerImpl(GrManager* manager, CString name)
+		: Sampler(manager, name)
+	{
+	}
+
+	~SamplerImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const SamplerInitInfo& init)
+	{
+		m_init = init;
+		return Error::NONE;
+	}
+};
+/// @}
+
+} // end namespace anki
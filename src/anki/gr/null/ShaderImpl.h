@@ -0,0 +1,44 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Shader.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Shader implementation. It doesn't compile anything, it only keeps a hash of the binary.
+class ShaderImpl final : public Shader
+{
+public:
+	U64 m_binaryHash = 0;
+
+	ShaderImpl(GrManager* manager, CString name)
+		: Shader(manager, name)
+	{
+	}
+
+	~ShaderImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const ShaderInitInfo& init)
+	{
+		ANKI_ASSERT(init.m_shaderType != ShaderType::COUNT);
+		ANKI_ASSERT(init.m_binary.getSize() > 0);
+
+		m_shaderType = init.m_shaderType;
+		m_binaryHash = computeHash(&init.m_binary[0], init.m_binary.getSize());
+		return Error::NONE;
+	}
+};
+/// @}
+
+} // end namespace anki
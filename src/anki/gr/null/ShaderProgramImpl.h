@@ -0,0 +1,57 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/ShaderProgram.h>
+#include <anki/gr/Shader.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Shader program implementation.
+class ShaderProgramImpl final : public ShaderProgram
+{
+public:
+	Array<ShaderPtr, U32(ShaderType::COUNT)> m_shaders;
+	ShaderTypeBit m_stages = ShaderTypeBit::NONE;
+
+	ShaderProgramImpl(GrManager* manager, CString name)
+		: ShaderProgram(manager, name)
+	{
+	}
+
+	~ShaderProgramImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init(const ShaderProgramInitInfo& init)
+	{
+		ANKI_ASSERT(init.isValid());
+
+		for(ShaderType type = ShaderType::FIRST; type < ShaderType::COUNT; ++type)
+		{
+			if(init.m_shaders[type])
+			{
+				m_shaders[type] = init.m_shaders[type];
+				m_stages |= shaderTypeToBit(type);
+			}
+		}
+
+		return Error::NONE;
+	}
+
+	Bool isCompute() const
+	{
+		return m_stages == ShaderTypeBit::COMPUTE;
+	}
+};
+/// @}
+
+} // end namespace anki
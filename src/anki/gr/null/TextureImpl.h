@@ -0,0 +1,43 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Texture.h>
+#include <anki/gr/null/Common.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Texture implementation. It only holds the metadata of the texture.
+class TextureImpl final : public Texture
+{
+public:
+	TextureImpl(GrManager* manager, CString name)
+		: Texture(manager, name)
+	{
+	}
+
+	~TextureImpl();
+
+	ANKI_USE_RESULT Error init(const TextureInitInfo& init);
+
+	Bool usageValid(TextureUsageBit usage) const
+	{
+		return (usage & m_usage) == usage;
+	}
+
+	/// Compute the new type of a texture view.
+	TextureType computeNewTexTypeOfSubresource(const TextureSubresourceInfo& subresource) const;
+
+private:
+	PtrSize m_virtualSize = 0; ///< The memory the texture would have occupied.
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,48 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/null/TextureViewImpl.h>
+#include <anki/gr/null/TextureImpl.h>
+#include <anki/gr/null/GrManagerImpl.h>
+
+namespace anki
+{
+
+TextureViewImpl::~TextureViewImpl()
+{
+	for(U32 i = 0; i < 2; ++i)
+	{
+		if(m_bindlessIndices[i] != MAX_U32)
+		{
+			static_cast<GrManagerImpl&>(getManager()).releaseBindlessIndex(m_bindlessIndices[i], i == 1);
+		}
+	}
+}
+
+Error TextureViewImpl::init(const TextureViewInitInfo& inf)
+{
+	ANKI_ASSERT(inf.isValid());
+
+	m_subresource = inf;
+	m_tex = inf.m_texture;
+	m_texType = static_cast<const TextureImpl&>(*m_tex).computeNewTexTypeOfSubresource(inf);
+
+	return Error::NONE;
+}
+
+U32 TextureViewImpl::getOrCreateBindlessIndex(Bool image)
+{
+	LockGuard<SpinLock> lock(m_bindlessIndicesLock);
+
+	U32& idx = m_bindlessIndices[(image) ? 1 : 0];
+	if(idx == MAX_U32)
+	{
+		idx = static_cast<GrManagerImpl&>(getManager()).newBindlessIndex(image);
+	}
+
+	return idx;
+}
+
+} // end namespace anki
@@ -0,0 +1,47 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/TimestampQuery.h>
+#include <anki/gr/null/Common.h>
+#include <anki/util/HighRezTimer.h>
+
+namespace anki
+{
+
+/// @addtogroup null
+/// @{
+
+/// Timestamp query implementation. It stores the CPU time the command buffer was submitted.
+class TimestampQueryImpl final : public TimestampQuery
+{
+public:
+	Second m_timestamp = -1.0;
+
+	TimestampQueryImpl(GrManager* manager, CString name)
+		: TimestampQuery(manager, name)
+	{
+	}
+
+	~TimestampQueryImpl()
+	{
+	}
+
+	ANKI_USE_RESULT Error init()
+	{
+		return Error::NONE;
+	}
+
+	/// Get query result.
+	TimestampQueryResult getResultInternal(Second& timestamp) const
+	{
+		timestamp = m_timestamp;
+		return (m_timestamp >= 0.0) ? TimestampQueryResult::AVAILABLE : TimestampQueryResult::NOT_AVAILABLE;
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -6,6 +6,8 @@
 #include <anki/gr/utils/ClassGpuAllocator.h>
 #include <anki/util/List.h>
 #include <anki/util/BitSet.h>
+#include <anki/util/DynamicArray.h>
+#include <algorithm>
 
 namespace anki
 {
@@ -27,6 +29,9 @@ public:
 
 	/// The owner.
 	ClassGpuAllocatorClass* m_class = nullptr;
+
+	/// The chunk is being emptied by the defragmentation. New allocations shouldn't go there.
+	Bool m_defragmenting = false;
 };
 
 class ClassGpuAllocatorClass
@@ -44,9 +49,28 @@ public:
 	/// The number of slots for a single chunk.
 	U32 m_slotsPerChunkCount = 0;
 
-	Mutex m_mtx;
+	/// A defragmentation of this class is in progress.
+	Bool m_defragmenting = false;
+
+	mutable Mutex m_mtx;
 };
 
+/// Find the first unused slot of a chunk.
+static U32 findUnusedSlot(const ClassGpuAllocatorChunk& chunk, U32 slotCount)
+{
+	ANKI_ASSERT(chunk.m_inUseSlotCount < slotCount);
+	for(U32 i = 0; i < slotCount; ++i)
+	{
+		if(!chunk.m_inUseSlots.get(i))
+		{
+			return i;
+		}
+	}
+
+	ANKI_ASSERT(0);
+	return MAX_U32;
+}
+
 ClassGpuAllocator::~ClassGpuAllocator()
 {
 	for(Class& c : m_classes)
@@ -136,7 +160,7 @@ ClassGpuAllocator::Chunk* ClassGpuAllocator::findChunkWithUnusedSlot(Class& cl)
 	const auto end = cl.m_inUseChunks.getEnd();
 	while(it != end)
 	{
-		if(it->m_inUseSlotCount < cl.m_slotsPerChunkCount)
+		if(it->m_inUseSlotCount < cl.m_slotsPerChunkCount && !it->m_defragmenting)
 		{
 			return &(*it);
 		}
@@ -194,22 +218,13 @@ Error ClassGpuAllocator::allocate(PtrSize size, U alignment, ClassGpuAllocatorHa
 	}
 
 	// Allocate from chunk
-	U32 bitCount = cl->m_slotsPerChunkCount;
-	for(U32 i = 0; i < bitCount; ++i)
-	{
-		if(!chunk->m_inUseSlots.get(i))
-		{
-			// Found an empty slot, allocate from it
-			chunk->m_inUseSlots.set(i);
-			++chunk->m_inUseSlotCount;
-
-			handle.m_memory = chunk->m_mem;
-			handle.m_offset = i * cl->m_maxSlotSize;
-			handle.m_chunk = chunk;
+	const U32 slotIdx = findUnusedSlot(*chunk, cl->m_slotsPerChunkCount);
+	chunk->m_inUseSlots.set(slotIdx);
+	++chunk->m_inUseSlotCount;
 
-			break;
-		}
-	}
+	handle.m_memory = chunk->m_mem;
+	handle.m_offset = slotIdx * cl->m_maxSlotSize;
+	handle.m_chunk = chunk;
 
 	ANKI_ASSERT(handle.m_memory && handle.m_chunk);
 	ANKI_ASSERT(isAligned(alignment, handle.m_offset));
@@ -225,8 +240,13 @@ void ClassGpuAllocator::free(ClassGpuAllocatorHandle& handle)
 	Class& cl = *chunk.m_class;
 
 	LockGuard<Mutex> lock(cl.m_mtx);
-	const U32 slotIdx = U32(handle.m_offset / cl.m_maxSlotSize);
+	releaseSlot(cl, chunk, U32(handle.m_offset / cl.m_maxSlotSize));
 
+	handle = {};
+}
+
+void ClassGpuAllocator::releaseSlot(Class& cl, Chunk& chunk, U32 slotIdx)
+{
 	ANKI_ASSERT(chunk.m_inUseSlots.get(slotIdx));
 	ANKI_ASSERT(chunk.m_inUseSlotCount > 0);
 	chunk.m_inUseSlots.unset(slotIdx);
@@ -236,8 +256,163 @@ void ClassGpuAllocator::free(ClassGpuAllocatorHandle& handle)
 	{
 		destroyChunk(cl, chunk);
 	}
+}
 
-	handle = {};
+void ClassGpuAllocator::getStats(U32 classIdx, ClassGpuAllocatorStats& stats) const
+{
+	const Class& cl = m_classes[classIdx];
+	stats = {};
+	stats.m_slotSize = cl.m_maxSlotSize;
+	stats.m_chunkSize = cl.m_chunkSize;
+
+	LockGuard<Mutex> lock(cl.m_mtx);
+	for(const Chunk& chunk : cl.m_inUseChunks)
+	{
+		++stats.m_chunkCount;
+		stats.m_usedSlotCount += chunk.m_inUseSlotCount;
+		stats.m_slotCount += cl.m_slotsPerChunkCount;
+
+		if(chunk.m_inUseSlotCount * 2 < cl.m_slotsPerChunkCount)
+		{
+			++stats.m_sparseChunkCount;
+		}
+	}
+}
+
+U32 ClassGpuAllocator::defragment(F32 maxOccupancy, ClassGpuAllocatorRelocator& relocator)
+{
+	ANKI_ASSERT(maxOccupancy > 0.0f && maxOccupancy <= 1.0f);
+
+	U32 moveCount = 0;
+	for(Class& cl : m_classes)
+	{
+		moveCount += defragmentClass(cl, maxOccupancy, relocator);
+	}
+
+	return moveCount;
+}
+
+U32 ClassGpuAllocator::defragmentClass(Class& cl, F32 maxOccupancy, ClassGpuAllocatorRelocator& relocator)
+{
+	class Move
+	{
+	public:
+		ClassGpuAllocatorHandle m_from;
+		ClassGpuAllocatorHandle m_to;
+		Bool m_done = false;
+	};
+
+	DynamicArrayAuto<Move> moves(m_alloc);
+	DynamicArrayAuto<Chunk*> srcChunks(m_alloc);
+
+	// Plan the moves and reserve the destination slots
+	{
+		LockGuard<Mutex> lock(cl.m_mtx);
+
+		if(cl.m_defragmenting)
+		{
+			// Some other thread is on it
+			return 0;
+		}
+
+		// Gather the chunks and sort them from the fullest to the emptiest
+		DynamicArrayAuto<Chunk*> chunks(m_alloc);
+		for(Chunk& chunk : cl.m_inUseChunks)
+		{
+			chunks.emplaceBack(&chunk);
+		}
+
+		if(chunks.getSize() < 2)
+		{
+			return 0;
+		}
+
+		std::sort(chunks.getBegin(), chunks.getEnd(), [](const Chunk* a, const Chunk* b) {
+			return a->m_inUseSlotCount > b->m_inUseSlotCount;
+		});
+
+		// Empty the sparse chunks at the back into the free slots of the chunks at the front
+		const U32 maxInUseSlotCount = U32(maxOccupancy * F32(cl.m_slotsPerChunkCount));
+		U32 dst = 0;
+		U32 src = chunks.getSize() - 1;
+		while(dst < src && chunks[src]->m_inUseSlotCount < maxInUseSlotCount)
+		{
+			Chunk& srcChunk = *chunks[src];
+
+			// Only empty the chunk if all of its slots fit in the chunks in front of it. Moving only a part of it
+			// won't free any memory
+			U32 freeSlotCount = 0;
+			for(U32 i = dst; i < src; ++i)
+			{
+				freeSlotCount += cl.m_slotsPerChunkCount - chunks[i]->m_inUseSlotCount;
+			}
+
+			if(freeSlotCount < srcChunk.m_inUseSlotCount)
+			{
+				break;
+			}
+
+			for(U32 srcSlot = 0; srcSlot < cl.m_slotsPerChunkCount; ++srcSlot)
+			{
+				if(!srcChunk.m_inUseSlots.get(srcSlot))
+				{
+					continue;
+				}
+
+				while(chunks[dst]->m_inUseSlotCount == cl.m_slotsPerChunkCount)
+				{
+					++dst;
+				}
+
+				ANKI_ASSERT(dst < src);
+				Chunk& dstChunk = *chunks[dst];
+				const U32 dstSlot = findUnusedSlot(dstChunk, cl.m_slotsPerChunkCount);
+				dstChunk.m_inUseSlots.set(dstSlot);
+				++dstChunk.m_inUseSlotCount;
+
+				Move& move = *moves.emplaceBack();
+				move.m_from.m_memory = srcChunk.m_mem;
+				move.m_from.m_offset = srcSlot * cl.m_maxSlotSize;
+				move.m_from.m_chunk = &srcChunk;
+				move.m_to.m_memory = dstChunk.m_mem;
+				move.m_to.m_offset = dstSlot * cl.m_maxSlotSize;
+				move.m_to.m_chunk = &dstChunk;
+			}
+
+			srcChunk.m_defragmenting = true;
+			srcChunks.emplaceBack(&srcChunk);
+			--src;
+		}
+
+		cl.m_defragmenting = moves.getSize() > 0;
+	}
+
+	// Copy without holding the lock. The reserved slots keep the chunks alive
+	U32 moveCount = 0;
+	for(Move& move : moves)
+	{
+		move.m_done = relocator.relocate(move.m_from, move.m_to);
+		moveCount += (move.m_done) ? 1 : 0;
+	}
+
+	// Release the slots that were moved or the reserved slots of the moves that didn't happen
+	{
+		LockGuard<Mutex> lock(cl.m_mtx);
+		cl.m_defragmenting = false;
+
+		for(Chunk* chunk : srcChunks)
+		{
+			chunk->m_defragmenting = false;
+		}
+
+		for(const Move& move : moves)
+		{
+			const ClassGpuAllocatorHandle& unused = (move.m_done) ? move.m_from : move.m_to;
+			releaseSlot(cl, *unused.m_chunk, U32(unused.m_offset / cl.m_maxSlotSize));
+		}
+	}
+
+	return moveCount;
 }
 
 } // end namespace anki
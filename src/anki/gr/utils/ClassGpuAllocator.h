@@ -67,6 +67,45 @@ private:
 	}
 };
 
+/// Moves the allocations of the ClassGpuAllocator during the defragmentation.
+class ClassGpuAllocatorRelocator
+{
+public:
+	virtual ~ClassGpuAllocatorRelocator()
+	{
+	}
+
+	/// Copy the contents of an allocation to a new place and make the owner of the allocation use the new handle. If it
+	/// returns false the allocation stays where it is (eg if it's used by the GPU at the moment).
+	/// @note It's called without holding the locks of the allocator so it can allocate or free other allocations. It
+	///       shouldn't free the allocation that is being moved.
+	virtual Bool relocate(const ClassGpuAllocatorHandle& from, const ClassGpuAllocatorHandle& to) = 0;
+};
+
+/// Statistics of a single class of the ClassGpuAllocator.
+class ClassGpuAllocatorStats
+{
+public:
+	PtrSize m_slotSize = 0;
+	PtrSize m_chunkSize = 0;
+	U32 m_chunkCount = 0;
+	U32 m_usedSlotCount = 0;
+	U32 m_slotCount = 0; ///< The slots of all the chunks.
+	U32 m_sparseChunkCount = 0; ///< The chunks that have less than half of their slots in use.
+
+	/// The part of the allocated chunks that is not used. Zero means no fragmentation.
+	F32 getFragmentation() const
+	{
+		return (m_slotCount) ? 1.0f - F32(m_usedSlotCount) / F32(m_slotCount) : 0.0f;
+	}
+
+	/// The memory of the chunks that is not used.
+	PtrSize getUnusedMemory() const
+	{
+		return PtrSize(m_slotCount - m_usedSlotCount) * m_slotSize;
+	}
+};
+
 /// Class based allocator.
 class ClassGpuAllocator : public NonCopyable
 {
@@ -90,6 +129,24 @@ public:
 		return m_allocatedMem;
 	}
 
+	U32 getClassCount() const
+	{
+		return m_classes.getSize();
+	}
+
+	/// Get the statistics of a class.
+	/// @note It's thread-safe.
+	void getStats(U32 classIdx, ClassGpuAllocatorStats& stats) const;
+
+	/// Move the allocations out of the sparsely used chunks to the denser ones and release the chunks that become
+	/// empty. It doesn't create new chunks. The destination slots are reserved under the lock of the class, the copies
+	/// happen without it and the lock is taken again to release the slots that were moved.
+	/// @param maxOccupancy The chunks that have less than this fraction of their slots in use will be emptied.
+	/// @param relocator Copies the allocations.
+	/// @return The number of allocations that were moved.
+	/// @note It's thread-safe.
+	U32 defragment(F32 maxOccupancy, ClassGpuAllocatorRelocator& relocator);
+
 private:
 	using Class = ClassGpuAllocatorClass;
 	using Chunk = ClassGpuAllocatorChunk;
@@ -111,6 +168,11 @@ private:
 
 	/// Destroy a chunk.
 	void destroyChunk(Class& cl, Chunk& chunk);
+
+	U32 defragmentClass(Class& cl, F32 maxOccupancy, ClassGpuAllocatorRelocator& relocator);
+
+	/// Mark a slot as unused and destroy the chunk if it becomes empty.
+	void releaseSlot(Class& cl, Chunk& chunk, U32 slotIdx);
 };
 /// @}
 
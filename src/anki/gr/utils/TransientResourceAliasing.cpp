@@ -0,0 +1,94 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/utils/TransientResourceAliasing.h>
+
+namespace anki
+{
+
+U32 planTransientResourceAliasing(ConstWeakArray<TransientResourceLifetime> resources,
+	WeakArray<TransientResourceAllocation> allocations,
+	WeakArray<U32> resourceAllocations)
+{
+	const U32 resourceCount = resources.getSize();
+	ANKI_ASSERT(allocations.getSize() >= resourceCount);
+	ANKI_ASSERT(resourceAllocations.getSize() == resourceCount);
+
+	for(U32 i = 0; i < resourceCount; ++i)
+	{
+		ANKI_ASSERT(resources[i].m_firstUse <= resources[i].m_lastUse);
+		resourceAllocations[i] = MAX_U32;
+	}
+
+	// Place the resources in the order of their first use. That way every resource goes to an allocation that has
+	// already finished. The resource count is small so a selection is fine
+	U32 allocationCount = 0;
+	for(U32 placedCount = 0; placedCount < resourceCount; ++placedCount)
+	{
+		// Find the next resource
+		U32 resourceIdx = MAX_U32;
+		for(U32 i = 0; i < resourceCount; ++i)
+		{
+			if(resourceAllocations[i] == MAX_U32
+				&& (resourceIdx == MAX_U32 || resources[i].m_firstUse < resources[resourceIdx].m_firstUse))
+			{
+				resourceIdx = i;
+			}
+		}
+
+		ANKI_ASSERT(resourceIdx != MAX_U32);
+		const TransientResourceLifetime& resource = resources[resourceIdx];
+
+		// Find a compatible allocation that is not used any more
+		U32 allocationIdx = MAX_U32;
+		for(U32 i = 0; i < allocationCount; ++i)
+		{
+			if(allocations[i].m_aliasingKey == resource.m_aliasingKey && allocations[i].m_lastUse < resource.m_firstUse)
+			{
+				allocationIdx = i;
+				break;
+			}
+		}
+
+		if(allocationIdx == MAX_U32)
+		{
+			// Not found, create a new one
+			allocationIdx = allocationCount++;
+			allocations[allocationIdx].m_aliasingKey = resource.m_aliasingKey;
+			allocations[allocationIdx].m_size = 0;
+		}
+
+		TransientResourceAllocation& allocation = allocations[allocationIdx];
+		allocation.m_size = max(allocation.m_size, resource.m_size);
+		allocation.m_lastUse = resource.m_lastUse;
+		resourceAllocations[resourceIdx] = allocationIdx;
+	}
+
+	return allocationCount;
+}
+
+PtrSize computeTransientResourceMemory(ConstWeakArray<TransientResourceLifetime> resources)
+{
+	PtrSize size = 0;
+	for(const TransientResourceLifetime& resource : resources)
+	{
+		size += resource.m_size;
+	}
+
+	return size;
+}
+
+PtrSize computeTransientResourceMemory(ConstWeakArray<TransientResourceAllocation> allocations)
+{
+	PtrSize size = 0;
+	for(const TransientResourceAllocation& allocation : allocations)
+	{
+		size += allocation.m_size;
+	}
+
+	return size;
+}
+
+} // end namespace anki
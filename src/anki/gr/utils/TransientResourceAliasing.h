@@ -0,0 +1,54 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/Common.h>
+#include <anki/util/WeakArray.h>
+
+namespace anki
+{
+
+/// @addtogroup graphics
+/// @{
+
+/// The lifetime of a transient resource. The lifetime is in batches (or any other ordered unit of work).
+class TransientResourceLifetime
+{
+public:
+	U64 m_aliasingKey = 0; ///< Only resources with the same key can share memory. Eg the hash of a texture descriptor.
+	PtrSize m_size = 0; ///< The memory size of the resource.
+	U32 m_firstUse = MAX_U32; ///< The first batch that uses the resource.
+	U32 m_lastUse = 0; ///< The last batch that uses the resource.
+};
+
+/// A memory allocation that is shared by transient resources with non-overlapping lifetimes.
+class TransientResourceAllocation
+{
+public:
+	U64 m_aliasingKey = 0;
+	PtrSize m_size = 0;
+	U32 m_lastUse = 0; ///< The last batch of the last resource that was placed in the allocation.
+};
+
+/// Find the transient resources that can share the same memory. Two resources can share memory if they have the same
+/// aliasing key and their lifetimes don't overlap. Resources used in the same batch always overlap since the work of a
+/// batch can run in parallel. It doesn't allocate memory.
+/// @param resources The lifetimes of the resources.
+/// @param[out] allocations The shared allocations. Should be at least as big as the resources.
+/// @param[out] resourceAllocations The allocation of every resource. Should be as big as the resources.
+/// @return The number of allocations.
+U32 planTransientResourceAliasing(ConstWeakArray<TransientResourceLifetime> resources,
+	WeakArray<TransientResourceAllocation> allocations,
+	WeakArray<U32> resourceAllocations);
+
+/// Compute the memory of some transient resources if each one of them has its own memory.
+PtrSize computeTransientResourceMemory(ConstWeakArray<TransientResourceLifetime> resources);
+
+/// Compute the memory of the allocations planned by planTransientResourceAliasing.
+PtrSize computeTransientResourceMemory(ConstWeakArray<TransientResourceAllocation> allocations);
+/// @}
+
+} // end namespace anki
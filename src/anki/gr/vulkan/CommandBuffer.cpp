@@ -433,4 +433,10 @@ void CommandBuffer::setLineWidth(F32 width)
 	self.setLineWidth(width);
 }
 
+void CommandBuffer::setSkippableDrawcalls(Bool skippable)
+{
+	ANKI_VK_SELF(CommandBufferImpl);
+	self.setSkippableDrawcalls(skippable);
+}
+
 } // end namespace anki
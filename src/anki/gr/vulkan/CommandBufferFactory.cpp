@@ -185,6 +185,7 @@ Error CommandBufferThreadAllocator::newCommandBuffer(
 			m_factory->m_alloc.getMemoryPool().getAllocationCallbackUserData(),
 			256_KB,
 			2.0f);
+		newCmdb->m_fastAlloc.getMemoryPool().setMemoryTag(m_factory->m_alloc.getMemoryPool().getMemoryTag());
 
 		newCmdb->m_handle = cmdb;
 		newCmdb->m_flags = cmdbFlags;
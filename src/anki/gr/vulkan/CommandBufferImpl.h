@@ -202,6 +202,11 @@ public:
 		m_state.setAlphaToCoverage(enable);
 	}
 
+	void setSkippableDrawcalls(Bool skippable)
+	{
+		m_state.setSkippableDrawcalls(skippable);
+	}
+
 	void setColorChannelWriteMask(U32 attachment, ColorBit mask)
 	{
 		commandCommon();
@@ -417,6 +422,18 @@ private:
 
 	PipelineStateTracker m_state;
 
+	/// A direct-mapped cache from the pipeline state hash to the pipeline. The drawcalls that use the same states again
+	/// don't go to the PipelineFactory.
+	class PipelineCacheEntry
+	{
+	public:
+		U64 m_hash = 0;
+		VkPipeline m_handle = VK_NULL_HANDLE;
+	};
+
+	static constexpr U32 PIPELINE_CACHE_ENTRY_COUNT = 16;
+	Array<PipelineCacheEntry, PIPELINE_CACHE_ENTRY_COUNT> m_pplineCache;
+
 	Array<DescriptorSetState, MAX_DESCRIPTOR_SETS> m_dsetState;
 
 	ShaderProgramImpl* m_computeProg ANKI_DEBUG_CODE(= nullptr);
@@ -495,7 +512,8 @@ private:
 	/// batch.
 	void flushBatches(CommandBufferCommandType type);
 
-	void drawcallCommon();
+	/// @return False if the drawcall should be skipped.
+	Bool drawcallCommon();
 
 	Bool insideRenderPass() const
 	{
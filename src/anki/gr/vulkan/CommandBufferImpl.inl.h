@@ -296,7 +296,11 @@ inline void CommandBufferImpl::drawArrays(
 	PrimitiveTopology topology, U32 count, U32 instanceCount, U32 first, U32 baseInstance)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	ANKI_CMD(vkCmdDraw(m_handle, count, instanceCount, first, baseInstance), ANY_OTHER_COMMAND);
 }
 
@@ -304,7 +308,11 @@ inline void CommandBufferImpl::drawElements(
 	PrimitiveTopology topology, U32 count, U32 instanceCount, U32 firstIndex, U32 baseVertex, U32 baseInstance)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	ANKI_CMD(vkCmdDrawIndexed(m_handle, count, instanceCount, firstIndex, baseVertex, baseInstance), ANY_OTHER_COMMAND);
 }
 
@@ -312,7 +320,11 @@ inline void CommandBufferImpl::drawArraysIndirect(
 	PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr& buff)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_DRAW));
 	ANKI_ASSERT((offset % 4) == 0);
@@ -326,7 +338,11 @@ inline void CommandBufferImpl::drawElementsIndirect(
 	PrimitiveTopology topology, U32 drawCount, PtrSize offset, BufferPtr& buff)
 {
 	m_state.setPrimitiveTopology(topology);
-	drawcallCommon();
+	if(ANKI_UNLIKELY(!drawcallCommon()))
+	{
+		return;
+	}
+
 	const BufferImpl& impl = static_cast<const BufferImpl&>(*buff);
 	ANKI_ASSERT(impl.usageValid(BufferUsageBit::INDIRECT_DRAW));
 	ANKI_ASSERT((offset % 4) == 0);
@@ -529,7 +545,7 @@ inline void CommandBufferImpl::pushSecondLevelCommandBuffer(CommandBufferPtr cmd
 	m_microCmdb->pushObjectRef(cmdb);
 }
 
-inline void CommandBufferImpl::drawcallCommon()
+inline Bool CommandBufferImpl::drawcallCommon()
 {
 	// Preconditions
 	commandCommon();
@@ -549,13 +565,29 @@ inline void CommandBufferImpl::drawcallCommon()
 
 	// Get or create ppline
 	ANKI_ASSERT(m_graphicsProg);
-	Pipeline ppline;
+	U64 pplineHash;
 	Bool stateDirty;
-	m_graphicsProg->getPipelineFactory().newPipeline(m_state, ppline, stateDirty);
+	m_state.flush(pplineHash, stateDirty);
 
 	if(stateDirty)
 	{
-		ANKI_CMD(vkCmdBindPipeline(m_handle, VK_PIPELINE_BIND_POINT_GRAPHICS, ppline.getHandle()), ANY_OTHER_COMMAND);
+		PipelineCacheEntry& entry = m_pplineCache[pplineHash & (PIPELINE_CACHE_ENTRY_COUNT - 1)];
+		if(entry.m_hash != pplineHash)
+		{
+			Pipeline ppline;
+			m_graphicsProg->getPipelineFactory().newPipeline(m_state, pplineHash, ppline);
+
+			if(ANKI_UNLIKELY(!ppline.isCreated()))
+			{
+				// The pipeline is created in the background, skip the drawcall
+				return false;
+			}
+
+			entry.m_hash = pplineHash;
+			entry.m_handle = ppline.getHandle();
+		}
+
+		ANKI_CMD(vkCmdBindPipeline(m_handle, VK_PIPELINE_BIND_POINT_GRAPHICS, entry.m_handle), ANY_OTHER_COMMAND);
 	}
 
 	// Bind dsets
@@ -647,6 +679,7 @@ inline void CommandBufferImpl::drawcallCommon()
 #endif
 
 	ANKI_TRACE_INC_COUNTER(GR_DRAWCALLS, 1);
+	return true;
 }
 
 inline void CommandBufferImpl::commandCommon()
@@ -6,8 +6,10 @@
 #include <anki/gr/vulkan/DescriptorSet.h>
 #include <anki/gr/Buffer.h>
 #include <anki/gr/vulkan/BufferImpl.h>
+#include <anki/gr/GrManager.h>
 #include <anki/util/List.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/ConcurrentPointerMap.h>
 #include <anki/util/Tracer.h>
 #include <algorithm>
 
@@ -296,6 +298,10 @@ public:
 	IntrusiveList<DS> m_list; ///< At the left of the list are the least used sets.
 	HashMap<U64, DS*> m_hashmap;
 
+	// Stats of the current frame. Only the owning thread touches them so they are not atomic
+	U32 m_setAllocationCount = 0; ///< The sets that were allocated or recycled.
+	U32 m_descriptorWriteCount = 0; ///< The descriptors that were written.
+
 	DSThreadAllocator(const DSLayoutCacheEntry* layout, ThreadId tid)
 		: m_layoutEntry(layout)
 		, m_tid(tid)
@@ -351,8 +357,8 @@ public:
 	Array<VkDescriptorPoolSize, U(DescriptorType::COUNT)> m_poolSizesCreateInf = {};
 	VkDescriptorPoolCreateInfo m_poolCreateInf = {};
 
-	DynamicArray<DSThreadAllocator*> m_threadAllocs;
-	RWMutex m_threadAllocsMtx;
+	ConcurrentPointerMap<DSThreadAllocator> m_threadAllocs; ///< One per thread ID. The lookups are lock-free.
+	Mutex m_threadAllocsMtx; ///< Serializes the creation of new thread allocators.
 
 	DSLayoutCacheEntry(DescriptorSetFactory* factory)
 		: m_factory(factory)
@@ -516,6 +522,7 @@ Error DSThreadAllocator::newSet(U64 hash,
 	ANKI_ASSERT(out);
 	out->m_lastFrameUsed = crntFrame;
 	out->m_hash = hash;
+	++m_setAllocationCount;
 
 	// Finally, write it
 	writeSet(bindings, *out, tmpAlloc);
@@ -651,6 +658,8 @@ void DSThreadAllocator::writeSet(const Array<AnyBindingExtended, MAX_BINDINGS_PE
 	}
 
 	// Write
+	ANKI_TRACE_INC_COUNTER(VK_DESCRIPTOR_SET_WRITE, writeInfos.getSize());
+	m_descriptorWriteCount += writeInfos.getSize();
 	vkUpdateDescriptorSets(m_layoutEntry->m_factory->m_dev,
 		writeInfos.getSize(),
 		(writeInfos.getSize() > 0) ? &writeInfos[0] : nullptr,
@@ -662,11 +671,7 @@ DSLayoutCacheEntry::~DSLayoutCacheEntry()
 {
 	auto alloc = m_factory->m_alloc;
 
-	for(DSThreadAllocator* a : m_threadAllocs)
-	{
-		alloc.deleteInstance(a);
-	}
-
+	m_threadAllocs.iterate([&](U64 tid, DSThreadAllocator* a) { alloc.deleteInstance(a); });
 	m_threadAllocs.destroy(alloc);
 
 	if(m_layoutHandle)
@@ -752,38 +757,17 @@ Error DSLayoutCacheEntry::init(const DescriptorBinding* bindings, U32 bindingCou
 
 Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAllocator*& alloc)
 {
-	alloc = nullptr;
+	// Fast path, lock-free
+	alloc = m_threadAllocs.find(tid);
 
-	class Comp
-	{
-	public:
-		Bool operator()(const DSThreadAllocator* a, ThreadId tid) const
-		{
-			return a->m_tid < tid;
-		}
-
-		Bool operator()(ThreadId tid, const DSThreadAllocator* a) const
-		{
-			return tid < a->m_tid;
-		}
-	};
-
-	// Find using binary search
-	{
-		RLockGuard<RWMutex> lock(m_threadAllocsMtx);
-		auto it = binarySearch(m_threadAllocs.getBegin(), m_threadAllocs.getEnd(), tid, Comp());
-		alloc = (it != m_threadAllocs.getEnd()) ? *it : nullptr;
-	}
-
-	if(alloc == nullptr)
+	if(ANKI_UNLIKELY(alloc == nullptr))
 	{
 		// Need to create one
 
-		WLockGuard<RWMutex> lock(m_threadAllocsMtx);
+		LockGuard<Mutex> lock(m_threadAllocsMtx);
 
 		// Search again
-		auto it = binarySearch(m_threadAllocs.getBegin(), m_threadAllocs.getEnd(), tid, Comp());
-		alloc = (it != m_threadAllocs.getEnd()) ? *it : nullptr;
+		alloc = m_threadAllocs.find(tid);
 
 		// Create
 		if(alloc == nullptr)
@@ -791,13 +775,7 @@ Error DSLayoutCacheEntry::getOrCreateThreadAllocator(ThreadId tid, DSThreadAlloc
 			alloc = m_factory->m_alloc.newInstance<DSThreadAllocator>(this, tid);
 			ANKI_CHECK(alloc->init());
 
-			m_threadAllocs.resize(m_factory->m_alloc, m_threadAllocs.getSize() + 1);
-			m_threadAllocs[m_threadAllocs.getSize() - 1] = alloc;
-
-			// Sort for fast find
-			std::sort(m_threadAllocs.getBegin(),
-				m_threadAllocs.getEnd(),
-				[](const DSThreadAllocator* a, const DSThreadAllocator* b) { return a->m_tid < b->m_tid; });
+			m_threadAllocs.insert(m_factory->m_alloc, tid, alloc);
 		}
 	}
 
@@ -1122,4 +1100,34 @@ void DescriptorSetFactory::unbindBindlessImage(U32 idx)
 	m_bindless->unbindImage(idx);
 }
 
+void DescriptorSetFactory::endFrame()
+{
+	U32 setAllocationCount = 0;
+	U32 descriptorWriteCount = 0;
+
+	{
+		LockGuard<SpinLock> lock(m_cachesMtx);
+
+		for(DSLayoutCacheEntry* entry : m_caches)
+		{
+			entry->m_threadAllocs.iterate([&](U64 tid, DSThreadAllocator* a) {
+				setAllocationCount += a->m_setAllocationCount;
+				descriptorWriteCount += a->m_descriptorWriteCount;
+				a->m_setAllocationCount = 0;
+				a->m_descriptorWriteCount = 0;
+			});
+		}
+	}
+
+	m_lastFrameSetAllocationCount = setAllocationCount;
+	m_lastFrameDescriptorWriteCount = descriptorWriteCount;
+	++m_frameCount;
+}
+
+void DescriptorSetFactory::getStats(GrManagerStats& stats) const
+{
+	stats.m_descriptorSetAllocationCount = m_lastFrameSetAllocationCount;
+	stats.m_descriptorWriteCount = m_lastFrameDescriptorWriteCount;
+}
+
 } // end namespace anki
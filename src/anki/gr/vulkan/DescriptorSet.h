@@ -20,6 +20,7 @@ namespace anki
 // Forward
 class DSThreadAllocator;
 class DSLayoutCacheEntry;
+class GrManagerStats;
 
 /// @addtogroup vulkan
 /// @{
@@ -407,10 +408,11 @@ public:
 		Array<PtrSize, MAX_BINDINGS_PER_DESCRIPTOR_SET>& dynamicOffsets,
 		U32& dynamicOffsetCount);
 
-	void endFrame()
-	{
-		++m_frameCount;
-	}
+	/// Gather the stats of the frame and move to the next.
+	void endFrame();
+
+	/// Get the descriptor set allocations and the descriptor writes of the last frame.
+	void getStats(GrManagerStats& stats) const;
 
 	/// Bind a sampled image.
 	/// @note It's thread-safe.
@@ -438,6 +440,10 @@ private:
 
 	BindlessDescriptorSet* m_bindless = nullptr;
 	BindlessLimits m_bindlessLimits;
+
+	// Stats. The thread allocators count the current frame
+	U32 m_lastFrameSetAllocationCount = 0;
+	U32 m_lastFrameDescriptorWriteCount = 0;
 };
 /// @}
 
@@ -72,6 +72,13 @@ public:
 		return m_colorAttCount + (hasDepthStencil() ? 1 : 0);
 	}
 
+	/// Get the format of an attachment. The depth/stencil attachment is after the color attachments.
+	VkFormat getAttachmentFormat(U32 idx) const
+	{
+		ANKI_ASSERT(idx < getAttachmentCount());
+		return m_attachmentDescriptions[idx].format;
+	}
+
 	const TextureViewPtr& getColorAttachment(U att) const
 	{
 		ANKI_ASSERT(m_refs[att].get());
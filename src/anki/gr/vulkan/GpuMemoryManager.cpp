@@ -370,4 +370,47 @@ void GpuMemoryManager::getAllocatedMemory(PtrSize& gpuMemory, PtrSize& cpuMemory
 	}
 }
 
+U32 GpuMemoryManager::getClassCount() const
+{
+	return CLASS_COUNT;
+}
+
+void GpuMemoryManager::getClassStats(U32 classIdx, ClassGpuAllocatorStats& stats) const
+{
+	stats = {};
+	stats.m_slotSize = CLASSES[classIdx].m_slotSize;
+	stats.m_chunkSize = CLASSES[classIdx].m_chunkSize;
+
+	for(U32 memTypeIdx = 0; memTypeIdx < m_callocs.getSize(); ++memTypeIdx)
+	{
+		for(U32 type = 0; type < 3; ++type)
+		{
+			if(!m_callocs[memTypeIdx][type].m_isDeviceMemory)
+			{
+				continue;
+			}
+
+			ClassGpuAllocatorStats s;
+			m_callocs[memTypeIdx][type].getStats(classIdx, s);
+			stats.m_chunkCount += s.m_chunkCount;
+			stats.m_usedSlotCount += s.m_usedSlotCount;
+			stats.m_slotCount += s.m_slotCount;
+			stats.m_sparseChunkCount += s.m_sparseChunkCount;
+		}
+	}
+}
+
+PtrSize GpuMemoryManager::getUnusedGpuMemory() const
+{
+	PtrSize unused = 0;
+	for(U32 classIdx = 0; classIdx < CLASS_COUNT; ++classIdx)
+	{
+		ClassGpuAllocatorStats stats;
+		getClassStats(classIdx, stats);
+		unused += stats.getUnusedMemory();
+	}
+
+	return unused;
+}
+
 } // end namespace anki
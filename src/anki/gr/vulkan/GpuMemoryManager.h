@@ -68,6 +68,14 @@ public:
 	/// Get some statistics.
 	void getAllocatedMemory(PtrSize& gpuMemory, PtrSize& cpuMemory) const;
 
+	U32 getClassCount() const;
+
+	/// Get the statistics of a class of all the device memory allocators.
+	void getClassStats(U32 classIdx, ClassGpuAllocatorStats& stats) const;
+
+	/// Get the device memory of the allocated chunks that is not used by any allocation.
+	PtrSize getUnusedGpuMemory() const;
+
 private:
 	class Memory;
 	class Interface;
@@ -35,6 +35,7 @@ GrManager::~GrManager()
 Error GrManager::newInstance(GrManagerInitInfo& init, GrManager*& gr)
 {
 	auto alloc = HeapAllocator<U8>(init.m_allocCallback, init.m_allocCallbackUserData);
+	alloc.getMemoryPool().setMemoryTag(MemoryTag::GR);
 
 	GrManagerImpl* impl = alloc.newInstance<GrManagerImpl>();
 
@@ -92,7 +93,10 @@ GrManagerStats GrManager::getStats() const
 	GrManagerStats out;
 
 	self.getGpuMemoryManager().getAllocatedMemory(out.m_gpuMemory, out.m_cpuMemory);
+	out.m_unusedGpuMemory = self.getGpuMemoryManager().getUnusedGpuMemory();
 	out.m_commandBufferCount = self.getCommandBufferFactory().getCreatedCommandBufferCount();
+	self.getPipelineCreationQueue().getStats(out);
+	self.getDescriptorSetFactory().getStats(out);
 
 	return out;
 }
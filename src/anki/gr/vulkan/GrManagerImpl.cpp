@@ -48,6 +48,7 @@ GrManagerImpl::~GrManagerImpl()
 	m_pplineLayoutFactory.destroy();
 	m_descrFactory.destroy();
 
+	m_pplineCreationQueue.destroy();
 	m_pplineCache.destroy(m_device, m_physicalDevice, getAllocator());
 
 	m_fences.destroy();
@@ -107,11 +108,12 @@ Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
 	ANKI_CHECK(initDevice(init));
 	vkGetDeviceQueue(m_device, m_queueIdx, 0, &m_queue);
 
-	m_swapchainFactory.init(this, init.m_config->getBool("gr_vsync"));
+	m_swapchainFactory.init(this, init.m_config->getBool(ConfigOption::gr_vsync));
 
 	m_crntSwapchain = m_swapchainFactory.newInstance();
 
 	ANKI_CHECK(m_pplineCache.init(m_device, m_physicalDevice, init.m_cacheDirectory, *init.m_config, getAllocator()));
+	ANKI_CHECK(m_pplineCreationQueue.init(getAllocator(), m_device, init.m_cacheDirectory, *init.m_config));
 
 	ANKI_CHECK(initMemory(*init.m_config));
 
@@ -202,8 +204,8 @@ Error GrManagerImpl::initInternal(const GrManagerInitInfo& init)
 		}
 	}
 
-	m_bindlessLimits.m_bindlessTextureCount = init.m_config->getNumberU32("gr_maxBindlessTextures");
-	m_bindlessLimits.m_bindlessImageCount = init.m_config->getNumberU32("gr_maxBindlessImages");
+	m_bindlessLimits.m_bindlessTextureCount = init.m_config->getNumberU32(ConfigOption::gr_maxBindlessTextures);
+	m_bindlessLimits.m_bindlessImageCount = init.m_config->getNumberU32(ConfigOption::gr_maxBindlessImages);
 	ANKI_CHECK(m_descrFactory.init(getAllocator(), m_device, m_bindlessLimits));
 	m_pplineLayoutFactory.init(getAllocator(), m_device);
 
@@ -218,8 +220,8 @@ Error GrManagerImpl::initInstance(const GrManagerInitInfo& init)
 
 	// Create the instance
 	//
-	const U8 vulkanMinor = init.m_config->getNumberU8("gr_vkminor");
-	const U8 vulkanMajor = init.m_config->getNumberU8("gr_vkmajor");
+	const U8 vulkanMinor = init.m_config->getNumberU8(ConfigOption::gr_vkminor);
+	const U8 vulkanMajor = init.m_config->getNumberU8(ConfigOption::gr_vkmajor);
 
 	VkApplicationInfo app = {};
 	app.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
@@ -236,7 +238,7 @@ Error GrManagerImpl::initInstance(const GrManagerInitInfo& init)
 	// Layers
 	static Array<const char*, 1> LAYERS = {{"VK_LAYER_KHRONOS_validation"}};
 	Array<const char*, LAYERS.getSize()> layersToEnable; // Keep it alive in the stack
-	if(init.m_config->getBool("gr_debugContext"))
+	if(init.m_config->getBool(ConfigOption::gr_debugContext))
 	{
 		uint32_t count;
 		vkEnumerateInstanceLayerProperties(&count, nullptr);
@@ -418,7 +420,7 @@ Error GrManagerImpl::initInstance(const GrManagerInitInfo& init)
 
 	vkGetPhysicalDeviceFeatures(m_physicalDevice, &m_devFeatures);
 	m_devFeatures.robustBufferAccess =
-		(init.m_config->getBool("gr_debugContext") && m_devFeatures.robustBufferAccess) ? true : false;
+		(init.m_config->getBool(ConfigOption::gr_debugContext) && m_devFeatures.robustBufferAccess) ? true : false;
 	ANKI_VK_LOGI("Robust buffer access is %s", (m_devFeatures.robustBufferAccess) ? "enabled" : "disabled");
 
 	// Set limits
@@ -514,13 +516,13 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 				extensionsToEnable[extensionsToEnableCount++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
 			}
 			else if(CString(extensionInfos[extCount].extensionName) == VK_EXT_DEBUG_MARKER_EXTENSION_NAME
-					&& init.m_config->getBool("gr_debugMarkers"))
+					&& init.m_config->getBool(ConfigOption::gr_debugMarkers))
 			{
 				m_extensions |= VulkanExtensions::EXT_DEBUG_MARKER;
 				extensionsToEnable[extensionsToEnableCount++] = VK_EXT_DEBUG_MARKER_EXTENSION_NAME;
 			}
 			else if(CString(extensionInfos[extCount].extensionName) == VK_AMD_SHADER_INFO_EXTENSION_NAME
-					&& init.m_config->getBool("core_displayStats"))
+					&& init.m_config->getBool(ConfigOption::core_displayStats))
 			{
 				m_extensions |= VulkanExtensions::AMD_SHADER_INFO;
 				extensionsToEnable[extensionsToEnableCount++] = VK_AMD_SHADER_INFO_EXTENSION_NAME;
@@ -531,7 +533,7 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 				extensionsToEnable[extensionsToEnableCount++] = VK_AMD_RASTERIZATION_ORDER_EXTENSION_NAME;
 			}
 			else if(CString(extensionInfos[extCount].extensionName) == VK_KHR_RAY_TRACING_EXTENSION_NAME
-					&& init.m_config->getBool("gr_rayTracing"))
+					&& init.m_config->getBool(ConfigOption::gr_rayTracing))
 			{
 				m_extensions |= VulkanExtensions::KHR_RAY_TRACING;
 				extensionsToEnable[extensionsToEnableCount++] = VK_KHR_RAY_TRACING_EXTENSION_NAME;
@@ -590,7 +592,7 @@ Error GrManagerImpl::initDevice(const GrManagerInitInfo& init)
 
 			m_bufferDeviceAddressFeatures.bufferDeviceAddressCaptureReplay =
 				m_bufferDeviceAddressFeatures.bufferDeviceAddressCaptureReplay
-				&& init.m_config->getBool("gr_debugMarkers");
+				&& init.m_config->getBool(ConfigOption::gr_debugMarkers);
 			m_bufferDeviceAddressFeatures.bufferDeviceAddressMultiDevice = false;
 
 			m_descriptorIndexingFeatures.pNext = &m_bufferDeviceAddressFeatures;
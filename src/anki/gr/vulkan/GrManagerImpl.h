@@ -18,6 +18,7 @@
 #include <anki/gr/vulkan/SwapchainFactory.h>
 #include <anki/gr/vulkan/PipelineLayout.h>
 #include <anki/gr/vulkan/PipelineCache.h>
+#include <anki/gr/vulkan/PipelineCreationQueue.h>
 #include <anki/gr/vulkan/DescriptorSet.h>
 #include <anki/util/HashMap.h>
 #include <anki/util/File.h>
@@ -160,6 +161,16 @@ public:
 		return m_pplineLayoutFactory;
 	}
 
+	PipelineCreationQueue& getPipelineCreationQueue()
+	{
+		return m_pplineCreationQueue;
+	}
+
+	const PipelineCreationQueue& getPipelineCreationQueue() const
+	{
+		return m_pplineCreationQueue;
+	}
+
 	VulkanExtensions getExtensions() const
 	{
 		return m_extensions;
@@ -304,6 +315,7 @@ private:
 	QueryFactory m_timestampQueryFactory;
 
 	PipelineCache m_pplineCache;
+	PipelineCreationQueue m_pplineCreationQueue;
 
 	Bool m_r8g8b8ImagesSupported = false;
 	Bool m_s8ImagesSupported = false;
@@ -4,9 +4,11 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/gr/vulkan/Pipeline.h>
+#include <anki/gr/vulkan/PipelineCreationQueue.h>
 #include <anki/gr/vulkan/GrManagerImpl.h>
 #include <anki/gr/utils/Functions.h>
 #include <anki/util/Tracer.h>
+#include <anki/util/HighRezTimer.h>
 
 namespace anki
 {
@@ -25,6 +27,7 @@ void PipelineStateTracker::reset()
 	m_fbColorAttachmentMask.unsetAll();
 	m_rpass = VK_NULL_HANDLE;
 	m_fb.reset(nullptr);
+	m_progImpl = nullptr;
 }
 
 Bool PipelineStateTracker::updateHashes()
@@ -36,44 +39,50 @@ Bool PipelineStateTracker::updateHashes()
 	{
 		m_dirty.m_other &= ~DirtyBit::PROG;
 		stateDirty = true;
-		m_hashes.m_prog = m_state.m_prog->getUuid();
+		m_hashes.m_prog = m_progImpl->getUuid();
 	}
 
 	// Vertex
 	if(m_dirty.m_attribs.getAny() || m_dirty.m_vertBindings.getAny())
 	{
+		// Many attributes may use the same binding so clear the dirty bits of the bindings after all are hashed
+		BitSet<MAX_VERTEX_ATTRIBUTES, U8> flushedBindings = {false};
+
 		for(U i = 0; i < MAX_VERTEX_ATTRIBUTES; ++i)
 		{
 			if(m_shaderAttributeMask.get(i))
 			{
 				ANKI_ASSERT(m_set.m_attribs.get(i) && "Forgot to set the attribute");
 
-				Bool dirty = false;
-				if(m_dirty.m_attribs.get(i))
-				{
-					m_dirty.m_attribs.unset(i);
-					dirty = true;
-				}
-
 				const U binding = m_state.m_vertex.m_attributes[i].m_binding;
-				if(m_dirty.m_vertBindings.get(binding))
-				{
-					m_dirty.m_vertBindings.unset(binding);
-					dirty = true;
-				}
+				flushedBindings.set(binding);
 
-				if(dirty)
+				if(m_dirty.m_attribs.get(i) || m_dirty.m_vertBindings.get(binding))
 				{
+					m_dirty.m_attribs.unset(i);
+
 					m_hashes.m_vertexAttribs[i] =
 						computeHash(&m_state.m_vertex.m_attributes[i], sizeof(m_state.m_vertex.m_attributes[i]));
-					m_hashes.m_vertexAttribs[i] = appendHash(&m_state.m_vertex.m_bindings[i],
-						sizeof(m_state.m_vertex.m_bindings[i]),
+					m_hashes.m_vertexAttribs[i] = appendHash(&m_state.m_vertex.m_bindings[binding],
+						sizeof(m_state.m_vertex.m_bindings[binding]),
 						m_hashes.m_vertexAttribs[i]);
 
 					stateDirty = true;
 				}
 			}
 		}
+
+		// The attributes that are not used by this program will rehash when they are used
+		for(U i = 0; i < MAX_VERTEX_ATTRIBUTES; ++i)
+		{
+			const U binding = m_state.m_vertex.m_attributes[i].m_binding;
+			if(!m_shaderAttributeMask.get(i) && flushedBindings.get(binding) && m_dirty.m_vertBindings.get(binding))
+			{
+				m_dirty.m_attribs.set(i);
+			}
+		}
+
+		m_dirty.m_vertBindings &= ~flushedBindings;
 	}
 
 	// IA
@@ -139,13 +148,17 @@ Bool PipelineStateTracker::updateHashes()
 	return stateDirty;
 }
 
-void PipelineStateTracker::updateSuperHash()
+/// Combine a hash with another one. The sub-state hashes are good hashes already so there is no need to run the full
+/// computeHash() on them, a cheap mix is enough.
+static ANKI_FORCE_INLINE U64 mixHash(U64 seed, U64 hash)
 {
-	Array<U64, sizeof(Hashes) / sizeof(U64)> buff;
-	U count = 0;
+	return seed ^ (hash + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
 
+void PipelineStateTracker::updateSuperHash()
+{
 	// Prog
-	buff[count++] = m_hashes.m_prog;
+	U64 hash = m_hashes.m_prog;
 
 	// Vertex
 	if(!!m_shaderAttributeMask)
@@ -154,45 +167,45 @@ void PipelineStateTracker::updateSuperHash()
 		{
 			if(m_shaderAttributeMask.get(i))
 			{
-				buff[count++] = m_hashes.m_vertexAttribs[i];
+				hash = mixHash(hash, m_hashes.m_vertexAttribs[i]);
 			}
 		}
 	}
 
 	// IA
-	buff[count++] = m_hashes.m_ia;
+	hash = mixHash(hash, m_hashes.m_ia);
 
 	// Rasterizer
-	buff[count++] = m_hashes.m_raster;
+	hash = mixHash(hash, m_hashes.m_raster);
 
 	// Depth
 	if(m_fbDepth)
 	{
-		buff[count++] = m_hashes.m_depth;
+		hash = mixHash(hash, m_hashes.m_depth);
 	}
 
 	// Stencil
 	if(m_fbStencil)
 	{
-		buff[count++] = m_hashes.m_stencil;
+		hash = mixHash(hash, m_hashes.m_stencil);
 	}
 
 	// Color
 	if(!!m_shaderColorAttachmentWritemask)
 	{
-		buff[count++] = m_hashes.m_color;
+		hash = mixHash(hash, m_hashes.m_color);
 
 		for(U i = 0; i < MAX_COLOR_ATTACHMENTS; ++i)
 		{
 			if(m_shaderColorAttachmentWritemask.get(i))
 			{
-				buff[count++] = m_hashes.m_colAttachments[i];
+				hash = mixHash(hash, m_hashes.m_colAttachments[i]);
 			}
 		}
 	}
 
-	// Super hash
-	m_hashes.m_superHash = computeHash(&buff[0], count * sizeof(buff[0]));
+	// Super hash. Zero means no hash
+	m_hashes.m_superHash = (hash != 0) ? hash : 1;
 }
 
 const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateInfo()
@@ -203,7 +216,7 @@ const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateIn
 	ci.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 
 	// Prog
-	ci.pStages = static_cast<const ShaderProgramImpl&>(*m_state.m_prog).getShaderCreateInfos(ci.stageCount);
+	ci.pStages = m_progImpl->getShaderCreateInfos(ci.stageCount);
 
 	// Vert
 	VkPipelineVertexInputStateCreateInfo& vertCi = m_ci.m_vert;
@@ -383,85 +396,320 @@ const VkGraphicsPipelineCreateInfo& PipelineStateTracker::updatePipelineCreateIn
 	ci.pDynamicState = &dynCi;
 
 	// The rest
-	ci.layout = static_cast<const ShaderProgramImpl&>(*m_state.m_prog).getPipelineLayout().getHandle();
+	ci.layout = m_progImpl->getPipelineLayout().getHandle();
 	ci.renderPass = m_rpass;
 	ci.subpass = 0;
 
 	return ci;
 }
 
+void PipelineStateTracker::getStateDescription(PipelineStateDescription& desc) const
+{
+	ANKI_ASSERT(m_progImpl && m_fb.isCreated());
+
+	// Copy only the state that affects the pipeline. The rest stays zero so equal pipelines have equal descriptions
+	desc = PipelineStateDescription();
+	desc.m_programHash = m_progImpl->getPersistentHash();
+
+	for(U32 i = 0; i < MAX_VERTEX_ATTRIBUTES; ++i)
+	{
+		if(m_shaderAttributeMask.get(i))
+		{
+			const U32 binding = m_state.m_vertex.m_attributes[i].m_binding;
+			memcpy(&desc.m_vertex.m_attributes[i],
+				&m_state.m_vertex.m_attributes[i],
+				sizeof(desc.m_vertex.m_attributes[i]));
+			memcpy(&desc.m_vertex.m_bindings[binding],
+				&m_state.m_vertex.m_bindings[binding],
+				sizeof(desc.m_vertex.m_bindings[binding]));
+		}
+	}
+
+	memcpy(&desc.m_inputAssembler, &m_state.m_inputAssembler, sizeof(desc.m_inputAssembler));
+	memcpy(&desc.m_rasterizer, &m_state.m_rasterizer, sizeof(desc.m_rasterizer));
+
+	if(m_fbDepth)
+	{
+		memcpy(&desc.m_depth, &m_state.m_depth, sizeof(desc.m_depth));
+	}
+
+	if(m_fbStencil)
+	{
+		memcpy(&desc.m_stencil, &m_state.m_stencil, sizeof(desc.m_stencil));
+	}
+
+	if(!!m_fbColorAttachmentMask)
+	{
+		desc.m_color.m_alphaToCoverageEnabled = m_state.m_color.m_alphaToCoverageEnabled;
+		for(U32 i = 0; i < MAX_COLOR_ATTACHMENTS; ++i)
+		{
+			if(m_fbColorAttachmentMask.get(i))
+			{
+				memcpy(&desc.m_color.m_attachments[i],
+					&m_state.m_color.m_attachments[i],
+					sizeof(desc.m_color.m_attachments[i]));
+			}
+		}
+	}
+
+	// Render pass
+	const FramebufferImpl& fbImpl = static_cast<const FramebufferImpl&>(*m_fb);
+	for(U32 i = 0; i < fbImpl.getAttachmentCount(); ++i)
+	{
+		desc.m_attachmentFormats[i] = fbImpl.getAttachmentFormat(i);
+	}
+
+	desc.m_colorAttachmentMask = m_fbColorAttachmentMask;
+	desc.m_hasDepthAttachment = m_fbDepth;
+	desc.m_hasStencilAttachment = m_fbStencil;
+}
+
+void PipelineStateTracker::setStateDescription(
+	const PipelineStateDescription& desc, const ShaderProgramImpl& prog, VkRenderPass rpass)
+{
+	ANKI_ASSERT(rpass);
+	reset();
+
+	memcpy(&m_state.m_vertex, &desc.m_vertex, sizeof(m_state.m_vertex));
+	memcpy(&m_state.m_inputAssembler, &desc.m_inputAssembler, sizeof(m_state.m_inputAssembler));
+	memcpy(&m_state.m_tessellation, &desc.m_tessellation, sizeof(m_state.m_tessellation));
+	memcpy(&m_state.m_viewport, &desc.m_viewport, sizeof(m_state.m_viewport));
+	memcpy(&m_state.m_rasterizer, &desc.m_rasterizer, sizeof(m_state.m_rasterizer));
+	memcpy(&m_state.m_depth, &desc.m_depth, sizeof(m_state.m_depth));
+	memcpy(&m_state.m_stencil, &desc.m_stencil, sizeof(m_state.m_stencil));
+	memcpy(&m_state.m_color, &desc.m_color, sizeof(m_state.m_color));
+
+	// Program
+	m_progImpl = &prog;
+	m_shaderColorAttachmentWritemask = prog.getReflectionInfo().m_colorAttachmentWritemask;
+	m_shaderAttributeMask = prog.getReflectionInfo().m_attributeMask;
+	m_set.m_attribs = m_shaderAttributeMask;
+	m_set.m_vertBindings = m_shaderAttributeMask;
+
+	// Render pass
+	m_rpass = rpass;
+	m_fbDepth = desc.m_hasDepthAttachment;
+	m_fbStencil = desc.m_hasStencilAttachment;
+	m_fbColorAttachmentMask = desc.m_colorAttachmentMask;
+	m_defaultFb = false;
+}
+
 class PipelineFactory::PipelineInternal
 {
 public:
-	VkPipeline m_handle = VK_NULL_HANDLE;
+	/// It's null while the pipeline is created in the background. It's set once.
+	Atomic<VkPipeline> m_handle = {VK_NULL_HANDLE};
 
 	/// The pipeline needs a render pass and the framebuffers are the owners of that. So the internal pipeline will
 	/// hold a ref to the FB in order to hold a ref to the render pass.
 	FramebufferPtr m_fb;
 };
 
-class PipelineFactory::Hasher
-{
-public:
-	U64 operator()(U64 h)
-	{
-		return h;
-	}
-};
-
 void PipelineFactory::destroy()
 {
-	for(auto it : m_pplines)
+	// Wait for the pipelines that are created in the background
+	if(m_queue)
 	{
-		if(it.m_handle)
+		m_queue->cancelTasks(*this);
+		while(m_pendingCreationCount.load() != 0)
 		{
-			vkDestroyPipeline(m_dev, it.m_handle, nullptr);
-			it.m_fb.reset(nullptr);
+			HighRezTimer::sleep(Second(1.0_ms));
 		}
 	}
 
+	m_pplines.iterate([&](U64 hash, PipelineInternal* pp) {
+		if(pp->m_handle.getNonAtomically())
+		{
+			vkDestroyPipeline(m_dev, pp->m_handle.getNonAtomically(), nullptr);
+		}
+
+		m_alloc.deleteInstance(pp);
+	});
+
 	m_pplines.destroy(m_alloc);
 }
 
-void PipelineFactory::newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty)
+void PipelineFactory::newPipeline(PipelineStateTracker& state, U64 hash, Pipeline& ppline)
 {
-	U64 hash;
-	state.flush(hash, stateDirty);
+	ANKI_ASSERT(hash);
+
+	// Fast path, lock-free
+	const PipelineInternal* pp = m_pplines.find(hash);
+	if(ANKI_LIKELY(pp))
+	{
+		ppline.m_handle = pp->m_handle.load(AtomicMemoryOrder::ACQUIRE);
+		if(ANKI_LIKELY(ppline.m_handle))
+		{
+			return;
+		}
+	}
+
+	// Only the drawcalls that can be skipped wait for the background creation. The default framebuffer flips the
+	// viewport so its pipelines can't be created from a description
+	const Bool async = m_queue->getAsyncCreation() && state.m_skippableDrawcalls && !state.m_defaultFb;
+	Bool inProgress = false;
+	{
+		LockGuard<SpinLock> lock(m_pplinesMtx);
+
+		pp = m_pplines.find(hash);
+		if(pp)
+		{
+			ppline.m_handle = pp->m_handle.load(AtomicMemoryOrder::ACQUIRE);
+			if(ppline.m_handle)
+			{
+				return;
+			}
+
+			inProgress = true;
+		}
+		else if(async)
+		{
+			// Add an empty pipeline to avoid creating it twice
+			m_pplines.insert(m_alloc, hash, m_alloc.newInstance<PipelineInternal>());
+		}
+	}
 
-	if(ANKI_UNLIKELY(!stateDirty))
+	if(async)
 	{
+		if(!inProgress)
+		{
+			PipelineCreationTask* task = m_queue->getAllocator().newInstance<PipelineCreationTask>();
+			task->m_factory = this;
+			task->m_prog = state.m_progImpl;
+			state.getStateDescription(task->m_desc);
+			task->m_rpass = state.m_rpass;
+			task->m_fb = state.getFb();
+			task->m_hash = hash;
+			m_queue->submitTask(task);
+
+			m_queue->recordPipelineState(task->m_desc);
+		}
+
+		// The pipeline is not ready. Skip the drawcalls and check again on the next one
 		ppline.m_handle = VK_NULL_HANDLE;
+		state.m_hashes.m_lastSuperHash = 0;
 		return;
 	}
 
-	LockGuard<SpinLock> lock(m_pplinesMtx);
+	// Create it now. If it's created in the background (pre-warm) the background one will be thrown away
+	const Second begin = HighRezTimer::getCurrentTime();
+	VkPipeline handle = createPipeline(state, hash);
+	m_queue->pipelineCreated(HighRezTimer::getCurrentTime() - begin, true, false);
+
+	ppline.m_handle = storePipeline(hash, handle, state.getFb());
 
-	auto it = m_pplines.find(hash);
-	if(it != m_pplines.getEnd())
+	if(!state.m_defaultFb)
 	{
-		ppline.m_handle = (*it).m_handle;
+		PipelineStateDescription desc;
+		state.getStateDescription(desc);
+		m_queue->recordPipelineState(desc);
 	}
-	else
+}
+
+void PipelineFactory::prewarm(const ShaderProgramImpl& prog, ConstWeakArray<PipelineStateDescription> descriptions)
+{
+	PipelineStateTracker state;
+
+	for(const PipelineStateDescription& desc : descriptions)
 	{
-		PipelineInternal pp;
-		const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
-		pp.m_fb = state.getFb();
+		const VkRenderPass rpass = m_queue->getCompatibleRenderPass(desc);
+		state.setStateDescription(desc, prog, rpass);
+
+		U64 hash;
+		Bool stateDirty;
+		state.flush(hash, stateDirty);
 
 		{
-			ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
-			ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &pp.m_handle));
+			LockGuard<SpinLock> lock(m_pplinesMtx);
+			if(m_pplines.find(hash))
+			{
+				continue;
+			}
+
+			m_pplines.insert(m_alloc, hash, m_alloc.newInstance<PipelineInternal>());
 		}
 
-		ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+		PipelineCreationTask* task = m_queue->getAllocator().newInstance<PipelineCreationTask>();
+		task->m_factory = this;
+		task->m_prog = &prog;
+		task->m_desc = desc;
+		task->m_rpass = rpass;
+		task->m_hash = hash;
+		task->m_prewarm = true;
+		m_queue->submitTask(task);
+	}
+}
 
-		m_pplines.emplace(m_alloc, hash, pp);
-		ppline.m_handle = pp.m_handle;
+VkPipeline PipelineFactory::createPipeline(PipelineStateTracker& state, U64 hash)
+{
+	const VkGraphicsPipelineCreateInfo& ci = state.updatePipelineCreateInfo();
 
-		// Print shader info
-		const ShaderProgramImpl& shaderImpl = static_cast<const ShaderProgramImpl&>(*state.m_state.m_prog);
-		shaderImpl.getGrManagerImpl().printPipelineShaderInfo(
-			pp.m_handle, shaderImpl.getName(), shaderImpl.getStages(), hash);
+	VkPipeline handle;
+	{
+		ANKI_TRACE_SCOPED_EVENT(VK_PIPELINE_CREATE);
+		ANKI_VK_CHECKF(vkCreateGraphicsPipelines(m_dev, m_pplineCache, 1, &ci, nullptr, &handle));
 	}
+
+	ANKI_TRACE_INC_COUNTER(VK_PIPELINE_CREATE, 1);
+
+	// Print shader info
+	const ShaderProgramImpl& shaderImpl = *state.m_progImpl;
+	shaderImpl.getGrManagerImpl().printPipelineShaderInfo(handle, shaderImpl.getName(), shaderImpl.getStages(), hash);
+
+	return handle;
+}
+
+VkPipeline PipelineFactory::storePipeline(U64 hash, VkPipeline handle, FramebufferPtr fb)
+{
+	VkPipeline oldHandle = VK_NULL_HANDLE;
+	{
+		LockGuard<SpinLock> lock(m_pplinesMtx);
+
+		PipelineInternal* pp = m_pplines.find(hash);
+		if(pp == nullptr)
+		{
+			pp = m_alloc.newInstance<PipelineInternal>();
+			pp->m_handle.setNonAtomically(handle);
+			pp->m_fb = fb;
+			m_pplines.insert(m_alloc, hash, pp);
+		}
+		else if(pp->m_handle.load() == VK_NULL_HANDLE)
+		{
+			// Set the FB before publishing the handle
+			pp->m_fb = fb;
+			pp->m_handle.store(handle, AtomicMemoryOrder::RELEASE);
+		}
+		else
+		{
+			// Someone created it first, keep that one
+			oldHandle = handle;
+			handle = pp->m_handle.load();
+		}
+	}
+
+	if(oldHandle)
+	{
+		vkDestroyPipeline(m_dev, oldHandle, nullptr);
+	}
+
+	return handle;
+}
+
+void PipelineFactory::runCreationTask(PipelineCreationTask& task)
+{
+	PipelineStateTracker state;
+	state.setStateDescription(task.m_desc, *task.m_prog, task.m_rpass);
+
+	U64 hash;
+	Bool stateDirty;
+	state.flush(hash, stateDirty);
+	ANKI_ASSERT(hash == task.m_hash);
+
+	const Second begin = HighRezTimer::getCurrentTime();
+	const VkPipeline handle = createPipeline(state, hash);
+	m_queue->pipelineCreated(HighRezTimer::getCurrentTime() - begin, false, task.m_prewarm);
+
+	storePipeline(hash, handle, task.m_fb);
 }
 
 } // end namespace anki
@@ -11,10 +11,16 @@
 #include <anki/gr/Framebuffer.h>
 #include <anki/gr/vulkan/FramebufferImpl.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/Atomic.h>
+#include <anki/util/ConcurrentPointerMap.h>
 
 namespace anki
 {
 
+// Forward
+class PipelineCreationQueue;
+class PipelineCreationTask;
+
 /// @addtogroup vulkan
 /// @{
 
@@ -173,6 +179,52 @@ public:
 	}
 };
 
+/// The static state of a graphics pipeline. It doesn't reference any objects so it can be stored to disk and used to
+/// create the same pipeline in the next runs.
+class PipelineStateDescription
+{
+public:
+	U64 m_programHash; ///< See ShaderProgramImpl::getPersistentHash().
+
+	PPVertexStateInfo m_vertex;
+	PPInputAssemblerStateInfo m_inputAssembler;
+	PPTessellationStateInfo m_tessellation;
+	PPViewportStateInfo m_viewport;
+	PPRasterizerStateInfo m_rasterizer;
+	PPDepthStateInfo m_depth;
+	PPStencilStateInfo m_stencil;
+	PPColorStateInfo m_color;
+
+	/// The formats of the render pass. The depth/stencil format is after the color formats.
+	Array<VkFormat, MAX_COLOR_ATTACHMENTS + 1> m_attachmentFormats;
+	BitSet<MAX_COLOR_ATTACHMENTS, U8> m_colorAttachmentMask;
+	Bool m_hasDepthAttachment;
+	Bool m_hasStencilAttachment;
+
+	PipelineStateDescription()
+	{
+		// Zero the padding because the description will be hashed and stored
+		zeroMemory(*this);
+	}
+
+	PipelineStateDescription(const PipelineStateDescription& b)
+	{
+		*this = b;
+	}
+
+	/// Copy the padding as well.
+	PipelineStateDescription& operator=(const PipelineStateDescription& b)
+	{
+		memcpy(static_cast<void*>(this), &b, sizeof(*this));
+		return *this;
+	}
+
+	U64 computeHash() const
+	{
+		return anki::computeHash(this, sizeof(*this));
+	}
+};
+
 /// Track changes in the static state.
 class PipelineStateTracker : public NonCopyable
 {
@@ -330,6 +382,12 @@ public:
 		}
 	}
 
+	/// If true the drawcalls can be skipped while their pipelines are created in the background.
+	void setSkippableDrawcalls(Bool skippable)
+	{
+		m_skippableDrawcalls = skippable;
+	}
+
 	void setColorChannelWriteMask(U32 attachment, ColorBit mask)
 	{
 		if(m_state.m_color.m_attachments[attachment].m_channelWriteMask != mask)
@@ -372,6 +430,7 @@ public:
 			m_shaderColorAttachmentWritemask = impl.getReflectionInfo().m_colorAttachmentWritemask;
 			m_shaderAttributeMask = impl.getReflectionInfo().m_attributeMask;
 			m_state.m_prog = prog;
+			m_progImpl = &impl;
 			m_dirty.m_other |= DirtyBit::PROG;
 		}
 	}
@@ -446,6 +505,7 @@ public:
 
 private:
 	PipelineInfoState m_state;
+	const ShaderProgramImpl* m_progImpl = nullptr; ///< Same as m_state.m_prog. It may be set without m_state.m_prog.
 
 	enum class DirtyBit : U8
 	{
@@ -491,6 +551,8 @@ private:
 	Bool m_defaultFb = false;
 	BitSet<MAX_COLOR_ATTACHMENTS, U8> m_fbColorAttachmentMask = {false};
 
+	Bool m_skippableDrawcalls = false;
+
 	class Hashes
 	{
 	public:
@@ -534,6 +596,12 @@ private:
 
 	Bool updateHashes();
 	void updateSuperHash();
+
+	/// Get the current state in a form that can be stored.
+	void getStateDescription(PipelineStateDescription& desc) const;
+
+	/// Set the state from a description. It doesn't hold a reference to the program.
+	void setStateDescription(const PipelineStateDescription& desc, const ShaderProgramImpl& prog, VkRenderPass rpass);
 };
 
 /// Small wrapper on top of the pipeline.
@@ -548,6 +616,12 @@ public:
 		return m_handle;
 	}
 
+	/// If it's false the pipeline is created in the background.
+	Bool isCreated() const
+	{
+		return m_handle != VK_NULL_HANDLE;
+	}
+
 private:
 	VkPipeline m_handle ANKI_DEBUG_CODE(= 0);
 };
@@ -555,6 +629,8 @@ private:
 /// Given some state it creates/hashes pipelines.
 class PipelineFactory
 {
+	friend class PipelineCreationQueue;
+
 public:
 	PipelineFactory()
 	{
@@ -564,28 +640,47 @@ public:
 	{
 	}
 
-	void init(GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache)
+	void init(GrAllocator<U8> alloc, VkDevice dev, VkPipelineCache pplineCache, PipelineCreationQueue* queue)
 	{
 		m_alloc = alloc;
 		m_dev = dev;
 		m_pplineCache = pplineCache;
+		m_queue = queue;
 	}
 
+	/// It waits for the pipelines that are created in the background.
 	void destroy();
 
+	/// Get the pipeline of a state that was flushed with PipelineStateTracker::flush(). If the pipeline doesn't exist
+	/// it will be created. In the async mode it will be created in the background and the pipeline will not be created
+	/// until then.
 	/// @note Thread-safe.
-	void newPipeline(PipelineStateTracker& state, Pipeline& ppline, Bool& stateDirty);
+	void newPipeline(PipelineStateTracker& state, U64 hash, Pipeline& ppline);
+
+	/// Create pipelines in the background.
+	/// @note Thread-safe.
+	void prewarm(const ShaderProgramImpl& prog, ConstWeakArray<PipelineStateDescription> descriptions);
 
 private:
 	class PipelineInternal;
-	class Hasher;
 
 	GrAllocator<U8> m_alloc;
 	VkDevice m_dev = VK_NULL_HANDLE;
 	VkPipelineCache m_pplineCache = VK_NULL_HANDLE;
+	PipelineCreationQueue* m_queue = nullptr;
+
+	ConcurrentPointerMap<PipelineInternal> m_pplines; ///< The lookups are lock-free.
+	SpinLock m_pplinesMtx; ///< Serializes the misses.
+
+	Atomic<U32> m_pendingCreationCount = {0};
+
+	VkPipeline createPipeline(PipelineStateTracker& state, U64 hash);
+
+	/// Put the pipeline to the map. If it exists already the new one will be destroyed.
+	VkPipeline storePipeline(U64 hash, VkPipeline handle, FramebufferPtr fb);
 
-	HashMap<U64, PipelineInternal, Hasher> m_pplines;
-	SpinLock m_pplinesMtx;
+	/// Called by the PipelineCreationQueue's threads.
+	void runCreationTask(PipelineCreationTask& task);
 };
 /// @}
 
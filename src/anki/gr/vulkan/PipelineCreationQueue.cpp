@@ -0,0 +1,389 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/vulkan/PipelineCreationQueue.h>
+#include <anki/gr/GrManager.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
+#include <algorithm>
+
+namespace anki
+{
+
+static const char* PIPELINE_RECORD_MAGIC = "ANKIPPS1";
+
+class PipelineRecordHeader
+{
+public:
+	Array<U8, 8> m_magic;
+	U32 m_descriptionSize;
+	U32 m_descriptionCount;
+};
+
+PipelineCreationQueue::~PipelineCreationQueue()
+{
+	ANKI_ASSERT(m_threads.getSize() == 0 && "Forgot to call destroy()");
+}
+
+Error PipelineCreationQueue::init(GrAllocator<U8> alloc, VkDevice dev, CString cacheDir, const ConfigSet& cfg)
+{
+	m_alloc = alloc;
+	m_dev = dev;
+	m_asyncCreation = cfg.getBool(ConfigOption::gr_asyncPipelineCreation);
+	m_prewarm = cfg.getBool(ConfigOption::gr_pipelinePrewarm);
+	m_recordFilename.sprintf(m_alloc, "%s/vk_pipeline_states", cacheDir.cstr());
+
+	if(m_prewarm)
+	{
+		const Error err = loadRecords();
+		if(err)
+		{
+			ANKI_VK_LOGW("Failed to load the pipeline states of the previous runs. Will ignore them");
+			m_loadedRecords.destroy(m_alloc);
+			m_programRecords.destroy(m_alloc);
+			m_recordHashes.destroy(m_alloc);
+		}
+	}
+
+	// Create the threads
+	const U32 threadCount = cfg.getNumberU32(ConfigOption::gr_pipelineCreationThreadCount);
+	m_threads.create(m_alloc, threadCount);
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		m_threads[i] = m_alloc.newInstance<Thread>("PplineCreate");
+		m_threads[i]->start(this, threadCallback);
+	}
+
+	return Error::NONE;
+}
+
+void PipelineCreationQueue::destroy()
+{
+	// Stop the threads. They will run the tasks that are left
+	{
+		LockGuard<Mutex> lock(m_tasksMtx);
+		m_quit = true;
+		m_tasksCondVar.notifyAll();
+	}
+
+	for(Thread* thread : m_threads)
+	{
+		const Error err = thread->join();
+		(void)err;
+		m_alloc.deleteInstance(thread);
+	}
+	m_threads.destroy(m_alloc);
+	ANKI_ASSERT(m_tasks.getSize() == 0);
+	m_tasks.destroy(m_alloc);
+
+	// Store the record
+	if(m_prewarm && !m_recordFilename.isEmpty())
+	{
+		const Error err = storeRecords();
+		if(err)
+		{
+			ANKI_VK_LOGE("An error occurred while storing the pipeline states to disk. Will ignore");
+		}
+	}
+
+	for(VkRenderPass rpass : m_rpasses)
+	{
+		vkDestroyRenderPass(m_dev, rpass, nullptr);
+	}
+	m_rpasses.destroy(m_alloc);
+
+	m_loadedRecords.destroy(m_alloc);
+	m_programRecords.destroy(m_alloc);
+	m_newRecords.destroy(m_alloc);
+	m_recordHashes.destroy(m_alloc);
+	m_recordFilename.destroy(m_alloc);
+}
+
+Error PipelineCreationQueue::threadCallback(ThreadCallbackInfo& info)
+{
+	static_cast<PipelineCreationQueue*>(info.m_userData)->runTasks();
+	return Error::NONE;
+}
+
+void PipelineCreationQueue::runTasks()
+{
+	while(true)
+	{
+		PipelineCreationTask* task;
+		{
+			LockGuard<Mutex> lock(m_tasksMtx);
+			while(m_tasks.getSize() == 0 && !m_quit)
+			{
+				m_tasksCondVar.wait(m_tasksMtx);
+			}
+
+			if(m_tasks.getSize() == 0)
+			{
+				break;
+			}
+
+			// The most recent first. The async creations are needed right away, the pre-warm can wait
+			task = m_tasks.getBack();
+			m_tasks.popBack(m_alloc);
+		}
+
+		PipelineFactory& factory = *task->m_factory;
+		factory.runCreationTask(*task);
+		m_alloc.deleteInstance(task);
+		m_pendingCount.fetchSub(1);
+
+		// Last thing, the factory might be destroyed after that
+		factory.m_pendingCreationCount.fetchSub(1);
+	}
+}
+
+void PipelineCreationQueue::submitTask(PipelineCreationTask* task)
+{
+	ANKI_ASSERT(task && task->m_factory);
+	task->m_factory->m_pendingCreationCount.fetchAdd(1);
+	m_pendingCount.fetchAdd(1);
+
+	LockGuard<Mutex> lock(m_tasksMtx);
+	m_tasks.emplaceBack(m_alloc, task);
+	m_tasksCondVar.notifyOne();
+}
+
+void PipelineCreationQueue::cancelTasks(PipelineFactory& factory)
+{
+	LockGuard<Mutex> lock(m_tasksMtx);
+
+	U32 count = 0;
+	for(U32 i = 0; i < m_tasks.getSize(); ++i)
+	{
+		PipelineCreationTask* task = m_tasks[i];
+		if(task->m_factory == &factory)
+		{
+			m_alloc.deleteInstance(task);
+			m_pendingCount.fetchSub(1);
+			factory.m_pendingCreationCount.fetchSub(1);
+		}
+		else
+		{
+			m_tasks[count++] = task;
+		}
+	}
+
+	m_tasks.resize(m_alloc, count);
+}
+
+void PipelineCreationQueue::prewarm(PipelineFactory& factory, const ShaderProgramImpl& prog)
+{
+	if(!m_prewarm)
+	{
+		return;
+	}
+
+	const ConstWeakArray<PipelineStateDescription> records = getLoadedPipelineStates(prog.getPersistentHash());
+	if(records.getSize())
+	{
+		factory.prewarm(prog, records);
+	}
+}
+
+ConstWeakArray<PipelineStateDescription> PipelineCreationQueue::getLoadedPipelineStates(U64 programHash) const
+{
+	// The loaded records are not modified so there is no need to lock
+	auto it = m_programRecords.find(programHash);
+	if(it == m_programRecords.getEnd())
+	{
+		return ConstWeakArray<PipelineStateDescription>();
+	}
+
+	return ConstWeakArray<PipelineStateDescription>(&m_loadedRecords[(*it).m_first], (*it).m_count);
+}
+
+void PipelineCreationQueue::recordPipelineState(const PipelineStateDescription& desc)
+{
+	if(!m_prewarm)
+	{
+		return;
+	}
+
+	const U64 hash = desc.computeHash();
+
+	LockGuard<Mutex> lock(m_recordMtx);
+	if(m_recordHashes.find(hash) == m_recordHashes.getEnd())
+	{
+		m_recordHashes.emplace(m_alloc, hash, true);
+		m_newRecords.emplaceBack(m_alloc, desc);
+	}
+}
+
+VkRenderPass PipelineCreationQueue::getCompatibleRenderPass(const PipelineStateDescription& desc)
+{
+	const U32 colorAttachmentCount = desc.m_colorAttachmentMask.getEnabledBitCount();
+	const Bool hasDepthStencil = desc.m_hasDepthAttachment || desc.m_hasStencilAttachment;
+	const U32 attachmentCount = colorAttachmentCount + (hasDepthStencil ? 1 : 0);
+
+	// Only the formats and the sample counts matter for the compatibility
+	U64 hash = computeHash(&desc.m_attachmentFormats[0], sizeof(VkFormat) * attachmentCount);
+	hash = appendHash(&attachmentCount, sizeof(attachmentCount), hash);
+
+	LockGuard<Mutex> lock(m_rpassesMtx);
+
+	auto it = m_rpasses.find(hash);
+	if(it != m_rpasses.getEnd())
+	{
+		return *it;
+	}
+
+	Array<VkAttachmentDescription, MAX_COLOR_ATTACHMENTS + 1> attachments = {};
+	Array<VkAttachmentReference, MAX_COLOR_ATTACHMENTS + 1> references = {};
+	for(U32 i = 0; i < attachmentCount; ++i)
+	{
+		const Bool depthStencil = i == colorAttachmentCount;
+		const VkImageLayout layout = (depthStencil) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
+													: VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentDescription& att = attachments[i];
+		att.format = desc.m_attachmentFormats[i];
+		att.samples = VK_SAMPLE_COUNT_1_BIT;
+		att.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		att.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		att.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		att.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		att.initialLayout = layout;
+		att.finalLayout = layout;
+
+		references[i].attachment = i;
+		references[i].layout = layout;
+	}
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = colorAttachmentCount;
+	subpass.pColorAttachments = (colorAttachmentCount) ? &references[0] : nullptr;
+	subpass.pDepthStencilAttachment = (hasDepthStencil) ? &references[colorAttachmentCount] : nullptr;
+
+	VkRenderPassCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	ci.attachmentCount = attachmentCount;
+	ci.pAttachments = (attachmentCount) ? &attachments[0] : nullptr;
+	ci.subpassCount = 1;
+	ci.pSubpasses = &subpass;
+
+	VkRenderPass rpass;
+	ANKI_VK_CHECKF(vkCreateRenderPass(m_dev, &ci, nullptr, &rpass));
+	m_rpasses.emplace(m_alloc, hash, rpass);
+
+	return rpass;
+}
+
+void PipelineCreationQueue::getStats(GrManagerStats& stats) const
+{
+	stats.m_pipelineCount = m_createdCount.load();
+	stats.m_pipelineHitchCount = m_hitchCount.load();
+	stats.m_prewarmedPipelineCount = m_prewarmedCount.load();
+	stats.m_pendingPipelineCount = m_pendingCount.load();
+	stats.m_pipelineCreationTime = Second(m_creationTimeUs.load()) / 1000000.0;
+}
+
+Error PipelineCreationQueue::loadRecords()
+{
+	if(!fileExists(m_recordFilename.toCString()))
+	{
+		ANKI_VK_LOGI("Pipeline states not found: %s", m_recordFilename.cstr());
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_recordFilename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::READ));
+
+	PipelineRecordHeader header;
+	ANKI_CHECK(file.read(&header, sizeof(header)));
+	if(memcmp(&header.m_magic[0], PIPELINE_RECORD_MAGIC, sizeof(header.m_magic)) != 0
+		|| header.m_descriptionSize != sizeof(PipelineStateDescription)
+		|| file.getSize() != sizeof(header) + PtrSize(header.m_descriptionCount) * sizeof(PipelineStateDescription))
+	{
+		ANKI_VK_LOGI("Pipeline states are not compatible. Will ignore them: %s", m_recordFilename.cstr());
+		return Error::NONE;
+	}
+
+	if(header.m_descriptionCount == 0)
+	{
+		return Error::NONE;
+	}
+
+	DynamicArrayAuto<PipelineStateDescription> records(m_alloc);
+	records.create(header.m_descriptionCount);
+	ANKI_CHECK(file.read(&records[0], records.getSizeInBytes()));
+
+	// Sort them by program to find the records of a program fast
+	DynamicArrayAuto<U32> indices(m_alloc);
+	indices.create(records.getSize());
+	for(U32 i = 0; i < indices.getSize(); ++i)
+	{
+		indices[i] = i;
+	}
+
+	std::sort(indices.getBegin(), indices.getEnd(), [&](U32 a, U32 b) {
+		return records[a].m_programHash < records[b].m_programHash;
+	});
+
+	m_loadedRecords.create(m_alloc, records.getSize());
+	for(U32 i = 0; i < indices.getSize(); ++i)
+	{
+		const PipelineStateDescription& record = records[indices[i]];
+		m_loadedRecords[i] = record;
+
+		const U64 hash = record.computeHash();
+		if(m_recordHashes.find(hash) == m_recordHashes.getEnd())
+		{
+			m_recordHashes.emplace(m_alloc, hash, true);
+		}
+
+		if(i == 0 || m_loadedRecords[i - 1].m_programHash != record.m_programHash)
+		{
+			Range range;
+			range.m_first = i;
+			m_programRecords.emplace(m_alloc, record.m_programHash, range);
+		}
+
+		++(*m_programRecords.find(record.m_programHash)).m_count;
+	}
+
+	ANKI_VK_LOGI(
+		"Loaded %u pipeline states of %u programs", m_loadedRecords.getSize(), U32(m_programRecords.getSize()));
+	return Error::NONE;
+}
+
+Error PipelineCreationQueue::storeRecords()
+{
+	const U32 count = m_loadedRecords.getSize() + m_newRecords.getSize();
+	if(count == 0)
+	{
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(m_recordFilename.toCString(), FileOpenFlag::BINARY | FileOpenFlag::WRITE));
+
+	PipelineRecordHeader header;
+	memcpy(&header.m_magic[0], PIPELINE_RECORD_MAGIC, sizeof(header.m_magic));
+	header.m_descriptionSize = sizeof(PipelineStateDescription);
+	header.m_descriptionCount = count;
+	ANKI_CHECK(file.write(&header, sizeof(header)));
+
+	if(m_loadedRecords.getSize())
+	{
+		ANKI_CHECK(file.write(&m_loadedRecords[0], m_loadedRecords.getSizeInBytes()));
+	}
+
+	if(m_newRecords.getSize())
+	{
+		ANKI_CHECK(file.write(&m_newRecords[0], m_newRecords.getSizeInBytes()));
+	}
+
+	ANKI_VK_LOGI("Stored %u pipeline states (%u new)", count, m_newRecords.getSize());
+	return Error::NONE;
+}
+
+} // end namespace anki
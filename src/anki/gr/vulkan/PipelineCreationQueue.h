@@ -0,0 +1,150 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/gr/vulkan/Pipeline.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+// Forward
+class ConfigSet;
+class GrManagerStats;
+
+/// @addtogroup vulkan
+/// @{
+
+/// A graphics pipeline that will be created by the PipelineCreationQueue.
+class PipelineCreationTask
+{
+public:
+	PipelineFactory* m_factory = nullptr;
+	const ShaderProgramImpl* m_prog = nullptr;
+	PipelineStateDescription m_desc;
+	VkRenderPass m_rpass = VK_NULL_HANDLE;
+	FramebufferPtr m_fb; ///< Holds the render pass if it's not a pre-warm task.
+	U64 m_hash = 0;
+	Bool m_prewarm = false;
+};
+
+/// Creates graphics pipelines in worker threads. It also records the states of the pipelines that were created in order
+/// to pre-warm them in the next runs: When a graphics program is created the pipelines that were used with it the last
+/// times are created in the background.
+class PipelineCreationQueue : public NonCopyable
+{
+public:
+	PipelineCreationQueue() = default;
+
+	~PipelineCreationQueue();
+
+	ANKI_USE_RESULT Error init(GrAllocator<U8> alloc, VkDevice dev, CString cacheDir, const ConfigSet& cfg);
+
+	/// Wait for the tasks, store the recorded pipeline states and destroy.
+	void destroy();
+
+	/// If true the PipelineFactory will create the missing pipelines in the background.
+	Bool getAsyncCreation() const
+	{
+		return m_asyncCreation;
+	}
+
+	/// Create the pipelines that were used with a program in the previous runs.
+	/// @note Thread-safe.
+	void prewarm(PipelineFactory& factory, const ShaderProgramImpl& prog);
+
+	/// Get the pipeline states of a program that were loaded from the previous runs.
+	/// @param programHash See ShaderProgramImpl::getPersistentHash().
+	/// @note Thread-safe.
+	ConstWeakArray<PipelineStateDescription> getLoadedPipelineStates(U64 programHash) const;
+
+	/// @note Thread-safe.
+	void submitTask(PipelineCreationTask* task);
+
+	/// Remove the tasks of a factory that haven't started.
+	/// @note Thread-safe.
+	void cancelTasks(PipelineFactory& factory);
+
+	/// Record the state of a new pipeline. It will be pre-warmed in the next runs.
+	/// @note Thread-safe.
+	void recordPipelineState(const PipelineStateDescription& desc);
+
+	/// Get a render pass that is compatible with the render pass of a recorded pipeline state.
+	/// @note Thread-safe.
+	VkRenderPass getCompatibleRenderPass(const PipelineStateDescription& desc);
+
+	GrAllocator<U8> getAllocator() const
+	{
+		return m_alloc;
+	}
+
+	/// @note Thread-safe.
+	void pipelineCreated(Second duration, Bool hitch, Bool prewarm)
+	{
+		m_createdCount.fetchAdd(1);
+		m_creationTimeUs.fetchAdd(U64(duration * 1000000.0));
+		if(hitch)
+		{
+			m_hitchCount.fetchAdd(1);
+		}
+
+		if(prewarm)
+		{
+			m_prewarmedCount.fetchAdd(1);
+		}
+	}
+
+	void getStats(GrManagerStats& stats) const;
+
+private:
+	class Range
+	{
+	public:
+		U32 m_first = 0;
+		U32 m_count = 0;
+	};
+
+	GrAllocator<U8> m_alloc;
+	VkDevice m_dev = VK_NULL_HANDLE;
+	String m_recordFilename;
+	Bool m_asyncCreation = false;
+	Bool m_prewarm = false;
+
+	// Threads
+	DynamicArray<Thread*> m_threads;
+	DynamicArray<PipelineCreationTask*> m_tasks;
+	Mutex m_tasksMtx;
+	ConditionVariable m_tasksCondVar;
+	Bool m_quit = false;
+
+	// Record
+	DynamicArray<PipelineStateDescription> m_loadedRecords; ///< Sorted by program hash.
+	HashMap<U64, Range> m_programRecords; ///< The loaded records of each program.
+	DynamicArray<PipelineStateDescription> m_newRecords;
+	HashMap<U64, Bool> m_recordHashes; ///< The hashes of all the records.
+	Mutex m_recordMtx;
+
+	HashMap<U64, VkRenderPass> m_rpasses;
+	Mutex m_rpassesMtx;
+
+	// Stats
+	Atomic<U32> m_createdCount = {0};
+	Atomic<U32> m_hitchCount = {0};
+	Atomic<U32> m_prewarmedCount = {0};
+	Atomic<U32> m_pendingCount = {0};
+	Atomic<U64> m_creationTimeUs = {0};
+
+	static Error threadCallback(ThreadCallbackInfo& info);
+
+	void runTasks();
+
+	ANKI_USE_RESULT Error loadRecords();
+
+	ANKI_USE_RESULT Error storeRecords();
+};
+/// @}
+
+} // end namespace anki
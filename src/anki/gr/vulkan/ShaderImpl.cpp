@@ -118,6 +118,13 @@ Error ShaderImpl::init(const ShaderInitInfo& inf)
 		}
 	}
 
+	// Compute the hash
+	m_hash = computeHash(&inf.m_binary[0], inf.m_binary.getSize());
+	if(m_specConstInfo.dataSize)
+	{
+		m_hash = appendHash(m_specConstInfo.pData, m_specConstInfo.dataSize, m_hash);
+	}
+
 	return Error::NONE;
 }
 
@@ -144,6 +144,7 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 			}
 
 			const ShaderImpl& shaderImpl = static_cast<const ShaderImpl&>(*m_shaders[stype]);
+			m_persistentHash = appendHash(&shaderImpl.m_hash, sizeof(shaderImpl.m_hash), m_persistentHash);
 
 			VkPipelineShaderStageCreateInfo& inf = m_shaderCreateInfos[m_shaderCreateInfoCount++];
 			inf = {};
@@ -159,9 +160,16 @@ Error ShaderProgramImpl::init(const ShaderProgramInitInfo& inf)
 	//
 	if(graphicsProg)
 	{
+		PipelineCreationQueue& queue = getGrManagerImpl().getPipelineCreationQueue();
+
 		m_pplineFactory = getAllocator().newInstance<PipelineFactory>();
-		m_pplineFactory->init(
-			getGrManagerImpl().getAllocator(), getGrManagerImpl().getDevice(), getGrManagerImpl().getPipelineCache());
+		m_pplineFactory->init(getGrManagerImpl().getAllocator(),
+			getGrManagerImpl().getDevice(),
+			getGrManagerImpl().getPipelineCache(),
+			&queue);
+
+		// Start creating the pipelines that were used with this program in the previous runs
+		queue.prewarm(*m_pplineFactory, *this);
 	}
 
 	// Create the pipeline if compute
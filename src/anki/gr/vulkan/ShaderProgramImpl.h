@@ -88,6 +88,13 @@ public:
 		return m_stages;
 	}
 
+	/// A hash of the shaders that is the same between runs. Only for graphics programs.
+	U64 getPersistentHash() const
+	{
+		ANKI_ASSERT(m_persistentHash);
+		return m_persistentHash;
+	}
+
 private:
 	Array<ShaderPtr, U(ShaderType::COUNT)> m_shaders;
 	ShaderTypeBit m_stages = ShaderTypeBit::NONE;
@@ -101,6 +108,7 @@ private:
 	ShaderProgramReflectionInfo m_refl;
 
 	PipelineFactory* m_pplineFactory = nullptr; ///< Only for graphics programs.
+	U64 m_persistentHash = 0;
 
 	VkPipeline m_computePpline = VK_NULL_HANDLE;
 };
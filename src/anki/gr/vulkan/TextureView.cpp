@@ -22,4 +22,11 @@ TextureView* TextureView::newInstance(GrManager* manager, const TextureViewInitI
 	return impl;
 }
 
+U32 TextureView::getOrCreateBindlessTextureIndex()
+{
+	ANKI_VK_SELF(TextureViewImpl);
+	const VkImageLayout layout = self.getTextureImpl().computeLayout(TextureUsageBit::SAMPLED_FRAGMENT, 0);
+	return self.getOrCreateBindlessIndex(layout, DescriptorType::TEXTURE);
+}
+
 } // end namespace anki
@@ -8,19 +8,28 @@
 namespace anki
 {
 
-void Input::handleEvents()
+Error Input::initInternal(NativeWindow* nativeWindow)
 {
-	// You are dummy... do nothing
+	ANKI_ASSERT(nativeWindow);
+	m_nativeWindow = nativeWindow;
+	return handleEvents();
 }
 
-void Input::init(NativeWindow* nativeWindow)
+void Input::destroy()
 {
-	// You are dummy... do nothing
+	m_nativeWindow = nullptr;
+}
+
+Error Input::handleEvents()
+{
+	// You are dummy... There are no events
+	m_textInput[0] = '\0';
+	return Error::NONE;
 }
 
 void Input::moveCursor(const Vec2& posNdc)
 {
-	// You are dummy... do nothing
+	m_mousePosNdc = posNdc;
 }
 
 void Input::hideCursor(Bool hide)
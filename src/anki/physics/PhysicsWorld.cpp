@@ -166,7 +166,9 @@ PhysicsWorld::~PhysicsWorld()
 Error PhysicsWorld::create(AllocAlignedCallback allocCb, void* allocCbData)
 {
 	m_alloc = HeapAllocator<U8>(allocCb, allocCbData);
+	m_alloc.getMemoryPool().setMemoryTag(MemoryTag::PHYSICS);
 	m_tmpAlloc = StackAllocator<U8>(allocCb, allocCbData, 1_KB, 2.0f);
+	m_tmpAlloc.getMemoryPool().setMemoryTag(MemoryTag::PHYSICS);
 
 	// Set allocators
 	gAlloc = &m_alloc;
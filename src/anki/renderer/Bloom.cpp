@@ -27,8 +27,8 @@ Error Bloom::initExposure(const ConfigSet& config)
 	m_exposure.m_width = m_r->getDownscaleBlur().getPassWidth(MAX_U32) * 2;
 	m_exposure.m_height = m_r->getDownscaleBlur().getPassHeight(MAX_U32) * 2;
 
-	m_exposure.m_threshold = config.getNumberF32("r_bloomThreshold");
-	m_exposure.m_scale = config.getNumberF32("r_bloomScale");
+	m_exposure.m_threshold = config.getNumberF32(ConfigOption::r_bloomThreshold);
+	m_exposure.m_scale = config.getNumberF32(ConfigOption::r_bloomScale);
 
 	// Create RT info
 	m_exposure.m_rtDescr =
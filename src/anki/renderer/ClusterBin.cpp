@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <anki/renderer/ClusterBin.h>
+#include <anki/renderer/ClusterBinKernels.h>
 #include <anki/renderer/RenderQueue.h>
 #include <anki/Collision.h>
 #include <anki/util/ThreadHive.h>
@@ -13,6 +14,9 @@
 namespace anki
 {
 
+/// The max size of the persistent buffers. Same as UBO_MAX_SIZE of the shaders.
+constexpr U32 MAX_PERSISTENT_BUFFER_SIZE = 16384;
+
 /// Get a view space point.
 static Vec4 unproject(const F32 zVspace, const Vec2& ndc, const Vec4& unprojParams)
 {
@@ -25,18 +29,117 @@ static Vec4 unproject(const F32 zVspace, const Vec2& ndc, const Vec4& unprojPara
 	return view * zVspace;
 }
 
-template<typename TShape>
-static Bool insideClusterFrustum(const Array<Plane, 4>& planeArr, const TShape& shape)
+/// Call a functor for every object of the batches that is inside the planes.
+template<typename TBatch, typename TFunc>
+static void iterateVisibleObjects(ConstWeakArray<Plane> planes, WeakArray<TBatch> batches, U32 objectCount, TFunc func)
 {
-	for(const Plane& plane : planeArr)
+	for(U32 batch = 0; batch < batches.getSize(); ++batch)
 	{
-		if(testPlane(plane, shape) < 0.0f)
+		const U32 firstObject = batch * CLUSTER_BIN_BATCH_SIZE;
+		const U32 mask = clusterBinTestPlanes(planes, batches[batch])
+						 & computeClusterBinLaneMask(min(CLUSTER_BIN_BATCH_SIZE, objectCount - firstObject));
+
+		for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+		{
+			if(mask & (1u << lane))
+			{
+				func(firstObject + lane);
+			}
+		}
+	}
+}
+
+/// Same as iterateVisibleObjects() but only for a subset of the objects.
+template<typename TBatch, typename TFunc>
+static void iterateVisibleCandidates(
+	ConstWeakArray<Plane> planes, WeakArray<TBatch> batches, ConstWeakArray<U32> candidates, TFunc func)
+{
+	for(U32 firstCandidate = 0; firstCandidate < candidates.getSize(); firstCandidate += CLUSTER_BIN_BATCH_SIZE)
+	{
+		// Gather the candidates in a batch
+		const U32 laneCount = min(CLUSTER_BIN_BATCH_SIZE, candidates.getSize() - firstCandidate);
+		TBatch batch;
+		for(U32 lane = 0; lane < laneCount; ++lane)
+		{
+			const U32 objectIdx = candidates[firstCandidate + lane];
+			copyClusterBinBatchLane(
+				batches[objectIdx / CLUSTER_BIN_BATCH_SIZE], objectIdx % CLUSTER_BIN_BATCH_SIZE, batch, lane);
+		}
+
+		const U32 mask = clusterBinTestPlanes(planes, batch) & computeClusterBinLaneMask(laneCount);
+		for(U32 lane = 0; lane < laneCount; ++lane)
 		{
-			return false;
+			if(mask & (1u << lane))
+			{
+				func(candidates[firstCandidate + lane]);
+			}
 		}
 	}
+}
+
+/// Call a functor for every cluster of a tile that passes a batched collision test. Only the batches that contain the
+/// clusters from firstClusterZ to lastClusterZ (inclusive) are tested.
+template<typename TTestFunc, typename TFunc>
+static void iterateCollidingClusters(
+	U32 clusterCountZ, U32 firstClusterZ, U32 lastClusterZ, TTestFunc testFunc, TFunc func)
+{
+	ANKI_ASSERT(firstClusterZ <= lastClusterZ && lastClusterZ < clusterCountZ);
+	const U32 lastBatch = lastClusterZ / CLUSTER_BIN_BATCH_SIZE;
+	for(U32 batch = firstClusterZ / CLUSTER_BIN_BATCH_SIZE; batch <= lastBatch; ++batch)
+	{
+		const U32 firstCluster = batch * CLUSTER_BIN_BATCH_SIZE;
+		const U32 mask =
+			testFunc(batch) & computeClusterBinLaneMask(min(CLUSTER_BIN_BATCH_SIZE, clusterCountZ - firstCluster));
 
-	return true;
+		for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+		{
+			if(mask & (1u << lane))
+			{
+				func(firstCluster + lane);
+			}
+		}
+	}
+}
+
+/// Allocate an array from the temp allocator and return the number of batches.
+template<typename TBatch>
+static WeakArray<TBatch> newBatches(StackAllocator<U8>& alloc, U32 objectCount)
+{
+	const U32 batchCount = (objectCount + CLUSTER_BIN_BATCH_SIZE - 1) / CLUSTER_BIN_BATCH_SIZE;
+	return (batchCount) ? WeakArray<TBatch>(alloc.newArray<TBatch>(batchCount), batchCount) : WeakArray<TBatch>();
+}
+
+/// The tiles and the Z slices an object may touch.
+class ClusterBin::CoarseBounds
+{
+public:
+	Array<U16, 2> m_firstTile; ///< Inclusive.
+	Array<U16, 2> m_lastTile; ///< Inclusive.
+	U16 m_firstClusterZ;
+	U16 m_lastClusterZ;
+	Bool m_visible;
+};
+
+/// Find the slots of some objects in a persistent buffer.
+template<typename TQueueElement>
+static void acquireObjectSlots(PersistentGpuObjectBuffer& buffer,
+	WeakArray<TQueueElement> elements,
+	StackAllocator<U8>& alloc,
+	WeakArray<U32>& slots,
+	Bool& outOfSlots)
+{
+	buffer.beginFrame();
+	if(elements.getSize() == 0)
+	{
+		return;
+	}
+
+	slots = WeakArray<U32>(alloc.newArray<U32>(elements.getSize()), elements.getSize());
+	for(U32 i = 0; i < elements.getSize(); ++i)
+	{
+		slots[i] = buffer.acquireSlot(elements[i].m_uuid);
+		outOfSlots = outOfSlots || slots[i] == MAX_U32;
+	}
 }
 
 /// Bin context.
@@ -55,12 +158,83 @@ public:
 	WeakArray<U32> m_lightIds;
 	WeakArray<U32> m_clusters;
 
+	/// The slots of the objects in the persistent buffers. Empty if the type doesn't have a persistent buffer or if the
+	/// typed objects are not written.
+	Array<WeakArray<U32>, TYPED_OBJECT_COUNT> m_objectSlots;
+
+	/// @name The bounds of the objects in batches. Computed once per frame
+	/// @{
+	WeakArray<ClusterBinSphereBatch> m_pointLightBatches;
+	WeakArray<ClusterBinSpotLightHullBatch> m_spotLightHullBatches;
+	WeakArray<ClusterBinCone> m_spotLightCones;
+	WeakArray<ClusterBinAabbBatch> m_probeBatches;
+	WeakArray<ClusterBinAabbBatch> m_giProbeBatches;
+	WeakArray<ClusterBinObbBatch> m_decalBatches;
+	WeakArray<Obb> m_decalObbs;
+	WeakArray<Aabb> m_decalAabbs;
+	WeakArray<ClusterBinAabbBatch> m_fogVolumeBatches; ///< Spheres are represented by their AABB.
+	/// @}
+
+	/// @name The output of the coarse binning
+	/// @{
+	WeakArray<Vec2> m_clusterDepthRanges; ///< The min and max depth of the cluster AABBs of every Z slice.
+	Array<WeakArray<CoarseBounds>, TYPED_OBJECT_COUNT> m_coarseBounds;
+	Array<WeakArray<U32>, TYPED_OBJECT_COUNT> m_tileCandidateOffsets; ///< Where the candidates of a tile start.
+	Array<WeakArray<U32>, TYPED_OBJECT_COUNT> m_tileCandidates; ///< The candidate objects of all tiles.
+	/// @}
+
 	Atomic<U32> m_tileIdxToProcess = {0};
 	Atomic<U32> m_allocatedIndexCount = {TYPED_OBJECT_COUNT};
 
 	Vec4 m_unprojParams;
 
 	Bool m_clusterEdgesDirty;
+
+	/// Call a functor for every object of a type that is inside the frustum of a tile.
+	template<typename TBatch, typename TFunc>
+	void iterateTileObjects(U32 typeIdx,
+		U32 tileIdx,
+		ConstWeakArray<Plane> tilePlanes,
+		WeakArray<TBatch> batches,
+		U32 objectCount,
+		TFunc func) const
+	{
+		if(m_bin->m_hierarchical)
+		{
+			const U32 firstCandidate = m_tileCandidateOffsets[typeIdx][tileIdx];
+			const ConstWeakArray<U32> candidates(m_tileCandidates[typeIdx].getBegin() + firstCandidate,
+				m_tileCandidateOffsets[typeIdx][tileIdx + 1] - firstCandidate);
+			iterateVisibleCandidates(tilePlanes, batches, candidates, func);
+		}
+		else
+		{
+			iterateVisibleObjects(tilePlanes, batches, objectCount, func);
+		}
+	}
+
+	/// Get the index that the shaders will use to access an object.
+	/// @return The index or MAX_U32 if the object didn't get a slot in the persistent buffer.
+	U32 getObjectShaderIndex(U32 typeIdx, U32 objectIdx) const
+	{
+		return (m_objectSlots[typeIdx].getSize()) ? m_objectSlots[typeIdx][objectIdx] : objectIdx;
+	}
+
+	/// Get the Z slices an object may touch.
+	void getClusterZRange(U32 typeIdx, U32 objectIdx, U32& firstClusterZ, U32& lastClusterZ) const
+	{
+		if(m_bin->m_hierarchical)
+		{
+			const CoarseBounds& bounds = m_coarseBounds[typeIdx][objectIdx];
+			ANKI_ASSERT(bounds.m_visible);
+			firstClusterZ = bounds.m_firstClusterZ;
+			lastClusterZ = bounds.m_lastClusterZ;
+		}
+		else
+		{
+			firstClusterZ = 0;
+			lastClusterZ = m_bin->m_clusterCounts[2] - 1;
+		}
+	}
 };
 
 class ClusterBin::TileCtx
@@ -73,8 +247,8 @@ public:
 	};
 
 	DynamicArrayAuto<Vec4> m_clusterEdgesWSpace;
-	DynamicArrayAuto<Aabb> m_clusterBoxes;
-	DynamicArrayAuto<Sphere> m_clusterSpheres;
+	DynamicArrayAuto<ClusterBinAabbBatch> m_clusterBoxBatches;
+	DynamicArrayAuto<ClusterBinSphereBatch> m_clusterSphereBatches;
 
 	DynamicArrayAuto<ClusterMetaInfo> m_clusterInfos;
 	DynamicArrayAuto<U32> m_indices;
@@ -83,8 +257,8 @@ public:
 
 	TileCtx(StackAllocator<U8>& alloc)
 		: m_clusterEdgesWSpace(alloc)
-		, m_clusterBoxes(alloc)
-		, m_clusterSpheres(alloc)
+		, m_clusterBoxBatches(alloc)
+		, m_clusterSphereBatches(alloc)
 		, m_clusterInfos(alloc)
 		, m_indices(alloc)
 	{
@@ -96,6 +270,34 @@ public:
 		const U32 perClusterCount = m_indices.getSize() / m_clusterCountZ;
 		return WeakArray<U32>(&m_indices[perClusterCount * clusterZ], perClusterCount);
 	}
+
+	Aabb getClusterBox(const U32 clusterZ) const
+	{
+		const ClusterBinAabbBatch& batch = m_clusterBoxBatches[clusterZ / CLUSTER_BIN_BATCH_SIZE];
+		const U32 lane = clusterZ % CLUSTER_BIN_BATCH_SIZE;
+		return Aabb(Vec4(batch.m_minX[lane], batch.m_minY[lane], batch.m_minZ[lane], 0.0f),
+			Vec4(batch.m_maxX[lane], batch.m_maxY[lane], batch.m_maxZ[lane], 0.0f));
+	}
+
+	void addObject(const U32 clusterZ, const U32 typeIdx, const U32 objectIdx, const U32 maxObjectsPerCluster)
+	{
+		if(ANKI_UNLIKELY(objectIdx == MAX_U32))
+		{
+			// The object didn't get a slot in the persistent buffer
+			return;
+		}
+
+		ClusterMetaInfo& inf = m_clusterInfos[clusterZ];
+		if(ANKI_UNLIKELY(U32(inf.m_offset) + 1 >= maxObjectsPerCluster))
+		{
+			ANKI_R_LOGW("Out of cluster indices. Increase r_avgObjectsPerCluster");
+			return;
+		}
+
+		getClusterIndices(clusterZ)[inf.m_offset++] = objectIdx;
+		++inf.m_counts[typeIdx];
+		ANKI_ASSERT(inf.m_counts[typeIdx] <= maxObjectsPerCluster);
+	}
 };
 
 ClusterBin::~ClusterBin()
@@ -103,8 +305,12 @@ ClusterBin::~ClusterBin()
 	m_clusterEdges.destroy(m_alloc);
 }
 
-void ClusterBin::init(
-	HeapAllocator<U8> alloc, U32 clusterCountX, U32 clusterCountY, U32 clusterCountZ, const ConfigSet& cfg)
+void ClusterBin::init(HeapAllocator<U8> alloc,
+	GrManager* gr,
+	U32 clusterCountX,
+	U32 clusterCountY,
+	U32 clusterCountZ,
+	const ConfigSet& cfg)
 {
 	m_alloc = alloc;
 
@@ -114,7 +320,8 @@ void ClusterBin::init(
 
 	m_totalClusterCount = clusterCountX * clusterCountY * clusterCountZ;
 
-	m_avgObjectsPerCluster = cfg.getNumberU32("r_avgObjectsPerCluster");
+	m_avgObjectsPerCluster = cfg.getNumberU32(ConfigOption::r_avgObjectsPerCluster);
+	m_hierarchical = cfg.getBool(ConfigOption::r_clusterBinHierarchical);
 
 	// The actual indices per cluster are
 	// - the object indices per cluster
@@ -123,18 +330,72 @@ void ClusterBin::init(
 	m_indexCount = m_totalClusterCount * (m_avgObjectsPerCluster + TYPED_OBJECT_COUNT - 1 + TYPED_OBJECT_COUNT);
 
 	m_clusterEdges.create(m_alloc, m_clusterCounts[0] * m_clusterCounts[1] * (m_clusterCounts[2] + 1) * 4);
+
+	m_pointLightBuffer.init(
+		m_alloc, gr, sizeof(PointLight), MAX_PERSISTENT_BUFFER_SIZE / sizeof(PointLight), "Point lights");
+	m_spotLightBuffer.init(
+		m_alloc, gr, sizeof(SpotLight), MAX_PERSISTENT_BUFFER_SIZE / sizeof(SpotLight), "Spot lights");
+	m_reflectionProbeBuffer.init(m_alloc,
+		gr,
+		sizeof(ReflectionProbe),
+		MAX_PERSISTENT_BUFFER_SIZE / sizeof(ReflectionProbe),
+		"Reflection probes");
+	m_decalBuffer.init(m_alloc, gr, sizeof(Decal), MAX_PERSISTENT_BUFFER_SIZE / sizeof(Decal), "Decals");
+	m_fogVolumeBuffer.init(m_alloc,
+		gr,
+		sizeof(FogDensityVolume),
+		MAX_PERSISTENT_BUFFER_SIZE / sizeof(FogDensityVolume),
+		"Fog density volumes");
 }
 
 void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 {
 	ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
 
+	// Allocate indices
+	U32* indices = static_cast<U32*>(in.m_stagingMem->allocateFrame(
+		m_indexCount * sizeof(U32), StagingGpuMemoryType::STORAGE, out.m_indicesToken));
+
+	// Allocate clusters
+	U32* clusters = static_cast<U32*>(in.m_stagingMem->allocateFrame(
+		sizeof(U32) * m_totalClusterCount, StagingGpuMemoryType::STORAGE, out.m_clustersToken));
+
+	binInternal(in, out, WeakArray<U32>(clusters, m_totalClusterCount), WeakArray<U32>(indices, m_indexCount), true);
+}
+
+void ClusterBin::binToCpuMemory(
+	ClusterBinIn& in, WeakArray<U32> clusters, WeakArray<U32> indices, ClustererMagicValues& magicValues)
+{
+	ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
+	ANKI_ASSERT(clusters.getSize() == m_totalClusterCount);
+	ANKI_ASSERT(indices.getSize() == m_indexCount);
+
+	ClusterBinOut out;
+	binInternal(in, out, clusters, indices, false);
+	magicValues = out.m_shaderMagicValues;
+}
+
+void ClusterBin::binInternal(
+	ClusterBinIn& in, ClusterBinOut& out, WeakArray<U32> clusters, WeakArray<U32> indices, Bool writeTypedObjects)
+{
 	BinCtx ctx;
 	ctx.m_bin = this;
 	ctx.m_in = &in;
 	ctx.m_out = &out;
+	ctx.m_clusters = clusters;
+	ctx.m_lightIds = indices;
 
 	prepare(ctx);
+	prepareObjects(ctx);
+	if(m_hierarchical)
+	{
+		coarseBin(ctx);
+	}
+
+	if(writeTypedObjects)
+	{
+		acquireSlots(ctx);
+	}
 
 	if(ctx.m_unprojParams != m_prevUnprojParams)
 	{
@@ -146,35 +407,30 @@ void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 		ctx.m_clusterEdgesDirty = false;
 	}
 
-	// Allocate indices
-	U32* indices = static_cast<U32*>(ctx.m_in->m_stagingMem->allocateFrame(
-		m_indexCount * sizeof(U32), StagingGpuMemoryType::STORAGE, ctx.m_out->m_indicesToken));
-	ctx.m_lightIds = WeakArray<U32>(indices, m_indexCount);
-
 	// Reserve some indices for empty clusters
-	for(U i = 0; i < TYPED_OBJECT_COUNT; ++i)
+	for(U32 i = 0; i < TYPED_OBJECT_COUNT; ++i)
 	{
 		indices[i] = 0;
 	}
 
-	// Allocate clusters
-	U32* clusters = static_cast<U32*>(ctx.m_in->m_stagingMem->allocateFrame(
-		sizeof(U32) * m_totalClusterCount, StagingGpuMemoryType::STORAGE, ctx.m_out->m_clustersToken));
-	ctx.m_clusters = WeakArray<U32>(clusters, m_totalClusterCount);
+	Array<ThreadHiveTask, ThreadHive::MAX_THREADS + 1> tasks;
+	U32 taskCount = 0;
 
 	// Create task for writing GPU buffers
-	Array<ThreadHiveTask, ThreadHive::MAX_THREADS + 1> tasks;
-	tasks[0] = ANKI_THREAD_HIVE_TASK(
-		{
-			ANKI_TRACE_SCOPED_EVENT(R_WRITE_LIGHT_BUFFERS);
-			self->m_bin->writeTypedObjectsToGpuBuffers(*self);
-		},
-		&ctx,
-		nullptr,
-		nullptr);
+	if(writeTypedObjects)
+	{
+		tasks[taskCount++] = ANKI_THREAD_HIVE_TASK(
+			{
+				ANKI_TRACE_SCOPED_EVENT(R_WRITE_LIGHT_BUFFERS);
+				self->m_bin->writeTypedObjectsToGpuBuffers(*self);
+			},
+			&ctx,
+			nullptr,
+			nullptr);
+	}
 
 	// Create tasks for binning
-	tasks[1] = ANKI_THREAD_HIVE_TASK(
+	const ThreadHiveTask binTask = ANKI_THREAD_HIVE_TASK(
 		{
 			ANKI_TRACE_SCOPED_EVENT(R_BIN_TO_CLUSTERS);
 			BinCtx& ctx = *self;
@@ -182,8 +438,9 @@ void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 			TileCtx tileCtx(ctx.m_in->m_tempAlloc);
 			const U32 clusterCountZ = ctx.m_bin->m_clusterCounts[2];
 			tileCtx.m_clusterEdgesWSpace.create((clusterCountZ + 1) * 4);
-			tileCtx.m_clusterBoxes.create(clusterCountZ);
-			tileCtx.m_clusterSpheres.create(clusterCountZ);
+			const U32 clusterBatchCount = (clusterCountZ + CLUSTER_BIN_BATCH_SIZE - 1) / CLUSTER_BIN_BATCH_SIZE;
+			tileCtx.m_clusterBoxBatches.create(clusterBatchCount);
+			tileCtx.m_clusterSphereBatches.create(clusterBatchCount);
 			tileCtx.m_indices.create(clusterCountZ * ctx.m_bin->m_avgObjectsPerCluster);
 			tileCtx.m_clusterInfos.create(clusterCountZ);
 			tileCtx.m_clusterCountZ = clusterCountZ;
@@ -199,13 +456,13 @@ void ClusterBin::bin(ClusterBinIn& in, ClusterBinOut& out)
 		nullptr,
 		nullptr);
 
-	for(U threadIdx = 1; threadIdx < in.m_threadHive->getThreadCount(); ++threadIdx)
+	for(U threadIdx = 0; threadIdx < in.m_threadHive->getThreadCount(); ++threadIdx)
 	{
-		tasks[threadIdx + 1] = tasks[1];
+		tasks[taskCount++] = binTask;
 	}
 
 	// Submit and wait
-	in.m_threadHive->submitTasks(&tasks[0], in.m_threadHive->getThreadCount() + 1);
+	in.m_threadHive->submitTasks(&tasks[0], taskCount);
 	in.m_threadHive->waitAllTasks();
 }
 
@@ -256,6 +513,391 @@ void ClusterBin::prepare(BinCtx& ctx)
 	ctx.m_unprojParams = ctx.m_in->m_renderQueue->m_projectionMatrix.extractPerspectiveUnprojectionParams();
 }
 
+void ClusterBin::prepareObjects(BinCtx& ctx)
+{
+	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
+	StackAllocator<U8>& alloc = ctx.m_in->m_tempAlloc;
+
+	// Point lights
+	ctx.m_pointLightBatches = newBatches<ClusterBinSphereBatch>(alloc, rqueue.m_pointLights.getSize());
+	for(U32 i = 0; i < rqueue.m_pointLights.getSize(); ++i)
+	{
+		const PointLightQueueElement& plight = rqueue.m_pointLights[i];
+		ctx.m_pointLightBatches[i / CLUSTER_BIN_BATCH_SIZE].set(
+			i % CLUSTER_BIN_BATCH_SIZE, plight.m_worldPosition, plight.m_radius);
+	}
+
+	// Spot lights
+	ctx.m_spotLightHullBatches = newBatches<ClusterBinSpotLightHullBatch>(alloc, rqueue.m_spotLights.getSize());
+	if(rqueue.m_spotLights.getSize())
+	{
+		ctx.m_spotLightCones = WeakArray<ClusterBinCone>(
+			alloc.newArray<ClusterBinCone>(rqueue.m_spotLights.getSize()), rqueue.m_spotLights.getSize());
+	}
+
+	for(U32 i = 0; i < rqueue.m_spotLights.getSize(); ++i)
+	{
+		const SpotLightQueueElement& slight = rqueue.m_spotLights[i];
+
+		Array<Vec4, ClusterBinSpotLightHullBatch::POINT_COUNT> edges;
+		edges[0] = Vec4(0.0f, 0.0f, 0.0f, 1.0f); // Eye
+		computeEdgesOfFrustum(slight.m_distance, slight.m_outerAngle, slight.m_outerAngle, &edges[1]);
+		for(U32 e = 0; e < edges.getSize(); ++e)
+		{
+			edges[e] = slight.m_worldTransform * edges[e].xyz1();
+		}
+		ctx.m_spotLightHullBatches[i / CLUSTER_BIN_BATCH_SIZE].set(i % CLUSTER_BIN_BATCH_SIZE, edges);
+
+		ClusterBinCone& cone = ctx.m_spotLightCones[i];
+		cone.m_origin = slight.m_worldTransform.getTranslationPart().xyz();
+		cone.m_direction = -slight.m_worldTransform.getZAxis().xyz();
+		cone.m_length = slight.m_distance;
+		cone.m_cosHalfAngle = cos(slight.m_outerAngle / 2.0f);
+		cone.m_sinHalfAngle = sin(slight.m_outerAngle / 2.0f);
+	}
+
+	// Probes
+	ctx.m_probeBatches = newBatches<ClusterBinAabbBatch>(alloc, rqueue.m_reflectionProbes.getSize());
+	for(U32 i = 0; i < rqueue.m_reflectionProbes.getSize(); ++i)
+	{
+		const ReflectionProbeQueueElement& probe = rqueue.m_reflectionProbes[i];
+		ctx.m_probeBatches[i / CLUSTER_BIN_BATCH_SIZE].set(
+			i % CLUSTER_BIN_BATCH_SIZE, probe.m_aabbMin, probe.m_aabbMax);
+	}
+
+	// GI probes
+	ctx.m_giProbeBatches = newBatches<ClusterBinAabbBatch>(alloc, rqueue.m_giProbes.getSize());
+	for(U32 i = 0; i < rqueue.m_giProbes.getSize(); ++i)
+	{
+		const GlobalIlluminationProbeQueueElement& probe = rqueue.m_giProbes[i];
+		ctx.m_giProbeBatches[i / CLUSTER_BIN_BATCH_SIZE].set(
+			i % CLUSTER_BIN_BATCH_SIZE, probe.m_aabbMin, probe.m_aabbMax);
+	}
+
+	// Decals
+	ctx.m_decalBatches = newBatches<ClusterBinObbBatch>(alloc, rqueue.m_decals.getSize());
+	if(rqueue.m_decals.getSize())
+	{
+		ctx.m_decalObbs = WeakArray<Obb>(alloc.newArray<Obb>(rqueue.m_decals.getSize()), rqueue.m_decals.getSize());
+		ctx.m_decalAabbs = WeakArray<Aabb>(alloc.newArray<Aabb>(rqueue.m_decals.getSize()), rqueue.m_decals.getSize());
+	}
+
+	for(U32 i = 0; i < rqueue.m_decals.getSize(); ++i)
+	{
+		const DecalQueueElement& decal = rqueue.m_decals[i];
+		ctx.m_decalBatches[i / CLUSTER_BIN_BATCH_SIZE].set(
+			i % CLUSTER_BIN_BATCH_SIZE, decal.m_obbCenter, decal.m_obbRotation, decal.m_obbExtend);
+
+		Obb& obb = ctx.m_decalObbs[i];
+		obb.setCenter(decal.m_obbCenter.xyz0());
+		obb.setRotation(Mat3x4(decal.m_obbRotation));
+		obb.setExtend(decal.m_obbExtend.xyz0());
+
+		// The extend of the AABB is the extend of the OBB projected to the world axes
+		Vec3 halfSize(0.0f);
+		for(U32 c = 0; c < 3; ++c)
+		{
+			halfSize += (decal.m_obbRotation.getColumn(c) * decal.m_obbExtend[c]).abs();
+		}
+		ctx.m_decalAabbs[i] = Aabb((decal.m_obbCenter - halfSize).xyz0(), (decal.m_obbCenter + halfSize).xyz0());
+	}
+
+	// Fog volumes
+	ctx.m_fogVolumeBatches = newBatches<ClusterBinAabbBatch>(alloc, rqueue.m_fogDensityVolumes.getSize());
+	for(U32 i = 0; i < rqueue.m_fogDensityVolumes.getSize(); ++i)
+	{
+		const FogDensityQueueElement& fogVol = rqueue.m_fogDensityVolumes[i];
+		ClusterBinAabbBatch& batch = ctx.m_fogVolumeBatches[i / CLUSTER_BIN_BATCH_SIZE];
+		if(fogVol.m_isBox)
+		{
+			batch.set(i % CLUSTER_BIN_BATCH_SIZE, fogVol.m_aabbMin, fogVol.m_aabbMax);
+		}
+		else
+		{
+			batch.set(i % CLUSTER_BIN_BATCH_SIZE,
+				fogVol.m_sphereCenter - fogVol.m_sphereRadius,
+				fogVol.m_sphereCenter + fogVol.m_sphereRadius);
+		}
+	}
+}
+
+void ClusterBin::coarseBin(BinCtx& ctx)
+{
+	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
+	StackAllocator<U8>& alloc = ctx.m_in->m_tempAlloc;
+	const U32 tileCount = m_clusterCounts[0] * m_clusterCounts[1];
+
+	// Compute the depth ranges of the Z slices. The AABB of a cluster is inside the AABB of all the clusters of the
+	// same slice so use the latter
+	ctx.m_clusterDepthRanges = WeakArray<Vec2>(alloc.newArray<Vec2>(m_clusterCounts[2]), m_clusterCounts[2]);
+	const Vec3 viewDir = -rqueue.m_cameraTransform.getZAxis().xyz();
+	const Vec3 eye = rqueue.m_cameraTransform.getTranslationPart().xyz();
+	const Array<Vec2, 4> cornersNdc = {{Vec2(-1.0f, -1.0f), Vec2(1.0f, -1.0f), Vec2(1.0f, 1.0f), Vec2(-1.0f, 1.0f)}};
+	Array<Vec3, 8> sliceCorners; // The 4 corners of the previous and the 4 of the current split
+	for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2] + 1; ++clusterZ)
+	{
+		const F32 zNear = -computeClusterNear(ctx.m_out->m_shaderMagicValues, clusterZ);
+		for(U32 i = 0; i < 4; ++i)
+		{
+			if(clusterZ > 0)
+			{
+				sliceCorners[i] = sliceCorners[i + 4];
+			}
+
+			sliceCorners[i + 4] =
+				(rqueue.m_cameraTransform * unproject(zNear, cornersNdc[i], ctx.m_unprojParams).xyz1()).xyz();
+		}
+
+		if(clusterZ > 0)
+		{
+			Vec3 aabbMin(MAX_F32);
+			Vec3 aabbMax(MIN_F32);
+			for(const Vec3& corner : sliceCorners)
+			{
+				aabbMin = aabbMin.min(corner);
+				aabbMax = aabbMax.max(corner);
+			}
+
+			const Vec3 center = (aabbMin + aabbMax) / 2.0f;
+			const F32 extend = viewDir.abs().dot(aabbMax - center);
+			const F32 centerDepth = viewDir.dot(center - eye);
+			ctx.m_clusterDepthRanges[clusterZ - 1] = Vec2(centerDepth - extend, centerDepth + extend);
+		}
+	}
+
+	// Computes the depth range of an AABB
+	auto computeAabbDepths = [&](const Vec3& aabbMin, const Vec3& aabbMax, F32& minDepth, F32& maxDepth) {
+		const Vec3 center = (aabbMin + aabbMax) / 2.0f;
+		const F32 extend = viewDir.abs().dot(aabbMax - center);
+		const F32 centerDepth = viewDir.dot(center - eye);
+		minDepth = centerDepth - extend;
+		maxDepth = centerDepth + extend;
+	};
+
+	auto getAabbCorners = [](const Vec3& aabbMin, const Vec3& aabbMax, Array<Vec3, 8>& corners) {
+		for(U32 i = 0; i < 8; ++i)
+		{
+			corners[i] = Vec3((i & 1) ? aabbMax.x() : aabbMin.x(),
+				(i & 2) ? aabbMax.y() : aabbMin.y(),
+				(i & 4) ? aabbMax.z() : aabbMin.z());
+		}
+	};
+
+	const Array<U32, TYPED_OBJECT_COUNT> objectCounts = {{rqueue.m_pointLights.getSize(),
+		rqueue.m_spotLights.getSize(),
+		rqueue.m_reflectionProbes.getSize(),
+		rqueue.m_giProbes.getSize(),
+		rqueue.m_decals.getSize(),
+		rqueue.m_fogDensityVolumes.getSize()}};
+	for(U32 typeIdx = 0; typeIdx < TYPED_OBJECT_COUNT; ++typeIdx)
+	{
+		if(objectCounts[typeIdx])
+		{
+			ctx.m_coarseBounds[typeIdx] = WeakArray<CoarseBounds>(
+				alloc.newArray<CoarseBounds>(objectCounts[typeIdx]), objectCounts[typeIdx]);
+		}
+	}
+
+	// Compute the bounds of the objects. Use the same shapes the tile frustum tests use
+	Array<Vec3, 8> points;
+	F32 minDepth, maxDepth;
+	for(U32 i = 0; i < rqueue.m_pointLights.getSize(); ++i)
+	{
+		const PointLightQueueElement& plight = rqueue.m_pointLights[i];
+		const Vec3 aabbMin = plight.m_worldPosition - plight.m_radius;
+		const Vec3 aabbMax = plight.m_worldPosition + plight.m_radius;
+		getAabbCorners(aabbMin, aabbMax, points);
+		computeAabbDepths(aabbMin, aabbMax, minDepth, maxDepth);
+		computeCoarseBounds(ctx, ConstWeakArray<Vec3>(points), minDepth, maxDepth, ctx.m_coarseBounds[0][i]);
+	}
+
+	for(U32 i = 0; i < rqueue.m_spotLights.getSize(); ++i)
+	{
+		// The cone test is against the bounding spheres of the clusters which go beyond the depth range of the slice
+		// so don't limit the Z slices
+		const ClusterBinSpotLightHullBatch& batch = ctx.m_spotLightHullBatches[i / CLUSTER_BIN_BATCH_SIZE];
+		const U32 lane = i % CLUSTER_BIN_BATCH_SIZE;
+		for(U32 p = 0; p < ClusterBinSpotLightHullBatch::POINT_COUNT; ++p)
+		{
+			points[p] = Vec3(batch.m_pointX[p][lane], batch.m_pointY[p][lane], batch.m_pointZ[p][lane]);
+		}
+
+		computeCoarseBounds(ctx,
+			ConstWeakArray<Vec3>(&points[0], ClusterBinSpotLightHullBatch::POINT_COUNT),
+			MIN_F32,
+			MAX_F32,
+			ctx.m_coarseBounds[1][i]);
+	}
+
+	for(U32 i = 0; i < rqueue.m_reflectionProbes.getSize(); ++i)
+	{
+		const ReflectionProbeQueueElement& probe = rqueue.m_reflectionProbes[i];
+		getAabbCorners(probe.m_aabbMin, probe.m_aabbMax, points);
+		computeAabbDepths(probe.m_aabbMin, probe.m_aabbMax, minDepth, maxDepth);
+		computeCoarseBounds(ctx, ConstWeakArray<Vec3>(points), minDepth, maxDepth, ctx.m_coarseBounds[2][i]);
+	}
+
+	for(U32 i = 0; i < rqueue.m_giProbes.getSize(); ++i)
+	{
+		const GlobalIlluminationProbeQueueElement& probe = rqueue.m_giProbes[i];
+		getAabbCorners(probe.m_aabbMin, probe.m_aabbMax, points);
+		computeAabbDepths(probe.m_aabbMin, probe.m_aabbMax, minDepth, maxDepth);
+		computeCoarseBounds(ctx, ConstWeakArray<Vec3>(points), minDepth, maxDepth, ctx.m_coarseBounds[3][i]);
+	}
+
+	for(U32 i = 0; i < rqueue.m_decals.getSize(); ++i)
+	{
+		Array<Vec4, 8> obbPoints;
+		ctx.m_decalObbs[i].getExtremePoints(obbPoints);
+		for(U32 p = 0; p < 8; ++p)
+		{
+			points[p] = obbPoints[p].xyz();
+		}
+
+		const Aabb& aabb = ctx.m_decalAabbs[i];
+		computeAabbDepths(aabb.getMin().xyz(), aabb.getMax().xyz(), minDepth, maxDepth);
+		computeCoarseBounds(ctx, ConstWeakArray<Vec3>(points), minDepth, maxDepth, ctx.m_coarseBounds[4][i]);
+	}
+
+	for(U32 i = 0; i < rqueue.m_fogDensityVolumes.getSize(); ++i)
+	{
+		const ClusterBinAabbBatch& batch = ctx.m_fogVolumeBatches[i / CLUSTER_BIN_BATCH_SIZE];
+		const U32 lane = i % CLUSTER_BIN_BATCH_SIZE;
+		const Vec3 aabbMin(batch.m_minX[lane], batch.m_minY[lane], batch.m_minZ[lane]);
+		const Vec3 aabbMax(batch.m_maxX[lane], batch.m_maxY[lane], batch.m_maxZ[lane]);
+		getAabbCorners(aabbMin, aabbMax, points);
+		computeAabbDepths(aabbMin, aabbMax, minDepth, maxDepth);
+		computeCoarseBounds(ctx, ConstWeakArray<Vec3>(points), minDepth, maxDepth, ctx.m_coarseBounds[5][i]);
+	}
+
+	// Build the candidate lists of the tiles. The candidates are sorted by index to keep the order of the objects
+	for(U32 typeIdx = 0; typeIdx < TYPED_OBJECT_COUNT; ++typeIdx)
+	{
+		const WeakArray<CoarseBounds> bounds = ctx.m_coarseBounds[typeIdx];
+		WeakArray<U32>& offsets = ctx.m_tileCandidateOffsets[typeIdx];
+		offsets = WeakArray<U32>(alloc.newArray<U32>(tileCount + 1, 0), tileCount + 1);
+
+		// Count the candidates of each tile
+		for(const CoarseBounds& b : bounds)
+		{
+			if(!b.m_visible)
+			{
+				continue;
+			}
+
+			for(U32 tileY = b.m_firstTile[1]; tileY <= b.m_lastTile[1]; ++tileY)
+			{
+				for(U32 tileX = b.m_firstTile[0]; tileX <= b.m_lastTile[0]; ++tileX)
+				{
+					++offsets[tileY * m_clusterCounts[0] + tileX + 1];
+				}
+			}
+		}
+
+		for(U32 tileIdx = 0; tileIdx < tileCount; ++tileIdx)
+		{
+			offsets[tileIdx + 1] += offsets[tileIdx];
+		}
+
+		const U32 candidateCount = offsets[tileCount];
+		if(candidateCount == 0)
+		{
+			continue;
+		}
+
+		// Write the candidates
+		WeakArray<U32>& candidates = ctx.m_tileCandidates[typeIdx];
+		candidates = WeakArray<U32>(alloc.newArray<U32>(candidateCount), candidateCount);
+		WeakArray<U32> tileCandidateCounts(alloc.newArray<U32>(tileCount, 0), tileCount);
+		for(U32 objectIdx = 0; objectIdx < bounds.getSize(); ++objectIdx)
+		{
+			const CoarseBounds& b = bounds[objectIdx];
+			if(!b.m_visible)
+			{
+				continue;
+			}
+
+			for(U32 tileY = b.m_firstTile[1]; tileY <= b.m_lastTile[1]; ++tileY)
+			{
+				for(U32 tileX = b.m_firstTile[0]; tileX <= b.m_lastTile[0]; ++tileX)
+				{
+					const U32 tileIdx = tileY * m_clusterCounts[0] + tileX;
+					candidates[offsets[tileIdx] + tileCandidateCounts[tileIdx]++] = objectIdx;
+				}
+			}
+		}
+	}
+}
+
+void ClusterBin::computeCoarseBounds(
+	const BinCtx& ctx, ConstWeakArray<Vec3> points, F32 minDepth, F32 maxDepth, CoarseBounds& bounds) const
+{
+	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
+
+	// The bounds need to be conservative because the tile frustums and the cluster AABBs are computed differently.
+	// Expand them a bit
+	const F32 tileMargin = 0.01f;
+	const F32 depthMargin = (rqueue.m_cameraFar + rqueue.m_cameraTransform.getTranslationPart().xyz().getLength())
+							* 0.0001f;
+
+	bounds.m_visible = false;
+
+	// Project the points to NDC. If some of them are behind the eye the projection is wrong so cover the whole screen
+	Vec2 ndcMin(MAX_F32);
+	Vec2 ndcMax(MIN_F32);
+	for(const Vec3& point : points)
+	{
+		const Vec4 clip = rqueue.m_viewProjectionMatrix * point.xyz1();
+		if(clip.w() <= EPSILON)
+		{
+			ndcMin = Vec2(-1.0f);
+			ndcMax = Vec2(1.0f);
+			break;
+		}
+
+		const Vec2 ndc = clip.xy() / clip.w();
+		ndcMin = ndcMin.min(ndc);
+		ndcMax = ndcMax.max(ndc);
+	}
+
+	// NDC to tiles
+	for(U32 i = 0; i < 2; ++i)
+	{
+		const F32 tileCount = F32(m_clusterCounts[i]);
+		const F32 firstTile = floor((ndcMin[i] * 0.5f + 0.5f) * tileCount - tileMargin);
+		const F32 lastTile = floor((ndcMax[i] * 0.5f + 0.5f) * tileCount + tileMargin);
+		if(lastTile < 0.0f || firstTile >= tileCount)
+		{
+			return;
+		}
+
+		bounds.m_firstTile[i] = U16(max(firstTile, 0.0f));
+		bounds.m_lastTile[i] = U16(min(lastTile, tileCount - 1.0f));
+	}
+
+	// Find the Z slices that overlap with the depth range
+	U32 firstClusterZ = MAX_U32;
+	U32 lastClusterZ = 0;
+	for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
+	{
+		const Vec2& range = ctx.m_clusterDepthRanges[clusterZ];
+		if(range.y() >= minDepth - depthMargin && range.x() <= maxDepth + depthMargin)
+		{
+			firstClusterZ = min(firstClusterZ, clusterZ);
+			lastClusterZ = clusterZ;
+		}
+	}
+
+	if(firstClusterZ == MAX_U32)
+	{
+		return;
+	}
+
+	bounds.m_firstClusterZ = U16(firstClusterZ);
+	bounds.m_lastClusterZ = U16(lastClusterZ);
+	bounds.m_visible = true;
+}
+
 void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 {
 	ANKI_ASSERT(tileIdx < m_clusterCounts[0] * m_clusterCounts[1]);
@@ -313,8 +955,6 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 		clusterEdgesWSpace[lastQuartet + 0]);
 
 	// Compute the cluster AABBs and spheres
-	DynamicArrayAuto<Aabb>& clusterBoxes = tileCtx.m_clusterBoxes;
-	DynamicArrayAuto<Sphere>& clusterSpheres = tileCtx.m_clusterSpheres;
 	for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
 	{
 		// Compute an AABB and a sphere that contains the cluster
@@ -326,215 +966,123 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 			aabbMax = aabbMax.max(clusterEdgesWSpace[clusterZ * 4 + i]);
 		}
 
-		clusterBoxes[clusterZ] = Aabb(aabbMin, aabbMax);
+		const U32 batch = clusterZ / CLUSTER_BIN_BATCH_SIZE;
+		const U32 lane = clusterZ % CLUSTER_BIN_BATCH_SIZE;
+		tileCtx.m_clusterBoxBatches[batch].set(lane, aabbMin.xyz(), aabbMax.xyz());
 
 		const Vec4 sphereCenter = (aabbMin + aabbMax) / 2.0f;
-		clusterSpheres[clusterZ] = Sphere(sphereCenter, (aabbMin - sphereCenter).getLength());
+		tileCtx.m_clusterSphereBatches[batch].set(lane, sphereCenter.xyz(), (aabbMin - sphereCenter).getLength());
 	}
 
 	// Zero the infos
 	memset(&tileCtx.m_clusterInfos[0], 0, tileCtx.m_clusterInfos.getSizeInBytes());
 
-#define ANKI_SET_IDX(typeIdx) \
-	ClusterBin::TileCtx::ClusterMetaInfo& inf = tileCtx.m_clusterInfos[clusterZ]; \
-	if(ANKI_UNLIKELY(U32(inf.m_offset) + 1 >= m_avgObjectsPerCluster)) \
-	{ \
-		ANKI_R_LOGW("Out of cluster indices. Increase r_avgObjectsPerCluster"); \
-		continue; \
-	} \
-	tileCtx.getClusterIndices(clusterZ)[inf.m_offset++] = i; \
-	++inf.m_counts[typeIdx]; \
-	ANKI_ASSERT(inf.m_counts[typeIdx] <= m_avgObjectsPerCluster)
+	const ConstWeakArray<Plane> planes(&frustumPlanes[0], frustumPlanes.getSize());
+	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
+	const U32 clusterCountZ = m_clusterCounts[2];
+	const U32 maxObjectsPerCluster = m_avgObjectsPerCluster;
+	const WeakArray<ClusterBinAabbBatch> clusterBoxes(tileCtx.m_clusterBoxBatches);
+	const WeakArray<ClusterBinSphereBatch> clusterSpheres(tileCtx.m_clusterSphereBatches);
 
 	// Point lights
-	{
-		Sphere lightSphere;
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_pointLights.getSize(); ++i)
-		{
-			const PointLightQueueElement& plight = ctx.m_in->m_renderQueue->m_pointLights[i];
-			lightSphere.setCenter(plight.m_worldPosition.xyz0());
-			lightSphere.setRadius(plight.m_radius);
-
-			if(!insideClusterFrustum(frustumPlanes, lightSphere))
-			{
-				continue;
-			}
-
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
-				if(!testCollision(lightSphere, clusterBoxes[clusterZ]))
-				{
-					continue;
-				}
-
-				ANKI_SET_IDX(0);
-			}
-		}
-	}
+	ctx.iterateTileObjects(0, tileIdx, planes, ctx.m_pointLightBatches, rqueue.m_pointLights.getSize(), [&](U32 i) {
+		const PointLightQueueElement& plight = rqueue.m_pointLights[i];
+		U32 firstClusterZ, lastClusterZ;
+		ctx.getClusterZRange(0, i, firstClusterZ, lastClusterZ);
+		const U32 shaderIdx = ctx.getObjectShaderIndex(0, i);
+		iterateCollidingClusters(
+			clusterCountZ,
+			firstClusterZ,
+			lastClusterZ,
+			[&](U32 batch) {
+				return clusterBinTestCollision(plight.m_worldPosition, plight.m_radius, clusterBoxes[batch]);
+			},
+			[&](U32 clusterZ) { tileCtx.addObject(clusterZ, 0, shaderIdx, maxObjectsPerCluster); });
+	});
 
 	// Spot lights
-	{
-		Array<Vec4, 5> lightEdges;
-		lightEdges[0] = Vec4(0.0f); // Eye
-		ConvexHullShape spotLightShape(&lightEdges[0], lightEdges.getSize());
-
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_spotLights.getSize(); ++i)
-		{
-			const SpotLightQueueElement& slight = ctx.m_in->m_renderQueue->m_spotLights[i];
-
-			computeEdgesOfFrustum(slight.m_distance, slight.m_outerAngle, slight.m_outerAngle, &lightEdges[1]);
-			spotLightShape.setTransform(Transform(slight.m_worldTransform));
-
-			if(!insideClusterFrustum(frustumPlanes, spotLightShape))
-			{
-				continue;
-			}
-
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
-				if(!testCollision(clusterSpheres[clusterZ],
-					   Cone(slight.m_worldTransform.getTranslationPart().xyz0(),
-						   -slight.m_worldTransform.getZAxis(),
-						   slight.m_distance,
-						   slight.m_outerAngle)))
-				{
-					continue;
-				}
-
-				ANKI_SET_IDX(1);
-			}
-		}
-	}
+	ctx.iterateTileObjects(1, tileIdx, planes, ctx.m_spotLightHullBatches, rqueue.m_spotLights.getSize(), [&](U32 i) {
+		const ClusterBinCone& cone = ctx.m_spotLightCones[i];
+		U32 firstClusterZ, lastClusterZ;
+		ctx.getClusterZRange(1, i, firstClusterZ, lastClusterZ);
+		const U32 shaderIdx = ctx.getObjectShaderIndex(1, i);
+		iterateCollidingClusters(
+			clusterCountZ,
+			firstClusterZ,
+			lastClusterZ,
+			[&](U32 batch) { return clusterBinTestCollision(cone, clusterSpheres[batch]); },
+			[&](U32 clusterZ) { tileCtx.addObject(clusterZ, 1, shaderIdx, maxObjectsPerCluster); });
+	});
 
 	// Probes
-	{
-		Aabb probeBox;
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_reflectionProbes.getSize(); ++i)
-		{
-			const ReflectionProbeQueueElement& probe = ctx.m_in->m_renderQueue->m_reflectionProbes[i];
-			probeBox.setMin(probe.m_aabbMin);
-			probeBox.setMax(probe.m_aabbMax);
-
-			if(!insideClusterFrustum(frustumPlanes, probeBox))
-			{
-				continue;
-			}
-
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
-				if(!testCollision(probeBox, clusterBoxes[clusterZ]))
-				{
-					continue;
-				}
-
-				ANKI_SET_IDX(2);
-			}
-		}
-	}
+	ctx.iterateTileObjects(2, tileIdx, planes, ctx.m_probeBatches, rqueue.m_reflectionProbes.getSize(), [&](U32 i) {
+		const ReflectionProbeQueueElement& probe = rqueue.m_reflectionProbes[i];
+		U32 firstClusterZ, lastClusterZ;
+		ctx.getClusterZRange(2, i, firstClusterZ, lastClusterZ);
+		const U32 shaderIdx = ctx.getObjectShaderIndex(2, i);
+		iterateCollidingClusters(
+			clusterCountZ,
+			firstClusterZ,
+			lastClusterZ,
+			[&](U32 batch) { return clusterBinTestCollision(probe.m_aabbMin, probe.m_aabbMax, clusterBoxes[batch]); },
+			[&](U32 clusterZ) { tileCtx.addObject(clusterZ, 2, shaderIdx, maxObjectsPerCluster); });
+	});
 
 	// GI probes
-	{
-		Aabb probeBox;
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_giProbes.getSize(); ++i)
-		{
-			const GlobalIlluminationProbeQueueElement& probe = ctx.m_in->m_renderQueue->m_giProbes[i];
-			probeBox.setMin(probe.m_aabbMin);
-			probeBox.setMax(probe.m_aabbMax);
-
-			if(!insideClusterFrustum(frustumPlanes, probeBox))
-			{
-				continue;
-			}
-
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
-				if(!testCollision(probeBox, clusterBoxes[clusterZ]))
-				{
-					continue;
-				}
-
-				ANKI_SET_IDX(3);
-			}
-		}
-	}
-
-	// Decals
-	{
-		Obb decalBox;
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_decals.getSize(); ++i)
-		{
-			const DecalQueueElement& decal = ctx.m_in->m_renderQueue->m_decals[i];
-			decalBox.setCenter(decal.m_obbCenter.xyz0());
-			decalBox.setRotation(Mat3x4(decal.m_obbRotation));
-			decalBox.setExtend(decal.m_obbExtend.xyz0());
-
-			if(!insideClusterFrustum(frustumPlanes, decalBox))
-			{
-				continue;
-			}
-
-			for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-			{
-				if(!testCollision(decalBox, clusterBoxes[clusterZ]))
+	ctx.iterateTileObjects(3, tileIdx, planes, ctx.m_giProbeBatches, rqueue.m_giProbes.getSize(), [&](U32 i) {
+		const GlobalIlluminationProbeQueueElement& probe = rqueue.m_giProbes[i];
+		U32 firstClusterZ, lastClusterZ;
+		ctx.getClusterZRange(3, i, firstClusterZ, lastClusterZ);
+		const U32 shaderIdx = ctx.getObjectShaderIndex(3, i);
+		iterateCollidingClusters(
+			clusterCountZ,
+			firstClusterZ,
+			lastClusterZ,
+			[&](U32 batch) { return clusterBinTestCollision(probe.m_aabbMin, probe.m_aabbMax, clusterBoxes[batch]); },
+			[&](U32 clusterZ) { tileCtx.addObject(clusterZ, 3, shaderIdx, maxObjectsPerCluster); });
+	});
+
+	// Decals. Use the AABB of the OBB for a quick rejection and then do the precise test
+	ctx.iterateTileObjects(4, tileIdx, planes, ctx.m_decalBatches, rqueue.m_decals.getSize(), [&](U32 i) {
+		const Obb& decalBox = ctx.m_decalObbs[i];
+		const Aabb& decalAabb = ctx.m_decalAabbs[i];
+		U32 firstClusterZ, lastClusterZ;
+		ctx.getClusterZRange(4, i, firstClusterZ, lastClusterZ);
+		const U32 shaderIdx = ctx.getObjectShaderIndex(4, i);
+		iterateCollidingClusters(
+			clusterCountZ,
+			firstClusterZ,
+			lastClusterZ,
+			[&](U32 batch) {
+				return clusterBinTestCollision(decalAabb.getMin().xyz(), decalAabb.getMax().xyz(), clusterBoxes[batch]);
+			},
+			[&](U32 clusterZ) {
+				if(testCollision(decalBox, tileCtx.getClusterBox(clusterZ)))
 				{
-					continue;
+					tileCtx.addObject(clusterZ, 4, shaderIdx, maxObjectsPerCluster);
 				}
-
-				ANKI_SET_IDX(4);
-			}
-		}
-	}
+			});
+	});
 
 	// Fog volumes
-	{
-		for(U32 i = 0; i < ctx.m_in->m_renderQueue->m_fogDensityVolumes.getSize(); ++i)
-		{
-			const FogDensityQueueElement& fogVol = ctx.m_in->m_renderQueue->m_fogDensityVolumes[i];
-
-			if(fogVol.m_isBox)
-			{
-				Aabb box;
-				box.setMin(fogVol.m_aabbMin);
-				box.setMax(fogVol.m_aabbMax);
-
-				if(!insideClusterFrustum(frustumPlanes, box))
-				{
-					continue;
-				}
-
-				for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-				{
-					if(!testCollision(box, clusterBoxes[clusterZ]))
-					{
-						continue;
-					}
-
-					ANKI_SET_IDX(5);
-				}
-			}
-			else
-			{
-				Sphere sphere;
-				sphere.setCenter(fogVol.m_sphereCenter.xyz0());
-				sphere.setRadius(fogVol.m_sphereRadius);
-
-				if(!insideClusterFrustum(frustumPlanes, sphere))
-				{
-					continue;
-				}
-
-				for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
-				{
-					if(!testCollision(sphere, clusterBoxes[clusterZ]))
-					{
-						continue;
-					}
-
-					ANKI_SET_IDX(5);
-				}
-			}
-		}
-	}
+	ctx.iterateTileObjects(
+		5, tileIdx, planes, ctx.m_fogVolumeBatches, rqueue.m_fogDensityVolumes.getSize(), [&](U32 i) {
+			const FogDensityQueueElement& fogVol = rqueue.m_fogDensityVolumes[i];
+			U32 firstClusterZ, lastClusterZ;
+			ctx.getClusterZRange(5, i, firstClusterZ, lastClusterZ);
+			const U32 shaderIdx = ctx.getObjectShaderIndex(5, i);
+			iterateCollidingClusters(
+				clusterCountZ,
+				firstClusterZ,
+				lastClusterZ,
+				[&](U32 batch) {
+					const ClusterBinAabbBatch& clusters = clusterBoxes[batch];
+					return (fogVol.m_isBox)
+							   ? clusterBinTestCollision(fogVol.m_aabbMin, fogVol.m_aabbMax, clusters)
+							   : clusterBinTestCollision(fogVol.m_sphereCenter, fogVol.m_sphereRadius, clusters);
+				},
+				[&](U32 clusterZ) { tileCtx.addObject(clusterZ, 5, shaderIdx, maxObjectsPerCluster); });
+		});
 
 	// Upload the indices for all clusters of the tile
 	for(U32 clusterZ = 0; clusterZ < m_clusterCounts[2]; ++clusterZ)
@@ -583,23 +1131,44 @@ void ClusterBin::binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx)
 	}
 }
 
-void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
+void ClusterBin::acquireSlots(BinCtx& ctx)
 {
 	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
+	StackAllocator<U8>& alloc = ctx.m_in->m_tempAlloc;
+	Bool outOfSlots = false;
 
-	// Write the point lights
-	const U32 visiblePointLightCount = rqueue.m_pointLights.getSize();
-	if(visiblePointLightCount)
+	acquireObjectSlots(m_pointLightBuffer, rqueue.m_pointLights, alloc, ctx.m_objectSlots[0], outOfSlots);
+	acquireObjectSlots(m_spotLightBuffer, rqueue.m_spotLights, alloc, ctx.m_objectSlots[1], outOfSlots);
+	acquireObjectSlots(m_reflectionProbeBuffer, rqueue.m_reflectionProbes, alloc, ctx.m_objectSlots[2], outOfSlots);
+	acquireObjectSlots(m_decalBuffer, rqueue.m_decals, alloc, ctx.m_objectSlots[4], outOfSlots);
+	acquireObjectSlots(m_fogVolumeBuffer, rqueue.m_fogDensityVolumes, alloc, ctx.m_objectSlots[5], outOfSlots);
+
+	if(ANKI_UNLIKELY(outOfSlots))
 	{
-		PointLight* data = static_cast<PointLight*>(ctx.m_in->m_stagingMem->allocateFrame(
-			sizeof(PointLight) * visiblePointLightCount, StagingGpuMemoryType::UNIFORM, ctx.m_out->m_pointLightsToken));
+		ANKI_R_LOGW("Too many visible lights, probes, decals or fog volumes. Some will be ignored");
+	}
+}
 
-		WeakArray<PointLight> gpuLights(data, visiblePointLightCount);
+void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx)
+{
+	const RenderQueue& rqueue = *ctx.m_in->m_renderQueue;
 
+	// Write the point lights. The persistent buffers compare the objects with their previous contents so zero the
+	// objects to avoid garbage in the padding
+	const U32 visiblePointLightCount = rqueue.m_pointLights.getSize();
+	if(visiblePointLightCount)
+	{
 		for(U32 i = 0; i < visiblePointLightCount; ++i)
 		{
+			const U32 slot = ctx.m_objectSlots[0][i];
+			if(slot == MAX_U32)
+			{
+				continue;
+			}
+
 			const PointLightQueueElement& in = rqueue.m_pointLights[i];
-			PointLight& out = gpuLights[i];
+			PointLight out;
+			zeroMemory(out);
 
 			out.m_position = in.m_worldPosition;
 			out.m_squareRadiusOverOne = 1.0f / (in.m_radius * in.m_radius);
@@ -619,7 +1188,11 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 			}
 
 			out.m_radius = in.m_radius;
+
+			m_pointLightBuffer.writeSlot(slot, &out);
 		}
+
+		m_pointLightBuffer.getToken(ctx.m_out->m_pointLightsToken);
 	}
 	else
 	{
@@ -630,15 +1203,17 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 	const U32 visibleSpotLightCount = rqueue.m_spotLights.getSize();
 	if(visibleSpotLightCount)
 	{
-		SpotLight* data = static_cast<SpotLight*>(ctx.m_in->m_stagingMem->allocateFrame(
-			sizeof(SpotLight) * visibleSpotLightCount, StagingGpuMemoryType::UNIFORM, ctx.m_out->m_spotLightsToken));
-
-		WeakArray<SpotLight> gpuLights(data, visibleSpotLightCount);
-
 		for(U32 i = 0; i < visibleSpotLightCount; ++i)
 		{
+			const U32 slot = ctx.m_objectSlots[1][i];
+			if(slot == MAX_U32)
+			{
+				continue;
+			}
+
 			const SpotLightQueueElement& in = rqueue.m_spotLights[i];
-			SpotLight& out = gpuLights[i];
+			SpotLight out;
+			zeroMemory(out);
 
 			F32 shadowmapIndex = INVALID_TEXTURE_INDEX;
 
@@ -666,7 +1241,11 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 			// Angles
 			out.m_outerCos = cos(in.m_outerAngle / 2.0f);
 			out.m_innerCos = cos(in.m_innerAngle / 2.0f);
+
+			m_spotLightBuffer.writeSlot(slot, &out);
 		}
+
+		m_spotLightBuffer.getToken(ctx.m_out->m_spotLightsToken);
 	}
 	else
 	{
@@ -677,17 +1256,12 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 	const U32 visibleDecalCount = rqueue.m_decals.getSize();
 	if(visibleDecalCount)
 	{
-		Decal* data = static_cast<Decal*>(ctx.m_in->m_stagingMem->allocateFrame(
-			sizeof(Decal) * visibleDecalCount, StagingGpuMemoryType::UNIFORM, ctx.m_out->m_decalsToken));
-
-		WeakArray<Decal> gpuDecals(data, visibleDecalCount);
 		TextureView* diffuseAtlas = nullptr;
 		TextureView* specularRoughnessAtlas = nullptr;
 
 		for(U32 i = 0; i < visibleDecalCount; ++i)
 		{
 			const DecalQueueElement& in = rqueue.m_decals[i];
-			Decal& out = gpuDecals[i];
 
 			if((diffuseAtlas != nullptr && diffuseAtlas != in.m_diffuseAtlas)
 				|| (specularRoughnessAtlas != nullptr && specularRoughnessAtlas != in.m_specularRoughnessAtlas))
@@ -698,6 +1272,15 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 			diffuseAtlas = in.m_diffuseAtlas;
 			specularRoughnessAtlas = in.m_specularRoughnessAtlas;
 
+			const U32 slot = ctx.m_objectSlots[4][i];
+			if(slot == MAX_U32)
+			{
+				continue;
+			}
+
+			Decal out;
+			zeroMemory(out);
+
 			// Diff
 			Vec4 uv = in.m_diffuseAtlasUv;
 			out.m_diffUv = Vec4(uv.x(), uv.y(), uv.z() - uv.x(), uv.w() - uv.y());
@@ -710,11 +1293,14 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 
 			// bias * proj_l * view
 			out.m_texProjectionMat = in.m_textureMatrix;
+
+			m_decalBuffer.writeSlot(slot, &out);
 		}
 
 		ANKI_ASSERT(diffuseAtlas || specularRoughnessAtlas);
 		ctx.m_out->m_diffDecalTexView.reset(diffuseAtlas);
 		ctx.m_out->m_specularRoughnessDecalTexView.reset(specularRoughnessAtlas);
+		m_decalBuffer.getToken(ctx.m_out->m_decalsToken);
 	}
 	else
 	{
@@ -725,23 +1311,27 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 	const U32 visibleProbeCount = rqueue.m_reflectionProbes.getSize();
 	if(visibleProbeCount)
 	{
-		ReflectionProbe* data = static_cast<ReflectionProbe*>(
-			ctx.m_in->m_stagingMem->allocateFrame(sizeof(ReflectionProbe) * visibleProbeCount,
-				StagingGpuMemoryType::UNIFORM,
-				ctx.m_out->m_reflectionProbesToken));
-
-		WeakArray<ReflectionProbe> gpuProbes(data, visibleProbeCount);
-
 		for(U32 i = 0; i < visibleProbeCount; ++i)
 		{
+			const U32 slot = ctx.m_objectSlots[2][i];
+			if(slot == MAX_U32)
+			{
+				continue;
+			}
+
 			const ReflectionProbeQueueElement& in = rqueue.m_reflectionProbes[i];
-			ReflectionProbe& out = gpuProbes[i];
+			ReflectionProbe out;
+			zeroMemory(out);
 
 			out.m_position = in.m_worldPosition;
 			out.m_cubemapIndex = F32(in.m_textureArrayIndex);
 			out.m_aabbMin = in.m_aabbMin;
 			out.m_aabbMax = in.m_aabbMax;
+
+			m_reflectionProbeBuffer.writeSlot(slot, &out);
 		}
+
+		m_reflectionProbeBuffer.getToken(ctx.m_out->m_reflectionProbesToken);
 	}
 	else
 	{
@@ -752,17 +1342,17 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 	const U32 visibleFogVolumeCount = rqueue.m_fogDensityVolumes.getSize();
 	if(visibleFogVolumeCount)
 	{
-		FogDensityVolume* data = static_cast<FogDensityVolume*>(
-			ctx.m_in->m_stagingMem->allocateFrame(sizeof(FogDensityVolume) * visibleFogVolumeCount,
-				StagingGpuMemoryType::UNIFORM,
-				ctx.m_out->m_fogDensityVolumesToken));
-
-		WeakArray<FogDensityVolume> gpuFogVolumes(data, visibleFogVolumeCount);
-
 		for(U32 i = 0; i < visibleFogVolumeCount; ++i)
 		{
+			const U32 slot = ctx.m_objectSlots[5][i];
+			if(slot == MAX_U32)
+			{
+				continue;
+			}
+
 			const FogDensityQueueElement& in = rqueue.m_fogDensityVolumes[i];
-			FogDensityVolume& out = gpuFogVolumes[i];
+			FogDensityVolume out;
+			zeroMemory(out);
 
 			out.m_density = in.m_density;
 			if(in.m_isBox)
@@ -777,14 +1367,23 @@ void ClusterBin::writeTypedObjectsToGpuBuffers(BinCtx& ctx) const
 				out.m_aabbMinOrSphereCenter = in.m_sphereCenter;
 				out.m_aabbMaxOrSphereRadiusSquared = Vec3(in.m_sphereRadius * in.m_sphereRadius);
 			}
+
+			m_fogVolumeBuffer.writeSlot(slot, &out);
 		}
+
+		m_fogVolumeBuffer.getToken(ctx.m_out->m_fogDensityVolumesToken);
 	}
 	else
 	{
 		ctx.m_out->m_fogDensityVolumesToken.markUnused();
 	}
 
-	// Write the probes
+	ANKI_TRACE_INC_COUNTER(R_PERSISTENT_OBJECT_WRITES,
+		m_pointLightBuffer.getWrittenSlotCount() + m_spotLightBuffer.getWrittenSlotCount()
+			+ m_reflectionProbeBuffer.getWrittenSlotCount() + m_decalBuffer.getWrittenSlotCount()
+			+ m_fogVolumeBuffer.getWrittenSlotCount());
+
+	// Write the GI probes. They are not persistent because the texture indices change every frame
 	const U32 visibleGiProbeCount = rqueue.m_giProbes.getSize();
 	if(visibleGiProbeCount)
 	{
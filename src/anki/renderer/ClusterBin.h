@@ -6,6 +6,7 @@
 #pragma once
 
 #include <anki/renderer/Common.h>
+#include <anki/renderer/PersistentGpuObjectBuffer.h>
 #include <shaders/glsl_cpp_common/ClusteredShading.h>
 
 namespace anki
@@ -57,13 +58,42 @@ class ClusterBin
 public:
 	~ClusterBin();
 
-	void init(HeapAllocator<U8> alloc, U32 clusterCountX, U32 clusterCountY, U32 clusterCountZ, const ConfigSet& cfg);
-
+	/// Initialize.
+	/// @param gr If it's nullptr the persistent object buffers live in CPU memory. Useful for testing.
+	void init(HeapAllocator<U8> alloc,
+		GrManager* gr,
+		U32 clusterCountX,
+		U32 clusterCountY,
+		U32 clusterCountZ,
+		const ConfigSet& cfg);
+
+	/// Bin the objects and write the typed objects. The point lights, spot lights, reflection probes, decals and fog
+	/// volumes are kept in persistent buffers so the indices of the clusters point to the slots of those buffers.
 	void bin(ClusterBinIn& in, ClusterBinOut& out);
 
+	/// Same as bin() but it writes the clusters and the indices to CPU memory and it doesn't write the GPU buffers of
+	/// the typed objects. The indices of the clusters point to the objects of the RenderQueue.
+	/// ClusterBinIn::m_stagingMem is not used. Useful for testing and benchmarking.
+	/// @param[out] clusters It should have getTotalClusterCount() elements.
+	/// @param[out] indices It should have getIndexCount() elements.
+	/// @param[out] magicValues The magic values the shaders use to find the cluster.
+	void binToCpuMemory(
+		ClusterBinIn& in, WeakArray<U32> clusters, WeakArray<U32> indices, ClustererMagicValues& magicValues);
+
+	U32 getTotalClusterCount() const
+	{
+		return m_totalClusterCount;
+	}
+
+	U32 getIndexCount() const
+	{
+		return m_indexCount;
+	}
+
 private:
 	class BinCtx;
 	class TileCtx;
+	class CoarseBounds;
 
 	HeapAllocator<U8> m_alloc;
 
@@ -71,15 +101,40 @@ private:
 	U32 m_totalClusterCount = 0;
 	U32 m_indexCount = 0;
 	U32 m_avgObjectsPerCluster = 0;
+	Bool m_hierarchical = true; ///< Bin to coarse tiles first and then bin only the candidates of each tile.
 
 	DynamicArray<Vec4> m_clusterEdges; ///< Cache those for opt. [tileCount][K+1][4]
 	Vec4 m_prevUnprojParams = Vec4(0.0f); ///< To check if m_tiles is dirty.
 
+	/// @name Persistent buffers of the typed objects
+	/// @{
+	PersistentGpuObjectBuffer m_pointLightBuffer;
+	PersistentGpuObjectBuffer m_spotLightBuffer;
+	PersistentGpuObjectBuffer m_reflectionProbeBuffer;
+	PersistentGpuObjectBuffer m_decalBuffer;
+	PersistentGpuObjectBuffer m_fogVolumeBuffer;
+	/// @}
+
+	void binInternal(
+		ClusterBinIn& in, ClusterBinOut& out, WeakArray<U32> clusters, WeakArray<U32> indices, Bool writeTypedObjects);
+
 	void prepare(BinCtx& ctx);
 
+	/// Pack the bounds of the objects in batches for the binning kernels.
+	void prepareObjects(BinCtx& ctx);
+
+	/// Find the tiles and the Z slices each object may touch and build the per tile lists of candidate objects.
+	void coarseBin(BinCtx& ctx);
+
+	void computeCoarseBounds(
+		const BinCtx& ctx, ConstWeakArray<Vec3> points, F32 minDepth, F32 maxDepth, CoarseBounds& bounds) const;
+
 	void binTile(U32 tileIdx, BinCtx& ctx, TileCtx& tileCtx);
 
-	void writeTypedObjectsToGpuBuffers(BinCtx& ctx) const;
+	/// Find the slots of the objects in the persistent buffers.
+	void acquireSlots(BinCtx& ctx);
+
+	void writeTypedObjectsToGpuBuffers(BinCtx& ctx);
 };
 /// @}
 
@@ -0,0 +1,285 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/ClusterBinKernels.h>
+
+namespace anki
+{
+
+#if ANKI_SIMD_SSE
+/// Compute the signed distance of 4 points from a plane.
+static ANKI_FORCE_INLINE __m128 planeDistance(const Plane& plane, __m128 x, __m128 y, __m128 z)
+{
+	const Vec4& n = plane.getNormal();
+	__m128 dist = _mm_mul_ps(_mm_set1_ps(n.x()), x);
+	dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(n.y()), y));
+	dist = _mm_add_ps(dist, _mm_mul_ps(_mm_set1_ps(n.z()), z));
+	return _mm_sub_ps(dist, _mm_set1_ps(plane.getOffset()));
+}
+
+static ANKI_FORCE_INLINE __m128 absolute(__m128 x)
+{
+	return _mm_andnot_ps(_mm_set1_ps(-0.0f), x);
+}
+#endif
+
+static ANKI_FORCE_INLINE F32 planeDistance(const Plane& plane, F32 x, F32 y, F32 z)
+{
+	const Vec4& n = plane.getNormal();
+	return n.x() * x + n.y() * y + n.z() * z - plane.getOffset();
+}
+
+U32 clusterBinTestPlanes(ConstWeakArray<Plane> planes, const ClusterBinSphereBatch& spheres)
+{
+#if ANKI_SIMD_SSE
+	const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), spheres.m_radius.getSimd());
+	U32 mask = computeClusterBinLaneMask(CLUSTER_BIN_BATCH_SIZE);
+	for(const Plane& plane : planes)
+	{
+		const __m128 dist =
+			planeDistance(plane, spheres.m_centerX.getSimd(), spheres.m_centerY.getSimd(), spheres.m_centerZ.getSimd());
+		mask &= U32(_mm_movemask_ps(_mm_cmpge_ps(dist, negRadius)));
+	}
+
+	return mask;
+#else
+	U32 mask = 0;
+	for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+	{
+		Bool inside = true;
+		for(const Plane& plane : planes)
+		{
+			const F32 dist =
+				planeDistance(plane, spheres.m_centerX[lane], spheres.m_centerY[lane], spheres.m_centerZ[lane]);
+			inside = inside && dist >= -spheres.m_radius[lane];
+		}
+
+		mask |= U32(inside) << lane;
+	}
+
+	return mask;
+#endif
+}
+
+U32 clusterBinTestPlanes(ConstWeakArray<Plane> planes, const ClusterBinAabbBatch& aabbs)
+{
+	// The box is behind the plane if the corner that is furthest along the normal is behind it. The plane is the same
+	// for all lanes so the corner selection doesn't need masking
+	U32 mask = computeClusterBinLaneMask(CLUSTER_BIN_BATCH_SIZE);
+	for(const Plane& plane : planes)
+	{
+		const Vec4& n = plane.getNormal();
+		const Vec4& x = (n.x() >= 0.0f) ? aabbs.m_maxX : aabbs.m_minX;
+		const Vec4& y = (n.y() >= 0.0f) ? aabbs.m_maxY : aabbs.m_minY;
+		const Vec4& z = (n.z() >= 0.0f) ? aabbs.m_maxZ : aabbs.m_minZ;
+
+#if ANKI_SIMD_SSE
+		const __m128 dist = planeDistance(plane, x.getSimd(), y.getSimd(), z.getSimd());
+		mask &= U32(_mm_movemask_ps(_mm_cmpge_ps(dist, _mm_setzero_ps())));
+#else
+		for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+		{
+			if(planeDistance(plane, x[lane], y[lane], z[lane]) < 0.0f)
+			{
+				mask &= ~(1u << lane);
+			}
+		}
+#endif
+	}
+
+	return mask;
+}
+
+U32 clusterBinTestPlanes(ConstWeakArray<Plane> planes, const ClusterBinSpotLightHullBatch& hulls)
+{
+	// The hull is behind the plane if all of its points are behind it
+	U32 mask = computeClusterBinLaneMask(CLUSTER_BIN_BATCH_SIZE);
+	for(const Plane& plane : planes)
+	{
+#if ANKI_SIMD_SSE
+		__m128 maxDist = _mm_set1_ps(MIN_F32);
+		for(U32 i = 0; i < ClusterBinSpotLightHullBatch::POINT_COUNT; ++i)
+		{
+			const __m128 dist = planeDistance(
+				plane, hulls.m_pointX[i].getSimd(), hulls.m_pointY[i].getSimd(), hulls.m_pointZ[i].getSimd());
+			maxDist = _mm_max_ps(maxDist, dist);
+		}
+
+		mask &= U32(_mm_movemask_ps(_mm_cmpge_ps(maxDist, _mm_setzero_ps())));
+#else
+		for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+		{
+			F32 maxDist = MIN_F32;
+			for(U32 i = 0; i < ClusterBinSpotLightHullBatch::POINT_COUNT; ++i)
+			{
+				maxDist = max(
+					maxDist,
+					planeDistance(plane, hulls.m_pointX[i][lane], hulls.m_pointY[i][lane], hulls.m_pointZ[i][lane]));
+			}
+
+			if(maxDist < 0.0f)
+			{
+				mask &= ~(1u << lane);
+			}
+		}
+#endif
+	}
+
+	return mask;
+}
+
+U32 clusterBinTestPlanes(ConstWeakArray<Plane> planes, const ClusterBinObbBatch& obbs)
+{
+	// The OBB is behind the plane if the distance of its center is less than minus the projection of the extends to the
+	// normal of the plane
+	U32 mask = computeClusterBinLaneMask(CLUSTER_BIN_BATCH_SIZE);
+	for(const Plane& plane : planes)
+	{
+		const Vec4& n = plane.getNormal();
+
+#if ANKI_SIMD_SSE
+		const __m128 nx = _mm_set1_ps(n.x());
+		const __m128 ny = _mm_set1_ps(n.y());
+		const __m128 nz = _mm_set1_ps(n.z());
+		__m128 r = _mm_setzero_ps();
+		for(U32 i = 0; i < 3; ++i)
+		{
+			__m128 proj = _mm_mul_ps(nx, obbs.m_axisX[i].getSimd());
+			proj = _mm_add_ps(proj, _mm_mul_ps(ny, obbs.m_axisY[i].getSimd()));
+			proj = _mm_add_ps(proj, _mm_mul_ps(nz, obbs.m_axisZ[i].getSimd()));
+			r = _mm_add_ps(r, absolute(proj));
+		}
+
+		const __m128 dist =
+			planeDistance(plane, obbs.m_centerX.getSimd(), obbs.m_centerY.getSimd(), obbs.m_centerZ.getSimd());
+		mask &= U32(_mm_movemask_ps(_mm_cmpge_ps(dist, _mm_sub_ps(_mm_setzero_ps(), r))));
+#else
+		for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+		{
+			F32 r = 0.0f;
+			for(U32 i = 0; i < 3; ++i)
+			{
+				r += absolute(
+					n.x() * obbs.m_axisX[i][lane] + n.y() * obbs.m_axisY[i][lane] + n.z() * obbs.m_axisZ[i][lane]);
+			}
+
+			const F32 dist = planeDistance(plane, obbs.m_centerX[lane], obbs.m_centerY[lane], obbs.m_centerZ[lane]);
+			if(dist < -r)
+			{
+				mask &= ~(1u << lane);
+			}
+		}
+#endif
+	}
+
+	return mask;
+}
+
+U32 clusterBinTestCollision(const Vec3& sphereCenter, F32 sphereRadius, const ClusterBinAabbBatch& clusters)
+{
+	// Find the closest point of the boxes to the sphere center and compare the distance with the radius
+#if ANKI_SIMD_SSE
+	const __m128 cx = _mm_set1_ps(sphereCenter.x());
+	const __m128 cy = _mm_set1_ps(sphereCenter.y());
+	const __m128 cz = _mm_set1_ps(sphereCenter.z());
+
+	const __m128 dx = _mm_sub_ps(cx, _mm_min_ps(_mm_max_ps(cx, clusters.m_minX.getSimd()), clusters.m_maxX.getSimd()));
+	const __m128 dy = _mm_sub_ps(cy, _mm_min_ps(_mm_max_ps(cy, clusters.m_minY.getSimd()), clusters.m_maxY.getSimd()));
+	const __m128 dz = _mm_sub_ps(cz, _mm_min_ps(_mm_max_ps(cz, clusters.m_minZ.getSimd()), clusters.m_maxZ.getSimd()));
+
+	__m128 distSq = _mm_mul_ps(dx, dx);
+	distSq = _mm_add_ps(distSq, _mm_mul_ps(dy, dy));
+	distSq = _mm_add_ps(distSq, _mm_mul_ps(dz, dz));
+
+	return U32(_mm_movemask_ps(_mm_cmple_ps(distSq, _mm_set1_ps(sphereRadius * sphereRadius))));
+#else
+	U32 mask = 0;
+	for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+	{
+		const F32 dx = sphereCenter.x() - min(max(sphereCenter.x(), clusters.m_minX[lane]), clusters.m_maxX[lane]);
+		const F32 dy = sphereCenter.y() - min(max(sphereCenter.y(), clusters.m_minY[lane]), clusters.m_maxY[lane]);
+		const F32 dz = sphereCenter.z() - min(max(sphereCenter.z(), clusters.m_minZ[lane]), clusters.m_maxZ[lane]);
+		const F32 distSq = dx * dx + dy * dy + dz * dz;
+		mask |= U32(distSq <= sphereRadius * sphereRadius) << lane;
+	}
+
+	return mask;
+#endif
+}
+
+U32 clusterBinTestCollision(const Vec3& aabbMin, const Vec3& aabbMax, const ClusterBinAabbBatch& clusters)
+{
+#if ANKI_SIMD_SSE
+	__m128 separated = _mm_cmpgt_ps(_mm_set1_ps(aabbMin.x()), clusters.m_maxX.getSimd());
+	separated = _mm_or_ps(separated, _mm_cmpgt_ps(_mm_set1_ps(aabbMin.y()), clusters.m_maxY.getSimd()));
+	separated = _mm_or_ps(separated, _mm_cmpgt_ps(_mm_set1_ps(aabbMin.z()), clusters.m_maxZ.getSimd()));
+	separated = _mm_or_ps(separated, _mm_cmpgt_ps(clusters.m_minX.getSimd(), _mm_set1_ps(aabbMax.x())));
+	separated = _mm_or_ps(separated, _mm_cmpgt_ps(clusters.m_minY.getSimd(), _mm_set1_ps(aabbMax.y())));
+	separated = _mm_or_ps(separated, _mm_cmpgt_ps(clusters.m_minZ.getSimd(), _mm_set1_ps(aabbMax.z())));
+
+	return U32(_mm_movemask_ps(separated)) ^ computeClusterBinLaneMask(CLUSTER_BIN_BATCH_SIZE);
+#else
+	U32 mask = 0;
+	for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+	{
+		const Bool separated = aabbMin.x() > clusters.m_maxX[lane] || aabbMin.y() > clusters.m_maxY[lane]
+							   || aabbMin.z() > clusters.m_maxZ[lane] || clusters.m_minX[lane] > aabbMax.x()
+							   || clusters.m_minY[lane] > aabbMax.y() || clusters.m_minZ[lane] > aabbMax.z();
+		mask |= U32(!separated) << lane;
+	}
+
+	return mask;
+#endif
+}
+
+U32 clusterBinTestCollision(const ClusterBinCone& cone, const ClusterBinSphereBatch& clusters)
+{
+	// Same as testCollision(const Sphere&, const Cone&)
+#if ANKI_SIMD_SSE
+	const __m128 vx = _mm_sub_ps(clusters.m_centerX.getSimd(), _mm_set1_ps(cone.m_origin.x()));
+	const __m128 vy = _mm_sub_ps(clusters.m_centerY.getSimd(), _mm_set1_ps(cone.m_origin.y()));
+	const __m128 vz = _mm_sub_ps(clusters.m_centerZ.getSimd(), _mm_set1_ps(cone.m_origin.z()));
+
+	__m128 vLenSq = _mm_mul_ps(vx, vx);
+	vLenSq = _mm_add_ps(vLenSq, _mm_mul_ps(vy, vy));
+	vLenSq = _mm_add_ps(vLenSq, _mm_mul_ps(vz, vz));
+
+	__m128 v1Len = _mm_mul_ps(vx, _mm_set1_ps(cone.m_direction.x()));
+	v1Len = _mm_add_ps(v1Len, _mm_mul_ps(vy, _mm_set1_ps(cone.m_direction.y())));
+	v1Len = _mm_add_ps(v1Len, _mm_mul_ps(vz, _mm_set1_ps(cone.m_direction.z())));
+
+	// Clamp to zero to avoid NaNs because of precision
+	const __m128 perpLenSq = _mm_max_ps(_mm_sub_ps(vLenSq, _mm_mul_ps(v1Len, v1Len)), _mm_setzero_ps());
+	const __m128 distanceClosestPoint = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(cone.m_cosHalfAngle), _mm_sqrt_ps(perpLenSq)),
+		_mm_mul_ps(v1Len, _mm_set1_ps(cone.m_sinHalfAngle)));
+
+	const __m128 radius = clusters.m_radius.getSimd();
+	__m128 culled = _mm_cmpgt_ps(distanceClosestPoint, radius);
+	culled = _mm_or_ps(culled, _mm_cmpgt_ps(v1Len, _mm_add_ps(radius, _mm_set1_ps(cone.m_length))));
+	culled = _mm_or_ps(culled, _mm_cmplt_ps(v1Len, _mm_sub_ps(_mm_setzero_ps(), radius)));
+
+	return U32(_mm_movemask_ps(culled)) ^ computeClusterBinLaneMask(CLUSTER_BIN_BATCH_SIZE);
+#else
+	U32 mask = 0;
+	for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+	{
+		const Vec3 clusterCenter(clusters.m_centerX[lane], clusters.m_centerY[lane], clusters.m_centerZ[lane]);
+		const Vec3 v = clusterCenter - cone.m_origin;
+		const F32 vLenSq = v.dot(v);
+		const F32 v1Len = v.dot(cone.m_direction);
+		const F32 distanceClosestPoint =
+			cone.m_cosHalfAngle * sqrt(max(vLenSq - v1Len * v1Len, 0.0f)) - v1Len * cone.m_sinHalfAngle;
+
+		const F32 radius = clusters.m_radius[lane];
+		const Bool culled =
+			distanceClosestPoint > radius || v1Len > radius + cone.m_length || v1Len < -radius;
+		mask |= U32(!culled) << lane;
+	}
+
+	return mask;
+#endif
+}
+
+} // end namespace anki
@@ -0,0 +1,162 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/Common.h>
+#include <anki/collision/Plane.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// The number of objects (or clusters) the batched binning kernels test at once.
+constexpr U32 CLUSTER_BIN_BATCH_SIZE = 4;
+
+/// Mask with the bits of the valid lanes of a batch.
+inline U32 computeClusterBinLaneMask(U32 validLaneCount)
+{
+	ANKI_ASSERT(validLaneCount <= CLUSTER_BIN_BATCH_SIZE);
+	return (1u << validLaneCount) - 1u;
+}
+
+/// A batch of spheres in SoA layout.
+class ClusterBinSphereBatch
+{
+public:
+	Vec4 m_centerX;
+	Vec4 m_centerY;
+	Vec4 m_centerZ;
+	Vec4 m_radius;
+
+	void set(U32 lane, const Vec3& center, F32 radius)
+	{
+		ANKI_ASSERT(lane < CLUSTER_BIN_BATCH_SIZE);
+		m_centerX[lane] = center.x();
+		m_centerY[lane] = center.y();
+		m_centerZ[lane] = center.z();
+		m_radius[lane] = radius;
+	}
+};
+
+/// A batch of AABBs in SoA layout.
+class ClusterBinAabbBatch
+{
+public:
+	Vec4 m_minX;
+	Vec4 m_minY;
+	Vec4 m_minZ;
+	Vec4 m_maxX;
+	Vec4 m_maxY;
+	Vec4 m_maxZ;
+
+	void set(U32 lane, const Vec3& aabbMin, const Vec3& aabbMax)
+	{
+		ANKI_ASSERT(lane < CLUSTER_BIN_BATCH_SIZE);
+		m_minX[lane] = aabbMin.x();
+		m_minY[lane] = aabbMin.y();
+		m_minZ[lane] = aabbMin.z();
+		m_maxX[lane] = aabbMax.x();
+		m_maxY[lane] = aabbMax.y();
+		m_maxZ[lane] = aabbMax.z();
+	}
+};
+
+/// A batch of convex hulls of 5 points (the shape of the spot lights) in SoA layout.
+class ClusterBinSpotLightHullBatch
+{
+public:
+	static constexpr U32 POINT_COUNT = 5;
+
+	Array<Vec4, POINT_COUNT> m_pointX;
+	Array<Vec4, POINT_COUNT> m_pointY;
+	Array<Vec4, POINT_COUNT> m_pointZ;
+
+	void set(U32 lane, const Array<Vec4, POINT_COUNT>& points)
+	{
+		ANKI_ASSERT(lane < CLUSTER_BIN_BATCH_SIZE);
+		for(U32 i = 0; i < POINT_COUNT; ++i)
+		{
+			m_pointX[i][lane] = points[i].x();
+			m_pointY[i][lane] = points[i].y();
+			m_pointZ[i][lane] = points[i].z();
+		}
+	}
+};
+
+/// A batch of OBBs in SoA layout.
+class ClusterBinObbBatch
+{
+public:
+	Vec4 m_centerX;
+	Vec4 m_centerY;
+	Vec4 m_centerZ;
+	Array<Vec4, 3> m_axisX; ///< The X component of the 3 axes (the columns of the rotation) multiplied by the extend.
+	Array<Vec4, 3> m_axisY;
+	Array<Vec4, 3> m_axisZ;
+
+	void set(U32 lane, const Vec3& center, const Mat3& rotation, const Vec3& extend)
+	{
+		ANKI_ASSERT(lane < CLUSTER_BIN_BATCH_SIZE);
+		m_centerX[lane] = center.x();
+		m_centerY[lane] = center.y();
+		m_centerZ[lane] = center.z();
+		for(U32 i = 0; i < 3; ++i)
+		{
+			const Vec3 axis = rotation.getColumn(i) * extend[i];
+			m_axisX[i][lane] = axis.x();
+			m_axisY[i][lane] = axis.y();
+			m_axisZ[i][lane] = axis.z();
+		}
+	}
+};
+
+/// Copy a lane of a batch to a lane of another batch. All the batches are made of Vec4s where each Vec4 holds one
+/// component of all the lanes.
+template<typename TBatch>
+inline void copyClusterBinBatchLane(const TBatch& src, U32 srcLane, TBatch& dst, U32 dstLane)
+{
+	static_assert(sizeof(TBatch) % sizeof(Vec4) == 0, "Batches should only contain Vec4s");
+	ANKI_ASSERT(srcLane < CLUSTER_BIN_BATCH_SIZE && dstLane < CLUSTER_BIN_BATCH_SIZE);
+	const Vec4* srcComponents = reinterpret_cast<const Vec4*>(&src);
+	Vec4* dstComponents = reinterpret_cast<Vec4*>(&dst);
+	for(U32 i = 0; i < sizeof(TBatch) / sizeof(Vec4); ++i)
+	{
+		dstComponents[i][dstLane] = srcComponents[i][srcLane];
+	}
+}
+
+/// The parameters of a cone in the form the batched kernels want them.
+class ClusterBinCone
+{
+public:
+	Vec3 m_origin;
+	Vec3 m_direction;
+	F32 m_length;
+	F32 m_cosHalfAngle;
+	F32 m_sinHalfAngle;
+};
+
+/// @name Test a batch of objects against a set of planes.
+/// @return A mask with the lanes of the objects that are not completely behind any of the planes.
+/// @{
+U32 clusterBinTestPlanes(ConstWeakArray<Plane> planes, const ClusterBinSphereBatch& spheres);
+U32 clusterBinTestPlanes(ConstWeakArray<Plane> planes, const ClusterBinAabbBatch& aabbs);
+U32 clusterBinTestPlanes(ConstWeakArray<Plane> planes, const ClusterBinSpotLightHullBatch& hulls);
+U32 clusterBinTestPlanes(ConstWeakArray<Plane> planes, const ClusterBinObbBatch& obbs);
+/// @}
+
+/// @name Test a single object against a batch of clusters.
+/// @return A mask with the lanes of the clusters that collide with the object.
+/// @{
+U32 clusterBinTestCollision(const Vec3& sphereCenter, F32 sphereRadius, const ClusterBinAabbBatch& clusters);
+U32 clusterBinTestCollision(const Vec3& aabbMin, const Vec3& aabbMax, const ClusterBinAabbBatch& clusters);
+U32 clusterBinTestCollision(const ClusterBinCone& cone, const ClusterBinSphereBatch& clusters);
+/// @}
+/// @}
+
+} // end namespace anki
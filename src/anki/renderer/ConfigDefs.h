@@ -32,6 +32,11 @@ ANKI_CONFIG_OPTION(r_shadowMappingScratchTileCountX,
 ANKI_CONFIG_OPTION(r_shadowMappingScratchTileCountY, 4, 1, 256, "Number of tiles of the scratch buffer in Y")
 ANKI_CONFIG_OPTION(r_shadowMappingLightLodDistance0, 10.0, 1.0, MAX_F64)
 ANKI_CONFIG_OPTION(r_shadowMappingLightLodDistance1, 20.0, 2.0, MAX_F64)
+ANKI_CONFIG_OPTION(r_shadowMappingStaticCasterCache,
+	1,
+	0,
+	1,
+	"Cache the static shadow casters of the lights and re-render only the dynamic ones")
 
 ANKI_CONFIG_OPTION(r_probeReflectionResolution, 128, 4, 2048)
 ANKI_CONFIG_OPTION(r_probeReflectionIrradianceResolution, 16, 4, 2048)
@@ -51,6 +56,10 @@ ANKI_CONFIG_OPTION(r_motionBlurSamples, 32, 1, 2048)
 ANKI_CONFIG_OPTION(r_dbgEnabled, 0, 0, 1)
 
 ANKI_CONFIG_OPTION(r_avgObjectsPerCluster, 16, 16, 256)
+ANKI_CONFIG_OPTION(
+	r_clusterBinHierarchical, 1, 0, 1, "Bin the objects to screen tiles before binning them to the clusters")
+
+ANKI_CONFIG_OPTION(r_autoInstancing, 1, 0, 1, "Instance together the renderables that are not consecutive")
 
 ANKI_CONFIG_OPTION(r_bloomThreshold, 2.5, 0.0, 256.0)
 ANKI_CONFIG_OPTION(r_bloomScale, 2.5, 0.0, 256.0)
@@ -29,7 +29,7 @@ Dbg::~Dbg()
 
 Error Dbg::init(const ConfigSet& initializer)
 {
-	m_enabled = initializer.getBool("r_dbgEnabled");
+	m_enabled = initializer.getBool(ConfigOption::r_dbgEnabled);
 	return Error::NONE;
 }
 
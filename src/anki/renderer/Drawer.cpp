@@ -34,6 +34,170 @@ static Bool canMergeRenderableQueueElements(const RenderableQueueElement& a, con
 	return a.m_callback == b.m_callback && a.m_mergeKey != 0 && a.m_mergeKey == b.m_mergeKey;
 }
 
+/// Used to sort the renderables when grouping them.
+class RenderableGroupSortElement
+{
+public:
+	U64 m_mergeKey;
+	PtrSize m_callback;
+	U32 m_lod;
+	U32 m_idx;
+	U32 m_groupFirstIdx; ///< The index of the first renderable of the group.
+
+	Bool sameGroup(const RenderableGroupSortElement& b) const
+	{
+		return m_mergeKey != 0 && m_mergeKey == b.m_mergeKey && m_callback == b.m_callback && m_lod == b.m_lod;
+	}
+};
+
+U32 groupRenderableQueueElements(ConstWeakArray<RenderableQueueElement> elements,
+	ConstWeakArray<U8> lods,
+	GenericMemoryPoolAllocator<U8> alloc,
+	WeakArray<U32> indices)
+{
+	ANKI_ASSERT(elements.getSize() == lods.getSize() && elements.getSize() == indices.getSize());
+	const U32 count = elements.getSize();
+	if(count == 0)
+	{
+		return 0;
+	}
+
+	DynamicArrayAuto<RenderableGroupSortElement> sortElements(alloc);
+	sortElements.create(count);
+
+	U32 consecutiveDrawcallCount = 0;
+	for(U32 i = 0; i < count; ++i)
+	{
+		RenderableGroupSortElement& el = sortElements[i];
+		el.m_mergeKey = elements[i].m_mergeKey;
+		el.m_callback = ptrToNumber(elements[i].m_callback);
+		el.m_lod = lods[i];
+		el.m_idx = i;
+		el.m_groupFirstIdx = i;
+
+		if(i == 0 || !sortElements[i - 1].sameGroup(el))
+		{
+			++consecutiveDrawcallCount;
+		}
+	}
+
+	// Bring the renderables of the same group together. Inside a group they are sorted by their index so the first is
+	// the first of the group
+	std::sort(sortElements.getBegin(),
+		sortElements.getEnd(),
+		[](const RenderableGroupSortElement& a, const RenderableGroupSortElement& b) {
+			if(a.m_mergeKey != b.m_mergeKey)
+			{
+				return a.m_mergeKey < b.m_mergeKey;
+			}
+			else if(a.m_callback != b.m_callback)
+			{
+				return a.m_callback < b.m_callback;
+			}
+			else if(a.m_lod != b.m_lod)
+			{
+				return a.m_lod < b.m_lod;
+			}
+			return a.m_idx < b.m_idx;
+		});
+
+	U32 groupCount = 0;
+	for(U32 i = 0; i < count; ++i)
+	{
+		if(i > 0 && sortElements[i - 1].sameGroup(sortElements[i]))
+		{
+			sortElements[i].m_groupFirstIdx = sortElements[i - 1].m_groupFirstIdx;
+		}
+		else
+		{
+			++groupCount;
+		}
+	}
+
+	// Order the groups using their first renderable
+	std::sort(sortElements.getBegin(),
+		sortElements.getEnd(),
+		[](const RenderableGroupSortElement& a, const RenderableGroupSortElement& b) {
+			return (a.m_groupFirstIdx != b.m_groupFirstIdx) ? a.m_groupFirstIdx < b.m_groupFirstIdx : a.m_idx < b.m_idx;
+		});
+
+	for(U32 i = 0; i < count; ++i)
+	{
+		indices[i] = sortElements[i].m_idx;
+	}
+
+	ANKI_ASSERT(groupCount <= consecutiveDrawcallCount);
+	return consecutiveDrawcallCount - groupCount;
+}
+
+U32 computeRenderableDrawCostPrefixSum(
+	ConstWeakArray<RenderableQueueElement> elements, U32 initialCost, WeakArray<U32> prefixSum)
+{
+	ANKI_ASSERT(elements.getSize() == prefixSum.getSize());
+
+	U32 cost = initialCost;
+	U32 instanceCount = 0;
+	for(U32 i = 0; i < elements.getSize(); ++i)
+	{
+		const Bool instanced = i > 0 && instanceCount < MAX_INSTANCES
+							   && canMergeRenderableQueueElements(elements[i - 1], elements[i]);
+		if(instanced)
+		{
+			cost += 1;
+			++instanceCount;
+		}
+		else
+		{
+			cost += RENDERABLE_DRAWCALL_RECORDING_COST;
+			instanceCount = 1;
+		}
+
+		prefixSum[i] = cost;
+	}
+
+	return cost;
+}
+
+void splitRenderablesByDrawCost(ConstWeakArray<U32> costPrefixSum, U32 chunkIdx, U32 chunkCount, U32& start, U32& end)
+{
+	ANKI_ASSERT(chunkCount > 0 && chunkIdx < chunkCount);
+	const U32 count = costPrefixSum.getSize();
+	if(count == 0)
+	{
+		start = end = 0;
+		return;
+	}
+
+	// A renderable starts a drawcall if it costs more than an instance. The first of every list does
+	auto startsDrawcall = [&](U32 idx) -> Bool {
+		return idx == 0 || costPrefixSum[idx] - costPrefixSum[idx - 1] != 1;
+	};
+
+	// A chunk starts after the renderables whose cost is covered by the previous chunks. Move it to the next drawcall
+	// so the instances of a drawcall are not split between chunks
+	const U64 totalCost = costPrefixSum[count - 1];
+	auto chunkBegin = [&](U32 idx) -> U32 {
+		if(idx == chunkCount)
+		{
+			return count;
+		}
+
+		const U64 targetCost = totalCost * idx / chunkCount;
+		U32 begin = U32(std::upper_bound(costPrefixSum.getBegin(), costPrefixSum.getEnd(), targetCost)
+						- costPrefixSum.getBegin());
+		while(begin < count && !startsDrawcall(begin))
+		{
+			++begin;
+		}
+
+		return begin;
+	};
+
+	start = chunkBegin(chunkIdx);
+	end = chunkBegin(chunkIdx + 1);
+	ANKI_ASSERT(start <= end && end <= count);
+}
+
 RenderableDrawer::~RenderableDrawer()
 {
 }
@@ -46,7 +210,8 @@ void RenderableDrawer::drawRange(Pass pass,
 	SamplerPtr sampler,
 	const RenderableQueueElement* begin,
 	const RenderableQueueElement* end,
-	U32 minLod)
+	U32 minLod,
+	Bool grouped)
 {
 	ANKI_ASSERT(begin && end && begin < end);
 
@@ -59,12 +224,25 @@ void RenderableDrawer::drawRange(Pass pass,
 	ctx.m_queueCtx.m_stagingGpuAllocator = &m_r->getStagingGpuMemoryManager();
 	ctx.m_queueCtx.m_commandBuffer = cmdb;
 	ctx.m_queueCtx.m_sampler = sampler;
+	ctx.m_queueCtx.m_frameAllocator = m_r->getFrameAllocator();
 	ctx.m_queueCtx.m_key = RenderingKey(pass, 0, 1, false, false);
 	ctx.m_queueCtx.m_debugDraw = false;
 
 	ANKI_ASSERT(minLod < MAX_LOD_COUNT);
 	ctx.m_minLod = minLod;
 
+	// A renderable can be missing for a few frames while its pipeline is created
+	cmdb->setSkippableDrawcalls(true);
+
+	// Group the renderables that can be instanced together. The forward shading needs the back to front order
+	if(!grouped && pass != Pass::FS)
+	{
+		const ConstWeakArray<RenderableQueueElement> groupedElements = groupRenderables(
+			ConstWeakArray<RenderableQueueElement>(begin, U32(end - begin)), minLod, ctx.m_queueCtx.m_frameAllocator);
+		begin = groupedElements.getBegin();
+		end = groupedElements.getEnd();
+	}
+
 	for(; begin != end; ++begin)
 	{
 		ctx.m_renderableElement = begin;
@@ -74,6 +252,42 @@ void RenderableDrawer::drawRange(Pass pass,
 
 	// Flush the last drawcall
 	flushDrawcall(ctx);
+
+	cmdb->setSkippableDrawcalls(false);
+}
+
+ConstWeakArray<RenderableQueueElement> RenderableDrawer::groupRenderables(
+	ConstWeakArray<RenderableQueueElement> elements, U32 minLod, StackAllocator<U8> alloc) const
+{
+	const U32 count = elements.getSize();
+	if(!m_autoInstancing || count < 2)
+	{
+		return elements;
+	}
+
+	ANKI_TRACE_SCOPED_EVENT(R_DRAWER_GROUPING);
+
+	DynamicArrayAuto<U8> lods(alloc);
+	lods.create(count);
+	for(U32 i = 0; i < count; ++i)
+	{
+		lods[i] = U8(computeLod(minLod, elements[i]));
+	}
+
+	DynamicArrayAuto<U32> indices(alloc);
+	indices.create(count);
+	const U32 savedDrawcalls = groupRenderableQueueElements(
+		elements, ConstWeakArray<U8>(&lods[0], count), alloc, WeakArray<U32>(&indices[0], count));
+	ANKI_TRACE_INC_COUNTER(R_AUTO_INSTANCED_DRAWCALLS, savedDrawcalls);
+	(void)savedDrawcalls;
+
+	RenderableQueueElement* groupedElements = alloc.newArray<RenderableQueueElement>(count);
+	for(U32 i = 0; i < count; ++i)
+	{
+		groupedElements[i] = elements[indices[i]];
+	}
+
+	return ConstWeakArray<RenderableQueueElement>(groupedElements, count);
 }
 
 void RenderableDrawer::flushDrawcall(DrawContext& ctx)
@@ -101,8 +315,7 @@ void RenderableDrawer::drawSingle(DrawContext& ctx)
 
 	const RenderableQueueElement& rqel = *ctx.m_renderableElement;
 
-	U32 lod = min(m_r->calculateLod(rqel.m_distanceFromCamera), MAX_LOD_COUNT - 1);
-	lod = max(lod, ctx.m_minLod);
+	const U32 lod = computeLod(ctx.m_minLod, rqel);
 
 	const Bool shouldFlush =
 		ctx.m_cachedRenderElementCount > 0
@@ -121,4 +334,10 @@ void RenderableDrawer::drawSingle(DrawContext& ctx)
 	++ctx.m_cachedRenderElementCount;
 }
 
+U32 RenderableDrawer::computeLod(U32 minLod, const RenderableQueueElement& rqel) const
+{
+	const U32 lod = min(m_r->calculateLod(rqel.m_distanceFromCamera), MAX_LOD_COUNT - 1);
+	return max(lod, minLod);
+}
+
 } // end namespace anki
@@ -19,6 +19,38 @@ class DrawContext;
 /// @addtogroup renderer
 /// @{
 
+/// Reorder a list of renderables so the ones that can be drawn with a single instanced drawcall (same callback, same
+/// merge key and same LOD) are consecutive. The groups keep the order of their first renderable and the renderables
+/// of a group keep their relative order.
+/// @param elements The renderables.
+/// @param lods The LOD of every renderable.
+/// @param alloc Allocator for temporary memory.
+/// @param[out] indices The new order. It should have the same size as the elements.
+/// @return The number of drawcalls that the grouping saved compared to merging only consecutive renderables. It
+///         ignores the MAX_INSTANCES limit.
+U32 groupRenderableQueueElements(ConstWeakArray<RenderableQueueElement> elements,
+	ConstWeakArray<U8> lods,
+	GenericMemoryPoolAllocator<U8> alloc,
+	WeakArray<U32> indices);
+
+/// The estimated CPU cost of recording a renderable that starts a new drawcall. A renderable that is instanced with the
+/// previous one costs 1.
+constexpr U32 RENDERABLE_DRAWCALL_RECORDING_COST = 8;
+
+/// Compute the inclusive prefix sum of the estimated CPU cost of recording some renderables. It assumes that the
+/// consecutive renderables that can be merged are instanced (up to MAX_INSTANCES) so group them first.
+/// @param elements The renderables.
+/// @param initialCost Added to all the sums. Use it to continue the prefix sum of a list that precedes.
+/// @param[out] prefixSum The prefix sum. It should have the same size as the elements.
+/// @return The total cost including the initialCost.
+U32 computeRenderableDrawCostPrefixSum(
+	ConstWeakArray<RenderableQueueElement> elements, U32 initialCost, WeakArray<U32> prefixSum);
+
+/// Similar to splitThreadedProblem but it splits a list of renderables so every chunk has a similar recording cost. The
+/// chunks start at drawcall boundaries so the instances of a drawcall stay in the same chunk. Some chunks may be empty.
+/// @param costPrefixSum The output of computeRenderableDrawCostPrefixSum.
+void splitRenderablesByDrawCost(ConstWeakArray<U32> costPrefixSum, U32 chunkIdx, U32 chunkCount, U32& start, U32& end);
+
 /// It uses the render queue to batch and render.
 class RenderableDrawer
 {
@@ -32,6 +64,14 @@ public:
 
 	~RenderableDrawer();
 
+	/// Group the renderables of a range that can be instanced together even if they are not consecutive. It's ignored
+	/// for the forward shading pass because it needs the back to front order.
+	void setAutoInstancing(Bool enable)
+	{
+		m_autoInstancing = enable;
+	}
+
+	/// @param grouped The renderables are already the output of groupRenderables().
 	void drawRange(Pass pass,
 		const Mat4& viewMat,
 		const Mat4& viewProjMat,
@@ -40,14 +80,24 @@ public:
 		SamplerPtr sampler,
 		const RenderableQueueElement* begin,
 		const RenderableQueueElement* end,
-		U32 minLod = 0);
+		U32 minLod = 0,
+		Bool grouped = false);
+
+	/// Reorder a list of renderables with groupRenderableQueueElements. Use it before splitting the list between
+	/// threads so the renderables that are instanced together end up in the same drawRange().
+	/// @return A grouped copy allocated from alloc or the elements themselves if there is nothing to group.
+	ConstWeakArray<RenderableQueueElement> groupRenderables(
+		ConstWeakArray<RenderableQueueElement> elements, U32 minLod, StackAllocator<U8> alloc) const;
 
 private:
 	Renderer* m_r;
+	Bool m_autoInstancing = true;
 
 	void flushDrawcall(DrawContext& ctx);
 
 	void drawSingle(DrawContext& ctx);
+
+	U32 computeLod(U32 minLod, const RenderableQueueElement& rqel) const;
 };
 /// @}
 
@@ -76,11 +76,14 @@ void GBuffer::runInThread(const RenderingContext& ctx, RenderPassWorkContext& rg
 	const U32 threadCount = rgraphCtx.m_secondLevelCommandBufferCount;
 
 	// Get some stuff
-	const U32 earlyZCount = ctx.m_renderQueue->m_earlyZRenderables.getSize();
-	const U32 problemSize = ctx.m_renderQueue->m_renderables.getSize() + earlyZCount;
+	const U32 earlyZCount = m_earlyZRenderables.getSize();
 	U32 start, end;
-	splitThreadedProblem(threadId, threadCount, problemSize, start, end);
-	ANKI_ASSERT(end != start);
+	splitRenderablesByDrawCost(m_drawCostPrefixSum, threadId, threadCount, start, end);
+	if(start == end)
+	{
+		// Big instanced drawcalls might leave nothing for some threads
+		return;
+	}
 
 	// Set some state, leave the rest to default
 	cmdb->setViewport(0, 0, m_r->getWidth(), m_r->getHeight());
@@ -107,8 +110,10 @@ void GBuffer::runInThread(const RenderingContext& ctx, RenderPassWorkContext& rg
 			ctx.m_matrices.m_jitter * ctx.m_prevMatrices.m_viewProjection,
 			cmdb,
 			m_r->getSamplers().m_trilinearRepeatAniso,
-			ctx.m_renderQueue->m_earlyZRenderables.getBegin() + earlyZStart,
-			ctx.m_renderQueue->m_earlyZRenderables.getBegin() + earlyZEnd);
+			m_earlyZRenderables.getBegin() + earlyZStart,
+			m_earlyZRenderables.getBegin() + earlyZEnd,
+			0,
+			true);
 
 		// Restore state for the color write
 		if(colorStart < colorEnd)
@@ -125,15 +130,17 @@ void GBuffer::runInThread(const RenderingContext& ctx, RenderPassWorkContext& rg
 	{
 		cmdb->setDepthCompareOperation(CompareOperation::LESS_EQUAL);
 
-		ANKI_ASSERT(colorStart < colorEnd && colorEnd <= I32(ctx.m_renderQueue->m_renderables.getSize()));
+		ANKI_ASSERT(colorStart < colorEnd && colorEnd <= I32(m_renderables.getSize()));
 		m_r->getSceneDrawer().drawRange(Pass::GB,
 			ctx.m_matrices.m_view,
 			ctx.m_matrices.m_viewProjectionJitter,
 			ctx.m_matrices.m_jitter * ctx.m_prevMatrices.m_viewProjection,
 			cmdb,
 			m_r->getSamplers().m_trilinearRepeatAniso,
-			ctx.m_renderQueue->m_renderables.getBegin() + colorStart,
-			ctx.m_renderQueue->m_renderables.getBegin() + colorEnd);
+			m_renderables.getBegin() + colorStart,
+			m_renderables.getBegin() + colorEnd,
+			0,
+			true);
 	}
 }
 
@@ -153,6 +160,24 @@ void GBuffer::populateRenderGraph(RenderingContext& ctx)
 	}
 	m_depthRt = rgraph.newRenderTarget(m_depthRtDescr);
 
+	// Group the renderables before splitting them between the threads so the instances of a drawcall are recorded by
+	// the same thread
+	const RenderQueue& rqueue = *ctx.m_renderQueue;
+	const RenderableDrawer& drawer = m_r->getSceneDrawer();
+	m_earlyZRenderables = drawer.groupRenderables(rqueue.m_earlyZRenderables, 0, ctx.m_tempAllocator);
+	m_renderables = drawer.groupRenderables(rqueue.m_renderables, 0, ctx.m_tempAllocator);
+
+	// Estimate the cost of recording the renderables to balance the work of the threads
+	const U32 renderableCount = m_earlyZRenderables.getSize() + m_renderables.getSize();
+	U32* prefixSumMem = (renderableCount) ? ctx.m_tempAllocator.newArray<U32>(renderableCount) : nullptr;
+	m_drawCostPrefixSum = WeakArray<U32>(prefixSumMem, renderableCount);
+	const U32 earlyZCost = computeRenderableDrawCostPrefixSum(m_earlyZRenderables,
+		0,
+		WeakArray<U32>(m_drawCostPrefixSum.getBegin(), m_earlyZRenderables.getSize()));
+	const U32 totalCost = computeRenderableDrawCostPrefixSum(m_renderables,
+		earlyZCost,
+		WeakArray<U32>(m_drawCostPrefixSum.getBegin() + m_earlyZRenderables.getSize(), m_renderables.getSize()));
+
 	// Create pass
 	GraphicsRenderPassDescription& pass = rgraph.newGraphicsRenderPass("GBuffer");
 
@@ -164,8 +189,7 @@ void GBuffer::populateRenderGraph(RenderingContext& ctx)
 			self->runInThread(*self->m_ctx, rgraphCtx);
 		},
 		this,
-		computeNumberOfSecondLevelCommandBuffers(
-			ctx.m_renderQueue->m_earlyZRenderables.getSize() + ctx.m_renderQueue->m_renderables.getSize()));
+		computeNumberOfSecondLevelCommandBuffers(totalCost / RENDERABLE_DRAWCALL_RECORDING_COST));
 
 	for(U i = 0; i < GBUFFER_COLOR_ATTACHMENT_COUNT; ++i)
 	{
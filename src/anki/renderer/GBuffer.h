@@ -69,6 +69,9 @@ private:
 	FramebufferDescription m_fbDescr;
 
 	RenderingContext* m_ctx = nullptr;
+	WeakArray<U32> m_drawCostPrefixSum; ///< For the early Z renderables followed by the rest.
+	ConstWeakArray<RenderableQueueElement> m_earlyZRenderables; ///< Grouped copy of RenderQueue::m_earlyZRenderables.
+	ConstWeakArray<RenderableQueueElement> m_renderables; ///< Grouped copy of RenderQueue::m_renderables.
 	Array<RenderTargetHandle, GBUFFER_COLOR_ATTACHMENT_COUNT> m_colorRts;
 	RenderTargetHandle m_depthRt;
 
@@ -34,8 +34,8 @@ Error GBufferPost::initInternal(const ConfigSet& cfg)
 	ANKI_CHECK(getResourceManager().loadResource("shaders/GBufferPost.ankiprog", m_prog));
 
 	ShaderProgramResourceVariantInitInfo variantInitInfo(m_prog);
-	variantInitInfo.addConstant("CLUSTER_COUNT_X", cfg.getNumberU32("r_clusterSizeX"));
-	variantInitInfo.addConstant("CLUSTER_COUNT_Y", cfg.getNumberU32("r_clusterSizeY"));
+	variantInitInfo.addConstant("CLUSTER_COUNT_X", cfg.getNumberU32(ConfigOption::r_clusterSizeX));
+	variantInitInfo.addConstant("CLUSTER_COUNT_Y", cfg.getNumberU32(ConfigOption::r_clusterSizeY));
 
 	const ShaderProgramResourceVariant* variant;
 	m_prog->getOrCreateVariant(variantInitInfo, variant);
@@ -62,6 +62,11 @@ public:
 
 GlobalIllumination::~GlobalIllumination()
 {
+	for(CacheEntry& entry : m_cacheEntries)
+	{
+		getResourceManager().getGpuMemoryBudget().unregisterEvictable(entry);
+	}
+
 	m_cacheEntries.destroy(getAllocator());
 	m_probeUuidToCacheEntryIdx.destroy(getAllocator());
 }
@@ -117,9 +122,9 @@ Error GlobalIllumination::init(const ConfigSet& cfg)
 
 Error GlobalIllumination::initInternal(const ConfigSet& cfg)
 {
-	m_tileSize = cfg.getNumberU32("r_giTileResolution");
-	m_cacheEntries.create(getAllocator(), cfg.getNumberU32("r_giMaxCachedProbes"));
-	m_maxVisibleProbes = cfg.getNumberU32("r_giMaxVisibleProbes");
+	m_tileSize = cfg.getNumberU32(ConfigOption::r_giTileResolution);
+	m_cacheEntries.create(getAllocator(), cfg.getNumberU32(ConfigOption::r_giMaxCachedProbes));
+	m_maxVisibleProbes = cfg.getNumberU32(ConfigOption::r_giMaxVisibleProbes);
 	ANKI_ASSERT(m_maxVisibleProbes <= MAX_VISIBLE_GLOBAL_ILLUMINATION_PROBES);
 	ANKI_ASSERT(m_cacheEntries.getSize() >= m_maxVisibleProbes);
 
@@ -175,7 +180,7 @@ Error GlobalIllumination::initGBuffer(const ConfigSet& cfg)
 
 Error GlobalIllumination::initShadowMapping(const ConfigSet& cfg)
 {
-	const U32 resolution = cfg.getNumberU32("r_giShadowMapResolution");
+	const U32 resolution = cfg.getNumberU32(ConfigOption::r_giShadowMapResolution);
 	ANKI_ASSERT(resolution > 8);
 
 	// RT descr
@@ -480,6 +485,7 @@ void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 			// It's updated, early exit
 
 			entry.m_lastUsedTimestamp = m_r->getGlobalTimestamp();
+			getResourceManager().getGpuMemoryBudget().touch(entry);
 			volumeRts[newListOfProbeCount] =
 				ctx.m_renderGraphDescr.importRenderTarget(entry.m_volumeTex, TextureUsageBit::SAMPLED_FRAGMENT);
 			newListOfProbes[newListOfProbeCount++] = probe;
@@ -537,6 +543,16 @@ void GlobalIllumination::prepareProbes(InternalContext& giCtx)
 			texInit.m_initialUsage = TextureUsageBit::SAMPLED_FRAGMENT;
 
 			entry.m_volumeTex = m_r->createAndClearRenderTarget(texInit);
+
+			// The texels of B10G11R11 are 32bit
+			GpuMemoryBudget& budget = getResourceManager().getGpuMemoryBudget();
+			budget.unregisterEvictable(entry);
+			entry.m_volumeTexMemory = PtrSize(texInit.m_width) * texInit.m_height * texInit.m_depth * sizeof(U32);
+			budget.registerEvictable(entry);
+		}
+		else
+		{
+			getResourceManager().getGpuMemoryBudget().touch(entry);
 		}
 
 		// Compute the render position
@@ -48,16 +48,30 @@ public:
 private:
 	class InternalContext;
 
-	class CacheEntry
+	/// The volume of a cache entry can be evicted by the GpuMemoryBudget. It will be rendered again the next time the
+	/// probe is visible.
+	class CacheEntry : public GpuMemoryEvictable
 	{
 	public:
-		U64 m_uuid; ///< Probe UUID.
+		U64 m_uuid = 0; ///< Probe UUID.
 		Timestamp m_lastUsedTimestamp = 0; ///< When it was last seen by the renderer.
 		TexturePtr m_volumeTex; ///< Contains the 6 directions.
+		PtrSize m_volumeTexMemory = 0;
 		UVec3 m_volumeSize = UVec3(0u);
 		Vec3 m_probeAabbMin = Vec3(0.0f);
 		Vec3 m_probeAabbMax = Vec3(0.0f);
 		U32 m_renderedCells = 0;
+
+		PtrSize getEvictableGpuMemory() const override
+		{
+			return m_volumeTexMemory;
+		}
+
+		void evict() override
+		{
+			m_volumeTex.reset(nullptr);
+			m_renderedCells = 0;
+		}
 	};
 
 	class
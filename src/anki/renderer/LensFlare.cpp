@@ -41,8 +41,8 @@ Error LensFlare::initInternal(const ConfigSet& config)
 
 Error LensFlare::initSprite(const ConfigSet& config)
 {
-	m_maxSpritesPerFlare = config.getNumberU8("r_lensFlareMaxSpritesPerFlare");
-	m_maxFlares = config.getNumberU8("r_lensFlareMaxFlares");
+	m_maxSpritesPerFlare = config.getNumberU8(ConfigOption::r_lensFlareMaxSpritesPerFlare);
+	m_maxFlares = config.getNumberU8(ConfigOption::r_lensFlareMaxFlares);
 
 	if(m_maxSpritesPerFlare < 1 || m_maxFlares < 1)
 	{
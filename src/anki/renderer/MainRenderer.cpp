@@ -42,17 +42,19 @@ Error MainRenderer::init(ThreadHive* hive,
 	ANKI_R_LOGI("Initializing main renderer");
 
 	m_alloc = HeapAllocator<U8>(allocCb, allocCbUserData);
+	m_alloc.getMemoryPool().setMemoryTag(MemoryTag::RENDERER);
 	m_frameAlloc = StackAllocator<U8>(allocCb, allocCbUserData, 1024 * 1024 * 10, 1.0f);
+	m_frameAlloc.getMemoryPool().setMemoryTag(MemoryTag::RENDERER);
 
 	// Init renderer and manipulate the width/height
-	m_width = config.getNumberU32("width");
-	m_height = config.getNumberU32("height");
+	m_width = config.getNumberU32(ConfigOption::width);
+	m_height = config.getNumberU32(ConfigOption::height);
 	ConfigSet config2 = config;
-	m_renderingQuality = config.getNumberF32("r_renderingQuality");
+	m_renderingQuality = config.getNumberF32(ConfigOption::r_renderingQuality);
 	UVec2 size(U32(m_renderingQuality * F32(m_width)), U32(m_renderingQuality * F32(m_height)));
 
-	config2.set("width", size.x());
-	config2.set("height", size.y());
+	config2.set(ConfigOption::width, size.x());
+	config2.set(ConfigOption::height, size.y());
 
 	m_rDrawToDefaultFb = m_renderingQuality == 1.0;
 
@@ -0,0 +1,214 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/renderer/PersistentGpuObjectBuffer.h>
+#include <anki/gr/GrManager.h>
+
+namespace anki
+{
+
+PersistentGpuObjectBuffer::~PersistentGpuObjectBuffer()
+{
+	for(BufferPtr& buff : m_buffers)
+	{
+		if(buff)
+		{
+			buff->unmap();
+			buff.reset(nullptr);
+		}
+	}
+
+	m_uuidToSlot.destroy(m_alloc);
+	m_slots.destroy(m_alloc);
+	m_shadowData.destroy(m_alloc);
+	m_freeSlots.destroy(m_alloc);
+	m_cpuMem.destroy(m_alloc);
+}
+
+void PersistentGpuObjectBuffer::init(
+	HeapAllocator<U8> alloc, GrManager* gr, U32 objectSize, U32 slotCount, CString name)
+{
+	ANKI_ASSERT(objectSize > 0 && slotCount > 0);
+	ANKI_ASSERT(MAX_FRAMES_IN_FLIGHT <= 8 && "Not enough bits in Slot::m_upToDateCopiesMask");
+
+	m_alloc = alloc;
+	m_objectSize = objectSize;
+
+	m_slots.create(m_alloc, slotCount);
+	m_shadowData.create(m_alloc, PtrSize(slotCount) * objectSize, 0);
+
+	// Push the slots in reverse so the first allocations get the first slots
+	m_freeSlots.create(m_alloc, slotCount);
+	for(U32 i = 0; i < slotCount; ++i)
+	{
+		m_freeSlots[i] = slotCount - i - 1;
+	}
+	m_freeSlotCount = slotCount;
+
+	const PtrSize size = PtrSize(slotCount) * objectSize;
+	if(gr)
+	{
+		for(U32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+		{
+			m_buffers[i] =
+				gr->newBuffer(BufferInitInfo(size, BufferUsageBit::ALL_UNIFORM, BufferMapAccessBit::WRITE, name));
+			m_mappedMem[i] = static_cast<U8*>(m_buffers[i]->map(0, size, BufferMapAccessBit::WRITE));
+		}
+	}
+	else
+	{
+		m_cpuMem.create(m_alloc, U32(size * MAX_FRAMES_IN_FLIGHT), 0);
+		for(U32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+		{
+			m_mappedMem[i] = &m_cpuMem[U32(size * i)];
+		}
+	}
+}
+
+void PersistentGpuObjectBuffer::beginFrame()
+{
+	++m_frame;
+	m_writtenSlotCount = 0;
+	m_skippedSlotCount = 0;
+	m_evictedSlotCount = 0;
+}
+
+U32 PersistentGpuObjectBuffer::acquireSlot(U64 uuid)
+{
+	ANKI_ASSERT(uuid != 0);
+	ANKI_ASSERT(m_frame > 0 && "Forgot to call beginFrame()");
+
+	// Search the cache
+	auto it = m_uuidToSlot.find(uuid);
+	if(it != m_uuidToSlot.getEnd())
+	{
+		const U32 slotIdx = *it;
+		Slot& slot = m_slots[slotIdx];
+		ANKI_ASSERT(slot.m_uuid == uuid);
+		slot.m_lastUsedFrame = m_frame;
+
+		// Now it's the most recently used
+		removeFromLru(slotIdx);
+		pushBackToLru(slotIdx);
+		return slotIdx;
+	}
+
+	// Not found, allocate a new slot
+	U32 slotIdx;
+	if(m_freeSlotCount > 0)
+	{
+		slotIdx = m_freeSlots[--m_freeSlotCount];
+		m_usedSlotRange = max(m_usedSlotRange, slotIdx + 1);
+	}
+	else
+	{
+		// Evict the least recently used. If it's used in this frame all of them are
+		slotIdx = m_lruHead;
+		ANKI_ASSERT(slotIdx != MAX_U32);
+		if(m_slots[slotIdx].m_lastUsedFrame == m_frame)
+		{
+			return MAX_U32;
+		}
+
+		auto oldIt = m_uuidToSlot.find(m_slots[slotIdx].m_uuid);
+		ANKI_ASSERT(oldIt != m_uuidToSlot.getEnd());
+		m_uuidToSlot.erase(m_alloc, oldIt);
+		removeFromLru(slotIdx);
+		++m_evictedSlotCount;
+	}
+
+	Slot& slot = m_slots[slotIdx];
+	slot.m_uuid = uuid;
+	slot.m_lastUsedFrame = m_frame;
+	slot.m_upToDateCopiesMask = 0;
+	m_uuidToSlot.emplace(m_alloc, uuid, slotIdx);
+	pushBackToLru(slotIdx);
+
+	return slotIdx;
+}
+
+void PersistentGpuObjectBuffer::removeFromLru(U32 slotIdx)
+{
+	Slot& slot = m_slots[slotIdx];
+
+	if(slot.m_prevLru != MAX_U32)
+	{
+		m_slots[slot.m_prevLru].m_nextLru = slot.m_nextLru;
+	}
+	else
+	{
+		ANKI_ASSERT(m_lruHead == slotIdx);
+		m_lruHead = slot.m_nextLru;
+	}
+
+	if(slot.m_nextLru != MAX_U32)
+	{
+		m_slots[slot.m_nextLru].m_prevLru = slot.m_prevLru;
+	}
+	else
+	{
+		ANKI_ASSERT(m_lruTail == slotIdx);
+		m_lruTail = slot.m_prevLru;
+	}
+
+	slot.m_prevLru = MAX_U32;
+	slot.m_nextLru = MAX_U32;
+}
+
+void PersistentGpuObjectBuffer::pushBackToLru(U32 slotIdx)
+{
+	Slot& slot = m_slots[slotIdx];
+	ANKI_ASSERT(slot.m_prevLru == MAX_U32 && slot.m_nextLru == MAX_U32);
+
+	slot.m_prevLru = m_lruTail;
+	if(m_lruTail != MAX_U32)
+	{
+		m_slots[m_lruTail].m_nextLru = slotIdx;
+	}
+	else
+	{
+		m_lruHead = slotIdx;
+	}
+
+	m_lruTail = slotIdx;
+}
+
+void PersistentGpuObjectBuffer::writeSlot(U32 slotIdx, const void* data)
+{
+	ANKI_ASSERT(data);
+	Slot& slot = m_slots[slotIdx];
+	ANKI_ASSERT(slot.m_uuid != 0 && slot.m_lastUsedFrame == m_frame && "Should have acquired the slot this frame");
+
+	U8* shadow = &m_shadowData[PtrSize(slotIdx) * m_objectSize];
+	if(memcmp(shadow, data, m_objectSize) != 0)
+	{
+		memcpy(shadow, data, m_objectSize);
+		slot.m_upToDateCopiesMask = 0;
+	}
+
+	const U32 copy = U32(m_frame % MAX_FRAMES_IN_FLIGHT);
+	const U8 copyBit = U8(1u << copy);
+	if(!(slot.m_upToDateCopiesMask & copyBit))
+	{
+		memcpy(m_mappedMem[copy] + PtrSize(slotIdx) * m_objectSize, shadow, m_objectSize);
+		slot.m_upToDateCopiesMask |= copyBit;
+		++m_writtenSlotCount;
+	}
+	else
+	{
+		++m_skippedSlotCount;
+	}
+}
+
+void PersistentGpuObjectBuffer::getToken(StagingGpuMemoryToken& token) const
+{
+	token.m_buffer = m_buffers[m_frame % MAX_FRAMES_IN_FLIGHT];
+	token.m_offset = 0;
+	// Bind only the slots that were ever used. Never zero because an empty range is not a valid binding
+	token.m_range = PtrSize(max(m_usedSlotRange, 1u)) * m_objectSize;
+	token.m_type = StagingGpuMemoryType::UNIFORM;
+}
+
+} // end namespace anki
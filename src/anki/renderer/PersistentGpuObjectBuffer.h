@@ -0,0 +1,125 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/renderer/Common.h>
+#include <anki/util/HashMap.h>
+
+namespace anki
+{
+
+/// @addtogroup renderer
+/// @{
+
+/// A GPU buffer that keeps objects of the same type (lights, decals etc) in stable slots across frames. The objects are
+/// identified by their UUID. The buffer has one copy per frame in flight and a slot of a copy is written only if the
+/// object changed since the last time that copy was written.
+class PersistentGpuObjectBuffer : public NonCopyable
+{
+public:
+	~PersistentGpuObjectBuffer();
+
+	/// Initialize.
+	/// @param gr If it's nullptr the copies are kept in CPU memory. Useful for testing.
+	/// @param objectSize The size of a single object.
+	/// @param slotCount The max number of objects.
+	void init(HeapAllocator<U8> alloc, GrManager* gr, U32 objectSize, U32 slotCount, CString name);
+
+	/// Start a new frame. Call it once per frame before anything else.
+	void beginFrame();
+
+	/// Get the slot of an object. If the object doesn't have one it will allocate a new one. If there are no free slots
+	/// it will evict the object that was used least recently, as long as it's not used in this frame.
+	/// @return The slot or MAX_U32 if all the slots are used in this frame.
+	U32 acquireSlot(U64 uuid);
+
+	/// Write the data of an object. It will write the copy of the current frame only if the data changed or if the copy
+	/// is stale.
+	void writeSlot(U32 slot, const void* data);
+
+	/// Get a token that covers the slots of the copy of the current frame up to the highest slot ever used.
+	void getToken(StagingGpuMemoryToken& token) const;
+
+	/// Get the data of a slot of the copy of the current frame.
+	const void* getSlotData(U32 slot) const
+	{
+		ANKI_ASSERT(slot < m_slots.getSize());
+		return m_mappedMem[m_frame % MAX_FRAMES_IN_FLIGHT] + PtrSize(slot) * m_objectSize;
+	}
+
+	U32 getSlotCount() const
+	{
+		return m_slots.getSize();
+	}
+
+	/// The number of slots the token covers.
+	U32 getUsedSlotRange() const
+	{
+		return m_usedSlotRange;
+	}
+
+	/// @name Statistics of the current frame
+	/// @{
+	U32 getWrittenSlotCount() const
+	{
+		return m_writtenSlotCount;
+	}
+
+	U32 getSkippedSlotCount() const
+	{
+		return m_skippedSlotCount;
+	}
+
+	U32 getEvictedSlotCount() const
+	{
+		return m_evictedSlotCount;
+	}
+	/// @}
+
+private:
+	class Slot
+	{
+	public:
+		U64 m_uuid = 0; ///< Zero means that the slot is free.
+		U64 m_lastUsedFrame = 0;
+		U32 m_prevLru = MAX_U32; ///< The slot that was used before this one.
+		U32 m_nextLru = MAX_U32; ///< The slot that was used after this one.
+		U8 m_upToDateCopiesMask = 0; ///< One bit per copy.
+	};
+
+	HeapAllocator<U8> m_alloc;
+	U32 m_objectSize = 0;
+
+	DynamicArray<Slot> m_slots;
+	DynamicArray<U8> m_shadowData; ///< The data of the last write of every slot.
+	DynamicArray<U32> m_freeSlots; ///< A stack.
+	U32 m_freeSlotCount = 0;
+	HashMap<U64, U32> m_uuidToSlot;
+
+	/// @name A list of the used slots. The least recently used is first.
+	/// @{
+	U32 m_lruHead = MAX_U32;
+	U32 m_lruTail = MAX_U32;
+	/// @}
+
+	U32 m_usedSlotRange = 0; ///< One more than the highest slot that was ever used.
+
+	Array<BufferPtr, MAX_FRAMES_IN_FLIGHT> m_buffers;
+	Array<U8*, MAX_FRAMES_IN_FLIGHT> m_mappedMem = {};
+	DynamicArray<U8> m_cpuMem; ///< Backs the copies if there is no GrManager.
+
+	U64 m_frame = 0;
+
+	U32 m_writtenSlotCount = 0;
+	U32 m_skippedSlotCount = 0;
+	U32 m_evictedSlotCount = 0;
+
+	void removeFromLru(U32 slotIdx);
+	void pushBackToLru(U32 slotIdx);
+};
+/// @}
+
+} // end namespace anki
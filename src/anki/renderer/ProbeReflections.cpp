@@ -44,7 +44,7 @@ Error ProbeReflections::init(const ConfigSet& config)
 Error ProbeReflections::initInternal(const ConfigSet& config)
 {
 	// Init cache entries
-	m_cacheEntries.create(getAllocator(), config.getNumberU32("r_probeRefectionlMaxSimultaneousProbeCount"));
+	m_cacheEntries.create(getAllocator(), config.getNumberU32(ConfigOption::r_probeRefectionlMaxSimultaneousProbeCount));
 
 	ANKI_CHECK(initGBuffer(config));
 	ANKI_CHECK(initLightShading(config));
@@ -68,7 +68,7 @@ Error ProbeReflections::initInternal(const ConfigSet& config)
 
 Error ProbeReflections::initGBuffer(const ConfigSet& config)
 {
-	m_gbuffer.m_tileSize = config.getNumberU32("r_probeReflectionResolution");
+	m_gbuffer.m_tileSize = config.getNumberU32(ConfigOption::r_probeReflectionResolution);
 
 	// Create RT descriptions
 	{
@@ -115,7 +115,7 @@ Error ProbeReflections::initGBuffer(const ConfigSet& config)
 
 Error ProbeReflections::initLightShading(const ConfigSet& config)
 {
-	m_lightShading.m_tileSize = config.getNumberU32("r_probeReflectionResolution");
+	m_lightShading.m_tileSize = config.getNumberU32(ConfigOption::r_probeReflectionResolution);
 	m_lightShading.m_mipCount = computeMaxMipmapCount2d(m_lightShading.m_tileSize, m_lightShading.m_tileSize, 8);
 
 	// Init cube arr
@@ -143,7 +143,7 @@ Error ProbeReflections::initLightShading(const ConfigSet& config)
 
 Error ProbeReflections::initIrradiance(const ConfigSet& config)
 {
-	m_irradiance.m_workgroupSize = config.getNumberU32("r_probeReflectionIrradianceResolution");
+	m_irradiance.m_workgroupSize = config.getNumberU32(ConfigOption::r_probeReflectionIrradianceResolution);
 
 	// Create prog
 	{
@@ -188,7 +188,7 @@ Error ProbeReflections::initIrradianceToRefl(const ConfigSet& cfg)
 
 Error ProbeReflections::initShadowMapping(const ConfigSet& cfg)
 {
-	const U32 resolution = cfg.getNumberU32("r_probeReflectionShadowMapResolution");
+	const U32 resolution = cfg.getNumberU32(ConfigOption::r_probeReflectionShadowMapResolution);
 	ANKI_ASSERT(resolution > 8);
 
 	// RT descr
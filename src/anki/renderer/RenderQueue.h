@@ -276,6 +276,7 @@ static_assert(std::is_trivially_destructible<LensFlareQueueElement>::value == tr
 class DecalQueueElement final
 {
 public:
+	U64 m_uuid;
 	RenderQueueDrawCallback m_debugDrawCallback;
 	const void* m_debugDrawCallbackUserData;
 	/// Totaly unsafe but we can't have a smart ptr in here since there will be no deletion.
@@ -319,6 +320,7 @@ static_assert(std::is_trivially_destructible<UiQueueElement>::value == true, "Sh
 class FogDensityQueueElement final
 {
 public:
+	U64 m_uuid;
 	union
 	{
 		Vec3 m_aabbMin;
@@ -368,6 +370,14 @@ public:
 	/// Applies only if the RenderQueue holds shadow casters. It's the max timesamp of all shadow casters
 	Timestamp m_shadowRenderablesLastUpdateTimestamp = 0;
 
+	/// Applies only if the RenderQueue holds shadow casters. The static casters are the ones that didn't change for a
+	/// few frames. They are the first m_staticShadowRenderableCount elements of m_renderables.
+	U32 m_staticShadowRenderableCount = 0;
+
+	/// Applies only if the RenderQueue holds shadow casters. It changes when the light changes or when a shadow caster
+	/// becomes static. Together with m_staticShadowRenderableCount it identifies the set of the static casters.
+	Timestamp m_staticShadowRenderablesLastUpdateTimestamp = 0;
+
 	F32 m_cameraNear;
 	F32 m_cameraFar;
 	F32 m_cameraFovX;
@@ -84,21 +84,23 @@ Error Renderer::init(ThreadHive* hive,
 Error Renderer::initInternal(const ConfigSet& config)
 {
 	// Set from the config
-	m_width = config.getNumberU32("width");
-	m_height = config.getNumberU32("height");
+	m_width = config.getNumberU32(ConfigOption::width);
+	m_height = config.getNumberU32(ConfigOption::height);
 	ANKI_R_LOGI("Initializing offscreen renderer. Size %ux%u", m_width, m_height);
 
 	ANKI_ASSERT(m_lodDistances.getSize() == 2);
-	m_lodDistances[0] = config.getNumberF32("r_lodDistance0");
-	m_lodDistances[1] = config.getNumberF32("r_lodDistance1");
+	m_lodDistances[0] = config.getNumberF32(ConfigOption::r_lodDistance0);
+	m_lodDistances[1] = config.getNumberF32(ConfigOption::r_lodDistance1);
 	m_frameCount = 0;
 
-	m_clusterCount[0] = config.getNumberU32("r_clusterSizeX");
-	m_clusterCount[1] = config.getNumberU32("r_clusterSizeY");
-	m_clusterCount[2] = config.getNumberU32("r_clusterSizeZ");
+	m_clusterCount[0] = config.getNumberU32(ConfigOption::r_clusterSizeX);
+	m_clusterCount[1] = config.getNumberU32(ConfigOption::r_clusterSizeY);
+	m_clusterCount[2] = config.getNumberU32(ConfigOption::r_clusterSizeZ);
 	m_clusterCount[3] = m_clusterCount[0] * m_clusterCount[1] * m_clusterCount[2];
 
-	m_clusterBin.init(m_alloc, m_clusterCount[0], m_clusterCount[1], m_clusterCount[2], config);
+	m_clusterBin.init(m_alloc, m_gr, m_clusterCount[0], m_clusterCount[1], m_clusterCount[2], config);
+
+	m_sceneDrawer.setAutoInstancing(config.getBool(ConfigOption::r_autoInstancing));
 
 	// A few sanity checks
 	if(m_width < 10 || m_height < 10)
@@ -215,7 +217,7 @@ Error Renderer::initInternal(const ConfigSet& config)
 		sinit.m_addressing = SamplingAddressing::REPEAT;
 		m_samplers.m_trilinearRepeat = m_gr->newSampler(sinit);
 
-		sinit.m_anisotropyLevel = U8(config.getNumberU32("r_textureAnisotropy"));
+		sinit.m_anisotropyLevel = U8(config.getNumberU32(ConfigOption::r_textureAnisotropy));
 		m_samplers.m_trilinearRepeatAniso = m_gr->newSampler(sinit);
 	}
 
@@ -283,6 +285,8 @@ void Renderer::initJitteredMats()
 
 Error Renderer::populateRenderGraph(RenderingContext& ctx)
 {
+	m_frameAlloc = ctx.m_tempAllocator;
+
 	ctx.m_matrices.m_cameraTransform = ctx.m_renderQueue->m_cameraTransform;
 	ctx.m_matrices.m_view = ctx.m_renderQueue->m_viewMatrix;
 	ctx.m_matrices.m_projection = ctx.m_renderQueue->m_projectionMatrix;
@@ -305,6 +305,13 @@ public:
 		return m_alloc;
 	}
 
+	/// The RenderingContext::m_tempAllocator of the frame that is being rendered. The memory lives until the next
+	/// frame so there is no need to free it.
+	StackAllocator<U8> getFrameAllocator() const
+	{
+		return m_frameAlloc;
+	}
+
 	ResourceManager& getResourceManager()
 	{
 		return *m_resources;
@@ -396,6 +403,7 @@ private:
 	UiManager* m_ui = nullptr;
 	Timestamp* m_globTimestamp;
 	HeapAllocator<U8> m_alloc;
+	StackAllocator<U8> m_frameAlloc;
 
 	/// @name Rendering stages
 	/// @{
@@ -18,7 +18,7 @@ class ShadowMapping::Scratch::WorkItem
 public:
 	Array<U32, 4> m_viewport;
 	RenderQueue* m_renderQueue;
-	U32 m_firstRenderableElement;
+	const RenderableQueueElement* m_renderableElements;
 	U32 m_renderableElementCount;
 	U32 m_threadPoolTaskIdx;
 };
@@ -28,6 +28,7 @@ class ShadowMapping::Scratch::LightToRenderToScratchInfo
 public:
 	Array<U32, 4> m_viewport;
 	RenderQueue* m_renderQueue;
+	const RenderableQueueElement* m_renderables; ///< Points to m_renderQueue or to a grouped copy.
 	U32 m_drawcallCount;
 };
 
@@ -35,12 +36,40 @@ class ShadowMapping::Atlas::ResolveWorkItem
 {
 public:
 	Vec4 m_uvIn; ///< UV + size that point to the scratch buffer.
+	Vec4 m_staticCacheUvIn; ///< UV + size that point to the static cache.
 	Array<U32, 4> m_viewportOut; ///< Viewport in the atlas RT.
 	Bool m_blur;
+	Bool m_sampleScratch;
+	Bool m_sampleStaticCache;
 };
 
+class ShadowMapping::StaticCache::StoreWorkItem
+{
+public:
+	Array<U32, 4> m_viewportIn; ///< Viewport in the scratch buffer.
+	Array<U32, 4> m_viewportOut; ///< Viewport in the static cache.
+};
+
+class ShadowMapping::StaticCache::TileWithDynamicCasters
+{
+public:
+	U64 m_lightUuid;
+	U32 m_lightFace;
+	Timestamp m_lastUsedTimestamp;
+};
+
+/// Forget a tile with dynamic casters if it's not used for that many frames.
+static const Timestamp TILE_WITH_DYNAMIC_CASTERS_MAX_AGE = 60;
+
+static U64 computeTileKey(U64 lightUuid, U32 lightFace)
+{
+	ANKI_ASSERT(lightFace < 6);
+	return (lightUuid << 3u) | lightFace;
+}
+
 ShadowMapping::~ShadowMapping()
 {
+	m_staticCache.m_tilesWithDynamicCasters.destroy(getAllocator());
 }
 
 Error ShadowMapping::init(const ConfigSet& config)
@@ -66,9 +95,9 @@ Error ShadowMapping::initScratch(const ConfigSet& cfg)
 {
 	// Init the shadowmaps and FBs
 	{
-		m_scratch.m_tileCountX = cfg.getNumberU32("r_shadowMappingScratchTileCountX");
-		m_scratch.m_tileCountY = cfg.getNumberU32("r_shadowMappingScratchTileCountY");
-		m_scratch.m_tileResolution = cfg.getNumberU32("r_shadowMappingTileResolution");
+		m_scratch.m_tileCountX = cfg.getNumberU32(ConfigOption::r_shadowMappingScratchTileCountX);
+		m_scratch.m_tileCountY = cfg.getNumberU32(ConfigOption::r_shadowMappingScratchTileCountY);
+		m_scratch.m_tileResolution = cfg.getNumberU32(ConfigOption::r_shadowMappingTileResolution);
 
 		// RT
 		m_scratch.m_rtDescr = m_r->create2DRenderTargetDescription(m_scratch.m_tileResolution * m_scratch.m_tileCountX,
@@ -93,8 +122,8 @@ Error ShadowMapping::initAtlas(const ConfigSet& cfg)
 {
 	// Init RT
 	{
-		m_atlas.m_tileResolution = cfg.getNumberU32("r_shadowMappingTileResolution");
-		m_atlas.m_tileCountBothAxis = cfg.getNumberU32("r_shadowMappingTileCountPerRowOrColumn");
+		m_atlas.m_tileResolution = cfg.getNumberU32(ConfigOption::r_shadowMappingTileResolution);
+		m_atlas.m_tileCountBothAxis = cfg.getNumberU32(ConfigOption::r_shadowMappingTileCountPerRowOrColumn);
 
 		// RT
 		TextureInitInfo texinit = m_r->create2DRenderTargetInitInfo(
@@ -119,10 +148,6 @@ Error ShadowMapping::initAtlas(const ConfigSet& cfg)
 			"shaders/ExponentialShadowmappingResolve.ankiprog", m_atlas.m_resolveProg));
 
 		ShaderProgramResourceVariantInitInfo variantInitInfo(m_atlas.m_resolveProg);
-		variantInitInfo.addConstant("INPUT_TEXTURE_SIZE",
-			UVec2(m_scratch.m_tileCountX * m_scratch.m_tileResolution,
-				m_scratch.m_tileCountY * m_scratch.m_tileResolution));
-
 		const ShaderProgramResourceVariant* variant;
 		m_atlas.m_resolveProg->getOrCreateVariant(variantInitInfo, variant);
 		m_atlas.m_resolveGrProg = variant->getProgram();
@@ -131,13 +156,50 @@ Error ShadowMapping::initAtlas(const ConfigSet& cfg)
 	return Error::NONE;
 }
 
+Error ShadowMapping::initStaticCache(const ConfigSet& cfg)
+{
+	m_staticCache.m_enabled = cfg.getBool(ConfigOption::r_shadowMappingStaticCasterCache);
+	if(!m_staticCache.m_enabled)
+	{
+		return Error::NONE;
+	}
+
+	// RT
+	{
+		const U32 size = m_atlas.m_tileResolution * m_atlas.m_tileCountBothAxis;
+		TextureInitInfo texinit = m_r->create2DRenderTargetInitInfo(size,
+			size,
+			Format::R32_SFLOAT,
+			TextureUsageBit::IMAGE_COMPUTE_WRITE | TextureUsageBit::SAMPLED_COMPUTE,
+			"SM static cache");
+		texinit.m_initialUsage = TextureUsageBit::SAMPLED_COMPUTE;
+		ClearValue clearVal;
+		clearVal.m_colorf[0] = 1.0f;
+		m_staticCache.m_tex = m_r->createAndClearRenderTarget(texinit, clearVal);
+	}
+
+	// Program
+	{
+		ANKI_CHECK(getResourceManager().loadResource(
+			"shaders/ShadowmapsStaticCacheStore.ankiprog", m_staticCache.m_storeProg));
+
+		ShaderProgramResourceVariantInitInfo variantInitInfo(m_staticCache.m_storeProg);
+		const ShaderProgramResourceVariant* variant;
+		m_staticCache.m_storeProg->getOrCreateVariant(variantInitInfo, variant);
+		m_staticCache.m_storeGrProg = variant->getProgram();
+	}
+
+	return Error::NONE;
+}
+
 Error ShadowMapping::initInternal(const ConfigSet& cfg)
 {
 	ANKI_CHECK(initScratch(cfg));
 	ANKI_CHECK(initAtlas(cfg));
+	ANKI_CHECK(initStaticCache(cfg));
 
-	m_lodDistances[0] = cfg.getNumberF32("r_shadowMappingLightLodDistance0");
-	m_lodDistances[1] = cfg.getNumberF32("r_shadowMappingLightLodDistance1");
+	m_lodDistances[0] = cfg.getNumberF32(ConfigOption::r_shadowMappingLightLodDistance0);
+	m_lodDistances[1] = cfg.getNumberF32(ConfigOption::r_shadowMappingLightLodDistance1);
 
 	return Error::NONE;
 }
@@ -151,29 +213,87 @@ void ShadowMapping::runAtlas(RenderPassWorkContext& rgraphCtx)
 
 	cmdb->bindShaderProgram(m_atlas.m_resolveGrProg);
 
+	// The scratch buffer or the static cache may not be used this frame. Bind something valid in their place
+	const Bool hasScratch = m_scratch.m_maxViewportWidth > 0;
+	const TextureSubresourceInfo scratchSubresource(DepthStencilAspectBit::DEPTH);
+	ANKI_ASSERT(hasScratch || m_staticCache.m_enabled);
+
 	cmdb->bindSampler(0, 0, m_r->getSamplers().m_trilinearClamp);
-	rgraphCtx.bindTexture(0, 1, m_scratch.m_rt, TextureSubresourceInfo(DepthStencilAspectBit::DEPTH));
+	if(hasScratch)
+	{
+		rgraphCtx.bindTexture(0, 1, m_scratch.m_rt, scratchSubresource);
+	}
+	else
+	{
+		rgraphCtx.bindTexture(0, 1, m_staticCache.m_rt, TextureSubresourceInfo());
+	}
 	rgraphCtx.bindImage(0, 2, m_atlas.m_rt, {});
+	if(m_staticCache.m_enabled)
+	{
+		rgraphCtx.bindTexture(0, 3, m_staticCache.m_rt, TextureSubresourceInfo());
+	}
+	else
+	{
+		rgraphCtx.bindTexture(0, 3, m_scratch.m_rt, scratchSubresource);
+	}
 
 	for(const Atlas::ResolveWorkItem& workItem : m_atlas.m_resolveWorkItems)
 	{
 		ANKI_TRACE_INC_COUNTER(R_SHADOW_PASSES, 1);
+		ANKI_ASSERT(!workItem.m_sampleScratch || hasScratch);
+		ANKI_ASSERT(!workItem.m_sampleStaticCache || m_staticCache.m_enabled);
 
 		struct Uniforms
 		{
 			UVec4 m_viewport;
 			Vec2 m_uvScale;
 			Vec2 m_uvTranslation;
+			Vec2 m_staticCacheUvScale;
+			Vec2 m_staticCacheUvTranslation;
 			U32 m_blur;
+			U32 m_sampleScratch;
+			U32 m_sampleStaticCache;
 			U32 m_padding0;
-			U32 m_padding1;
-			U32 m_padding2;
 		} unis;
 		unis.m_uvScale = workItem.m_uvIn.zw();
 		unis.m_uvTranslation = workItem.m_uvIn.xy();
+		unis.m_staticCacheUvScale = workItem.m_staticCacheUvIn.zw();
+		unis.m_staticCacheUvTranslation = workItem.m_staticCacheUvIn.xy();
 		unis.m_viewport = UVec4(
 			workItem.m_viewportOut[0], workItem.m_viewportOut[1], workItem.m_viewportOut[2], workItem.m_viewportOut[3]);
 		unis.m_blur = workItem.m_blur;
+		unis.m_sampleScratch = workItem.m_sampleScratch;
+		unis.m_sampleStaticCache = workItem.m_sampleStaticCache;
+
+		cmdb->setPushConstants(&unis, sizeof(unis));
+
+		dispatchPPCompute(cmdb, 8, 8, workItem.m_viewportOut[2], workItem.m_viewportOut[3]);
+	}
+}
+
+void ShadowMapping::runStaticCacheStore(RenderPassWorkContext& rgraphCtx)
+{
+	ANKI_ASSERT(m_staticCache.m_storeWorkItems.getSize());
+	ANKI_TRACE_SCOPED_EVENT(R_SM);
+
+	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
+
+	cmdb->bindShaderProgram(m_staticCache.m_storeGrProg);
+
+	rgraphCtx.bindTexture(0, 0, m_scratch.m_rt, TextureSubresourceInfo(DepthStencilAspectBit::DEPTH));
+	rgraphCtx.bindImage(0, 1, m_staticCache.m_rt, {});
+
+	for(const StaticCache::StoreWorkItem& workItem : m_staticCache.m_storeWorkItems)
+	{
+		struct Uniforms
+		{
+			UVec4 m_viewportIn;
+			UVec4 m_viewportOut;
+		} unis;
+		unis.m_viewportIn = UVec4(
+			workItem.m_viewportIn[0], workItem.m_viewportIn[1], workItem.m_viewportIn[2], workItem.m_viewportIn[3]);
+		unis.m_viewportOut = UVec4(
+			workItem.m_viewportOut[0], workItem.m_viewportOut[1], workItem.m_viewportOut[2], workItem.m_viewportOut[3]);
 
 		cmdb->setPushConstants(&unis, sizeof(unis));
 
@@ -183,7 +303,6 @@ void ShadowMapping::runAtlas(RenderPassWorkContext& rgraphCtx)
 
 void ShadowMapping::runShadowMapping(RenderPassWorkContext& rgraphCtx)
 {
-	ANKI_ASSERT(m_scratch.m_workItems.getSize());
 	ANKI_TRACE_SCOPED_EVENT(R_SM);
 
 	CommandBufferPtr& cmdb = rgraphCtx.m_commandBuffer;
@@ -206,10 +325,10 @@ void ShadowMapping::runShadowMapping(RenderPassWorkContext& rgraphCtx)
 			Mat4::getIdentity(), // Don't care about prev matrices here
 			cmdb,
 			m_r->getSamplers().m_trilinearRepeatAniso,
-			work.m_renderQueue->m_renderables.getBegin() + work.m_firstRenderableElement,
-			work.m_renderQueue->m_renderables.getBegin() + work.m_firstRenderableElement
-				+ work.m_renderableElementCount,
-			MAX_LOD_COUNT - 1);
+			work.m_renderableElements,
+			work.m_renderableElements + work.m_renderableElementCount,
+			MAX_LOD_COUNT - 1,
+			true);
 	}
 }
 
@@ -223,11 +342,19 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 
 	// Build the render graph
 	RenderGraphDescription& rgraph = ctx.m_renderGraphDescr;
-	if(m_scratch.m_workItems.getSize())
+	m_atlas.m_rt = rgraph.importRenderTarget(m_atlas.m_tex, TextureUsageBit::SAMPLED_FRAGMENT);
+	if(m_staticCache.m_enabled)
 	{
-		// Will have to create render passes
+		m_staticCache.m_rt = rgraph.importRenderTarget(m_staticCache.m_tex, TextureUsageBit::SAMPLED_COMPUTE);
+	}
+
+	if(m_atlas.m_resolveWorkItems.getSize())
+	{
+		// Will have to create render passes. The scratch buffer is not needed if only the static cache is resolved
+		const Bool hasScratch = m_scratch.m_maxViewportWidth > 0;
 
 		// Scratch pass
+		if(hasScratch)
 		{
 			// Compute render area
 			const U32 minx = 0, miny = 0;
@@ -251,14 +378,15 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 			pass.newDependency({m_scratch.m_rt, TextureUsageBit::FRAMEBUFFER_ATTACHMENT_READ_WRITE, subresource});
 		}
 
-		// Atlas pass
+		// Static cache pass
+		if(m_staticCache.m_storeWorkItems.getSize())
 		{
-			ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SM atlas");
+			ANKI_ASSERT(hasScratch);
+			ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SM static cache");
 
-			m_atlas.m_rt = rgraph.importRenderTarget(m_atlas.m_tex, TextureUsageBit::SAMPLED_FRAGMENT);
 			pass.setWork(
 				[](RenderPassWorkContext& rgraphCtx) {
-					static_cast<ShadowMapping*>(rgraphCtx.m_userData)->runAtlas(rgraphCtx);
+					static_cast<ShadowMapping*>(rgraphCtx.m_userData)->runStaticCacheStore(rgraphCtx);
 				},
 				this,
 				0);
@@ -266,14 +394,35 @@ void ShadowMapping::populateRenderGraph(RenderingContext& ctx)
 			pass.newDependency({m_scratch.m_rt,
 				TextureUsageBit::SAMPLED_COMPUTE,
 				TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
+			pass.newDependency({m_staticCache.m_rt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
+		}
+
+		// Atlas pass
+		{
+			ComputeRenderPassDescription& pass = rgraph.newComputeRenderPass("SM atlas");
+
+			pass.setWork(
+				[](RenderPassWorkContext& rgraphCtx) {
+					static_cast<ShadowMapping*>(rgraphCtx.m_userData)->runAtlas(rgraphCtx);
+				},
+				this,
+				0);
+
+			if(hasScratch)
+			{
+				pass.newDependency({m_scratch.m_rt,
+					TextureUsageBit::SAMPLED_COMPUTE,
+					TextureSubresourceInfo(DepthStencilAspectBit::DEPTH)});
+			}
+
+			if(m_staticCache.m_enabled)
+			{
+				pass.newDependency({m_staticCache.m_rt, TextureUsageBit::SAMPLED_COMPUTE});
+			}
+
 			pass.newDependency({m_atlas.m_rt, TextureUsageBit::IMAGE_COMPUTE_WRITE});
 		}
 	}
-	else
-	{
-		// No need for shadowmapping passes, just import the atlas
-		m_atlas.m_rt = rgraph.importRenderTarget(m_atlas.m_tex, TextureUsageBit::SAMPLED_FRAGMENT);
-	}
 }
 
 Mat4 ShadowMapping::createSpotLightTextureMatrix(const Viewport& viewport) const
@@ -359,15 +508,39 @@ U32 ShadowMapping::choseLod(const Vec4& cameraOrigin, const SpotLightQueueElemen
 	return lod;
 }
 
+ShadowMapping::TileUpdate ShadowMapping::chooseTileUpdate(
+	Bool usesStaticCache, TileAllocatorResult res, Bool hasDynamicCasters, Bool hadDynamicCasters)
+{
+	ANKI_ASSERT(res != TileAllocatorResult::ALLOCATION_FAILED);
+
+	if(!usesStaticCache)
+	{
+		return (res == TileAllocatorResult::CACHED) ? TileUpdate::NONE : TileUpdate::ALL_CASTERS;
+	}
+	else if(res != TileAllocatorResult::CACHED)
+	{
+		// The static casters changed, need to render them again
+		return TileUpdate::STATIC_AND_DYNAMIC_CASTERS;
+	}
+	else
+	{
+		// The static casters are in the cache. Resolve again if there are dynamic casters now or if there were some
+		// when the tile was last resolved
+		return (hasDynamicCasters || hadDynamicCasters) ? TileUpdate::DYNAMIC_CASTERS : TileUpdate::NONE;
+	}
+}
+
 TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 	U32 faceCount,
 	const U64* faceTimestamps,
 	const U32* faceIndices,
 	const U32* drawcallsCount,
+	const U32* dynamicDrawcallCounts,
 	const U32* lods,
 	Viewport* atlasTileViewports,
 	Viewport* scratchTileViewports,
-	TileAllocatorResult* subResults)
+	Viewport* dynamicScratchTileViewports,
+	TileUpdate* tileUpdates)
 {
 	ANKI_ASSERT(lightUuid > 0);
 	ANKI_ASSERT(faceCount > 0);
@@ -375,6 +548,7 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 	ANKI_ASSERT(faceIndices);
 	ANKI_ASSERT(drawcallsCount);
 	ANKI_ASSERT(lods);
+	ANKI_ASSERT(!dynamicDrawcallCounts || m_staticCache.m_enabled);
 
 	TileAllocatorResult res = TileAllocatorResult::ALLOCATION_FAILED;
 
@@ -403,7 +577,18 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 			return res;
 		}
 
-		subResults[i] = res;
+		if(!dynamicDrawcallCounts)
+		{
+			tileUpdates[i] = chooseTileUpdate(false, res, false, false);
+		}
+		else
+		{
+			const U64 key = computeTileKey(lightUuid, faceIndices[i]);
+			const Bool hadDynamicCasters = m_staticCache.m_tilesWithDynamicCasters.find(key)
+										   != m_staticCache.m_tilesWithDynamicCasters.getEnd();
+
+			tileUpdates[i] = chooseTileUpdate(true, res, dynamicDrawcallCounts[i] > 0, hadDynamicCasters);
+		}
 
 		// Fix viewport
 		atlasTileViewports[i][0] *= m_atlas.m_tileResolution;
@@ -412,52 +597,107 @@ TileAllocatorResult ShadowMapping::allocateTilesAndScratchTiles(U64 lightUuid,
 		atlasTileViewports[i][3] *= m_atlas.m_tileResolution;
 	}
 
-	// Allocate scratch tiles
+	// Allocate scratch tiles. The first is for all or the static casters and the second for the dynamic casters
 	for(U i = 0; i < faceCount; ++i)
 	{
-		if(subResults[i] == TileAllocatorResult::CACHED)
+		const U32 dynamicDrawcallCount = (dynamicDrawcallCounts) ? dynamicDrawcallCounts[i] : 0;
+		const Bool needsScratchTile =
+			tileUpdates[i] == TileUpdate::ALL_CASTERS || tileUpdates[i] == TileUpdate::STATIC_AND_DYNAMIC_CASTERS;
+		const Bool needsDynamicScratchTile = (tileUpdates[i] == TileUpdate::STATIC_AND_DYNAMIC_CASTERS
+												 || tileUpdates[i] == TileUpdate::DYNAMIC_CASTERS)
+											 && dynamicDrawcallCount > 0;
+
+		for(U32 tile = 0; tile < 2; ++tile)
 		{
-			continue;
-		}
+			if((tile == 0 && !needsScratchTile) || (tile == 1 && !needsDynamicScratchTile))
+			{
+				continue;
+			}
 
-		ANKI_ASSERT(subResults[i] == TileAllocatorResult::ALLOCATION_SUCCEEDED);
+			Viewport& viewport = (tile == 0) ? scratchTileViewports[i] : dynamicScratchTileViewports[i];
+			res = m_scratch.m_tileAlloc.allocate(m_r->getGlobalTimestamp(),
+				faceTimestamps[i],
+				lightUuid,
+				faceIndices[i],
+				(tile == 0) ? drawcallsCount[i] : dynamicDrawcallCount,
+				lods[i],
+				viewport);
 
-		res = m_scratch.m_tileAlloc.allocate(m_r->getGlobalTimestamp(),
-			faceTimestamps[i],
-			lightUuid,
-			faceIndices[i],
-			drawcallsCount[i],
-			lods[i],
-			scratchTileViewports[i]);
+			if(res == TileAllocatorResult::ALLOCATION_FAILED)
+			{
+				ANKI_R_LOGW("Don't have enough space in the scratch shadow mapping buffer. "
+							"If you see this message too often increase r_shadowMappingScratchTileCountX/Y");
 
-		if(res == TileAllocatorResult::ALLOCATION_FAILED)
+				// Invalidate atlas tiles
+				for(U j = 0; j < faceCount; ++j)
+				{
+					m_atlas.m_tileAlloc.invalidateCache(lightUuid, faceIndices[j]);
+				}
+
+				return res;
+			}
+
+			// Fix viewport
+			viewport[0] *= m_scratch.m_tileResolution;
+			viewport[1] *= m_scratch.m_tileResolution;
+			viewport[2] *= m_scratch.m_tileResolution;
+			viewport[3] *= m_scratch.m_tileResolution;
+
+			// Update the max view width
+			m_scratch.m_maxViewportWidth = max(m_scratch.m_maxViewportWidth, viewport[0] + viewport[2]);
+			m_scratch.m_maxViewportHeight = max(m_scratch.m_maxViewportHeight, viewport[1] + viewport[3]);
+		}
+	}
+
+	// Remember the tiles that will have dynamic casters
+	if(dynamicDrawcallCounts)
+	{
+		for(U i = 0; i < faceCount; ++i)
 		{
-			ANKI_R_LOGW("Don't have enough space in the scratch shadow mapping buffer. "
-						"If you see this message too often increase r_shadowMappingScratchTileCountX/Y");
+			const U64 key = computeTileKey(lightUuid, faceIndices[i]);
+			auto it = m_staticCache.m_tilesWithDynamicCasters.find(key);
 
-			// Invalidate atlas tiles
-			for(U j = 0; j < faceCount; ++j)
+			if(dynamicDrawcallCounts[i] > 0)
 			{
-				m_atlas.m_tileAlloc.invalidateCache(lightUuid, faceIndices[j]);
-			}
+				if(it == m_staticCache.m_tilesWithDynamicCasters.getEnd())
+				{
+					it = m_staticCache.m_tilesWithDynamicCasters.emplace(getAllocator(), key);
+				}
 
-			return res;
+				it->m_lightUuid = lightUuid;
+				it->m_lightFace = faceIndices[i];
+				it->m_lastUsedTimestamp = m_r->getGlobalTimestamp();
+			}
+			else if(it != m_staticCache.m_tilesWithDynamicCasters.getEnd())
+			{
+				m_staticCache.m_tilesWithDynamicCasters.erase(getAllocator(), it);
+			}
 		}
+	}
 
-		// Fix viewport
-		scratchTileViewports[i][0] *= m_scratch.m_tileResolution;
-		scratchTileViewports[i][1] *= m_scratch.m_tileResolution;
-		scratchTileViewports[i][2] *= m_scratch.m_tileResolution;
-		scratchTileViewports[i][3] *= m_scratch.m_tileResolution;
+	return TileAllocatorResult::ALLOCATION_SUCCEEDED;
+}
 
-		// Update the max view width
-		m_scratch.m_maxViewportWidth =
-			max(m_scratch.m_maxViewportWidth, scratchTileViewports[i][0] + scratchTileViewports[i][2]);
-		m_scratch.m_maxViewportHeight =
-			max(m_scratch.m_maxViewportHeight, scratchTileViewports[i][1] + scratchTileViewports[i][3]);
+void ShadowMapping::cleanupTilesWithDynamicCasters()
+{
+	// The tiles of lights that are not visible for a while won't be tracked any more. Invalidate them in the atlas so
+	// they won't be used with stale dynamic casters. Gather the keys first because erasing invalidates the iterators
+	DynamicArrayAuto<U64> keysToErase(getAllocator());
+	for(const StaticCache::TileWithDynamicCasters& tile : m_staticCache.m_tilesWithDynamicCasters)
+	{
+		if(m_r->getGlobalTimestamp() - tile.m_lastUsedTimestamp > TILE_WITH_DYNAMIC_CASTERS_MAX_AGE)
+		{
+			m_atlas.m_tileAlloc.invalidateCache(tile.m_lightUuid, tile.m_lightFace);
+			keysToErase.emplaceBack(computeTileKey(tile.m_lightUuid, tile.m_lightFace));
+		}
 	}
 
-	return res;
+	for(U64 key : keysToErase)
+	{
+		auto it = m_staticCache.m_tilesWithDynamicCasters.find(key);
+		ANKI_ASSERT(it != m_staticCache.m_tilesWithDynamicCasters.getEnd());
+		m_staticCache.m_tilesWithDynamicCasters.erase(getAllocator(), it);
+	}
 }
 
 void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScratchPass)
@@ -466,11 +706,18 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 	m_scratch.m_maxViewportWidth = 0;
 	m_scratch.m_maxViewportHeight = 0;
 
+	if(m_staticCache.m_enabled)
+	{
+		cleanupTilesWithDynamicCasters();
+	}
+
 	// Vars
 	const Vec4 cameraOrigin = ctx.m_renderQueue->m_cameraTransform.getTranslationPart().xyz0();
 	DynamicArrayAuto<Scratch::LightToRenderToScratchInfo> lightsToRender(ctx.m_tempAllocator);
 	U32 drawcallCount = 0;
 	DynamicArrayAuto<Atlas::ResolveWorkItem> atlasWorkItems(ctx.m_tempAllocator);
+	DynamicArrayAuto<StaticCache::StoreWorkItem> staticCacheStoreWorkItems(ctx.m_tempAllocator);
+	U32 reusedTileCount = 0;
 
 	// First thing, allocate an empty tile for empty faces of point lights
 	Viewport emptyTileViewport;
@@ -503,7 +750,8 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		Array<U32, MAX_SHADOW_CASCADES> drawcallCounts;
 		Array<Viewport, MAX_SHADOW_CASCADES> atlasViewports;
 		Array<Viewport, MAX_SHADOW_CASCADES> scratchViewports;
-		Array<TileAllocatorResult, MAX_SHADOW_CASCADES> subResults;
+		Array<Viewport, MAX_SHADOW_CASCADES> dynamicScratchViewports;
+		Array<TileUpdate, MAX_SHADOW_CASCADES> tileUpdates;
 		Array<U32, MAX_SHADOW_CASCADES> lods;
 		Array<Bool, MAX_SHADOW_CASCADES> blurAtlass;
 
@@ -528,16 +776,19 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 			}
 		}
 
+		// The cascades follow the camera so they don't use the static cache
 		const Bool allocationFailed = activeCascades == 0
 									  || allocateTilesAndScratchTiles(light.m_uuid,
 											 activeCascades,
 											 &timestamps[0],
 											 &cascadeIndices[0],
 											 &drawcallCounts[0],
+											 nullptr,
 											 &lods[0],
 											 &atlasViewports[0],
 											 &scratchViewports[0],
-											 &subResults[0])
+											 &dynamicScratchViewports[0],
+											 &tileUpdates[0])
 											 == TileAllocatorResult::ALLOCATION_FAILED;
 
 		if(!allocationFailed)
@@ -555,12 +806,16 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 						createSpotLightTextureMatrix(atlasViewports[activeCascades]) * light.m_textureMatrices[cascade];
 
 					// Push work
+					ANKI_ASSERT(tileUpdates[activeCascades] == TileUpdate::ALL_CASTERS);
 					newScratchAndAtlasResloveRenderWorkItems(atlasViewports[activeCascades],
 						scratchViewports[activeCascades],
+						dynamicScratchViewports[activeCascades],
+						tileUpdates[activeCascades],
 						blurAtlass[activeCascades],
 						light.m_shadowRenderQueues[cascade],
 						lightsToRender,
 						atlasWorkItems,
+						staticCacheStoreWorkItems,
 						drawcallCount);
 
 					++activeCascades;
@@ -589,9 +844,11 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		Array<U64, 6> timestamps;
 		Array<U32, 6> faceIndices;
 		Array<U32, 6> drawcallCounts;
+		Array<U32, 6> dynamicDrawcallCounts;
 		Array<Viewport, 6> atlasViewports;
 		Array<Viewport, 6> scratchViewports;
-		Array<TileAllocatorResult, 6> subResults;
+		Array<Viewport, 6> dynamicScratchViewports;
+		Array<TileUpdate, 6> tileUpdates;
 		Array<U32, 6> lods;
 		U32 numOfFacesThatHaveDrawcalls = 0;
 
@@ -601,16 +858,25 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		for(U32 face = 0; face < 6; ++face)
 		{
 			ANKI_ASSERT(light->m_shadowRenderQueues[face]);
-			if(light->m_shadowRenderQueues[face]->m_renderables.getSize())
+			const RenderQueue& queue = *light->m_shadowRenderQueues[face];
+			if(queue.m_renderables.getSize())
 			{
 				// Has renderables, need to allocate tiles for it so add it to the arrays
 
 				faceIndices[numOfFacesThatHaveDrawcalls] = face;
-				timestamps[numOfFacesThatHaveDrawcalls] =
-					light->m_shadowRenderQueues[face]->m_shadowRenderablesLastUpdateTimestamp;
 
-				drawcallCounts[numOfFacesThatHaveDrawcalls] =
-					light->m_shadowRenderQueues[face]->m_renderables.getSize();
+				if(m_staticCache.m_enabled)
+				{
+					timestamps[numOfFacesThatHaveDrawcalls] = queue.m_staticShadowRenderablesLastUpdateTimestamp;
+					drawcallCounts[numOfFacesThatHaveDrawcalls] = queue.m_staticShadowRenderableCount;
+					dynamicDrawcallCounts[numOfFacesThatHaveDrawcalls] =
+						queue.m_renderables.getSize() - queue.m_staticShadowRenderableCount;
+				}
+				else
+				{
+					timestamps[numOfFacesThatHaveDrawcalls] = queue.m_shadowRenderablesLastUpdateTimestamp;
+					drawcallCounts[numOfFacesThatHaveDrawcalls] = queue.m_renderables.getSize();
+				}
 
 				lods[numOfFacesThatHaveDrawcalls] = lod;
 
@@ -624,10 +890,12 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 											 &timestamps[0],
 											 &faceIndices[0],
 											 &drawcallCounts[0],
+											 (m_staticCache.m_enabled) ? &dynamicDrawcallCounts[0] : nullptr,
 											 &lods[0],
 											 &atlasViewports[0],
 											 &scratchViewports[0],
-											 &subResults[0])
+											 &dynamicScratchViewports[0],
+											 &tileUpdates[0])
 											 == TileAllocatorResult::ALLOCATION_FAILED;
 
 		if(!allocationFailed)
@@ -648,22 +916,28 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 					// Has drawcalls, asigned it to a tile
 
 					const Viewport& atlasViewport = atlasViewports[numOfFacesThatHaveDrawcalls];
-					const Viewport& scratchViewport = scratchViewports[numOfFacesThatHaveDrawcalls];
 
 					// Add a half texel to the viewport's start to avoid bilinear filtering bleeding
 					light->m_shadowAtlasTileOffsets[face].x() = (F32(atlasViewport[0]) + 0.5f) / atlasResolution;
 					light->m_shadowAtlasTileOffsets[face].y() = (F32(atlasViewport[1]) + 0.5f) / atlasResolution;
 
-					if(subResults[numOfFacesThatHaveDrawcalls] != TileAllocatorResult::CACHED)
+					if(tileUpdates[numOfFacesThatHaveDrawcalls] != TileUpdate::NONE)
 					{
 						newScratchAndAtlasResloveRenderWorkItems(atlasViewport,
-							scratchViewport,
+							scratchViewports[numOfFacesThatHaveDrawcalls],
+							dynamicScratchViewports[numOfFacesThatHaveDrawcalls],
+							tileUpdates[numOfFacesThatHaveDrawcalls],
 							blurAtlas,
 							light->m_shadowRenderQueues[face],
 							lightsToRender,
 							atlasWorkItems,
+							staticCacheStoreWorkItems,
 							drawcallCount);
 					}
+					else
+					{
+						++reusedTileCount;
+					}
 
 					++numOfFacesThatHaveDrawcalls;
 				}
@@ -691,26 +965,34 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 	for(SpotLightQueueElement* light : ctx.m_renderQueue->m_shadowSpotLights)
 	{
 		ANKI_ASSERT(light->m_shadowRenderQueue);
+		const RenderQueue& queue = *light->m_shadowRenderQueue;
 
 		// Allocate tiles
 		U32 faceIdx = 0;
-		TileAllocatorResult subResult;
+		TileUpdate tileUpdate;
 		Viewport atlasViewport;
 		Viewport scratchViewport;
-		const U32 localDrawcallCount = light->m_shadowRenderQueue->m_renderables.getSize();
+		Viewport dynamicScratchViewport;
+		const U32 localDrawcallCount =
+			(m_staticCache.m_enabled) ? queue.m_staticShadowRenderableCount : queue.m_renderables.getSize();
+		const U32 localDynamicDrawcallCount = queue.m_renderables.getSize() - localDrawcallCount;
+		const Timestamp timestamp = (m_staticCache.m_enabled) ? queue.m_staticShadowRenderablesLastUpdateTimestamp
+															  : queue.m_shadowRenderablesLastUpdateTimestamp;
 
 		Bool blurAtlas;
 		const U32 lod = choseLod(cameraOrigin, *light, blurAtlas);
-		const Bool allocationFailed = localDrawcallCount == 0
+		const Bool allocationFailed = queue.m_renderables.getSize() == 0
 									  || allocateTilesAndScratchTiles(light->m_uuid,
 											 1,
-											 &light->m_shadowRenderQueue->m_shadowRenderablesLastUpdateTimestamp,
+											 &timestamp,
 											 &faceIdx,
 											 &localDrawcallCount,
+											 (m_staticCache.m_enabled) ? &localDynamicDrawcallCount : nullptr,
 											 &lod,
 											 &atlasViewport,
 											 &scratchViewport,
-											 &subResult)
+											 &dynamicScratchViewport,
+											 &tileUpdate)
 											 == TileAllocatorResult::ALLOCATION_FAILED;
 
 		if(!allocationFailed)
@@ -720,16 +1002,23 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 			// Update the texture matrix to point to the correct region in the atlas
 			light->m_textureMatrix = createSpotLightTextureMatrix(atlasViewport) * light->m_textureMatrix;
 
-			if(subResult != TileAllocatorResult::CACHED)
+			if(tileUpdate != TileUpdate::NONE)
 			{
 				newScratchAndAtlasResloveRenderWorkItems(atlasViewport,
 					scratchViewport,
+					dynamicScratchViewport,
+					tileUpdate,
 					blurAtlas,
 					light->m_shadowRenderQueue,
 					lightsToRender,
 					atlasWorkItems,
+					staticCacheStoreWorkItems,
 					drawcallCount);
 			}
+			else
+			{
+				++reusedTileCount;
+			}
 		}
 		else
 		{
@@ -738,6 +1027,9 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		}
 	}
 
+	ANKI_TRACE_INC_COUNTER(R_SHADOW_TILES_REUSED, reusedTileCount);
+	(void)reusedTileCount;
+
 	// Split the work that will happen in the scratch buffer
 	if(lightsToRender.getSize())
 	{
@@ -746,16 +1038,36 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		U32 lightToRenderDrawcallCount = lightToRender->m_drawcallCount;
 		const Scratch::LightToRenderToScratchInfo* lightToRenderEnd = lightsToRender.getEnd();
 
-		const U32 threadCount = computeNumberOfSecondLevelCommandBuffers(drawcallCount);
+		// Group the renderables of every light and estimate the cost of recording them to balance the work of the
+		// threads. The grouping happens first so the instances of a drawcall are recorded by the same thread
+		WeakArray<U32> costPrefixSum(ctx.m_tempAllocator.newArray<U32>(drawcallCount), drawcallCount);
+		U32 totalCost = 0;
+		U32 renderableCount = 0;
+		for(Scratch::LightToRenderToScratchInfo& light : lightsToRender)
+		{
+			const ConstWeakArray<RenderableQueueElement> renderables = m_r->getSceneDrawer().groupRenderables(
+				ConstWeakArray<RenderableQueueElement>(light.m_renderables, light.m_drawcallCount),
+				MAX_LOD_COUNT - 1,
+				ctx.m_tempAllocator);
+			light.m_renderables = renderables.getBegin();
+
+			totalCost = computeRenderableDrawCostPrefixSum(renderables,
+				totalCost,
+				WeakArray<U32>(costPrefixSum.getBegin() + renderableCount, light.m_drawcallCount));
+			renderableCount += light.m_drawcallCount;
+		}
+		ANKI_ASSERT(renderableCount == drawcallCount);
+
+		const U32 threadCount =
+			computeNumberOfSecondLevelCommandBuffers(totalCost / RENDERABLE_DRAWCALL_RECORDING_COST);
 		threadCountForScratchPass = threadCount;
 		for(U32 taskId = 0; taskId < threadCount; ++taskId)
 		{
 			U32 start, end;
-			splitThreadedProblem(taskId, threadCount, drawcallCount, start, end);
+			splitRenderablesByDrawCost(costPrefixSum, taskId, threadCount, start, end);
 
 			// While there are drawcalls in this task emit new work items
 			U32 taskDrawcallCount = end - start;
-			ANKI_ASSERT(taskDrawcallCount > 0 && "Because we used computeNumberOfSecondLevelCommandBuffers()");
 
 			while(taskDrawcallCount)
 			{
@@ -765,7 +1077,8 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 				Scratch::WorkItem workItem;
 				workItem.m_viewport = lightToRender->m_viewport;
 				workItem.m_renderQueue = lightToRender->m_renderQueue;
-				workItem.m_firstRenderableElement = lightToRender->m_drawcallCount - lightToRenderDrawcallCount;
+				workItem.m_renderableElements =
+					lightToRender->m_renderables + lightToRender->m_drawcallCount - lightToRenderDrawcallCount;
 				workItem.m_renderableElementCount = workItemDrawcallCount;
 				workItem.m_threadPoolTaskIdx = taskId;
 				workItems.emplaceBack(workItem);
@@ -790,54 +1103,134 @@ void ShadowMapping::processLights(RenderingContext& ctx, U32& threadCountForScra
 		ANKI_ASSERT(lightsToRender.getSize() <= workItems.getSize());
 
 		// All good, store the work items for the threads to pick up
-		{
-			Scratch::WorkItem* items;
-			U32 itemSize;
-			U32 itemStorageSize;
-			workItems.moveAndReset(items, itemSize, itemStorageSize);
-
-			ANKI_ASSERT(items && itemSize && itemStorageSize);
-			m_scratch.m_workItems = WeakArray<Scratch::WorkItem>(items, itemSize);
-
-			Atlas::ResolveWorkItem* atlasItems;
-			atlasWorkItems.moveAndReset(atlasItems, itemSize, itemStorageSize);
-			ANKI_ASSERT(atlasItems && itemSize && itemStorageSize);
-			m_atlas.m_resolveWorkItems = WeakArray<Atlas::ResolveWorkItem>(atlasItems, itemSize);
-		}
+		Scratch::WorkItem* items;
+		U32 itemSize;
+		U32 itemStorageSize;
+		workItems.moveAndReset(items, itemSize, itemStorageSize);
+
+		ANKI_ASSERT(items && itemSize && itemStorageSize);
+		m_scratch.m_workItems = WeakArray<Scratch::WorkItem>(items, itemSize);
 	}
 	else
 	{
+		// The scratch tiles may still be needed. They are cleared and the static casters may be in the static cache
 		m_scratch.m_workItems = WeakArray<Scratch::WorkItem>();
+		threadCountForScratchPass = 1;
+	}
+
+	// Store the rest of the work items
+	if(atlasWorkItems.getSize())
+	{
+		Atlas::ResolveWorkItem* atlasItems;
+		U32 itemSize;
+		U32 itemStorageSize;
+		atlasWorkItems.moveAndReset(atlasItems, itemSize, itemStorageSize);
+		m_atlas.m_resolveWorkItems = WeakArray<Atlas::ResolveWorkItem>(atlasItems, itemSize);
+	}
+	else
+	{
 		m_atlas.m_resolveWorkItems = WeakArray<Atlas::ResolveWorkItem>();
 	}
+
+	if(staticCacheStoreWorkItems.getSize())
+	{
+		StaticCache::StoreWorkItem* storeItems;
+		U32 itemSize;
+		U32 itemStorageSize;
+		staticCacheStoreWorkItems.moveAndReset(storeItems, itemSize, itemStorageSize);
+		m_staticCache.m_storeWorkItems = WeakArray<StaticCache::StoreWorkItem>(storeItems, itemSize);
+	}
+	else
+	{
+		m_staticCache.m_storeWorkItems = WeakArray<StaticCache::StoreWorkItem>();
+	}
 }
 
 void ShadowMapping::newScratchAndAtlasResloveRenderWorkItems(const Viewport& atlasViewport,
 	const Viewport& scratchVewport,
+	const Viewport& dynamicScratchViewport,
+	TileUpdate tileUpdate,
 	Bool blurAtlas,
 	RenderQueue* lightRenderQueue,
 	DynamicArrayAuto<Scratch::LightToRenderToScratchInfo>& scratchWorkItem,
 	DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItem,
+	DynamicArrayAuto<StaticCache::StoreWorkItem>& staticCacheStoreWorkItems,
 	U32& drawcallCount) const
 {
-	// Scratch work item
+	ANKI_ASSERT(tileUpdate != TileUpdate::NONE);
+
+	const U32 renderableCount = lightRenderQueue->m_renderables.getSize();
+	const U32 staticRenderableCount =
+		(tileUpdate == TileUpdate::ALL_CASTERS) ? renderableCount : lightRenderQueue->m_staticShadowRenderableCount;
+	const U32 dynamicRenderableCount = renderableCount - staticRenderableCount;
+
+	// Scratch work items. Skip the empty ones, the scratch tiles are cleared anyway
+	if(tileUpdate != TileUpdate::DYNAMIC_CASTERS && staticRenderableCount > 0)
 	{
 		Scratch::LightToRenderToScratchInfo toRender = {
-			scratchVewport, lightRenderQueue, lightRenderQueue->m_renderables.getSize()};
+			scratchVewport, lightRenderQueue, lightRenderQueue->m_renderables.getBegin(), staticRenderableCount};
+		scratchWorkItem.emplaceBack(toRender);
+		drawcallCount += staticRenderableCount;
+	}
+
+	if(tileUpdate != TileUpdate::ALL_CASTERS && dynamicRenderableCount > 0)
+	{
+		Scratch::LightToRenderToScratchInfo toRender = {dynamicScratchViewport,
+			lightRenderQueue,
+			lightRenderQueue->m_renderables.getBegin() + staticRenderableCount,
+			dynamicRenderableCount};
 		scratchWorkItem.emplaceBack(toRender);
-		drawcallCount += lightRenderQueue->m_renderables.getSize();
+		drawcallCount += dynamicRenderableCount;
+	}
+
+	// Static cache work item
+	if(tileUpdate == TileUpdate::STATIC_AND_DYNAMIC_CASTERS)
+	{
+		StaticCache::StoreWorkItem storeItem;
+		storeItem.m_viewportIn = scratchVewport;
+		storeItem.m_viewportOut = atlasViewport;
+		staticCacheStoreWorkItems.emplaceBack(storeItem);
+
+		ANKI_TRACE_INC_COUNTER(R_SHADOW_TILES_RENDERED, 1);
+	}
+	else if(tileUpdate == TileUpdate::DYNAMIC_CASTERS)
+	{
+		ANKI_TRACE_INC_COUNTER(R_SHADOW_TILES_DYNAMIC_ONLY, 1);
+	}
+	else
+	{
+		ANKI_TRACE_INC_COUNTER(R_SHADOW_TILES_RENDERED, 1);
 	}
 
 	// Atlas resolve work item
 	{
 		const F32 scratchAtlasWidth = F32(m_scratch.m_tileCountX * m_scratch.m_tileResolution);
 		const F32 scratchAtlasHeight = F32(m_scratch.m_tileCountY * m_scratch.m_tileResolution);
+		const F32 atlasSize = F32(m_atlas.m_tileResolution * m_atlas.m_tileCountBothAxis);
 
 		Atlas::ResolveWorkItem atlasItem;
-		atlasItem.m_uvIn[0] = F32(scratchVewport[0]) / scratchAtlasWidth;
-		atlasItem.m_uvIn[1] = F32(scratchVewport[1]) / scratchAtlasHeight;
-		atlasItem.m_uvIn[2] = F32(scratchVewport[2]) / scratchAtlasWidth;
-		atlasItem.m_uvIn[3] = F32(scratchVewport[3]) / scratchAtlasHeight;
+		atlasItem.m_sampleScratch = tileUpdate == TileUpdate::ALL_CASTERS || dynamicRenderableCount > 0;
+		atlasItem.m_sampleStaticCache = tileUpdate != TileUpdate::ALL_CASTERS;
+
+		const Viewport& scratchTileViewport =
+			(tileUpdate == TileUpdate::ALL_CASTERS) ? scratchVewport : dynamicScratchViewport;
+		if(atlasItem.m_sampleScratch)
+		{
+			atlasItem.m_uvIn[0] = F32(scratchTileViewport[0]) / scratchAtlasWidth;
+			atlasItem.m_uvIn[1] = F32(scratchTileViewport[1]) / scratchAtlasHeight;
+			atlasItem.m_uvIn[2] = F32(scratchTileViewport[2]) / scratchAtlasWidth;
+			atlasItem.m_uvIn[3] = F32(scratchTileViewport[3]) / scratchAtlasHeight;
+		}
+		else
+		{
+			atlasItem.m_uvIn = Vec4(0.0f);
+		}
+
+		// The static cache has the same layout as the atlas
+		atlasItem.m_staticCacheUvIn[0] = F32(atlasViewport[0]) / atlasSize;
+		atlasItem.m_staticCacheUvIn[1] = F32(atlasViewport[1]) / atlasSize;
+		atlasItem.m_staticCacheUvIn[2] = F32(atlasViewport[2]) / atlasSize;
+		atlasItem.m_staticCacheUvIn[3] = F32(atlasViewport[3]) / atlasSize;
 
 		atlasItem.m_viewportOut = atlasViewport;
 		atlasItem.m_blur = blurAtlas;
@@ -37,6 +37,23 @@ public:
 		return m_atlas.m_rt;
 	}
 
+	/// What needs to be rendered to update a tile of the atlas.
+	enum class TileUpdate : U8
+	{
+		NONE, ///< The tile is cached.
+		ALL_CASTERS, ///< Render all the casters to a scratch tile.
+		STATIC_AND_DYNAMIC_CASTERS, ///< Render the static and the dynamic casters to two scratch tiles.
+		DYNAMIC_CASTERS ///< Render only the dynamic casters. The static are in the static cache.
+	};
+
+	/// Decide how to update an atlas tile.
+	/// @param usesStaticCache The tile uses the static cache.
+	/// @param res The result of the atlas tile allocation.
+	/// @param hasDynamicCasters The tile has dynamic casters in this frame.
+	/// @param hadDynamicCasters The tile had dynamic casters when it was last resolved.
+	static TileUpdate chooseTileUpdate(
+		Bool usesStaticCache, TileAllocatorResult res, Bool hasDynamicCasters, Bool hadDynamicCasters);
+
 private:
 	using Viewport = Array<U32, 4>;
 
@@ -98,6 +115,36 @@ private:
 	void runShadowMapping(RenderPassWorkContext& rgraphCtx);
 	/// @}
 
+	/// @name Static shadow casters cache
+	/// @{
+
+	class StaticCache
+	{
+	public:
+		class StoreWorkItem;
+		class TileWithDynamicCasters;
+
+		TexturePtr m_tex; ///< The depth of the static casters. It has the same layout as the atlas.
+		RenderTargetHandle m_rt;
+
+		ShaderProgramResourcePtr m_storeProg;
+		ShaderProgramPtr m_storeGrProg;
+
+		/// The atlas tiles that contain dynamic casters. They need a resolve even when the casters are gone.
+		HashMap<U64, TileWithDynamicCasters> m_tilesWithDynamicCasters;
+
+		WeakArray<StoreWorkItem> m_storeWorkItems;
+		Bool m_enabled = false;
+	} m_staticCache;
+
+	ANKI_USE_RESULT Error initStaticCache(const ConfigSet& cfg);
+
+	void runStaticCacheStore(RenderPassWorkContext& rgraphCtx);
+
+	/// Forget the tiles with dynamic casters that haven't been used for a while.
+	void cleanupTilesWithDynamicCasters();
+	/// @}
+
 	/// @name Misc & common
 	/// @{
 
@@ -112,23 +159,30 @@ private:
 	U32 choseLod(const Vec4& cameraOrigin, const SpotLightQueueElement& light, Bool& blurAtlas) const;
 
 	/// Try to allocate a number of scratch tiles and regular tiles.
+	/// @param dynamicDrawcallCounts If it's nullptr the faces don't use the static cache and the timestamps and the
+	///                              drawcall counts are of all the casters. If not they are of the static casters.
 	TileAllocatorResult allocateTilesAndScratchTiles(U64 lightUuid,
 		U32 faceCount,
 		const U64* faceTimestamps,
 		const U32* faceIndices,
 		const U32* drawcallsCount,
+		const U32* dynamicDrawcallCounts,
 		const U32* lods,
 		Viewport* atlasTileViewports,
 		Viewport* scratchTileViewports,
-		TileAllocatorResult* subResults);
+		Viewport* dynamicScratchTileViewports,
+		TileUpdate* tileUpdates);
 
 	/// Add new work to render to scratch buffer and atlas buffer.
 	void newScratchAndAtlasResloveRenderWorkItems(const Viewport& atlasViewport,
 		const Viewport& scratchVewport,
+		const Viewport& dynamicScratchViewport,
+		TileUpdate tileUpdate,
 		Bool blurAtlas,
 		RenderQueue* lightRenderQueue,
 		DynamicArrayAuto<Scratch::LightToRenderToScratchInfo>& scratchWorkItem,
 		DynamicArrayAuto<Atlas::ResolveWorkItem>& atlasResolveWorkItem,
+		DynamicArrayAuto<StaticCache::StoreWorkItem>& staticCacheStoreWorkItems,
 		U32& drawcallCount) const;
 
 	/// Iterate lights and create work items.
@@ -29,9 +29,9 @@ Error ShadowmapsResolve::init(const ConfigSet& cfg)
 
 Error ShadowmapsResolve::initInternal(const ConfigSet& cfg)
 {
-	U32 width = U32(cfg.getNumberF32("r_smResolveFactor") * F32(m_r->getWidth()));
+	U32 width = U32(cfg.getNumberF32(ConfigOption::r_smResolveFactor) * F32(m_r->getWidth()));
 	width = min(m_r->getWidth(), getAlignedRoundUp(4, width));
-	U32 height = U32(cfg.getNumberF32("r_smResolveFactor") * F32(m_r->getHeight()));
+	U32 height = U32(cfg.getNumberF32(ConfigOption::r_smResolveFactor) * F32(m_r->getHeight()));
 	height = min(m_r->getHeight(), getAlignedRoundUp(4, height));
 	ANKI_R_LOGI("Initializing shadow resolve pass. Size %ux%u", width, height);
 
@@ -37,8 +37,8 @@ Error Ssgi::initInternal(const ConfigSet& cfg)
 	const U32 height = m_r->getHeight();
 	ANKI_ASSERT((width % 2) == 0 && (height % 2) == 0 && "The algorithms won't work");
 	ANKI_R_LOGI("Initializing SSGI pass");
-	m_main.m_maxSteps = cfg.getNumberU32("r_ssgiMaxSteps");
-	m_main.m_depthLod = min(cfg.getNumberU32("r_ssgiDepthLod"), m_r->getDepthDownscale().getMipmapCount() - 1);
+	m_main.m_maxSteps = cfg.getNumberU32(ConfigOption::r_ssgiMaxSteps);
+	m_main.m_depthLod = min(cfg.getNumberU32(ConfigOption::r_ssgiDepthLod), m_r->getDepthDownscale().getMipmapCount() - 1);
 	m_main.m_firstStepPixels = 32;
 
 	ANKI_CHECK(getResourceManager().loadResource("engine_data/BlueNoiseRgb816x16.png", m_main.m_noiseTex));
@@ -34,8 +34,8 @@ Error Ssr::initInternal(const ConfigSet& cfg)
 	const U32 width = m_r->getWidth();
 	const U32 height = m_r->getHeight();
 	ANKI_R_LOGI("Initializing SSR pass (%ux%u)", width, height);
-	m_maxSteps = cfg.getNumberU32("r_ssrMaxSteps");
-	m_depthLod = cfg.getNumberU32("r_ssrDepthLod");
+	m_maxSteps = cfg.getNumberU32(ConfigOption::r_ssrMaxSteps);
+	m_depthLod = cfg.getNumberU32(ConfigOption::r_ssrDepthLod);
 	m_firstStepPixels = 32;
 
 	ANKI_CHECK(getResourceManager().loadResource("engine_data/BlueNoiseRgb816x16.png", m_noiseTex));
@@ -5,8 +5,18 @@
 
 ANKI_CONFIG_OPTION(rsrc_maxTextureSize, 1024u * 1024u, 4u, MAX_U32)
 ANKI_CONFIG_OPTION(rsrc_dumpShaderSources, 0, 0, 1)
+ANKI_CONFIG_OPTION(rsrc_lazyShaderVariants,
+	0,
+	0,
+	1,
+	"Compile only the shader variants that were used before. The rest are compiled on demand")
 ANKI_CONFIG_OPTION(rsrc_dataPaths,
 	".",
 	"The engine loads assets only in from these paths. Separate them with : (it's smart enough to identify drive "
 	"letters in Windows)")
 ANKI_CONFIG_OPTION(rsrc_transferScratchMemorySize, 256_MB, 1_MB, 4_GB)
+ANKI_CONFIG_OPTION(rsrc_gpuMemoryBudget,
+	0,
+	0,
+	64_GB,
+	"Release the least recently used GPU caches when the GPU memory gets over this. Zero means no limit")
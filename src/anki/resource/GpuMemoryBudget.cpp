@@ -0,0 +1,98 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/resource/GpuMemoryBudget.h>
+#include <anki/util/Tracer.h>
+
+namespace anki
+{
+
+void GpuMemoryBudget::registerEvictable(GpuMemoryEvictable& obj)
+{
+	ANKI_ASSERT(!obj.m_registered);
+
+	LockGuard<Mutex> lock(m_mtx);
+	obj.m_registered = true;
+	obj.m_lastUsedFrame = m_frame;
+	m_lru.pushBack(&obj);
+	m_evictableMemory.fetchAdd(obj.getEvictableGpuMemory());
+}
+
+void GpuMemoryBudget::unregisterEvictable(GpuMemoryEvictable& obj)
+{
+	LockGuard<Mutex> lock(m_mtx);
+	if(obj.m_registered)
+	{
+		m_lru.erase(&obj);
+		obj.m_registered = false;
+		m_evictableMemory.fetchSub(obj.getEvictableGpuMemory());
+	}
+}
+
+void GpuMemoryBudget::touch(GpuMemoryEvictable& obj)
+{
+	LockGuard<Mutex> lock(m_mtx);
+	ANKI_ASSERT(obj.m_registered);
+
+	// Move it to the back only the first time it's used in a frame
+	if(obj.m_lastUsedFrame != m_frame)
+	{
+		obj.m_lastUsedFrame = m_frame;
+		m_lru.erase(&obj);
+		m_lru.pushBack(&obj);
+	}
+}
+
+GpuMemoryEvictable* GpuMemoryBudget::popEvictionCandidate()
+{
+	LockGuard<Mutex> lock(m_mtx);
+
+	if(m_lru.isEmpty())
+	{
+		return nullptr;
+	}
+
+	GpuMemoryEvictable& obj = m_lru.getFront();
+	if(obj.m_lastUsedFrame + m_minFrameAge >= m_frame)
+	{
+		// The rest are even more recent
+		return nullptr;
+	}
+
+	m_lru.popFront();
+	obj.m_registered = false;
+	m_evictableMemory.fetchSub(obj.getEvictableGpuMemory());
+	return &obj;
+}
+
+PtrSize GpuMemoryBudget::endFrame(PtrSize usedGpuMemory)
+{
+	PtrSize evictedMemory = 0;
+
+	if(m_budget > 0)
+	{
+		// Evict outside the lock because evict() might touch or register other objects
+		while(usedGpuMemory > m_budget + evictedMemory)
+		{
+			GpuMemoryEvictable* obj = popEvictionCandidate();
+			if(obj == nullptr)
+			{
+				break;
+			}
+
+			evictedMemory += obj->getEvictableGpuMemory();
+			obj->evict();
+			++m_evictionCount;
+			ANKI_TRACE_INC_COUNTER(RESOURCE_GPU_MEMORY_EVICTIONS, 1);
+		}
+	}
+
+	LockGuard<Mutex> lock(m_mtx);
+	++m_frame;
+
+	return evictedMemory;
+}
+
+} // end namespace anki
@@ -0,0 +1,114 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/resource/Common.h>
+#include <anki/util/List.h>
+#include <anki/util/Thread.h>
+
+namespace anki
+{
+
+/// @addtogroup resource
+/// @{
+
+/// Something that owns GPU memory that it can release and recreate when it's needed (eg a cached GI probe volume).
+class GpuMemoryEvictable : public IntrusiveListEnabled<GpuMemoryEvictable>
+{
+	friend class GpuMemoryBudget;
+
+public:
+	virtual ~GpuMemoryEvictable()
+	{
+		ANKI_ASSERT(!m_registered && "Forgot to unregister");
+	}
+
+	/// The GPU memory that evict() will release.
+	virtual PtrSize getEvictableGpuMemory() const = 0;
+
+	/// Release the GPU memory. It's called by the main thread between frames after the object has been unregistered.
+	virtual void evict() = 0;
+
+	Bool isRegistered() const
+	{
+		return m_registered;
+	}
+
+private:
+	U64 m_lastUsedFrame = 0;
+	Bool m_registered = false;
+};
+
+/// Keeps the GPU memory under a budget by evicting the least recently used GpuMemoryEvictable objects.
+class GpuMemoryBudget : public NonCopyable
+{
+public:
+	GpuMemoryBudget() = default;
+
+	~GpuMemoryBudget()
+	{
+		ANKI_ASSERT(m_lru.isEmpty() && "Forgot to unregister some objects");
+	}
+
+	/// @param budget The max GPU memory. Zero means no limit.
+	/// @param minFrameAge The objects that were used in the current frame or in the minFrameAge frames before it are
+	///                    not evicted because the GPU might still use them.
+	void init(PtrSize budget, U32 minFrameAge)
+	{
+		m_budget = budget;
+		m_minFrameAge = minFrameAge;
+	}
+
+	PtrSize getBudget() const
+	{
+		return m_budget;
+	}
+
+	/// Make an object a candidate for eviction. Call it when its GPU memory is loaded.
+	/// @note Thread-safe.
+	void registerEvictable(GpuMemoryEvictable& obj);
+
+	/// Call it when the object is destroyed or when it releases its memory by itself.
+	/// @note Thread-safe.
+	void unregisterEvictable(GpuMemoryEvictable& obj);
+
+	/// Mark the object as used in the current frame.
+	/// @note Thread-safe.
+	void touch(GpuMemoryEvictable& obj);
+
+	/// Evict objects starting from the least recently used until the GPU memory fits in the budget and then move to
+	/// the next frame.
+	/// @param usedGpuMemory The GPU memory that is currently allocated.
+	/// @return The memory of the evicted objects.
+	PtrSize endFrame(PtrSize usedGpuMemory);
+
+	/// The memory of the objects that can be evicted.
+	PtrSize getEvictableGpuMemory() const
+	{
+		return m_evictableMemory.load();
+	}
+
+	/// The number of objects that were evicted since the beginning.
+	U64 getEvictionCount() const
+	{
+		return m_evictionCount;
+	}
+
+private:
+	IntrusiveList<GpuMemoryEvictable> m_lru; ///< The front is the least recently used.
+	Mutex m_mtx;
+	U64 m_frame = 1;
+	PtrSize m_budget = 0;
+	U32 m_minFrameAge = 0;
+	Atomic<PtrSize> m_evictableMemory = {0};
+	U64 m_evictionCount = 0;
+
+	/// Pop the least recently used object if it can be evicted.
+	GpuMemoryEvictable* popEvictionCandidate();
+};
+/// @}
+
+} // end namespace anki
@@ -116,6 +116,14 @@ MaterialResource::~MaterialResource()
 		}
 	}
 
+	for(MaterialVariant* variant : m_fallbackVariants)
+	{
+		variant->m_blockInfos.destroy(getAllocator());
+		variant->m_opaqueBindings.destroy(getAllocator());
+		getAllocator().deleteInstance(variant);
+	}
+	m_fallbackVariants.destroy(getAllocator());
+
 	for(MaterialVariable& var : m_vars)
 	{
 		var.m_name.destroy(getAllocator());
@@ -447,9 +455,11 @@ Error MaterialResource::findBuiltinMutators()
 	return Error::NONE;
 }
 
-Error MaterialResource::parseVariable(CString fullVarName, Bool& instanced, U32& idx, CString& name)
+Error MaterialResource::parseVariable(
+	CString fullVarName, Bool& instanced, Bool& bindlessTexture, U32& idx, CString& name)
 {
 	idx = 0;
+	bindlessTexture = false;
 
 	if(fullVarName.find("u_ankiPerDraw") != CString::NPOS)
 	{
@@ -459,6 +469,11 @@ Error MaterialResource::parseVariable(CString fullVarName, Bool& instanced, U32&
 	{
 		instanced = true;
 	}
+	else if(fullVarName.find("u_ankiBindlessTextures") != CString::NPOS)
+	{
+		instanced = false;
+		bindlessTexture = true;
+	}
 	else
 	{
 		ANKI_RESOURCE_LOGE("Wrong variable name: %s", fullVarName.cstr());
@@ -538,9 +553,10 @@ Error MaterialResource::createVars()
 		for(const ShaderProgramBinaryVariable& var : block.m_variables)
 		{
 			Bool instanced;
+			Bool bindlessTexture;
 			U32 idx;
 			CString name;
-			ANKI_CHECK(parseVariable(var.m_name.getBegin(), instanced, idx, name));
+			ANKI_CHECK(parseVariable(var.m_name.getBegin(), instanced, bindlessTexture, idx, name));
 			ANKI_ASSERT(name.getLength() > 0 && (instanced || idx == 0));
 
 			if(idx > 0)
@@ -577,8 +593,15 @@ Error MaterialResource::createVars()
 			in.m_indexInBinary = U32(&var - block.m_variables.getBegin());
 			in.m_constant = false;
 			in.m_instanced = instanced;
+			in.m_bindlessTexture = bindlessTexture;
 			in.m_dataType = var.m_type;
 
+			if(bindlessTexture && in.m_dataType != ShaderVariableDataType::UINT)
+			{
+				ANKI_RESOURCE_LOGE("Bindless texture variables should be U32: %s", var.m_name.getBegin());
+				return Error::USER_DATA;
+			}
+
 			// Check if it's builtin
 			ANKI_CHECK(checkBuiltin(name, in.m_dataType, instanced, in.m_builtin));
 		}
@@ -593,6 +616,20 @@ Error MaterialResource::createVars()
 	// Continue with the opaque if it's a material shader program
 	for(const ShaderProgramBinaryOpaque& o : binary.m_opaques)
 	{
+		// The bindless descriptor set is shared by all materials, skip it
+		if(CString(o.m_name.getBegin()).find("u_bindless") == 0)
+		{
+			if(o.m_set == descriptorSet
+				|| (m_bindlessDescriptorSetIdx != MAX_U8 && m_bindlessDescriptorSetIdx != o.m_set))
+			{
+				ANKI_RESOURCE_LOGE("Wrong descriptor set for the bindless textures: %s", o.m_name.getBegin());
+				return Error::USER_DATA;
+			}
+
+			m_bindlessDescriptorSetIdx = U8(o.m_set);
+			continue;
+		}
+
 		maxDescriptorSet = max(maxDescriptorSet, o.m_set);
 
 		if(o.m_set != descriptorSet)
@@ -736,7 +773,26 @@ Error MaterialResource::parseInputs(XmlElement inputsEl, Bool async)
 				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_ivec4));
 				break;
 			case ShaderVariableDataType::UINT:
-				ANKI_CHECK(inputEl.getAttributeNumber("value", foundVar->m_uint));
+				if(foundVar->m_bindlessTexture)
+				{
+					CString texfname;
+					ANKI_CHECK(inputEl.getAttributeText("value", texfname));
+					ANKI_CHECK(getManager().loadResource(texfname, foundVar->m_tex, async));
+
+					const TextureViewPtr& view = foundVar->m_tex->getGrTextureView();
+					if(view->getTextureType() != TextureType::_2D)
+					{
+						ANKI_RESOURCE_LOGE("Only 2D textures can be bindless: %s", varName.cstr());
+						return Error::USER_DATA;
+					}
+
+					// Add it to the bindless set now and not while rendering
+					foundVar->m_uint = view->getOrCreateBindlessTextureIndex();
+				}
+				else
+				{
+					ANKI_CHECK(inputEl.getAttributeNumber("value", foundVar->m_uint));
+				}
 				break;
 			case ShaderVariableDataType::UVEC2:
 				ANKI_CHECK(inputEl.getAttributeNumbers("value", foundVar->m_uvec2));
@@ -901,12 +957,24 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 	}
 
 	const ShaderProgramResourceVariant* progVariant;
-	m_prog->getOrCreateVariant(initInfo, progVariant);
+	if(m_prog->getOrCreateVariantAsync(initInfo, progVariant))
+	{
+		// Init the variant
+		initVariant(*progVariant, variant, key.getInstanceCount());
+		return variant;
+	}
 
-	// Init the variant
-	initVariant(*progVariant, variant, key.getInstanceCount());
+	// The program variant is compiled in the background, use a fallback variant until then
+	const U32 idx = U32(&variant - &m_variantMatrix[0][0][0][0][0]);
+	auto it = m_fallbackVariants.find(idx);
+	if(it == m_fallbackVariants.getEnd())
+	{
+		MaterialVariant* fallback = getAllocator().newInstance<MaterialVariant>();
+		initVariant(*progVariant, *fallback, key.getInstanceCount());
+		it = m_fallbackVariants.emplace(getAllocator(), idx, fallback);
+	}
 
-	return variant;
+	return **it;
 }
 
 void MaterialResource::initVariant(
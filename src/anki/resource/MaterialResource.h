@@ -82,6 +82,7 @@ public:
 		m_indexInBinary2ndElement = b.m_indexInBinary2ndElement;
 		m_constant = b.m_constant;
 		m_instanced = b.m_instanced;
+		m_bindlessTexture = b.m_bindlessTexture;
 		m_dataType = b.m_dataType;
 		m_builtin = b.m_builtin;
 		m_mat4 = b.m_mat4;
@@ -114,6 +115,13 @@ public:
 		return m_dataType == ShaderVariableDataType::SAMPLER;
 	}
 
+	/// The variable is a U32 in the uniform block that holds the index of a texture in the bindless descriptor set. The
+	/// material sets a texture to it like it does for the texture variables.
+	Bool isBindlessTexture() const
+	{
+		return m_bindlessTexture;
+	}
+
 	Bool inBlock() const
 	{
 		return !m_constant && !isTexture() && !isSampler();
@@ -149,6 +157,7 @@ protected:
 	U32 m_indexInBinary2ndElement = MAX_U32;
 	Bool m_constant = false;
 	Bool m_instanced = false;
+	Bool m_bindlessTexture = false;
 	ShaderVariableDataType m_dataType = ShaderVariableDataType::NONE;
 	BuiltinMaterialVariableId m_builtin = BuiltinMaterialVariableId::NONE;
 
@@ -209,7 +218,7 @@ ANKI_SPECIALIZE_GET_VALUE(Mat4, m_mat4, MAT4)
 template<>
 inline const TextureResourcePtr& MaterialVariable::getValue() const
 {
-	ANKI_ASSERT(isTexture());
+	ANKI_ASSERT(isTexture() || isBindlessTexture());
 	ANKI_ASSERT(m_builtin == BuiltinMaterialVariableId::NONE);
 	return m_tex;
 }
@@ -289,6 +298,10 @@ private:
 /// </material>
 /// @endcode
 /// (1): Only for non-builtins.
+///
+/// The textures can be bindless. Instead of a texture binding the shader program declares the bindless descriptor set
+/// (ANKI_BINDLESS_SET) and a U32 "u_ankiBindlessTextures.name" in the b_ankiMaterial UBO. The <input> with that name
+/// sets a texture like for the other textures and the index of the texture is written to the UBO.
 class MaterialResource : public ResourceObject
 {
 public:
@@ -335,6 +348,18 @@ public:
 		return m_descriptorSetIdx;
 	}
 
+	/// If true the bindless descriptor set should be bound to getBindlessDescriptorSetIndex().
+	Bool usesBindlessTextures() const
+	{
+		return m_bindlessDescriptorSetIdx != MAX_U8;
+	}
+
+	U32 getBindlessDescriptorSetIndex() const
+	{
+		ANKI_ASSERT(usesBindlessTextures());
+		return m_bindlessDescriptorSetIdx;
+	}
+
 	U32 getBoneTransformsBinding() const
 	{
 		return m_boneTrfsBinding;
@@ -369,6 +394,7 @@ private:
 	Bool m_forwardShading = false;
 	U8 m_lodCount = 1;
 	U8 m_descriptorSetIdx = MAX_U8; ///< The material set.
+	U8 m_bindlessDescriptorSetIdx = MAX_U8;
 	U32 m_uboIdx = MAX_U32; ///< The b_ankiMaterial UBO inside the binary.
 	U32 m_uboBinding = MAX_U32;
 	U32 m_boneTrfsBinding = MAX_U32;
@@ -378,13 +404,17 @@ private:
 	mutable Array5d<MaterialVariant, U(Pass::COUNT), MAX_LOD_COUNT, MAX_INSTANCE_GROUPS, 2, 2> m_variantMatrix;
 	mutable RWMutex m_variantMatrixMtx;
 
+	/// Variants that use a fallback program until the real one is compiled. Indexed by the position in m_variantMatrix.
+	mutable HashMap<U32, MaterialVariant*> m_fallbackVariants;
+
 	DynamicArray<MaterialVariable> m_vars;
 
 	DynamicArray<SubMutation> m_nonBuiltinsMutation;
 
 	ANKI_USE_RESULT Error createVars();
 
-	static ANKI_USE_RESULT Error parseVariable(CString fullVarName, Bool& instanced, U32& idx, CString& name);
+	static ANKI_USE_RESULT Error parseVariable(
+		CString fullVarName, Bool& instanced, Bool& bindlessTexture, U32& idx, CString& name);
 
 	/// Parse whatever is inside the <inputs> tag.
 	ANKI_USE_RESULT Error parseInputs(XmlElement inputsEl, Bool async);
@@ -41,14 +41,17 @@ Error ResourceManager::init(ResourceManagerInitInfo& init)
 	m_physics = init.m_physics;
 	m_fs = init.m_resourceFs;
 	m_alloc = ResourceAllocator<U8>(init.m_allocCallback, init.m_allocCallbackData);
+	m_alloc.getMemoryPool().setMemoryTag(MemoryTag::RESOURCE);
 
 	m_tmpAlloc = TempResourceAllocator<U8>(init.m_allocCallback, init.m_allocCallbackData, 10 * 1024 * 1024);
+	m_tmpAlloc.getMemoryPool().setMemoryTag(MemoryTag::RESOURCE);
 
 	m_cacheDir.create(m_alloc, init.m_cacheDir);
 
 	// Init some constants
-	m_maxTextureSize = init.m_config->getNumberU32("rsrc_maxTextureSize");
-	m_dumpShaderSource = init.m_config->getBool("rsrc_dumpShaderSources");
+	m_maxTextureSize = init.m_config->getNumberU32(ConfigOption::rsrc_maxTextureSize);
+	m_dumpShaderSource = init.m_config->getBool(ConfigOption::rsrc_dumpShaderSources);
+	m_lazyShaderVariants = init.m_config->getBool(ConfigOption::rsrc_lazyShaderVariants);
 
 	// Init type resource managers
 #define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) TypeResourceManager<rsrc_>::init(m_alloc);
@@ -62,7 +65,10 @@ Error ResourceManager::init(ResourceManagerInitInfo& init)
 	m_asyncLoader->init(m_alloc);
 
 	m_transferGpuAlloc = m_alloc.newInstance<TransferGpuAllocator>();
-	ANKI_CHECK(m_transferGpuAlloc->init(init.m_config->getNumberU32("rsrc_transferScratchMemorySize"), m_gr, m_alloc));
+	ANKI_CHECK(m_transferGpuAlloc->init(
+		init.m_config->getNumberU32(ConfigOption::rsrc_transferScratchMemorySize), m_gr, m_alloc));
+
+	m_gpuMemBudget.init(init.m_config->getNumberU64(ConfigOption::rsrc_gpuMemoryBudget), MAX_FRAMES_IN_FLIGHT);
 
 	return Error::NONE;
 }
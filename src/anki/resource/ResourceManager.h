@@ -6,6 +6,7 @@
 #pragma once
 
 #include <anki/resource/TransferGpuAllocator.h>
+#include <anki/resource/GpuMemoryBudget.h>
 #include <anki/util/List.h>
 #include <anki/util/Functions.h>
 #include <anki/util/String.h>
@@ -139,6 +140,11 @@ public:
 		return m_dumpShaderSource;
 	}
 
+	ANKI_INTERNAL Bool getLazyShaderVariants() const
+	{
+		return m_lazyShaderVariants;
+	}
+
 	ANKI_INTERNAL ResourceAllocator<U8>& getAllocator()
 	{
 		return m_alloc;
@@ -200,6 +206,13 @@ public:
 		return *m_asyncLoader;
 	}
 
+	/// The objects that can release their GPU memory register themselves there to be evicted when the GPU memory is
+	/// over the budget.
+	ANKI_INTERNAL GpuMemoryBudget& getGpuMemoryBudget()
+	{
+		return m_gpuMemBudget;
+	}
+
 	/// Get the number of times loadResource() was called.
 	ANKI_INTERNAL U64 getLoadingRequestCount() const
 	{
@@ -221,7 +234,9 @@ private:
 	U64 m_uuid = 0;
 	U64 m_loadRequestCount = 0;
 	TransferGpuAllocator* m_transferGpuAlloc = nullptr;
+	GpuMemoryBudget m_gpuMemBudget;
 	Bool m_dumpShaderSource = false;
+	Bool m_lazyShaderVariants = false;
 };
 /// @}
 
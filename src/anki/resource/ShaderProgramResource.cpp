@@ -5,14 +5,34 @@
 
 #include <anki/resource/ShaderProgramResource.h>
 #include <anki/resource/ResourceManager.h>
+#include <anki/resource/AsyncLoader.h>
 #include <anki/gr/ShaderProgram.h>
 #include <anki/gr/GrManager.h>
 #include <anki/util/Filesystem.h>
 #include <anki/util/Functions.h>
+#include <anki/util/HighRezTimer.h>
 
 namespace anki
 {
 
+/// Compiles a variant that is not in the binary.
+class ShaderProgramResource::VariantCompileTask : public AsyncLoaderTask
+{
+public:
+	ShaderProgramResourcePtr m_rsrc; ///< Keep the resource alive until the task is done.
+	ShaderProgramResourceVariantInitInfo m_info;
+	U64 m_hash = 0;
+	U64 m_mutationHash = 0;
+
+	Error operator()(AsyncLoaderTaskContext& ctx) final
+	{
+		m_rsrc->finishVariantCompilation(*this);
+
+		// Don't fail the async loader, the fallback will be used
+		return Error::NONE;
+	}
+};
+
 ShaderProgramResourceVariant::ShaderProgramResourceVariant()
 {
 }
@@ -24,11 +44,22 @@ ShaderProgramResourceVariant::~ShaderProgramResourceVariant()
 ShaderProgramResource::ShaderProgramResource(ResourceManager* manager)
 	: ResourceObject(manager)
 	, m_binary(getAllocator())
+	, m_usedMutations(getAllocator())
 {
 }
 
 ShaderProgramResource::~ShaderProgramResource()
 {
+	if(m_usedMutationsDirty)
+	{
+		StringAuto fname(getTempAllocator());
+		getUsedMutationsFilename(getFilename(), fname);
+		if(m_usedMutations.save(fname))
+		{
+			ANKI_RESOURCE_LOGW("Failed to save the used mutations of %s", getFilename().cstr());
+		}
+	}
+
 	m_mutators.destroy(getAllocator());
 
 	for(ShaderProgramResourceConstant& c : m_consts)
@@ -38,12 +69,27 @@ ShaderProgramResource::~ShaderProgramResource()
 	m_consts.destroy(getAllocator());
 	m_constBinaryMapping.destroy(getAllocator());
 
-	for(auto it : m_variants)
+	for(ShaderProgramResourceVariant* variant : m_variants)
 	{
-		ShaderProgramResourceVariant* variant = &(*it);
-		getAllocator().deleteInstance(variant);
+		deleteVariant(variant);
 	}
 	m_variants.destroy(getAllocator());
+
+	for(ShaderProgramResourceVariant* variant : m_retiredVariants)
+	{
+		deleteVariant(variant);
+	}
+	m_retiredVariants.destroy(getAllocator());
+}
+
+void ShaderProgramResource::deleteVariant(ShaderProgramResourceVariant* variant) const
+{
+	if(variant->m_binary)
+	{
+		getAllocator().deleteInstance(variant->m_binary);
+	}
+
+	getAllocator().deleteInstance(variant);
 }
 
 Error ShaderProgramResource::load(const ResourceFilename& filename, Bool async)
@@ -164,9 +210,38 @@ Error ShaderProgramResource::load(const ResourceFilename& filename, Bool async)
 
 	m_shaderStages = binary.m_presentShaderTypes;
 
+	m_lazyVariants = getManager().getLazyShaderVariants();
+	if(m_lazyVariants)
+	{
+		StringAuto fname(getTempAllocator());
+		getUsedMutationsFilename(filename, fname);
+		ANKI_CHECK(m_usedMutations.load(fname));
+
+		// The builtin mutators change the interface of the program. The fallbacks should have the same values
+		static const Array<CString, 5> BUILTIN_MUTATORS = {
+			{"ANKI_PASS", "ANKI_INSTANCE_COUNT", "ANKI_BONES", "ANKI_VELOCITY", "ANKI_LOD"}};
+		for(U32 i = 0; i < m_mutators.getSize(); ++i)
+		{
+			for(CString name : BUILTIN_MUTATORS)
+			{
+				if(m_mutators[i].m_name == name)
+				{
+					m_builtinMutators.set(i);
+				}
+			}
+		}
+	}
+
 	return Error::NONE;
 }
 
+void ShaderProgramResource::getUsedMutationsFilename(CString rsrcFilename, StringAuto& fname) const
+{
+	StringAuto baseFilename(getTempAllocator());
+	getFilepathFilename(rsrcFilename, baseFilename);
+	fname.sprintf("%s/%svariants", getManager().getCacheDirectory().cstr(), baseFilename.cstr());
+}
+
 Error ShaderProgramResource::parseConst(CString constName, U32& componentIdx, U32& componentCount, CString& name)
 {
 	const CString prefixName = "_anki_const_";
@@ -193,8 +268,8 @@ Error ShaderProgramResource::parseConst(CString constName, U32& componentIdx, U3
 	return Error::NONE;
 }
 
-void ShaderProgramResource::getOrCreateVariant(
-	const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const
+Bool ShaderProgramResource::getOrCreateVariantInternal(
+	const ShaderProgramResourceVariantInitInfo& info, Bool async, const ShaderProgramResourceVariant*& variant) const
 {
 	// Sanity checks
 	ANKI_ASSERT(info.m_setMutators.getEnabledBitCount() == m_mutators.getSize());
@@ -202,9 +277,11 @@ void ShaderProgramResource::getOrCreateVariant(
 
 	// Compute variant hash
 	U64 hash = 0;
+	U64 mutationHash = 1;
 	if(m_mutators.getSize())
 	{
-		hash = computeHash(info.m_mutation.getBegin(), m_mutators.getSize() * sizeof(info.m_mutation[0]));
+		mutationHash = computeHash(info.m_mutation.getBegin(), m_mutators.getSize() * sizeof(info.m_mutation[0]));
+		hash = mutationHash;
 	}
 
 	if(m_consts.getSize())
@@ -219,62 +296,268 @@ void ShaderProgramResource::getOrCreateVariant(
 
 		auto it = m_variants.find(hash);
 		variant = (it != m_variants.getEnd()) ? *it : nullptr;
+	}
 
-		if(variant != nullptr)
+	if(variant != nullptr)
+	{
+		waitForCompilation(*variant);
+		if(async || !variant->m_fallback)
 		{
 			// Done
-			return;
+			return !variant->m_fallback;
 		}
 	}
 
 	// Create the variant
-	WLockGuard<RWMutex> lock(m_mtx);
+	ShaderProgramResourceVariant* v = nullptr;
+	Bool compileOnTheSpot = false;
+	{
+		WLockGuard<RWMutex> lock(m_mtx);
 
-	// Check again
-	auto it = m_variants.find(hash);
-	variant = (it != m_variants.getEnd()) ? *it : nullptr;
-	if(variant != nullptr)
+		// Check again
+		auto it = m_variants.find(hash);
+		variant = (it != m_variants.getEnd()) ? *it : nullptr;
+		if(variant != nullptr
+			&& (variant->m_compiling.load(AtomicMemoryOrder::ACQUIRE) || async || !variant->m_fallback))
+		{
+			v = const_cast<ShaderProgramResourceVariant*>(variant);
+		}
+		else
+		{
+			// Remember the mutation for the next time the program is compiled
+			if(m_lazyVariants && variant == nullptr && m_usedMutations.add(mutationHash))
+			{
+				m_usedMutationsDirty = true;
+			}
+
+			// Create
+			v = getAllocator().newInstance<ShaderProgramResourceVariant>();
+			const ShaderProgramBinaryVariant* binaryVariant = tryFindBinaryVariant(m_binary.getBinary(), mutationHash);
+			const ShaderProgramBinaryVariant* fallback = nullptr;
+			if(binaryVariant)
+			{
+				initVariant(info, m_binary.getBinary(), *binaryVariant, *v);
+			}
+			else if(async && (fallback = tryFindFallbackBinaryVariant(info, true)) != nullptr)
+			{
+				ANKI_ASSERT(m_lazyVariants && "The variant is not in the binary");
+
+				// Use the fallback and compile the real one in the background
+				initVariant(info, m_binary.getBinary(), *fallback, *v);
+				v->m_fallback = true;
+
+				VariantCompileTask* task = getManager().getAsyncLoader().newTask<VariantCompileTask>();
+				task->m_rsrc.reset(const_cast<ShaderProgramResource*>(this));
+				memcpy(&task->m_info.m_constantValues, &info.m_constantValues, sizeof(info.m_constantValues));
+				task->m_info.m_setConstants = info.m_setConstants;
+				task->m_info.m_mutation = info.m_mutation;
+				task->m_info.m_setMutators = info.m_setMutators;
+				task->m_hash = hash;
+				task->m_mutationHash = mutationHash;
+				getManager().getAsyncLoader().submitTask(task);
+			}
+			else
+			{
+				ANKI_ASSERT(m_lazyVariants && "The variant is not in the binary");
+
+				// Compile it on the spot but outside the lock. The others that need it will wait for it
+				v->m_compiling.store(true, AtomicMemoryOrder::RELEASE);
+				compileOnTheSpot = true;
+			}
+
+			if(variant)
+			{
+				// Replace the fallback
+				m_retiredVariants.emplaceBack(getAllocator(), *it);
+				*it = v;
+			}
+			else
+			{
+				m_variants.emplace(getAllocator(), hash, v);
+			}
+		}
+	}
+
+	if(compileOnTheSpot)
 	{
-		// Done
-		return;
+		compileAndInitVariant(info, mutationHash, *v);
+
+		{
+			LockGuard<Mutex> lock(m_compilingMtx);
+			v->m_compiling.store(false, AtomicMemoryOrder::RELEASE);
+		}
+		m_compilingCond.notifyAll();
+	}
+	else
+	{
+		// Someone else might compile it
+		waitForCompilation(*v);
 	}
 
-	// Create
-	ShaderProgramResourceVariant* v = getAllocator().newInstance<ShaderProgramResourceVariant>();
-	initVariant(info, *v);
-	m_variants.emplace(getAllocator(), hash, v);
 	variant = v;
+	return !v->m_fallback;
 }
 
-void ShaderProgramResource::initVariant(
-	const ShaderProgramResourceVariantInitInfo& info, ShaderProgramResourceVariant& variant) const
+void ShaderProgramResource::compileAndInitVariant(const ShaderProgramResourceVariantInitInfo& info,
+	U64 mutationHash,
+	ShaderProgramResourceVariant& variant) const
 {
-	const ShaderProgramBinary& binary = m_binary.getBinary();
+	ShaderProgramBinaryWrapper* binary;
+	if(!compileVariant(mutationHash, binary))
+	{
+		variant.m_binary = binary;
+		initVariant(info, binary->getBinary(), *tryFindBinaryVariant(binary->getBinary(), mutationHash), variant);
+		return;
+	}
 
-	// Get the binary program variant
-	const ShaderProgramBinaryVariant* binaryVariant = nullptr;
-	if(m_mutators.getSize())
+	ANKI_RESOURCE_LOGE("Failed to compile a variant of %s. Will use a fallback", getFilename().cstr());
+
+	const ShaderProgramBinaryVariant* fallback = tryFindFallbackBinaryVariant(info, true);
+	if(fallback == nullptr)
+	{
+		// Nothing better to use
+		fallback = tryFindFallbackBinaryVariant(info, false);
+	}
+
+	ANKI_ASSERT(fallback);
+	initVariant(info, m_binary.getBinary(), *fallback, variant);
+	variant.m_fallback = true;
+}
+
+void ShaderProgramResource::waitForCompilation(const ShaderProgramResourceVariant& variant) const
+{
+	if(!variant.m_compiling.load(AtomicMemoryOrder::ACQUIRE))
+	{
+		return;
+	}
+
+	LockGuard<Mutex> lock(m_compilingMtx);
+	while(variant.m_compiling.load(AtomicMemoryOrder::ACQUIRE))
 	{
-		// Create the mutation hash
-		const U64 hash = computeHash(info.m_mutation.getBegin(), m_mutators.getSize() * sizeof(info.m_mutation[0]));
+		m_compilingCond.wait(m_compilingMtx);
+	}
+}
 
-		// Search for the mutation in the binary
-		// TODO optimize the search
-		for(const ShaderProgramBinaryMutation& mutation : binary.m_mutations)
+void ShaderProgramResource::finishVariantCompilation(VariantCompileTask& task) const
+{
+	ShaderProgramResourceVariant* v = nullptr;
+	ShaderProgramBinaryWrapper* binary;
+	if(!compileVariant(task.m_mutationHash, binary))
+	{
+		v = getAllocator().newInstance<ShaderProgramResourceVariant>();
+		v->m_binary = binary;
+		initVariant(
+			task.m_info, binary->getBinary(), *tryFindBinaryVariant(binary->getBinary(), task.m_mutationHash), *v);
+	}
+	else
+	{
+		ANKI_RESOURCE_LOGE("Failed to compile a variant of %s. Will keep using the fallback", getFilename().cstr());
+	}
+
+	if(v)
+	{
+		WLockGuard<RWMutex> lock(m_mtx);
+
+		auto it = m_variants.find(task.m_hash);
+		ANKI_ASSERT(it != m_variants.getEnd());
+		if(!(*it)->m_compiling.load(AtomicMemoryOrder::ACQUIRE) && (*it)->m_fallback)
 		{
-			if(mutation.m_hash == hash)
-			{
-				binaryVariant = &binary.m_variants[mutation.m_variantIndex];
-				break;
-			}
+			m_retiredVariants.emplaceBack(getAllocator(), *it);
+			*it = v;
+			v = nullptr;
 		}
 	}
-	else
+
+	if(v)
+	{
+		// Someone else compiled it in the meantime
+		deleteVariant(v);
+	}
+}
+
+Error ShaderProgramResource::compileVariant(U64 mutationHash, ShaderProgramBinaryWrapper*& binary) const
+{
+	class FSystem : public ShaderProgramFilesystemInterface
+	{
+	public:
+		ResourceFilesystem* m_fsystem = nullptr;
+
+		Error readAllText(CString filename, StringAuto& txt) final
+		{
+			ResourceFilePtr file;
+			ANKI_CHECK(m_fsystem->openFile(filename, file));
+			ANKI_CHECK(file->readAllText(txt));
+			return Error::NONE;
+		}
+	} fsystem;
+	fsystem.m_fsystem = &getManager().getFilesystem();
+
+	const Second startTime = HighRezTimer::getCurrentTime();
+
+	GrManager& gr = getManager().getGrManager();
+	binary = getAllocator().newInstance<ShaderProgramBinaryWrapper>(getAllocator());
+	const Error err = compileShaderProgramVariant(getFilename(),
+		mutationHash,
+		m_binary.getBinary(),
+		fsystem,
+		getAllocator(),
+		gr.getDeviceCapabilities(),
+		gr.getBindlessLimits(),
+		*binary);
+
+	if(err)
+	{
+		getAllocator().deleteInstance(binary);
+		binary = nullptr;
+		return err;
+	}
+
+	ANKI_RESOURCE_LOGI("Compiled a variant of %s on demand in %fms",
+		getFilename().cstr(),
+		(HighRezTimer::getCurrentTime() - startTime) * 1000.0);
+	return Error::NONE;
+}
+
+const ShaderProgramBinaryVariant* ShaderProgramResource::tryFindBinaryVariant(
+	const ShaderProgramBinary& binary, U64 mutationHash) const
+{
+	if(m_mutators.getSize() == 0)
 	{
 		ANKI_ASSERT(binary.m_variants.getSize() == 1);
-		binaryVariant = &binary.m_variants[0];
+		return &binary.m_variants[0];
+	}
+
+	// TODO optimize the search
+	for(const ShaderProgramBinaryMutation& mutation : binary.m_mutations)
+	{
+		if(mutation.m_hash == mutationHash)
+		{
+			return (mutation.m_variantIndex != MAX_U32) ? &binary.m_variants[mutation.m_variantIndex] : nullptr;
+		}
 	}
-	ANKI_ASSERT(binaryVariant);
+
+	return nullptr;
+}
+
+const ShaderProgramBinaryVariant* ShaderProgramResource::tryFindFallbackBinaryVariant(
+	const ShaderProgramResourceVariantInitInfo& info, Bool matchBuiltinMutators) const
+{
+	const ShaderProgramBinary& binary = m_binary.getBinary();
+	const ShaderProgramBinaryMutation* mutation = findShaderProgramFallbackMutation(binary,
+		ConstWeakArray<MutatorValue>(info.m_mutation.getBegin(), m_mutators.getSize()),
+		(matchBuiltinMutators) ? m_builtinMutators : BitSet<64, U64>(false));
+
+	return (mutation) ? &binary.m_variants[mutation->m_variantIndex] : nullptr;
+}
+
+void ShaderProgramResource::initVariant(const ShaderProgramResourceVariantInitInfo& info,
+	const ShaderProgramBinary& codeBinary,
+	const ShaderProgramBinaryVariant& binaryVariant_,
+	ShaderProgramResourceVariant& variant) const
+{
+	// The variants of other binaries point to the blocks, opaques and constants of the program's binary
+	const ShaderProgramBinary& binary = m_binary.getBinary();
+	const ShaderProgramBinaryVariant* binaryVariant = &binaryVariant_;
 	variant.m_binaryVariant = binaryVariant;
 
 	// Set the constannt values
@@ -367,7 +650,7 @@ void ShaderProgramResource::initVariant(
 
 		ShaderInitInfo inf(cprogName);
 		inf.m_shaderType = shaderType;
-		inf.m_binary = binary.m_codeBlocks[binaryVariant->m_codeBlockIndices[shaderType]].m_binary;
+		inf.m_binary = codeBinary.m_codeBlocks[binaryVariant->m_codeBlockIndices[shaderType]].m_binary;
 		inf.m_constValues.setArray((constValueCount) ? constValues.getBegin() : nullptr, constValueCount);
 
 		progInf.m_shaders[shaderType] = getManager().getGrManager().newShader(inf);
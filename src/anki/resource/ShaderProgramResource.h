@@ -13,6 +13,8 @@
 #include <anki/util/String.h>
 #include <anki/util/HashMap.h>
 #include <anki/util/WeakArray.h>
+#include <anki/util/Atomic.h>
+#include <anki/util/Thread.h>
 #include <anki/Math.h>
 
 namespace anki
@@ -94,6 +96,9 @@ private:
 	const ShaderProgramBinaryVariant* m_binaryVariant = nullptr;
 	BitSet<128, U64> m_activeConsts = {false};
 	Array<U32, 3> m_workgroupSizes;
+	ShaderProgramBinaryWrapper* m_binary = nullptr; ///< If it was compiled on demand it has its own binary.
+	Bool m_fallback = false; ///< It uses another variant until the real one is compiled.
+	Atomic<Bool> m_compiling = {false}; ///< Some thread compiles it on the spot. Wait for it before using it.
 };
 
 /// The value of a constant.
@@ -166,6 +171,10 @@ private:
 };
 
 /// Shader program resource. It loads special AnKi programs.
+///
+/// The variants that are not in the binary are compiled on demand if the rsrc_lazyShaderVariants option is set. The
+/// mutations that were requested are saved in the cache directory and the next time the programs are compiled only
+/// those variants are compiled ahead of time.
 class ShaderProgramResource : public ResourceObject
 {
 public:
@@ -224,10 +233,14 @@ public:
 		return m_binary.getBinary();
 	}
 
-	/// Get or create a graphics shader program variant.
+	/// Get or create a graphics shader program variant. If the variant is not in the binary it will be compiled on
+	/// the spot. The lock of the resource is not held during the compilation.
 	/// @note It's thread-safe.
 	void getOrCreateVariant(
-		const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const;
+		const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const
+	{
+		getOrCreateVariantInternal(info, false, variant);
+	}
 
 	/// @copydoc getOrCreateVariant
 	void getOrCreateVariant(const ShaderProgramResourceVariant*& variant) const
@@ -235,10 +248,24 @@ public:
 		getOrCreateVariant(ShaderProgramResourceVariantInitInfo(), variant);
 	}
 
+	/// Same as getOrCreateVariant() but if the variant is not in the binary it will be compiled in the background.
+	/// Until then a fallback variant will be returned. The fallback has the same values for the builtin mutators (pass,
+	/// instance count, bones, velocity and LOD) and of the rest the most matching, the first mutators being the most
+	/// important. If there is no such variant it will be compiled on the spot.
+	/// @return False if the variant is a fallback. Call it again later.
+	/// @note It's thread-safe.
+	Bool getOrCreateVariantAsync(
+		const ShaderProgramResourceVariantInitInfo& info, const ShaderProgramResourceVariant*& variant) const
+	{
+		return getOrCreateVariantInternal(info, true, variant);
+	}
+
 private:
 	using Mutator = ShaderProgramResourceMutator;
 	using Const = ShaderProgramResourceConstant;
 
+	class VariantCompileTask;
+
 	ShaderProgramBinaryWrapper m_binary;
 
 	DynamicArray<Const> m_consts;
@@ -254,11 +281,48 @@ private:
 	DynamicArray<ConstMapping> m_constBinaryMapping;
 
 	mutable HashMap<U64, ShaderProgramResourceVariant*> m_variants;
+	mutable DynamicArray<ShaderProgramResourceVariant*> m_retiredVariants; ///< Replaced fallbacks. Might be in use.
 	mutable RWMutex m_mtx;
 
+	/// Signaled when a variant that was compiled on the spot is ready.
+	mutable ConditionVariable m_compilingCond;
+	mutable Mutex m_compilingMtx;
+
+	mutable ShaderProgramUsedMutations m_usedMutations; ///< The mutations that were ever requested.
+	mutable Bool m_usedMutationsDirty = false;
+	Bool m_lazyVariants = false;
+	BitSet<64, U64> m_builtinMutators = {false}; ///< The mutators that the fallbacks should match.
+
 	ShaderTypeBit m_shaderStages = ShaderTypeBit::NONE;
 
-	void initVariant(const ShaderProgramResourceVariantInitInfo& info, ShaderProgramResourceVariant& variant) const;
+	Bool getOrCreateVariantInternal(const ShaderProgramResourceVariantInitInfo& info,
+		Bool async,
+		const ShaderProgramResourceVariant*& variant) const;
+
+	void initVariant(const ShaderProgramResourceVariantInitInfo& info,
+		const ShaderProgramBinary& codeBinary,
+		const ShaderProgramBinaryVariant& binaryVariant,
+		ShaderProgramResourceVariant& variant) const;
+
+	const ShaderProgramBinaryVariant* tryFindBinaryVariant(const ShaderProgramBinary& binary, U64 mutationHash) const;
+
+	const ShaderProgramBinaryVariant* tryFindFallbackBinaryVariant(
+		const ShaderProgramResourceVariantInitInfo& info, Bool matchBuiltinMutators) const;
+
+	ANKI_USE_RESULT Error compileVariant(U64 mutationHash, ShaderProgramBinaryWrapper*& binary) const;
+
+	/// Compile a variant on the spot and initialize it. If the compilation fails it will be a fallback.
+	void compileAndInitVariant(const ShaderProgramResourceVariantInitInfo& info,
+		U64 mutationHash,
+		ShaderProgramResourceVariant& variant) const;
+
+	void waitForCompilation(const ShaderProgramResourceVariant& variant) const;
+
+	void finishVariantCompilation(VariantCompileTask& task) const;
+
+	void deleteVariant(ShaderProgramResourceVariant* variant) const;
+
+	void getUsedMutationsFilename(CString rsrcFilename, StringAuto& fname) const;
 
 	static ANKI_USE_RESULT Error parseConst(CString constName, U32& componentIdx, U32& componentCount, CString& name);
 };
@@ -94,6 +94,12 @@ Error ModelNode::init(ModelResourcePtr resource, U32 modelPatchIdx)
 	toHash[1] = resource->getUuid();
 	m_mergeKey = computeHash(&toHash[0], sizeof(toHash));
 
+	// Skinned models bind the bones of a single node so they can't be instanced
+	if(m_model->getSkeleton().isCreated())
+	{
+		m_mergeKey = 0;
+	}
+
 	// Components
 	if(m_model->getSkeleton().isCreated())
 	{
@@ -71,13 +71,16 @@ Error SceneGraph::init(AllocAlignedCallback allocCb,
 	m_scriptManager = scriptManager;
 
 	m_alloc = SceneAllocator<U8>(allocCb, allocCbData);
+	m_alloc.getMemoryPool().setMemoryTag(MemoryTag::SCENE);
 	m_frameAlloc = SceneFrameAllocator<U8>(allocCb, allocCbData, 1 * 1024 * 1024);
+	m_frameAlloc.getMemoryPool().setMemoryTag(MemoryTag::SCENE);
 
 	// Limits
-	m_limits.m_earlyZDistance = config.getNumberF32("scene_earlyZDistance");
-	m_limits.m_reflectionProbeEffectiveDistance = config.getNumberF32("scene_reflectionProbeEffectiveDistance");
+	m_limits.m_earlyZDistance = config.getNumberF32(ConfigOption::scene_earlyZDistance);
+	m_limits.m_reflectionProbeEffectiveDistance =
+		config.getNumberF32(ConfigOption::scene_reflectionProbeEffectiveDistance);
 	m_limits.m_reflectionProbeShadowEffectiveDistance =
-		config.getNumberF32("scene_reflectionProbeShadowEffectiveDistance");
+		config.getNumberF32(ConfigOption::scene_reflectionProbeShadowEffectiveDistance);
 
 	ANKI_CHECK(m_events.init(this));
 
@@ -47,13 +47,72 @@ static Bool spatialInsideFrustum(const FrustumComponent& frc, const SpatialCompo
 }
 
 void VisibilityContext::submitNewWork(const FrustumComponent& frc, RenderQueue& rqueue, ThreadHive& hive)
+{
+	const FrustumComponent* pfrc = &frc;
+	RenderQueue* prqueue = &rqueue;
+	submitNewWork(ConstWeakArray<const FrustumComponent*>(&pfrc, 1), ConstWeakArray<RenderQueue*>(&prqueue, 1), hive);
+}
+
+void VisibilityContext::submitNewWork(
+	ConstWeakArray<const FrustumComponent*> frcs, ConstWeakArray<RenderQueue*> results, ThreadHive& hive)
 {
 	ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_SUBMIT_WORK);
+	ANKI_ASSERT(frcs.getSize() == results.getSize());
+
+	// Create the contexts. The frustums that need occlusion tests will walk the octree on their own because they have
+	// to wait for their rasterizer
+	Array<FrustumVisibilityContext*, MAX_FRUSTUMS_PER_VIS_GROUP> groupCtxs;
+	U32 groupCtxCount = 0;
+	for(U32 i = 0; i < frcs.getSize(); ++i)
+	{
+		FrustumVisibilityContext* frcCtx = newFrustumVisibilityContext(*frcs[i], *results[i], hive);
+		if(frcCtx == nullptr)
+		{
+			continue;
+		}
+
+		const FrustumComponent& frc = *frcs[i];
+		if(frc.visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::OCCLUDERS) && frc.hasCoverageBuffer())
+		{
+			// Gather triangles task
+			auto alloc = m_scene->getFrameAllocator();
+			ThreadHiveTask fillDepthTask = ANKI_THREAD_HIVE_TASK({ self->fill(); },
+				alloc.newInstance<FillRasterizerWithCoverageTask>(frcCtx),
+				nullptr,
+				hive.newSemaphore(1));
+
+			hive.submitTasks(&fillDepthTask, 1);
+
+			submitGatherTask(ConstWeakArray<FrustumVisibilityContext*>(&frcCtx, 1),
+				fillDepthTask.m_signalSemaphore,
+				hive);
+		}
+		else
+		{
+			if(groupCtxCount == MAX_FRUSTUMS_PER_VIS_GROUP)
+			{
+				submitGatherTask(
+					ConstWeakArray<FrustumVisibilityContext*>(&groupCtxs[0], groupCtxCount), nullptr, hive);
+				groupCtxCount = 0;
+			}
+
+			groupCtxs[groupCtxCount++] = frcCtx;
+		}
+	}
 
+	if(groupCtxCount)
+	{
+		submitGatherTask(ConstWeakArray<FrustumVisibilityContext*>(&groupCtxs[0], groupCtxCount), nullptr, hive);
+	}
+}
+
+FrustumVisibilityContext* VisibilityContext::newFrustumVisibilityContext(
+	const FrustumComponent& frc, RenderQueue& rqueue, ThreadHive& hive)
+{
 	// Check enabled and make sure that the results are null (this can happen on multiple on circular viewing)
 	if(ANKI_UNLIKELY(!frc.anyVisibilityTestEnabled()))
 	{
-		return;
+		return nullptr;
 	}
 
 	rqueue.m_cameraTransform = Mat4(frc.getTransform());
@@ -85,7 +144,7 @@ void VisibilityContext::submitNewWork(const FrustumComponent& frc, RenderQueue&
 		{
 			if(x == &frc)
 			{
-				return;
+				return nullptr;
 			}
 		}
 
@@ -101,42 +160,30 @@ void VisibilityContext::submitNewWork(const FrustumComponent& frc, RenderQueue&
 	frcCtx->m_visTestsSignalSem = hive.newSemaphore(1);
 	frcCtx->m_renderQueue = &rqueue;
 
-	// Submit new work
-	//
-
-	// Software rasterizer task
-	ThreadHiveSemaphore* prepareRasterizerSem = nullptr;
-	if(frc.visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::OCCLUDERS) && frc.hasCoverageBuffer())
-	{
-		// Gather triangles task
-		ThreadHiveTask fillDepthTask = ANKI_THREAD_HIVE_TASK({ self->fill(); },
-			alloc.newInstance<FillRasterizerWithCoverageTask>(frcCtx),
-			nullptr,
-			hive.newSemaphore(1));
-
-		hive.submitTasks(&fillDepthTask, 1);
-
-		prepareRasterizerSem = fillDepthTask.m_signalSemaphore;
-	}
-
 	if(frc.visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::OCCLUDERS))
 	{
 		rqueue.m_fillCoverageBufferCallback = FrustumComponent::fillCoverageBufferCallback;
 		rqueue.m_fillCoverageBufferCallbackUserData = static_cast<void*>(const_cast<FrustumComponent*>(&frc));
 	}
 
-	// Gather visibles from the octree. No need to signal anything because it will spawn new tasks
-	ThreadHiveTask gatherTask = ANKI_THREAD_HIVE_TASK({ self->gather(hive); },
-		alloc.newInstance<GatherVisiblesFromOctreeTask>(frcCtx),
-		prepareRasterizerSem,
-		nullptr);
-	hive.submitTasks(&gatherTask, 1);
-
 	// Combind results task
 	ANKI_ASSERT(frcCtx->m_visTestsSignalSem);
 	ThreadHiveTask combineTask = ANKI_THREAD_HIVE_TASK(
 		{ self->combine(); }, alloc.newInstance<CombineResultsTask>(frcCtx), frcCtx->m_visTestsSignalSem, nullptr);
 	hive.submitTasks(&combineTask, 1);
+
+	return frcCtx;
+}
+
+void VisibilityContext::submitGatherTask(
+	ConstWeakArray<FrustumVisibilityContext*> frcCtxs, ThreadHiveSemaphore* waitSemaphore, ThreadHive& hive)
+{
+	// Gather visibles from the octree. No need to signal anything because it will spawn new tasks
+	ThreadHiveTask gatherTask = ANKI_THREAD_HIVE_TASK({ self->gather(hive); },
+		m_scene->getFrameAllocator().newInstance<GatherVisiblesFromOctreeTask>(frcCtxs, m_scene->getFrameAllocator()),
+		waitSemaphore,
+		nullptr);
+	hive.submitTasks(&gatherTask, 1);
 }
 
 void FillRasterizerWithCoverageTask::fill()
@@ -164,16 +211,39 @@ void FillRasterizerWithCoverageTask::fill()
 void GatherVisiblesFromOctreeTask::gather(ThreadHive& hive)
 {
 	ANKI_TRACE_SCOPED_EVENT(SCENE_VIS_OCTREE);
+	ANKI_TRACE_INC_COUNTER(SCENE_VIS_OCTREE_WALKS, 1);
 
-	U32 testIdx = m_frcCtx->m_visCtx->m_testsCount.fetchAdd(1);
+	const U32 frustumCount = m_frustums.getSize();
+	VisibilityContext& visCtx = *m_frustums[0].m_frcCtx->m_visCtx;
+	const U32 testIdx = visCtx.m_testsCount.fetchAdd(1);
+
+	// Pack the planes of all the frustums to test them at once
+	const U32 volumeGroupCount =
+		(frustumCount + ConvexVolumeGroup::MAX_VOLUMES - 1) / ConvexVolumeGroup::MAX_VOLUMES;
+	Array<ConvexVolumeGroup, MAX_FRUSTUMS_PER_VIS_GROUP / ConvexVolumeGroup::MAX_VOLUMES> volumeGroups;
+	for(U32 i = 0; i < frustumCount; ++i)
+	{
+		ANKI_ASSERT(m_frustums[i].m_frcCtx->m_visCtx == &visCtx);
+		const auto& planes = m_frustums[i].m_frcCtx->m_frc->getViewPlanes();
+		volumeGroups[i / ConvexVolumeGroup::MAX_VOLUMES].setVolume(
+			i % ConvexVolumeGroup::MAX_VOLUMES, ConstWeakArray<Plane>(&planes[0], planes.getSize()));
+	}
+
+	const SoftwareRasterizer* r = (frustumCount == 1) ? m_frustums[0].m_frcCtx->m_r : nullptr;
+	ANKI_ASSERT(frustumCount == 1 || m_frustums[0].m_frcCtx->m_r == nullptr);
 
 	// Walk the tree
-	m_frcCtx->m_visCtx->m_scene->getOctree().walkTree(testIdx,
+	visCtx.m_scene->getOctree().walkTree(testIdx,
 		[&](const Aabb& box) {
-			Bool visible = m_frcCtx->m_frc->insideFrustum(box);
-			if(visible && m_frcCtx->m_r)
+			Bool visible = false;
+			for(U32 i = 0; i < volumeGroupCount && !visible; ++i)
+			{
+				visible = volumeGroups[i].testAabb(box) != 0;
+			}
+
+			if(visible && r)
 			{
-				visible = m_frcCtx->m_r->visibilityTest(box);
+				visible = r->visibilityTest(box);
 			}
 
 			return visible;
@@ -182,45 +252,64 @@ void GatherVisiblesFromOctreeTask::gather(ThreadHive& hive)
 			ANKI_ASSERT(placeableUserData);
 			SpatialComponent* scomp = static_cast<SpatialComponent*>(placeableUserData);
 
-			ANKI_ASSERT(m_spatialCount < m_spatials.getSize());
+			for(U32 i = 0; i < volumeGroupCount; ++i)
+			{
+				// A single frustum doesn't need the extra test, its node was visible
+				const U32 mask = (frustumCount == 1) ? 1 : volumeGroups[i].testAabb(scomp->getAabb());
+				for(U32 j = 0; j < ConvexVolumeGroup::MAX_VOLUMES; ++j)
+				{
+					if(!(mask & (1u << j)))
+					{
+						continue;
+					}
 
-			m_spatials[m_spatialCount++] = scomp;
+					Frustum& frustum = m_frustums[i * ConvexVolumeGroup::MAX_VOLUMES + j];
 
-			if(m_spatialCount == m_spatials.getSize())
-			{
-				flush(hive);
+					ANKI_ASSERT(frustum.m_spatialCount < frustum.m_spatials.getSize());
+					frustum.m_spatials[frustum.m_spatialCount++] = scomp;
+
+					if(frustum.m_spatialCount == frustum.m_spatials.getSize())
+					{
+						flush(hive, frustum);
+					}
+				}
 			}
 		});
 
-	// Flush the remaining
-	flush(hive);
+	for(Frustum& frustum : m_frustums)
+	{
+		// Flush the remaining
+		flush(hive, frustum);
 
-	// Fire an additional dummy task to decrease the semaphore to zero
-	GatherVisiblesFromOctreeTask* pself = this; // MSVC workaround
-	ThreadHiveTask task = ANKI_THREAD_HIVE_TASK({}, pself, nullptr, m_frcCtx->m_visTestsSignalSem);
-	hive.submitTasks(&task, 1);
+		// Fire an additional dummy task to decrease the semaphore to zero
+		GatherVisiblesFromOctreeTask* pself = this; // MSVC workaround
+		ThreadHiveTask task = ANKI_THREAD_HIVE_TASK({}, pself, nullptr, frustum.m_frcCtx->m_visTestsSignalSem);
+		hive.submitTasks(&task, 1);
+	}
 }
 
-void GatherVisiblesFromOctreeTask::flush(ThreadHive& hive)
+void GatherVisiblesFromOctreeTask::flush(ThreadHive& hive, Frustum& frustum)
 {
-	if(m_spatialCount)
+	FrustumVisibilityContext* frcCtx = frustum.m_frcCtx;
+	const U32 spatialCount = frustum.m_spatialCount;
+	if(spatialCount)
 	{
 		// Create the task
 		VisibilityTestTask* vis =
-			m_frcCtx->m_visCtx->m_scene->getFrameAllocator().newInstance<VisibilityTestTask>(m_frcCtx);
-		memcpy(&vis->m_spatialsToTest[0], &m_spatials[0], sizeof(m_spatials[0]) * m_spatialCount);
-		vis->m_spatialToTestCount = m_spatialCount;
+			frcCtx->m_visCtx->m_scene->getFrameAllocator().newInstance<VisibilityTestTask>(frcCtx);
+		memcpy(&vis->m_spatialsToTest[0], &frustum.m_spatials[0], sizeof(frustum.m_spatials[0]) * spatialCount);
+		vis->m_spatialToTestCount = spatialCount;
 
 		// Increase the semaphore to block the CombineResultsTask
-		m_frcCtx->m_visTestsSignalSem->increaseSemaphore(1);
+		frcCtx->m_visTestsSignalSem->increaseSemaphore(1);
 
 		// Submit task
 		ThreadHiveTask task =
-			ANKI_THREAD_HIVE_TASK({ self->test(hive, threadId); }, vis, nullptr, m_frcCtx->m_visTestsSignalSem);
+			ANKI_THREAD_HIVE_TASK({ self->test(hive, threadId); }, vis, nullptr, frcCtx->m_visTestsSignalSem);
 		hive.submitTasks(&task, 1);
 
 		// Clear count
-		m_spatialCount = 0;
+		frustum.m_spatialCount = 0;
 	}
 }
 
@@ -237,6 +326,10 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 	Timestamp& timestamp = m_frcCtx->m_queueViews[taskId].m_timestamp;
 	timestamp = testedNode.getComponentMaxTimestamp();
 
+	Timestamp& staticShadowRenderablesTimestamp = m_frcCtx->m_queueViews[taskId].m_staticShadowRenderablesTimestamp;
+	staticShadowRenderablesTimestamp = timestamp;
+	const Timestamp globalTimestamp = m_frcCtx->m_visCtx->m_scene->getGlobalTimestamp();
+
 	const Bool wantsRenderComponents =
 		testedFrc.visibilityTestsEnabled(FrustumComponentVisibilityTestFlag::RENDER_COMPONENTS);
 
@@ -371,9 +464,21 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 			{
 				el = result.m_forwardShadingRenderables.newElement(alloc);
 			}
+			else if(wantsShadowCasters && !isStaticShadowCaster(node.getComponentMaxTimestamp(), globalTimestamp))
+			{
+				// Changed recently, it's a dynamic shadow caster
+				el = result.m_dynamicShadowRenderables.newElement(alloc);
+			}
 			else
 			{
 				el = result.m_renderables.newElement(alloc);
+
+				if(wantsShadowCasters)
+				{
+					// Static shadow caster. Remember when it became static
+					staticShadowRenderablesTimestamp = max(staticShadowRenderablesTimestamp,
+						computeStaticShadowCasterTimestamp(node.getComponentMaxTimestamp()));
+				}
 			}
 
 			rc->setupRenderableQueueElement(*el);
@@ -561,12 +666,14 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 		{
 			DecalQueueElement* el = result.m_decals.newElement(alloc);
 			decalc->setupDecalQueueElement(*el);
+			el->m_uuid = node.getUuid();
 		}
 
 		if(fogc)
 		{
 			FogDensityQueueElement* el = result.m_fogDensityVolumes.newElement(alloc);
 			fogc->setupFogDensityQueueElement(*el);
+			el->m_uuid = node.getUuid();
 		}
 
 		if(giprobec)
@@ -601,12 +708,35 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 		// Add more frustums to the list
 		if(nextQueues.getSize() > 0)
 		{
+			// Gather the frustums to walk the octree once for all of them. Submit a group every time it gets full
+			Array<const FrustumComponent*, MAX_FRUSTUMS_PER_VIS_GROUP> frcs;
+			Array<RenderQueue*, MAX_FRUSTUMS_PER_VIS_GROUP> rqueues;
+			U32 groupCount = 0;
 			count = 0;
 
+			auto submitGroup = [&]() {
+				m_frcCtx->m_visCtx->submitNewWork(ConstWeakArray<const FrustumComponent*>(&frcs[0], groupCount),
+					ConstWeakArray<RenderQueue*>(&rqueues[0], groupCount),
+					hive);
+				groupCount = 0;
+			};
+
+			auto addFrustum = [&](const FrustumComponent& frc) {
+				if(groupCount == MAX_FRUSTUMS_PER_VIS_GROUP)
+				{
+					submitGroup();
+				}
+
+				frcs[groupCount] = &frc;
+				rqueues[groupCount] = &nextQueues[count];
+				++groupCount;
+				++count;
+			};
+
 			if(ANKI_LIKELY(nextQueueFrustumComponents.getSize() == 0))
 			{
 				err = node.iterateComponentsOfType<FrustumComponent>([&](FrustumComponent& frc) {
-					m_frcCtx->m_visCtx->submitNewWork(frc, nextQueues[count++], hive);
+					addFrustum(frc);
 					return Error::NONE;
 				});
 				(void)err;
@@ -615,9 +745,14 @@ void VisibilityTestTask::test(ThreadHive& hive, U32 taskId)
 			{
 				for(FrustumComponent& frc : nextQueueFrustumComponents)
 				{
-					m_frcCtx->m_visCtx->submitNewWork(frc, nextQueues[count++], hive);
+					addFrustum(frc);
 				}
 			}
+
+			if(groupCount)
+			{
+				submitGroup();
+			}
 		}
 
 		// Update timestamp
@@ -642,6 +777,13 @@ void CombineResultsTask::combine()
 	}
 	ANKI_ASSERT(results.m_shadowRenderablesLastUpdateTimestamp);
 
+	results.m_staticShadowRenderablesLastUpdateTimestamp = 0;
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		results.m_staticShadowRenderablesLastUpdateTimestamp = max(results.m_staticShadowRenderablesLastUpdateTimestamp,
+			m_frcCtx->m_queueViews[i].m_staticShadowRenderablesTimestamp);
+	}
+
 #define ANKI_VIS_COMBINE(t_, member_) \
 	{ \
 		Array<TRenderQueueElementStorage<t_>, 64> subStorages; \
@@ -674,6 +816,37 @@ void CombineResultsTask::combine()
 	}
 
 	ANKI_VIS_COMBINE(RenderableQueueElement, m_renderables);
+	results.m_staticShadowRenderableCount = results.m_renderables.getSize();
+	{
+		// The dynamic shadow casters go after the static
+		WeakArray<RenderableQueueElement> dynamicShadowRenderables;
+		Array<TRenderQueueElementStorage<RenderableQueueElement>, 64> subStorages;
+		for(U32 i = 0; i < threadCount; ++i)
+		{
+			subStorages[i] = m_frcCtx->m_queueViews[i].m_dynamicShadowRenderables;
+		}
+		combineQueueElements<RenderableQueueElement>(alloc,
+			WeakArray<TRenderQueueElementStorage<RenderableQueueElement>>(&subStorages[0], threadCount),
+			nullptr,
+			dynamicShadowRenderables,
+			nullptr);
+
+		if(dynamicShadowRenderables.getSize())
+		{
+			const U32 staticCount = results.m_staticShadowRenderableCount;
+			const U32 count = staticCount + dynamicShadowRenderables.getSize();
+			RenderableQueueElement* renderables = alloc.newArray<RenderableQueueElement>(count);
+			if(staticCount)
+			{
+				memcpy(renderables, results.m_renderables.getBegin(), results.m_renderables.getSizeInBytes());
+			}
+			memcpy(renderables + staticCount,
+				dynamicShadowRenderables.getBegin(),
+				dynamicShadowRenderables.getSizeInBytes());
+
+			results.m_renderables = WeakArray<RenderableQueueElement>(renderables, count);
+		}
+	}
 	ANKI_VIS_COMBINE(RenderableQueueElement, m_earlyZRenderables);
 	ANKI_VIS_COMBINE(RenderableQueueElement, m_forwardShadingRenderables);
 	ANKI_VIS_COMBINE_AND_PTR(PointLightQueueElement, m_pointLights, m_shadowPointLights);
@@ -709,7 +882,11 @@ void CombineResultsTask::combine()
 #endif
 
 	// Sort some of the arrays
-	std::sort(results.m_renderables.getBegin(), results.m_renderables.getEnd(), MaterialDistanceSortFunctor(20.0f));
+	// Sort the static and the dynamic shadow casters separately to keep them apart
+	RenderableQueueElement* staticRenderablesEnd =
+		results.m_renderables.getBegin() + results.m_staticShadowRenderableCount;
+	std::sort(results.m_renderables.getBegin(), staticRenderablesEnd, MaterialDistanceSortFunctor(20.0f));
+	std::sort(staticRenderablesEnd, results.m_renderables.getEnd(), MaterialDistanceSortFunctor(20.0f));
 
 	std::sort(results.m_earlyZRenderables.getBegin(),
 		results.m_earlyZRenderables.getEnd(),
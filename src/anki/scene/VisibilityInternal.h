@@ -9,6 +9,7 @@
 #include <anki/scene/SoftwareRasterizer.h>
 #include <anki/scene/components/FrustumComponent.h>
 #include <anki/scene/Octree.h>
+#include <anki/collision/ConvexVolumeGroup.h>
 #include <anki/util/Thread.h>
 #include <anki/util/Tracer.h>
 #include <anki/renderer/RenderQueue.h>
@@ -22,6 +23,25 @@ namespace anki
 static const U32 MAX_SPATIALS_PER_VIS_TEST = 48; ///< Num of spatials to test in a single ThreadHive task.
 static const U32 SW_RASTERIZER_WIDTH = 80;
 static const U32 SW_RASTERIZER_HEIGHT = 50;
+static const U32 MAX_FRUSTUMS_PER_VIS_GROUP = 8; ///< Max num of frustums that share a single octree walk.
+
+/// A shadow caster that didn't change for that many frames is considered static.
+static const Timestamp STATIC_SHADOW_CASTER_FRAME_COUNT = 4;
+
+/// The timestamp that a shadow caster becomes static.
+/// @param lastChangeTimestamp The last time any of the caster's components changed.
+inline Timestamp computeStaticShadowCasterTimestamp(Timestamp lastChangeTimestamp)
+{
+	return lastChangeTimestamp + STATIC_SHADOW_CASTER_FRAME_COUNT;
+}
+
+/// Check if a shadow caster is static in the current frame.
+/// @param lastChangeTimestamp The last time any of the caster's components changed.
+/// @param globalTimestamp The timestamp of the current frame.
+inline Bool isStaticShadowCaster(Timestamp lastChangeTimestamp, Timestamp globalTimestamp)
+{
+	return computeStaticShadowCasterTimestamp(lastChangeTimestamp) <= globalTimestamp;
+}
 
 /// Sort objects on distance
 template<typename T>
@@ -103,7 +123,8 @@ public:
 class RenderQueueView
 {
 public:
-	TRenderQueueElementStorage<RenderableQueueElement> m_renderables; ///< Deferred shading or shadow renderables.
+	TRenderQueueElementStorage<RenderableQueueElement> m_renderables; ///< Deferred shading or static shadow casters.
+	TRenderQueueElementStorage<RenderableQueueElement> m_dynamicShadowRenderables; ///< Dynamic shadow casters.
 	TRenderQueueElementStorage<RenderableQueueElement> m_forwardShadingRenderables;
 	TRenderQueueElementStorage<RenderableQueueElement> m_earlyZRenderables;
 	TRenderQueueElementStorage<PointLightQueueElement> m_pointLights;
@@ -119,6 +140,7 @@ public:
 	TRenderQueueElementStorage<GenericGpuComputeJobQueueElement> m_genericGpuComputeJobs;
 
 	Timestamp m_timestamp = 0;
+	Timestamp m_staticShadowRenderablesTimestamp = 0;
 
 	RenderQueueView()
 	{
@@ -128,6 +150,9 @@ public:
 
 static_assert(std::is_trivially_destructible<RenderQueueView>::value == true, "Should be trivially destructible");
 
+// Forward
+class FrustumVisibilityContext;
+
 /// Data common for all tasks.
 class VisibilityContext
 {
@@ -141,6 +166,21 @@ public:
 	Mutex m_mtx;
 
 	void submitNewWork(const FrustumComponent& frc, RenderQueue& result, ThreadHive& hive);
+
+	/// Submit work for a group of frustums that will share the octree walk. Eg the faces of a point light or the
+	/// cascades of a directional light.
+	void submitNewWork(
+		ConstWeakArray<const FrustumComponent*> frcs, ConstWeakArray<RenderQueue*> results, ThreadHive& hive);
+
+private:
+	/// Prepare the results and the context of a frustum and submit the task that will combine its results.
+	/// @return The new context or nullptr if the frustum doesn't need testing.
+	FrustumVisibilityContext* newFrustumVisibilityContext(
+		const FrustumComponent& frc, RenderQueue& result, ThreadHive& hive);
+
+	/// Submit a task that walks the octree for some frustums.
+	void submitGatherTask(
+		ConstWeakArray<FrustumVisibilityContext*> frcCtxs, ThreadHiveSemaphore* waitSemaphore, ThreadHive& hive);
 };
 
 /// A context for a specific test of a frustum component.
@@ -181,26 +221,38 @@ public:
 static_assert(
 	std::is_trivially_destructible<FillRasterizerWithCoverageTask>::value == true, "Should be trivially destructible");
 
-/// ThreadHive task to get visible nodes from the octree.
+/// ThreadHive task to get visible nodes from the octree. It walks the octree once for a group of frustums and tests
+/// the octree nodes against all of them at once.
 class GatherVisiblesFromOctreeTask
 {
 public:
-	FrustumVisibilityContext* m_frcCtx = nullptr;
-
-	GatherVisiblesFromOctreeTask(FrustumVisibilityContext* frcCtx)
-		: m_frcCtx(frcCtx)
+	GatherVisiblesFromOctreeTask(ConstWeakArray<FrustumVisibilityContext*> frcCtxs, SceneFrameAllocator<U8> alloc)
 	{
-		ANKI_ASSERT(m_frcCtx);
+		ANKI_ASSERT(frcCtxs.getSize() > 0 && frcCtxs.getSize() <= MAX_FRUSTUMS_PER_VIS_GROUP);
+		m_frustums = WeakArray<Frustum>(alloc.newArray<Frustum>(frcCtxs.getSize()), frcCtxs.getSize());
+		for(U32 i = 0; i < frcCtxs.getSize(); ++i)
+		{
+			ANKI_ASSERT(frcCtxs[i]);
+			m_frustums[i].m_frcCtx = frcCtxs[i];
+		}
 	}
 
 	void gather(ThreadHive& hive);
 
 private:
-	Array<SpatialComponent*, MAX_SPATIALS_PER_VIS_TEST> m_spatials;
-	U32 m_spatialCount = 0;
+	/// The per frustum state. It's allocated for the frustums of the group only.
+	class Frustum
+	{
+	public:
+		FrustumVisibilityContext* m_frcCtx = nullptr;
+		Array<SpatialComponent*, MAX_SPATIALS_PER_VIS_TEST> m_spatials;
+		U32 m_spatialCount = 0;
+	};
+
+	WeakArray<Frustum> m_frustums;
 
-	/// Submit tasks to test the m_spatials.
-	void flush(ThreadHive& hive);
+	/// Submit tasks to test the m_spatials of a frustum.
+	void flush(ThreadHive& hive, Frustum& frustum);
 };
 static_assert(
 	std::is_trivially_destructible<GatherVisiblesFromOctreeTask>::value == true, "Should be trivially destructible");
@@ -56,6 +56,12 @@ void MaterialRenderComponent::allocateAndSetupUniforms(const RenderQueueDrawCont
 	ctx.m_commandBuffer->bindUniformBuffer(
 		set, m_mtl->getUniformsBinding(), token.m_buffer, token.m_offset, token.m_range);
 
+	// The bindless set is the same for all materials so it doesn't need a new descriptor set per drawcall
+	if(m_mtl->usesBindlessTextures())
+	{
+		ctx.m_commandBuffer->bindAllBindless(m_mtl->getBindlessDescriptorSetIndex());
+	}
+
 	// Iterate variables
 	for(auto it = m_vars.getBegin(); it != m_vars.getEnd(); ++it)
 	{
@@ -232,6 +238,24 @@ void MaterialRenderComponent::allocateAndSetupUniforms(const RenderQueueDrawCont
 
 			break;
 		}
+		case ShaderVariableDataType::UINT:
+		{
+			U32 val;
+			if(mvar.isBindlessTexture())
+			{
+				// The texture was added to the bindless set at load time. This only keeps it alive for the GPU
+				val = ctx.m_commandBuffer->bindBindlessTexture(
+					mvar.getValue<TextureResourcePtr>()->getGrTextureView(), TextureUsageBit::SAMPLED_FRAGMENT);
+				ANKI_ASSERT(val == mvar.getValue<U32>());
+			}
+			else
+			{
+				val = mvar.getValue<U32>();
+			}
+
+			variant.writeShaderBlockMemory(mvar, &val, 1, uniformsBegin, uniformsEnd);
+			break;
+		}
 		case ShaderVariableDataType::TEXTURE_2D:
 		case ShaderVariableDataType::TEXTURE_2D_ARRAY:
 		case ShaderVariableDataType::TEXTURE_3D:
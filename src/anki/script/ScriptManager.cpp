@@ -24,6 +24,7 @@ Error ScriptManager::init(AllocAlignedCallback allocCb, void* allocCbData)
 	ANKI_SCRIPT_LOGI("Initializing scripting engine...");
 
 	m_alloc = ScriptAllocator(allocCb, allocCbData);
+	m_alloc.getMemoryPool().setMemoryTag(MemoryTag::SCRIPT);
 
 	ANKI_CHECK(m_lua.init(m_alloc, &m_otherSystems));
 
@@ -21,6 +21,7 @@ namespace anki
 #define ANKI_SHADER_COMPILER_LOGF(...) ANKI_LOG("SHCO", FATAL, __VA_ARGS__)
 
 constexpr U32 MAX_SHADER_BINARY_NAME_LENGTH = 63;
+constexpr U32 MAX_SHADER_BINARY_FILENAME_LENGTH = 255;
 
 using MutatorValue = I32; ///< The type of the mutator value
 
@@ -36,6 +37,14 @@ class ShaderProgramPostParseInterface
 {
 public:
 	virtual Bool skipCompilation(U64 programHash) = 0;
+
+	/// Check if a variant should be compiled. The mutations of the skipped variants won't point to any variant. The
+	/// variant can be compiled later with compileShaderProgramVariant().
+	/// @param mutationHash The hash of a mutation. See ShaderProgramBinaryMutation::m_hash.
+	virtual Bool skipVariant(U64 mutationHash)
+	{
+		return false;
+	}
 };
 
 /// An interface for asynchronous shader compilation.
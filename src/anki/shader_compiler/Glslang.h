@@ -19,6 +19,10 @@ namespace anki
 /// Run glslang's preprocessor.
 ANKI_USE_RESULT Error preprocessGlsl(CString in, StringAuto& out);
 
+/// The version of compilerGlslToSpirv. Bump it when the compiler or its options change in a way that affects the
+/// output. It invalidates the cached SPIR-V.
+constexpr U32 GLSL_TO_SPIRV_VERSION = 1;
+
 /// Compile glsl to SPIR-V.
 ANKI_USE_RESULT Error compilerGlslToSpirv(
 	CString src, ShaderType shaderType, GenericMemoryPoolAllocator<U8> tmpAlloc, DynamicArrayAuto<U8>& spirv);
@@ -348,7 +348,7 @@ class ShaderProgramBinaryMutation
 {
 public:
 	WeakArray<MutatorValue> m_values;
-	U32 m_variantIndex = MAX_U32;
+	U32 m_variantIndex = MAX_U32; ///< MAX_U32 means that the variant was not compiled.
 	U64 m_hash = 0; ///< Mutation hash.
 
 	template<typename TSerializer, typename TClass>
@@ -372,6 +372,36 @@ public:
 	}
 };
 
+/// A file that was used to build the binary.
+class ShaderProgramBinaryDependency
+{
+public:
+	Array<char, MAX_SHADER_BINARY_FILENAME_LENGTH + 1> m_filename = {};
+	U64 m_hash = 0; ///< The hash of the contents of the file.
+
+	template<typename TSerializer, typename TClass>
+	static void serializeCommon(TSerializer& s, TClass self)
+	{
+		s.doArray("m_filename",
+			offsetof(ShaderProgramBinaryDependency, m_filename),
+			&self.m_filename[0],
+			self.m_filename.getSize());
+		s.doValue("m_hash", offsetof(ShaderProgramBinaryDependency, m_hash), self.m_hash);
+	}
+
+	template<typename TDeserializer>
+	void deserialize(TDeserializer& deserializer)
+	{
+		serializeCommon<TDeserializer, ShaderProgramBinaryDependency&>(deserializer, *this);
+	}
+
+	template<typename TSerializer>
+	void serialize(TSerializer& serializer) const
+	{
+		serializeCommon<TSerializer, const ShaderProgramBinaryDependency&>(serializer, *this);
+	}
+};
+
 /// ShaderProgramBinary class.
 class ShaderProgramBinary
 {
@@ -387,6 +417,7 @@ public:
 	WeakArray<ShaderProgramBinaryOpaque> m_opaques;
 	WeakArray<ShaderProgramBinaryConstant> m_constants;
 	ShaderTypeBit m_presentShaderTypes = ShaderTypeBit::NONE;
+	WeakArray<ShaderProgramBinaryDependency> m_dependencies; ///< The program and its includes.
 
 	template<typename TSerializer, typename TClass>
 	static void serializeCommon(TSerializer& s, TClass self)
@@ -404,6 +435,7 @@ public:
 		s.doValue("m_constants", offsetof(ShaderProgramBinary, m_constants), self.m_constants);
 		s.doValue(
 			"m_presentShaderTypes", offsetof(ShaderProgramBinary, m_presentShaderTypes), self.m_presentShaderTypes);
+		s.doValue("m_dependencies", offsetof(ShaderProgramBinary, m_dependencies), self.m_dependencies);
 	}
 
 	template<typename TDeserializer>
@@ -7,26 +7,41 @@
 #include <anki/shader_compiler/ShaderProgramParser.h>
 #include <anki/shader_compiler/Glslang.h>
 #include <anki/shader_compiler/ShaderProgramReflection.h>
+#include <anki/shader_compiler/SpirvCache.h>
 #include <anki/util/Serializer.h>
+#include <anki/util/Filesystem.h>
 #include <anki/util/HashMap.h>
+#include <anki/util/HighRezTimer.h>
 
 namespace anki
 {
 
 static const char* SHADER_BINARY_MAGIC = "ANKISDR1";
-const U32 SHADER_BINARY_VERSION = 1;
+const U32 SHADER_BINARY_VERSION = 3;
 
 Error ShaderProgramBinaryWrapper::serializeToFile(CString fname) const
 {
 	ANKI_ASSERT(m_binary);
 
-	File file;
-	ANKI_CHECK(file.open(fname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
-
-	BinarySerializer serializer;
 	HeapAllocator<U8> tmpAlloc(
 		m_alloc.getMemoryPool().getAllocationCallback(), m_alloc.getMemoryPool().getAllocationCallbackUserData());
-	ANKI_CHECK(serializer.serialize(*m_binary, tmpAlloc, file));
+
+	// Other processes might have the file mapped. Truncating it in place will crash them so write a new file and move
+	// it in place. The mappings will keep the old one alive
+	StringAuto tmpFname(tmpAlloc);
+	const Second time = HighRezTimer::getCurrentTime();
+	const U64 tmpId = computeHash(&time, sizeof(time), Thread::getCurrentThreadId());
+	tmpFname.sprintf("%s.%016" PRIx64 ".tmp", fname.cstr(), tmpId);
+
+	{
+		File file;
+		ANKI_CHECK(file.open(tmpFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+
+		BinarySerializer serializer;
+		ANKI_CHECK(serializer.serialize(*m_binary, tmpAlloc, file));
+	}
+
+	ANKI_CHECK(renameFile(tmpFname, fname));
 
 	return Error::NONE;
 }
@@ -35,17 +50,37 @@ Error ShaderProgramBinaryWrapper::deserializeFromFile(CString fname)
 {
 	cleanup();
 
-	File file;
-	ANKI_CHECK(file.open(fname, FileOpenFlag::READ | FileOpenFlag::BINARY));
+	if(fileExists(fname))
+	{
+		// Use the binary from the mapped file. The code blocks are big and they will be read from the disk only when
+		// a variant needs them
+		ANKI_CHECK(m_mappedFile.open(fname));
+		const Error err =
+			BinaryDeserializer::deserializeInPlace(m_binary, m_mappedFile.getData(), m_mappedFile.getSize());
+		if(err)
+		{
+			// cleanup() won't see the file without a binary
+			m_mappedFile.close();
+			m_binary = nullptr;
+			return err;
+		}
+	}
+	else
+	{
+		// Not a regular file, read it
+		File file;
+		ANKI_CHECK(file.open(fname, FileOpenFlag::READ | FileOpenFlag::BINARY));
 
-	BinaryDeserializer deserializer;
-	ANKI_CHECK(deserializer.deserialize(m_binary, m_alloc, file));
+		BinaryDeserializer deserializer;
+		ANKI_CHECK(deserializer.deserialize(m_binary, m_alloc, file));
 
-	m_singleAllocation = true;
+		m_singleAllocation = true;
+	}
 
-	if(memcmp(SHADER_BINARY_MAGIC, &m_binary->m_magic[0], 0) != 0)
+	if(memcmp(SHADER_BINARY_MAGIC, &m_binary->m_magic[0], sizeof(m_binary->m_magic)) != 0)
 	{
 		ANKI_SHADER_COMPILER_LOGE("Corrupted or wrong version of shader binary: %s", fname.cstr());
+		cleanup();
 		return Error::USER_DATA;
 	}
 
@@ -59,6 +94,14 @@ void ShaderProgramBinaryWrapper::cleanup()
 		return;
 	}
 
+	if(m_mappedFile.isOpen())
+	{
+		// The binary lives in the file
+		m_mappedFile.close();
+		m_binary = nullptr;
+		return;
+	}
+
 	if(!m_singleAllocation)
 	{
 		for(ShaderProgramBinaryMutator& mutator : m_binary->m_mutators)
@@ -99,6 +142,7 @@ void ShaderProgramBinaryWrapper::cleanup()
 
 		m_alloc.getMemoryPool().free(m_binary->m_opaques.getBegin());
 		m_alloc.getMemoryPool().free(m_binary->m_constants.getBegin());
+		m_alloc.getMemoryPool().free(m_binary->m_dependencies.getBegin());
 
 		for(ShaderProgramBinaryVariant& variant : m_binary->m_variants)
 		{
@@ -167,148 +211,6 @@ static Bool spinDials(DynamicArrayAuto<U32>& dials, ConstWeakArray<ShaderProgram
 	return done;
 }
 
-static Error compileSpirv(ConstWeakArray<MutatorValue> mutation,
-	const ShaderProgramParser& parser,
-	GenericMemoryPoolAllocator<U8>& tmpAlloc,
-	Array<DynamicArrayAuto<U8>, U32(ShaderType::COUNT)>& spirv)
-{
-	// Generate the source and the rest for the variant
-	ShaderProgramParserVariant parserVariant;
-	ANKI_CHECK(parser.generateVariant(mutation, parserVariant));
-
-	// Compile stages
-	for(ShaderType shaderType : EnumIterable<ShaderType>())
-	{
-		if(!(shaderTypeToBit(shaderType) & parser.getShaderTypes()))
-		{
-			continue;
-		}
-
-		// Compile
-		ANKI_CHECK(compilerGlslToSpirv(parserVariant.getSource(shaderType), shaderType, tmpAlloc, spirv[shaderType]));
-		ANKI_ASSERT(spirv[shaderType].getSize() > 0);
-	}
-
-	return Error::NONE;
-}
-
-static void compileVariantAsync(ConstWeakArray<MutatorValue> mutation,
-	const ShaderProgramParser& parser,
-	ShaderProgramBinaryVariant& variant,
-	DynamicArrayAuto<ShaderProgramBinaryCodeBlock>& codeBlocks,
-	DynamicArrayAuto<U64>& codeBlockHashes,
-	GenericMemoryPoolAllocator<U8>& tmpAlloc,
-	GenericMemoryPoolAllocator<U8>& binaryAlloc,
-	ShaderProgramAsyncTaskInterface& taskManager,
-	Mutex& mtx,
-	Atomic<I32>& error)
-{
-	variant = {};
-
-	class Ctx
-	{
-	public:
-		GenericMemoryPoolAllocator<U8> m_tmpAlloc;
-		GenericMemoryPoolAllocator<U8> m_binaryAlloc;
-		DynamicArrayAuto<MutatorValue> m_mutation{m_tmpAlloc};
-		const ShaderProgramParser* m_parser;
-		ShaderProgramBinaryVariant* m_variant;
-		DynamicArrayAuto<ShaderProgramBinaryCodeBlock>* m_codeBlocks;
-		DynamicArrayAuto<U64>* m_codeBlockHashes;
-		Mutex* m_mtx;
-		Atomic<I32>* m_err;
-
-		Ctx(GenericMemoryPoolAllocator<U8> tmpAlloc)
-			: m_tmpAlloc(tmpAlloc)
-		{
-		}
-	};
-
-	Ctx* ctx = tmpAlloc.newInstance<Ctx>(tmpAlloc);
-	ctx->m_binaryAlloc = binaryAlloc;
-	ctx->m_mutation.create(mutation.getSize());
-	memcpy(ctx->m_mutation.getBegin(), mutation.getBegin(), mutation.getSizeInBytes());
-	ctx->m_parser = &parser;
-	ctx->m_variant = &variant;
-	ctx->m_codeBlocks = &codeBlocks;
-	ctx->m_codeBlockHashes = &codeBlockHashes;
-	ctx->m_mtx = &mtx;
-	ctx->m_err = &error;
-
-	auto callback = [](void* userData) {
-		Ctx& ctx = *static_cast<Ctx*>(userData);
-		GenericMemoryPoolAllocator<U8>& tmpAlloc = ctx.m_tmpAlloc;
-
-		if(ctx.m_err->load() != 0)
-		{
-			// Cleanup and return
-			tmpAlloc.deleteInstance(&ctx);
-			return;
-		}
-
-		// All good, compile the variant
-		Array<DynamicArrayAuto<U8>, U32(ShaderType::COUNT)> spirvs = {
-			{{tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}, {tmpAlloc}}};
-		const Error err = compileSpirv(ctx.m_mutation, *ctx.m_parser, tmpAlloc, spirvs);
-
-		if(!err)
-		{
-			// No error, check if the spirvs are common with some other variant and store it
-
-			LockGuard<Mutex> lock(*ctx.m_mtx);
-
-			for(ShaderType shaderType : EnumIterable<ShaderType>())
-			{
-				DynamicArrayAuto<U8>& spirv = spirvs[shaderType];
-
-				if(spirv.isEmpty())
-				{
-					ctx.m_variant->m_codeBlockIndices[shaderType] = MAX_U32;
-					continue;
-				}
-
-				// Check if the spirv is already generated
-				const U64 newHash = computeHash(&spirv[0], spirv.getSize());
-				Bool found = false;
-				for(U32 i = 0; i < ctx.m_codeBlockHashes->getSize(); ++i)
-				{
-					if((*ctx.m_codeBlockHashes)[i] == newHash)
-					{
-						// Found it
-						ctx.m_variant->m_codeBlockIndices[shaderType] = i;
-						found = true;
-						break;
-					}
-				}
-
-				// Create it if not found
-				if(!found)
-				{
-					U8* code = ctx.m_binaryAlloc.allocate(spirv.getSizeInBytes());
-					memcpy(code, &spirv[0], spirv.getSizeInBytes());
-
-					ShaderProgramBinaryCodeBlock block;
-					block.m_binary.setArray(code, U32(spirv.getSizeInBytes()));
-
-					ctx.m_codeBlocks->emplaceBack(block);
-					ctx.m_codeBlockHashes->emplaceBack(newHash);
-
-					ctx.m_variant->m_codeBlockIndices[shaderType] = ctx.m_codeBlocks->getSize() - 1;
-				}
-			}
-		}
-		else
-		{
-			ctx.m_err->store(err._getCode());
-		}
-
-		// Cleanup
-		tmpAlloc.deleteInstance(&ctx);
-	};
-
-	taskManager.enqueueTask(callback, ctx);
-}
-
 class Refl final : public ShaderReflectionVisitorInterface
 {
 public:
@@ -346,6 +248,69 @@ public:
 	{
 	}
 
+	/// Start with the blocks, opaques and constants of another binary. That way the indices of the variant instances
+	/// will be valid for that binary.
+	void setReference(const ShaderProgramBinary& reference)
+	{
+		const Array<ConstWeakArray<ShaderProgramBinaryBlock>, 3> blocks = {
+			{reference.m_uniformBlocks,
+				reference.m_storageBlocks,
+				{reference.m_pushConstantBlock, (reference.m_pushConstantBlock) ? 1u : 0u}}};
+
+		for(U32 blockType = 0; blockType < 3; ++blockType)
+		{
+			for(const ShaderProgramBinaryBlock& inBlock : blocks[blockType])
+			{
+				ShaderProgramBinaryBlock& block = *m_blocks[blockType].emplaceBack(inBlock);
+				block.m_variables = {};
+
+				DynamicArrayAuto<ShaderProgramBinaryVariable>& vars = *m_vars[blockType].emplaceBack(m_alloc);
+				for(const ShaderProgramBinaryVariable& var : inBlock.m_variables)
+				{
+					vars.emplaceBack(var);
+				}
+			}
+		}
+
+		for(const ShaderProgramBinaryOpaque& o : reference.m_opaques)
+		{
+			m_opaque.emplaceBack(o);
+		}
+
+		for(const ShaderProgramBinaryConstant& c : reference.m_constants)
+		{
+			m_consts.emplaceBack(c);
+		}
+	}
+
+	/// Check if the variants didn't add anything to what setReference() added.
+	Bool matchesReference(const ShaderProgramBinary& reference) const
+	{
+		const Array<ConstWeakArray<ShaderProgramBinaryBlock>, 3> blocks = {
+			{reference.m_uniformBlocks,
+				reference.m_storageBlocks,
+				{reference.m_pushConstantBlock, (reference.m_pushConstantBlock) ? 1u : 0u}}};
+
+		for(U32 blockType = 0; blockType < 3; ++blockType)
+		{
+			if(m_blocks[blockType].getSize() != blocks[blockType].getSize())
+			{
+				return false;
+			}
+
+			for(U32 i = 0; i < blocks[blockType].getSize(); ++i)
+			{
+				if(m_vars[blockType][i].getSize() != blocks[blockType][i].m_variables.getSize())
+				{
+					return false;
+				}
+			}
+		}
+
+		return m_opaque.getSize() == reference.m_opaques.getSize()
+			   && m_consts.getSize() == reference.m_constants.getSize();
+	}
+
 	Error setWorkgroupSizes(U32 x, U32 y, U32 z, U32 specConstMask) final
 	{
 		m_workgroupSizesConstants = {{MAX_U32, MAX_U32, MAX_U32}};
@@ -636,12 +601,18 @@ public:
 	}
 };
 
-static Error doReflection(
-	ShaderProgramBinary& binary, GenericMemoryPoolAllocator<U8>& tmpAlloc, GenericMemoryPoolAllocator<U8>& binaryAlloc)
+static Error doReflection(ShaderProgramBinary& binary,
+	GenericMemoryPoolAllocator<U8>& tmpAlloc,
+	GenericMemoryPoolAllocator<U8>& binaryAlloc,
+	const ShaderProgramBinary* reference)
 {
 	ANKI_ASSERT(binary.m_variants.getSize() > 0);
 
 	Refl refl(binaryAlloc);
+	if(reference)
+	{
+		refl.setReference(*reference);
+	}
 
 	for(ShaderProgramBinaryVariant& variant : binary.m_variants)
 	{
@@ -702,6 +673,18 @@ static Error doReflection(
 		variant.m_workgroupSizesConstants = refl.m_workgroupSizesConstants;
 	}
 
+	if(reference)
+	{
+		if(!refl.matchesReference(*reference))
+		{
+			ANKI_SHADER_COMPILER_LOGE("The variants have blocks, opaques or constants that the reference doesn't have");
+			return Error::USER_DATA;
+		}
+
+		// The variants point to the reference, no need to store anything else
+		return Error::NONE;
+	}
+
 	if(refl.m_blocks[0].getSize())
 	{
 		ShaderProgramBinaryBlock* blocks;
@@ -767,14 +750,101 @@ static Error doReflection(
 	return Error::NONE;
 }
 
-Error compileShaderProgramInternal(CString fname,
-	ShaderProgramFilesystemInterface& fsystem,
-	ShaderProgramPostParseInterface* postParseCallback,
-	ShaderProgramAsyncTaskInterface* taskManager_,
+class ShaderProgramBatchCompiler::Program
+{
+public:
+	ShaderProgramParser m_parser;
+	StringAuto m_fname;
+	ShaderProgramBinaryWrapper* m_binaryW = nullptr;
+	ShaderProgramPostCompileInterface* m_postCompileCallback = nullptr;
+
+	DynamicArrayAuto<ShaderProgramBinaryVariant> m_variants;
+	DynamicArrayAuto<ShaderProgramBinaryCodeBlock> m_codeBlocks;
+	DynamicArrayAuto<ShaderProgramBinaryMutation> m_mutations;
+	DynamicArrayAuto<U64> m_codeBlockHashes;
+	DynamicArrayAuto<MutatorValue> m_variantMutations; ///< The mutation of every variant one after the other.
+	const ShaderProgramBinary* m_reflectionReference = nullptr;
+	Mutex m_mtx;
+	Atomic<U32> m_pendingJobCount = {0};
+
+	Program(CString fname,
+		ShaderProgramFilesystemInterface* fsystem,
+		GenericMemoryPoolAllocator<U8> tempAlloc,
+		GenericMemoryPoolAllocator<U8> binaryAlloc,
+		const GpuDeviceCapabilities& gpuCapabilities,
+		const BindlessLimits& bindlessLimits,
+		ShaderProgramParserCache* parserCache)
+		: m_parser(fname, fsystem, tempAlloc, gpuCapabilities, bindlessLimits, parserCache)
+		, m_fname(tempAlloc, fname)
+		, m_variants(binaryAlloc)
+		, m_codeBlocks(binaryAlloc)
+		, m_mutations(binaryAlloc)
+		, m_codeBlockHashes(tempAlloc)
+		, m_variantMutations(tempAlloc)
+	{
+	}
+};
+
+/// Compile a single stage of a single variant.
+class ShaderProgramBatchCompiler::Job
+{
+public:
+	ShaderProgramBatchCompiler* m_compiler;
+	Program* m_program;
+	U32 m_programIdx;
+	U32 m_variantIdx;
+	ShaderType m_shaderType;
+	U32 m_cost; ///< An estimation of the time it will take to compile.
+};
+
+ShaderProgramBatchCompiler::ShaderProgramBatchCompiler(ShaderProgramFilesystemInterface& fsystem,
 	GenericMemoryPoolAllocator<U8> tempAllocator,
 	const GpuDeviceCapabilities& gpuCapabilities,
-	const BindlessLimits& bindlessLimits,
-	ShaderProgramBinaryWrapper& binaryW)
+	const BindlessLimits& bindlessLimits)
+	: m_fsystem(&fsystem)
+	, m_alloc(tempAllocator)
+	, m_gpuCapabilities(gpuCapabilities)
+	, m_bindlessLimits(bindlessLimits)
+	, m_parserCache(tempAllocator)
+{
+}
+
+ShaderProgramBatchCompiler::~ShaderProgramBatchCompiler()
+{
+	cleanup();
+}
+
+void ShaderProgramBatchCompiler::cleanup()
+{
+	for(Program* program : m_programs)
+	{
+		m_alloc.deleteInstance(program);
+	}
+
+	m_programs.destroy(m_alloc);
+	m_jobs.destroy(m_alloc);
+}
+
+Error ShaderProgramBatchCompiler::addProgram(CString fname,
+	ShaderProgramPostParseInterface* postParseCallback,
+	ShaderProgramPostCompileInterface* postCompileCallback,
+	ShaderProgramBinaryWrapper& binaryW,
+	const ShaderProgramBinary* reflectionReference)
+{
+	const Error err = addProgramInternal(fname, postParseCallback, postCompileCallback, binaryW, reflectionReference);
+	if(err)
+	{
+		ANKI_SHADER_COMPILER_LOGE("Failed to compile: %s", fname.cstr());
+	}
+
+	return err;
+}
+
+Error ShaderProgramBatchCompiler::addProgramInternal(CString fname,
+	ShaderProgramPostParseInterface* postParseCallback,
+	ShaderProgramPostCompileInterface* postCompileCallback,
+	ShaderProgramBinaryWrapper& binaryW,
+	const ShaderProgramBinary* reflectionReference)
 {
 	// Initialize the binary
 	binaryW.cleanup();
@@ -786,14 +856,42 @@ Error compileShaderProgramInternal(CString fname,
 	memcpy(&binary.m_magic[0], SHADER_BINARY_MAGIC, 8);
 
 	// Parse source
-	ShaderProgramParser parser(fname, &fsystem, tempAllocator, gpuCapabilities, bindlessLimits);
-	ANKI_CHECK(parser.parse());
+	Program* program = m_alloc.newInstance<Program>(
+		fname, m_fsystem, m_alloc, binaryAllocator, m_gpuCapabilities, m_bindlessLimits, &m_parserCache);
+	m_programs.emplaceBack(m_alloc, program);
+	program->m_binaryW = &binaryW;
+	program->m_postCompileCallback = postCompileCallback;
+	program->m_reflectionReference = reflectionReference;
+
+	const ShaderProgramParser& parser = program->m_parser;
+	const Second parseStartTime = HighRezTimer::getCurrentTime();
+	const Error parseErr = program->m_parser.parse();
+	m_parseTime += HighRezTimer::getCurrentTime() - parseStartTime;
+	ANKI_CHECK(parseErr);
 
 	if(postParseCallback && postParseCallback->skipCompilation(parser.getHash()))
 	{
 		return Error::NONE;
 	}
 
+	// Store the dependencies
+	const ConstWeakArray<const ShaderProgramParserFile*> dependencies = parser.getDependencies();
+	binary.m_dependencies.setArray(
+		binaryAllocator.newArray<ShaderProgramBinaryDependency>(dependencies.getSize()), dependencies.getSize());
+	for(U32 i = 0; i < dependencies.getSize(); ++i)
+	{
+		const CString depFname = dependencies[i]->getFilename();
+		ShaderProgramBinaryDependency& out = binary.m_dependencies[i];
+		if(depFname.getLength() >= out.m_filename.getSize())
+		{
+			ANKI_SHADER_COMPILER_LOGE("Filename too long: %s", depFname.cstr());
+			return Error::USER_DATA;
+		}
+
+		memcpy(&out.m_filename[0], depFname.cstr(), depFname.getLength() + 1);
+		out.m_hash = dependencies[i]->getHash();
+	}
+
 	// Get mutators
 	U32 mutationCount = 0;
 	if(parser.getMutators().getSize() > 0)
@@ -822,45 +920,21 @@ Error compileShaderProgramInternal(CString fname,
 	}
 
 	// Create all variants
-	Mutex mtx;
-	Atomic<I32> errorAtomic(0);
-	class SyncronousShaderProgramAsyncTaskInterface : public ShaderProgramAsyncTaskInterface
-	{
-	public:
-		void enqueueTask(void (*callback)(void* userData), void* userData) final
-		{
-			callback(userData);
-		}
-
-		Error joinTasks() final
-		{
-			// Nothing
-			return Error::NONE;
-		}
-	} syncTaskManager;
-	ShaderProgramAsyncTaskInterface& taskManager = (taskManager_) ? *taskManager_ : syncTaskManager;
-
+	DynamicArrayAuto<ShaderProgramBinaryVariant>& variants = program->m_variants;
+	DynamicArrayAuto<ShaderProgramBinaryMutation>& mutations = program->m_mutations;
 	if(parser.getMutators().getSize() > 0)
 	{
 		// Initialize
-		DynamicArrayAuto<MutatorValue> originalMutationValues(tempAllocator, parser.getMutators().getSize());
-		DynamicArrayAuto<MutatorValue> rewrittenMutationValues(tempAllocator, parser.getMutators().getSize());
-		DynamicArrayAuto<U32> dials(tempAllocator, parser.getMutators().getSize(), 0);
-		DynamicArrayAuto<ShaderProgramBinaryVariant> variants(binaryAllocator);
-		DynamicArrayAuto<ShaderProgramBinaryCodeBlock> codeBlocks(binaryAllocator);
-		DynamicArrayAuto<ShaderProgramBinaryMutation> mutations(binaryAllocator, mutationCount);
-		DynamicArrayAuto<U64> codeBlockHashes(tempAllocator);
-		HashMapAuto<U64, U32> mutationHashToIdx(tempAllocator);
-
-		// Grow the storage of the variants array. Can't have it resize, threads will work on stale data
-		variants.resizeStorage(mutationCount);
-		const ShaderProgramBinaryVariant* baseVariant = nullptr;
+		DynamicArrayAuto<MutatorValue> originalMutationValues(m_alloc, parser.getMutators().getSize());
+		DynamicArrayAuto<MutatorValue> rewrittenMutationValues(m_alloc, parser.getMutators().getSize());
+		DynamicArrayAuto<U32> dials(m_alloc, parser.getMutators().getSize(), 0);
+		HashMapAuto<U64, U32> mutationHashToIdx(m_alloc);
 
+		mutations.create(mutationCount);
+		variants.resizeStorage(mutationCount);
 		mutationCount = 0;
 
-		// Spin for all possible combinations of mutators and
-		// - Create the spirv
-		// - Populate the binary variant
+		// Spin for all possible combinations of mutators and populate the binary variants. Compile them later
 		do
 		{
 			// Create the mutation
@@ -888,19 +962,11 @@ Error compileShaderProgramInternal(CString fname,
 			{
 				// New and unique mutation and thus variant, add it
 
-				ShaderProgramBinaryVariant& variant = *variants.emplaceBack();
-				baseVariant = (baseVariant == nullptr) ? variants.getBegin() : baseVariant;
-
-				compileVariantAsync(originalMutationValues,
-					parser,
-					variant,
-					codeBlocks,
-					codeBlockHashes,
-					tempAllocator,
-					binaryAllocator,
-					taskManager,
-					mtx,
-					errorAtomic);
+				variants.emplaceBack();
+				for(MutatorValue value : originalMutationValues)
+				{
+					program->m_variantMutations.emplaceBack(value);
+				}
 
 				mutation.m_variantIndex = variants.getSize() - 1;
 
@@ -914,24 +980,15 @@ Error compileShaderProgramInternal(CString fname,
 					computeHash(rewrittenMutationValues.getBegin(), rewrittenMutationValues.getSizeInBytes());
 				auto it = mutationHashToIdx.find(otherMutationHash);
 
-				ShaderProgramBinaryVariant* variant = nullptr;
 				if(it == mutationHashToIdx.getEnd())
 				{
 					// Rewrite variant not found, create it
 
-					variant = variants.emplaceBack();
-					baseVariant = (baseVariant == nullptr) ? variants.getBegin() : baseVariant;
-
-					compileVariantAsync(originalMutationValues,
-						parser,
-						*variant,
-						codeBlocks,
-						codeBlockHashes,
-						tempAllocator,
-						binaryAllocator,
-						taskManager,
-						mtx,
-						errorAtomic);
+					variants.emplaceBack();
+					for(MutatorValue value : originalMutationValues)
+					{
+						program->m_variantMutations.emplaceBack(value);
+					}
 
 					ShaderProgramBinaryMutation& otherMutation = mutations[mutationCount++];
 					otherMutation.m_values.setArray(
@@ -955,70 +1012,263 @@ Error compileShaderProgramInternal(CString fname,
 		} while(!spinDials(dials, parser.getMutators()));
 
 		ANKI_ASSERT(mutationCount == mutations.getSize());
-		ANKI_ASSERT(baseVariant == variants.getBegin() && "Can't have the variants array grow");
+	}
+	else
+	{
+		variants.emplaceBack();
 
-		// Done, wait the threads
-		ANKI_CHECK(taskManager.joinTasks());
-		ANKI_CHECK(Error(errorAtomic.getNonAtomically()));
+		mutations.emplaceBack();
+		mutations[0].m_hash = 1;
+		mutations[0].m_variantIndex = 0;
+	}
 
-		// Store temp containers to binary
-		U32 size, storage;
-		ShaderProgramBinaryVariant* firstVariant;
-		variants.moveAndReset(firstVariant, size, storage);
-		binary.m_variants.setArray(firstVariant, size);
+	// Drop the variants that are not wanted. Their mutations will point to no variant
+	if(postParseCallback)
+	{
+		DynamicArrayAuto<U32> variantRemap(m_alloc, variants.getSize(), MAX_U32);
+		Bool keepAny = false;
+		for(const ShaderProgramBinaryMutation& mutation : mutations)
+		{
+			if(!postParseCallback->skipVariant(mutation.m_hash))
+			{
+				variantRemap[mutation.m_variantIndex] = 0;
+				keepAny = true;
+			}
+		}
+
+		// Keep at least one variant. The reflection needs it
+		if(!keepAny)
+		{
+			variantRemap[0] = 0;
+		}
+
+		const U32 mutatorCount = parser.getMutators().getSize();
+		U32 count = 0;
+		for(U32 i = 0; i < variants.getSize(); ++i)
+		{
+			if(variantRemap[i] == MAX_U32)
+			{
+				continue;
+			}
+
+			if(i != count && mutatorCount)
+			{
+				memcpy(&program->m_variantMutations[count * mutatorCount],
+					&program->m_variantMutations[i * mutatorCount],
+					mutatorCount * sizeof(MutatorValue));
+			}
+
+			variantRemap[i] = count++;
+		}
 
-		ShaderProgramBinaryCodeBlock* firstCodeBlock;
-		codeBlocks.moveAndReset(firstCodeBlock, size, storage);
-		binary.m_codeBlocks.setArray(firstCodeBlock, size);
+		variants.resize(count);
+		program->m_variantMutations.resize(count * mutatorCount);
 
-		ShaderProgramBinaryMutation* firstMutation;
-		mutations.moveAndReset(firstMutation, size, storage);
-		binary.m_mutations.setArray(firstMutation, size);
+		for(ShaderProgramBinaryMutation& mutation : mutations)
+		{
+			mutation.m_variantIndex = variantRemap[mutation.m_variantIndex];
+		}
 	}
-	else
+
+	// Create a job for every stage of every variant. The size of the source is a good enough estimation of the cost
+	const U32 programIdx = m_programs.getSize() - 1;
+	const U32 cost = parser.getSourceLength();
+	for(U32 variantIdx = 0; variantIdx < variants.getSize(); ++variantIdx)
+	{
+		ShaderProgramBinaryVariant& variant = variants[variantIdx];
+		variant = {};
+
+		for(ShaderType shaderType : EnumIterable<ShaderType>())
+		{
+			variant.m_codeBlockIndices[shaderType] = MAX_U32;
+
+			if(!(shaderTypeToBit(shaderType) & parser.getShaderTypes()))
+			{
+				continue;
+			}
+
+			Job job;
+			job.m_compiler = this;
+			job.m_program = program;
+			job.m_programIdx = programIdx;
+			job.m_variantIdx = variantIdx;
+			job.m_shaderType = shaderType;
+			job.m_cost = cost;
+			m_jobs.emplaceBack(m_alloc, job);
+
+			program->m_pendingJobCount.fetchAdd(1);
+		}
+	}
+
+	return Error::NONE;
+}
+
+Error ShaderProgramBatchCompiler::compile(ShaderProgramAsyncTaskInterface* taskManager_)
+{
+	class SyncronousShaderProgramAsyncTaskInterface : public ShaderProgramAsyncTaskInterface
+	{
+	public:
+		void enqueueTask(void (*callback)(void* userData), void* userData) final
+		{
+			callback(userData);
+		}
+
+		Error joinTasks() final
+		{
+			// Nothing
+			return Error::NONE;
+		}
+	} syncTaskManager;
+	ShaderProgramAsyncTaskInterface& taskManager = (taskManager_) ? *taskManager_ : syncTaskManager;
+
+	// Put the most expensive jobs first so the cheap ones fill the gaps at the end
+	std::sort(m_jobs.getBegin(), m_jobs.getEnd(), [](const Job& a, const Job& b) {
+		if(a.m_cost != b.m_cost)
+		{
+			return a.m_cost > b.m_cost;
+		}
+
+		return (a.m_programIdx != b.m_programIdx) ? a.m_programIdx < b.m_programIdx : a.m_variantIdx < b.m_variantIdx;
+	});
+
+	for(Job& job : m_jobs)
+	{
+		taskManager.enqueueTask(jobCallback, &job);
+	}
+
+	// Done, wait the threads
+	Error err = taskManager.joinTasks();
+	if(!err)
+	{
+		err = Error(m_error.getNonAtomically());
+	}
+
+	cleanup();
+	return err;
+}
+
+void ShaderProgramBatchCompiler::jobCallback(void* userData)
+{
+	const Job& job = *static_cast<const Job*>(userData);
+	ShaderProgramBatchCompiler& self = *job.m_compiler;
+	Program& program = *job.m_program;
+
+	Error err = Error::NONE;
+	if(self.m_error.load() == 0)
+	{
+		err = self.compileJob(job);
+	}
+
+	// The last job of the program completes it
+	if(program.m_pendingJobCount.fetchSub(1) == 1 && !err && self.m_error.load() == 0)
+	{
+		err = self.finalizeProgram(program);
+	}
+
+	if(err)
+	{
+		ANKI_SHADER_COMPILER_LOGE("Failed to compile: %s", program.m_fname.cstr());
+		self.m_error.store(err._getCode());
+	}
+}
+
+Error ShaderProgramBatchCompiler::compileJob(const Job& job)
+{
+	Program& program = *job.m_program;
+	const ShaderProgramParser& parser = program.m_parser;
+	const U32 mutatorCount = parser.getMutators().getSize();
+
+	// Generate the source of the variant
+	const ConstWeakArray<MutatorValue> mutation(
+		(mutatorCount) ? &program.m_variantMutations[job.m_variantIdx * mutatorCount] : nullptr, mutatorCount);
+	ShaderProgramParserVariant parserVariant;
+	ANKI_CHECK(parser.generateVariant(mutation, parserVariant));
+
+	// Get it from the cache or compile it
+	const CString source = parserVariant.getSource(job.m_shaderType);
+	DynamicArrayAuto<U8> spirv(m_alloc);
+	Bool inCache = false;
+	U64 cacheKey = 0;
+	if(m_spirvCache)
+	{
+		ANKI_CHECK(SpirvCache::computeKey(source, job.m_shaderType, m_alloc, cacheKey));
+		ANKI_CHECK(m_spirvCache->find(cacheKey, spirv, inCache));
+	}
+
+	if(!inCache)
+	{
+		ANKI_CHECK(compilerGlslToSpirv(source, job.m_shaderType, m_alloc, spirv));
+
+		if(m_spirvCache)
+		{
+			ANKI_CHECK(m_spirvCache->store(cacheKey, spirv));
+		}
+	}
+	ANKI_ASSERT(spirv.getSize() > 0);
+
+	// Check if the spirv is common with some other variant and store it
+	LockGuard<Mutex> lock(program.m_mtx);
+
+	ShaderProgramBinaryVariant& variant = program.m_variants[job.m_variantIdx];
+	const U64 newHash = computeHash(&spirv[0], spirv.getSize());
+	for(U32 i = 0; i < program.m_codeBlockHashes.getSize(); ++i)
 	{
-		DynamicArrayAuto<MutatorValue> mutation(tempAllocator);
-		DynamicArrayAuto<ShaderProgramBinaryCodeBlock> codeBlocks(binaryAllocator);
-		DynamicArrayAuto<U64> codeBlockHashes(tempAllocator);
-
-		binary.m_variants.setArray(binaryAllocator.newInstance<ShaderProgramBinaryVariant>(), 1);
-
-		compileVariantAsync(mutation,
-			parser,
-			binary.m_variants[0],
-			codeBlocks,
-			codeBlockHashes,
-			tempAllocator,
-			binaryAllocator,
-			taskManager,
-			mtx,
-			errorAtomic);
-
-		ANKI_CHECK(taskManager.joinTasks());
-		ANKI_CHECK(Error(errorAtomic.getNonAtomically()));
-
-		ANKI_ASSERT(codeBlocks.getSize() == U32(__builtin_popcount(U32(parser.getShaderTypes()))));
-
-		ShaderProgramBinaryCodeBlock* firstCodeBlock;
-		U32 size, storage;
-		codeBlocks.moveAndReset(firstCodeBlock, size, storage);
-		binary.m_codeBlocks.setArray(firstCodeBlock, size);
-
-		binary.m_mutations.setArray(binaryAllocator.newInstance<ShaderProgramBinaryMutation>(), 1);
-		binary.m_mutations[0].m_hash = 1;
-		binary.m_mutations[0].m_variantIndex = 0;
+		if(program.m_codeBlockHashes[i] == newHash)
+		{
+			// Found it
+			variant.m_codeBlockIndices[job.m_shaderType] = i;
+			return Error::NONE;
+		}
 	}
 
+	// Create it if not found
+	U8* code = program.m_binaryW->m_alloc.allocate(spirv.getSizeInBytes());
+	memcpy(code, &spirv[0], spirv.getSizeInBytes());
+
+	ShaderProgramBinaryCodeBlock block;
+	block.m_binary.setArray(code, U32(spirv.getSizeInBytes()));
+
+	program.m_codeBlocks.emplaceBack(block);
+	program.m_codeBlockHashes.emplaceBack(newHash);
+
+	variant.m_codeBlockIndices[job.m_shaderType] = program.m_codeBlocks.getSize() - 1;
+
+	return Error::NONE;
+}
+
+Error ShaderProgramBatchCompiler::finalizeProgram(Program& program)
+{
+	ShaderProgramBinary& binary = *program.m_binaryW->m_binary;
+
+	// Store temp containers to binary
+	U32 size, storage;
+	ShaderProgramBinaryVariant* firstVariant;
+	program.m_variants.moveAndReset(firstVariant, size, storage);
+	binary.m_variants.setArray(firstVariant, size);
+
+	ShaderProgramBinaryCodeBlock* firstCodeBlock;
+	program.m_codeBlocks.moveAndReset(firstCodeBlock, size, storage);
+	binary.m_codeBlocks.setArray(firstCodeBlock, size);
+
+	ShaderProgramBinaryMutation* firstMutation;
+	program.m_mutations.moveAndReset(firstMutation, size, storage);
+	binary.m_mutations.setArray(firstMutation, size);
+
 	// Sort the mutations
 	std::sort(binary.m_mutations.getBegin(),
 		binary.m_mutations.getEnd(),
 		[](const ShaderProgramBinaryMutation& a, const ShaderProgramBinaryMutation& b) { return a.m_hash < b.m_hash; });
 
 	// Misc
-	binary.m_presentShaderTypes = parser.getShaderTypes();
+	binary.m_presentShaderTypes = program.m_parser.getShaderTypes();
 
 	// Reflection
-	ANKI_CHECK(doReflection(binary, tempAllocator, binaryAllocator));
+	ANKI_CHECK(doReflection(binary, m_alloc, program.m_binaryW->m_alloc, program.m_reflectionReference));
+
+	if(program.m_postCompileCallback)
+	{
+		ANKI_CHECK(program.m_postCompileCallback->programCompiled(*program.m_binaryW));
+	}
 
 	return Error::NONE;
 }
@@ -1032,14 +1282,152 @@ Error compileShaderProgram(CString fname,
 	const BindlessLimits& bindlessLimits,
 	ShaderProgramBinaryWrapper& binaryW)
 {
-	const Error err = compileShaderProgramInternal(
-		fname, fsystem, postParseCallback, taskManager, tempAllocator, gpuCapabilities, bindlessLimits, binaryW);
-	if(err)
+	ShaderProgramBatchCompiler compiler(fsystem, tempAllocator, gpuCapabilities, bindlessLimits);
+	ANKI_CHECK(compiler.addProgram(fname, postParseCallback, nullptr, binaryW));
+	ANKI_CHECK(compiler.compile(taskManager));
+	return Error::NONE;
+}
+
+Error compileShaderProgramVariant(CString fname,
+	U64 mutationHash,
+	const ShaderProgramBinary& reference,
+	ShaderProgramFilesystemInterface& fsystem,
+	GenericMemoryPoolAllocator<U8> tempAllocator,
+	const GpuDeviceCapabilities& gpuCapabilities,
+	const BindlessLimits& bindlessLimits,
+	ShaderProgramBinaryWrapper& binaryW)
+{
+	class VariantFilter : public ShaderProgramPostParseInterface
 	{
-		ANKI_SHADER_COMPILER_LOGE("Failed to compile: %s", fname.cstr());
+	public:
+		U64 m_mutationHash;
+
+		Bool skipCompilation(U64 programHash) final
+		{
+			return false;
+		}
+
+		Bool skipVariant(U64 mutationHash) final
+		{
+			return mutationHash != m_mutationHash;
+		}
+	} filter;
+	filter.m_mutationHash = mutationHash;
+
+	ShaderProgramBatchCompiler compiler(fsystem, tempAllocator, gpuCapabilities, bindlessLimits);
+	ANKI_CHECK(compiler.addProgram(fname, &filter, nullptr, binaryW, &reference));
+	ANKI_CHECK(compiler.compile(nullptr));
+
+	// Check if the variant is there
+	for(const ShaderProgramBinaryMutation& mutation : binaryW.getBinary().m_mutations)
+	{
+		if(mutation.m_hash == mutationHash)
+		{
+			return Error::NONE;
+		}
 	}
 
-	return err;
+	ANKI_SHADER_COMPILER_LOGE("Mutation not found in %s", fname.cstr());
+	return Error::USER_DATA;
+}
+
+const ShaderProgramBinaryMutation* findShaderProgramFallbackMutation(
+	const ShaderProgramBinary& binary, ConstWeakArray<MutatorValue> mutation, const BitSet<64, U64>& exactMutators)
+{
+	const U32 mutatorCount = binary.m_mutators.getSize();
+	ANKI_ASSERT(mutation.getSize() >= mutatorCount && mutatorCount <= 64);
+
+	// One bit per matching mutator. The first mutators are in the most significant bits
+	const ShaderProgramBinaryMutation* best = nullptr;
+	U64 bestScore = 0;
+	for(const ShaderProgramBinaryMutation& other : binary.m_mutations)
+	{
+		if(other.m_variantIndex == MAX_U32)
+		{
+			continue;
+		}
+
+		Bool skip = false;
+		U64 score = 0;
+		for(U32 i = 0; i < mutatorCount && !skip; ++i)
+		{
+			if(other.m_values[i] == mutation[i])
+			{
+				score |= U64(1) << U64(mutatorCount - i - 1);
+			}
+			else
+			{
+				skip = exactMutators.get(i);
+			}
+		}
+
+		if(!skip && (best == nullptr || score > bestScore))
+		{
+			best = &other;
+			bestScore = score;
+		}
+	}
+
+	return best;
+}
+
+Error ShaderProgramUsedMutations::load(CString filename)
+{
+	m_hashes.destroy(m_alloc);
+
+	if(!fileExists(filename))
+	{
+		return Error::NONE;
+	}
+
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::READ | FileOpenFlag::BINARY));
+	const PtrSize size = file.getSize();
+	if((size % sizeof(U64)) != 0)
+	{
+		ANKI_SHADER_COMPILER_LOGW("Ignoring corrupted file: %s", filename.cstr());
+		return Error::NONE;
+	}
+
+	if(size > 0)
+	{
+		m_hashes.create(m_alloc, U32(size / sizeof(U64)));
+		ANKI_CHECK(file.read(m_hashes.getBegin(), size));
+	}
+
+	return Error::NONE;
+}
+
+Error ShaderProgramUsedMutations::save(CString filename) const
+{
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+	ANKI_CHECK(file.write(m_hashes.getBegin(), m_hashes.getSizeInBytes()));
+	return Error::NONE;
+}
+
+Bool ShaderProgramUsedMutations::add(U64 mutationHash)
+{
+	if(contains(mutationHash))
+	{
+		return false;
+	}
+
+	m_hashes.emplaceBack(m_alloc, mutationHash);
+	return true;
+}
+
+Bool ShaderProgramUsedMutations::contains(U64 mutationHash) const
+{
+	for(U64 hash : m_hashes)
+	{
+		if(hash == mutationHash)
+		{
+			return true;
+		}
+	}
+
+	return false;
 }
 
 } // end namespace anki
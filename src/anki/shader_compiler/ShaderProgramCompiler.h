@@ -6,12 +6,20 @@
 #pragma once
 
 #include <anki/shader_compiler/ShaderProgramDump.h>
+#include <anki/shader_compiler/ShaderProgramParser.h>
 #include <anki/util/String.h>
+#include <anki/util/Atomic.h>
+#include <anki/util/MappedFile.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/BitSet.h>
 #include <anki/gr/Common.h>
 
 namespace anki
 {
 
+// Forward
+class SpirvCache;
+
 /// @addtogroup shader_compiler
 /// @{
 
@@ -21,14 +29,7 @@ extern const U32 SHADER_BINARY_VERSION;
 /// @memberof ShaderProgramCompiler
 class ShaderProgramBinaryWrapper : public NonCopyable
 {
-	friend Error compileShaderProgramInternal(CString fname,
-		ShaderProgramFilesystemInterface& fsystem,
-		ShaderProgramPostParseInterface* postParseCallback,
-		ShaderProgramAsyncTaskInterface* taskManager,
-		GenericMemoryPoolAllocator<U8> tempAllocator,
-		const GpuDeviceCapabilities& gpuCapabilities,
-		const BindlessLimits& bindlessLimits,
-		ShaderProgramBinaryWrapper& binary);
+	friend class ShaderProgramBatchCompiler;
 
 public:
 	ShaderProgramBinaryWrapper(GenericMemoryPoolAllocator<U8> alloc)
@@ -43,6 +44,7 @@ public:
 
 	ANKI_USE_RESULT Error serializeToFile(CString fname) const;
 
+	/// Load a binary. If it's a regular file it will be memory-mapped and used in place.
 	ANKI_USE_RESULT Error deserializeFromFile(CString fname);
 
 	const ShaderProgramBinary& getBinary() const
@@ -54,11 +56,99 @@ public:
 private:
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	ShaderProgramBinary* m_binary = nullptr;
+	MappedFile m_mappedFile; ///< If it's open the m_binary lives there.
 	Bool m_singleAllocation = false;
 
 	void cleanup();
 };
 
+/// This is called by the ShaderProgramBatchCompiler when the binary of a program is ready.
+class ShaderProgramPostCompileInterface
+{
+public:
+	/// It's called by the thread that compiled the last stage of the program.
+	virtual ANKI_USE_RESULT Error programCompiled(const ShaderProgramBinaryWrapper& binary) = 0;
+};
+
+/// Compiles many shader programs at once. It parses all the programs first and then it compiles the stages of the
+/// variants of all programs as independent tasks, the most expensive first. That way programs with few variants don't
+/// leave threads idle.
+class ShaderProgramBatchCompiler : public NonCopyable
+{
+public:
+	ShaderProgramBatchCompiler(ShaderProgramFilesystemInterface& fsystem,
+		GenericMemoryPoolAllocator<U8> tempAllocator,
+		const GpuDeviceCapabilities& gpuCapabilities,
+		const BindlessLimits& bindlessLimits);
+
+	~ShaderProgramBatchCompiler();
+
+	/// Parse a program and prepare its compilation.
+	/// @param postParseCallback Optional. If it skips the compilation the program won't be compiled. It can also skip
+	///                          some of the variants.
+	/// @param postCompileCallback Optional.
+	/// @param[out] binary The binary of the program. It should be alive until compile() returns.
+	/// @param reflectionReference Optional. If it's not nullptr the variants will point to the blocks, opaques and
+	///                            constants of that binary and the binary of the program won't have its own.
+	ANKI_USE_RESULT Error addProgram(CString fname,
+		ShaderProgramPostParseInterface* postParseCallback,
+		ShaderProgramPostCompileInterface* postCompileCallback,
+		ShaderProgramBinaryWrapper& binary,
+		const ShaderProgramBinary* reflectionReference = nullptr);
+
+	/// Set a cache that will be used to skip the compilation of stages that were compiled before.
+	void setSpirvCache(SpirvCache* cache)
+	{
+		m_spirvCache = cache;
+	}
+
+	/// Compile all the programs that were added.
+	/// @param taskManager Optional. If it's nullptr the compilation is synchronous.
+	ANKI_USE_RESULT Error compile(ShaderProgramAsyncTaskInterface* taskManager);
+
+	/// The cache of the files that the parsers loaded. The programs that share includes load them once.
+	const ShaderProgramParserCache& getParserCache() const
+	{
+		return m_parserCache;
+	}
+
+	/// The time spent parsing in addProgram().
+	Second getParseTime() const
+	{
+		return m_parseTime;
+	}
+
+private:
+	class Program;
+	class Job;
+
+	ShaderProgramFilesystemInterface* m_fsystem;
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	GpuDeviceCapabilities m_gpuCapabilities;
+	BindlessLimits m_bindlessLimits;
+	SpirvCache* m_spirvCache = nullptr;
+	ShaderProgramParserCache m_parserCache;
+	Second m_parseTime = 0.0;
+
+	DynamicArray<Program*> m_programs;
+	DynamicArray<Job> m_jobs;
+	Atomic<I32> m_error = {0};
+
+	ANKI_USE_RESULT Error addProgramInternal(CString fname,
+		ShaderProgramPostParseInterface* postParseCallback,
+		ShaderProgramPostCompileInterface* postCompileCallback,
+		ShaderProgramBinaryWrapper& binary,
+		const ShaderProgramBinary* reflectionReference);
+
+	ANKI_USE_RESULT Error compileJob(const Job& job);
+
+	ANKI_USE_RESULT Error finalizeProgram(Program& program);
+
+	static void jobCallback(void* userData);
+
+	void cleanup();
+};
+
 /// Takes an AnKi special shader program and spits a binary.
 ANKI_USE_RESULT Error compileShaderProgram(CString fname,
 	ShaderProgramFilesystemInterface& fsystem,
@@ -68,6 +158,68 @@ ANKI_USE_RESULT Error compileShaderProgram(CString fname,
 	const GpuDeviceCapabilities& gpuCapabilities,
 	const BindlessLimits& bindlessLimits,
 	ShaderProgramBinaryWrapper& binary);
+
+/// Compile a single variant of a program whose binary was compiled with that variant skipped. See
+/// ShaderProgramPostParseInterface::skipVariant(). The new variant will point to the blocks, opaques and constants of
+/// the reference binary so it can be used along with it. It will fail if the variant has some that the reference
+/// doesn't have.
+/// @param mutationHash The hash of the mutation of the variant.
+/// @param reference The binary that skipped the variant.
+/// @param[out] binary A binary that contains only the new variant and its code blocks.
+ANKI_USE_RESULT Error compileShaderProgramVariant(CString fname,
+	U64 mutationHash,
+	const ShaderProgramBinary& reference,
+	ShaderProgramFilesystemInterface& fsystem,
+	GenericMemoryPoolAllocator<U8> tempAllocator,
+	const GpuDeviceCapabilities& gpuCapabilities,
+	const BindlessLimits& bindlessLimits,
+	ShaderProgramBinaryWrapper& binary);
+
+/// Find a variant of a binary that can stand in for a variant that was skipped until the latter is compiled.
+/// @param binary The binary that skipped the variant.
+/// @param mutation The values of the mutators of the skipped variant.
+/// @param exactMutators The mutators that should have the same values. Those are the mutators that change the
+///                      interface of the program (eg the inputs or the outputs). Of the rest the first mutators are
+///                      the most important.
+/// @return The mutation of the variant or nullptr if none matches the exactMutators.
+const ShaderProgramBinaryMutation* findShaderProgramFallbackMutation(
+	const ShaderProgramBinary& binary, ConstWeakArray<MutatorValue> mutation, const BitSet<64, U64>& exactMutators);
+
+/// The record of the mutations of a program that were used. Used with ShaderProgramPostParseInterface::skipVariant() to
+/// compile only those ahead of time.
+class ShaderProgramUsedMutations : public NonCopyable
+{
+public:
+	ShaderProgramUsedMutations(GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~ShaderProgramUsedMutations()
+	{
+		m_hashes.destroy(m_alloc);
+	}
+
+	/// Load the record. If the file is missing or corrupted the record will be empty.
+	ANKI_USE_RESULT Error load(CString filename);
+
+	ANKI_USE_RESULT Error save(CString filename) const;
+
+	/// Add a mutation.
+	/// @return True if it wasn't in the record.
+	Bool add(U64 mutationHash);
+
+	Bool contains(U64 mutationHash) const;
+
+	ConstWeakArray<U64> getMutationHashes() const
+	{
+		return m_hashes;
+	}
+
+private:
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	DynamicArray<U64> m_hashes;
+};
 /// @}
 
 } // end namespace anki
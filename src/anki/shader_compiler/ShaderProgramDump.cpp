@@ -60,6 +60,12 @@ void dumpShaderProgramBinary(const ShaderProgramBinary& binary, StringAuto& huma
 		lines.pushBack(ANKI_TAB "N/A\n");
 	}
 
+	lines.pushBack("\n**DEPENDENCIES**\n");
+	for(const ShaderProgramBinaryDependency& dep : binary.m_dependencies)
+	{
+		lines.pushBackSprintf(ANKI_TAB "%-64s %016" PRIx64 "\n", &dep.m_filename[0], dep.m_hash);
+	}
+
 	lines.pushBack("\n**BINARIES**\n");
 	U32 count = 0;
 	for(const ShaderProgramBinaryCodeBlock& code : binary.m_codeBlocks)
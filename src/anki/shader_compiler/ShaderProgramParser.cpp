@@ -139,16 +139,45 @@ static const char* SHADER_HEADER = R"(#version 450 core
 	}
 )";
 
-static const U64 SHADER_HEADER_HASH = computeHash(SHADER_HEADER, sizeof(SHADER_HEADER));
+static const U64 SHADER_HEADER_HASH = computeHash(SHADER_HEADER, strlen(SHADER_HEADER));
+
+ShaderProgramParserFile::~ShaderProgramParserFile()
+{
+	for(Line& line : m_lines)
+	{
+		line.m_text.destroy(m_alloc);
+
+		for(String& token : line.m_tokens)
+		{
+			token.destroy(m_alloc);
+		}
+		line.m_tokens.destroy(m_alloc);
+	}
+
+	m_lines.destroy(m_alloc);
+	m_fname.destroy(m_alloc);
+}
+
+ShaderProgramParserCache::~ShaderProgramParserCache()
+{
+	for(ShaderProgramParserFile* file : m_files)
+	{
+		m_alloc.deleteInstance(file);
+	}
+
+	m_files.destroy(m_alloc);
+}
 
 ShaderProgramParser::ShaderProgramParser(CString fname,
 	ShaderProgramFilesystemInterface* fsystem,
 	GenericMemoryPoolAllocator<U8> alloc,
 	const GpuDeviceCapabilities& gpuCapabilities,
-	const BindlessLimits& bindlessLimits)
+	const BindlessLimits& bindlessLimits,
+	ShaderProgramParserCache* cache)
 	: m_alloc(alloc)
 	, m_fname(alloc, fname)
 	, m_fsystem(fsystem)
+	, m_cache(cache)
 	, m_gpuCapabilities(gpuCapabilities)
 	, m_bindlessLimits(bindlessLimits)
 {
@@ -156,13 +185,18 @@ ShaderProgramParser::ShaderProgramParser(CString fname,
 
 ShaderProgramParser::~ShaderProgramParser()
 {
+	for(ShaderProgramParserFile* file : m_ownedFiles)
+	{
+		GenericMemoryPoolAllocator<U8> alloc = file->m_alloc;
+		alloc.deleteInstance(file);
+	}
 }
 
-void ShaderProgramParser::tokenizeLine(CString line, DynamicArrayAuto<StringAuto>& tokens) const
+void ShaderProgramParser::tokenizeLine(CString line, GenericMemoryPoolAllocator<U8> alloc, DynamicArray<String>& tokens)
 {
 	ANKI_ASSERT(line.getLength() > 0);
 
-	StringAuto l(m_alloc, line);
+	StringAuto l(alloc, line);
 
 	// Replace all tabs with spaces
 	for(char& c : l)
@@ -174,17 +208,19 @@ void ShaderProgramParser::tokenizeLine(CString line, DynamicArrayAuto<StringAuto
 	}
 
 	// Split
-	StringListAuto spaceTokens(m_alloc);
+	StringListAuto spaceTokens(alloc);
 	spaceTokens.splitString(l, ' ', false);
 
 	// Create the array
+	tokens.create(alloc, U32(spaceTokens.getSize()));
+	U32 count = 0;
 	for(const String& s : spaceTokens)
 	{
-		tokens.emplaceBack(m_alloc, s);
+		tokens[count++].create(alloc, s);
 	}
 }
 
-Error ShaderProgramParser::parsePragmaStart(const StringAuto* begin, const StringAuto* end, CString line, CString fname)
+Error ShaderProgramParser::parsePragmaStart(const String* begin, const String* end, CString line, CString fname)
 {
 	ANKI_ASSERT(begin && end);
 
@@ -249,7 +285,7 @@ Error ShaderProgramParser::parsePragmaStart(const StringAuto* begin, const Strin
 	return Error::NONE;
 }
 
-Error ShaderProgramParser::parsePragmaEnd(const StringAuto* begin, const StringAuto* end, CString line, CString fname)
+Error ShaderProgramParser::parsePragmaEnd(const String* begin, const String* end, CString line, CString fname)
 {
 	ANKI_ASSERT(begin && end);
 
@@ -273,7 +309,7 @@ Error ShaderProgramParser::parsePragmaEnd(const StringAuto* begin, const StringA
 }
 
 Error ShaderProgramParser::parsePragmaMutator(
-	const StringAuto* begin, const StringAuto* end, CString line, CString fname)
+	const String* begin, const String* end, CString line, CString fname)
 {
 	ANKI_ASSERT(begin && end);
 
@@ -353,7 +389,7 @@ Error ShaderProgramParser::parsePragmaMutator(
 }
 
 Error ShaderProgramParser::parsePragmaRewriteMutation(
-	const StringAuto* begin, const StringAuto* end, CString line, CString fname)
+	const String* begin, const String* end, CString line, CString fname)
 {
 	ANKI_ASSERT(begin && end);
 
@@ -495,7 +531,7 @@ Error ShaderProgramParser::parsePragmaRewriteMutation(
 }
 
 Error ShaderProgramParser::parseInclude(
-	const StringAuto* begin, const StringAuto* end, CString line, CString fname, U32 depth)
+	const String* begin, const String* end, CString line, CString fname, U32 depth)
 {
 	// Gather the path
 	StringAuto path(m_alloc);
@@ -531,15 +567,13 @@ Error ShaderProgramParser::parseInclude(
 	return Error::NONE;
 }
 
-Error ShaderProgramParser::parseLine(CString line, CString fname, Bool& foundPragmaOnce, U32 depth)
+Error ShaderProgramParser::parseLine(
+	CString line, ConstWeakArray<String> tokens, CString fname, Bool& foundPragmaOnce, U32 depth)
 {
-	// Tokenize
-	DynamicArrayAuto<StringAuto> tokens(m_alloc);
-	tokenizeLine(line, tokens);
 	ANKI_ASSERT(tokens.getSize() > 0);
 
-	const StringAuto* token = tokens.getBegin();
-	const StringAuto* end = tokens.getEnd();
+	const String* token = tokens.getBegin();
+	const String* end = tokens.getEnd();
 
 	// Skip the hash
 	Bool foundAloneHash = false;
@@ -627,6 +661,91 @@ Error ShaderProgramParser::parseLine(CString line, CString fname, Bool& foundPra
 	return Error::NONE;
 }
 
+Error ShaderProgramParser::loadFile(CString fname, const ShaderProgramParserFile*& out)
+{
+	out = nullptr;
+	const U64 fnameHash = fname.computeHash();
+
+	// Check the cache first
+	if(m_cache)
+	{
+		LockGuard<Mutex> lock(m_cache->m_mtx);
+		auto it = m_cache->m_files.find(fnameHash);
+		if(it != m_cache->m_files.getEnd() && (*it)->m_fname == fname)
+		{
+			out = *it;
+		}
+	}
+
+	if(out)
+	{
+		m_cache->m_hitCount.fetchAdd(1);
+	}
+	else
+	{
+		// Load file in lines
+		StringAuto txt(m_alloc);
+		ANKI_CHECK(m_fsystem->readAllText(fname, txt));
+
+		GenericMemoryPoolAllocator<U8> alloc = (m_cache) ? m_cache->m_alloc : m_alloc;
+		ShaderProgramParserFile* file = alloc.newInstance<ShaderProgramParserFile>(alloc);
+		file->m_fname.create(alloc, fname);
+		file->m_hash = ShaderProgramParserFile::computeFileHash(txt.toCString());
+
+		StringListAuto lines(m_alloc);
+		lines.splitString(txt.toCString(), '\n');
+
+		// Tokenize only the lines that may contain a preprocessor directive we care
+		file->m_lines.create(alloc, U32(lines.getSize()));
+		U32 count = 0;
+		for(const String& line : lines)
+		{
+			ShaderProgramParserFile::Line& outLine = file->m_lines[count++];
+			outLine.m_text.create(alloc, line);
+
+			if(line.find("pragma") != CString::NPOS || line.find("include") != CString::NPOS)
+			{
+				tokenizeLine(line.toCString(), alloc, outLine.m_tokens);
+			}
+		}
+
+		// Move it to the cache if no one else added it. Otherwise the parser owns it
+		Bool cached = false;
+		if(m_cache)
+		{
+			m_cache->m_missCount.fetchAdd(1);
+
+			LockGuard<Mutex> lock(m_cache->m_mtx);
+			if(m_cache->m_files.find(fnameHash) == m_cache->m_files.getEnd())
+			{
+				m_cache->m_files.emplace(m_cache->m_alloc, fnameHash, file);
+				cached = true;
+			}
+		}
+
+		if(!cached)
+		{
+			m_ownedFiles.emplaceBack(file);
+		}
+
+		out = file;
+	}
+
+	// Add it to the dependencies
+	Bool found = false;
+	for(const ShaderProgramParserFile* dep : m_dependencies)
+	{
+		found = found || dep == out;
+	}
+
+	if(!found)
+	{
+		m_dependencies.emplaceBack(out);
+	}
+
+	return Error::NONE;
+}
+
 Error ShaderProgramParser::parseFile(CString fname, U32 depth)
 {
 	// First check the depth
@@ -637,29 +756,25 @@ Error ShaderProgramParser::parseFile(CString fname, U32 depth)
 
 	Bool foundPragmaOnce = false;
 
-	// Load file in lines
-	StringAuto txt(m_alloc);
-	ANKI_CHECK(m_fsystem->readAllText(fname, txt));
-
-	StringListAuto lines(m_alloc);
-	lines.splitString(txt.toCString(), '\n');
-	if(lines.getSize() < 1)
+	const ShaderProgramParserFile* file;
+	ANKI_CHECK(loadFile(fname, file));
+	if(file->m_lines.getSize() < 1)
 	{
 		ANKI_SHADER_COMPILER_LOGE("Source is empty");
 	}
 
 	// Parse lines
-	for(const String& line : lines)
+	for(const ShaderProgramParserFile::Line& line : file->m_lines)
 	{
-		if(line.find("pragma") != CString::NPOS || line.find("include") != CString::NPOS)
+		if(line.m_tokens.getSize() > 0)
 		{
 			// Possibly a preprocessor directive we care
-			ANKI_CHECK(parseLine(line.toCString(), fname, foundPragmaOnce, depth));
+			ANKI_CHECK(parseLine(line.m_text.toCString(), line.m_tokens, fname, foundPragmaOnce, depth));
 		}
 		else
 		{
 			// Just append the line
-			m_codeLines.pushBack(line.toCString());
+			m_codeLines.pushBack(line.m_text.toCString());
 		}
 	}
 
@@ -726,6 +841,11 @@ Error ShaderProgramParser::parse()
 	return Error::NONE;
 }
 
+U64 ShaderProgramParser::getShaderHeaderHash()
+{
+	return SHADER_HEADER_HASH;
+}
+
 void ShaderProgramParser::generateAnkiShaderHeader(
 	const GpuDeviceCapabilities& caps, const BindlessLimits& limits, StringAuto& header)
 {
@@ -9,6 +9,9 @@
 #include <anki/util/StringList.h>
 #include <anki/util/WeakArray.h>
 #include <anki/util/DynamicArray.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/Thread.h>
+#include <anki/util/Atomic.h>
 #include <anki/gr/utils/Functions.h>
 
 namespace anki
@@ -17,6 +20,7 @@ namespace anki
 // Forward
 class ShaderProgramParser;
 class ShaderProgramParserVariant;
+class ShaderProgramParserCache;
 
 /// @addtogroup shader_compiler
 /// @{
@@ -72,6 +76,88 @@ private:
 	Array<String, U(ShaderType::COUNT)> m_sources;
 };
 
+/// A source file that was loaded and tokenized by the ShaderProgramParser.
+/// @memberof ShaderProgramParser
+class ShaderProgramParserFile : public NonCopyable
+{
+	friend class ShaderProgramParser;
+
+public:
+	ShaderProgramParserFile(GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~ShaderProgramParserFile();
+
+	CString getFilename() const
+	{
+		return m_fname.toCString();
+	}
+
+	/// The hash of the contents of the file.
+	U64 getHash() const
+	{
+		ANKI_ASSERT(m_hash != 0);
+		return m_hash;
+	}
+
+	/// Compute the hash of the contents of a file the same way getHash() does. Use it to check if a file changed.
+	static U64 computeFileHash(CString txt)
+	{
+		return (txt.getLength()) ? computeHash(txt.cstr(), txt.getLength()) : 1;
+	}
+
+private:
+	class Line
+	{
+	public:
+		String m_text;
+		DynamicArray<String> m_tokens; ///< Only the lines that might contain a directive are tokenized.
+	};
+
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	String m_fname;
+	U64 m_hash = 0;
+	DynamicArray<Line> m_lines;
+};
+
+/// Keeps the files that were loaded by ShaderProgramParsers so other parsers won't have to load and tokenize them
+/// again. Useful when parsing many programs that share includes. The files are not expected to change while the cache
+/// is alive. It's thread-safe.
+class ShaderProgramParserCache : public NonCopyable
+{
+	friend class ShaderProgramParser;
+
+public:
+	ShaderProgramParserCache(GenericMemoryPoolAllocator<U8> alloc)
+		: m_alloc(alloc)
+	{
+	}
+
+	~ShaderProgramParserCache();
+
+	/// @name Statistics
+	/// @{
+	U32 getHitCount() const
+	{
+		return m_hitCount.load();
+	}
+
+	U32 getMissCount() const
+	{
+		return m_missCount.load();
+	}
+	/// @}
+
+private:
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	HashMap<U64, ShaderProgramParserFile*> m_files; ///< Indexed by the hash of the filename.
+	Mutex m_mtx;
+	Atomic<U32> m_hitCount = {0};
+	Atomic<U32> m_missCount = {0};
+};
+
 /// This is a special preprocessor that run before the usual preprocessor. Its purpose is to add some meta information
 /// in the shader programs.
 ///
@@ -92,7 +178,8 @@ public:
 		ShaderProgramFilesystemInterface* fsystem,
 		GenericMemoryPoolAllocator<U8> alloc,
 		const GpuDeviceCapabilities& gpuCapabilities,
-		const BindlessLimits& bindlessLimits);
+		const BindlessLimits& bindlessLimits,
+		ShaderProgramParserCache* cache = nullptr);
 
 	~ShaderProgramParser();
 
@@ -123,6 +210,21 @@ public:
 		return m_codeSourceHash;
 	}
 
+	/// Get all the files that were parsed. The first is the program itself.
+	ConstWeakArray<const ShaderProgramParserFile*> getDependencies() const
+	{
+		return m_dependencies;
+	}
+
+	/// The hash of the header that generateVariant() adds to all stages.
+	static U64 getShaderHeaderHash();
+
+	/// The length of the parsed source of all stages.
+	U32 getSourceLength() const
+	{
+		return U32(m_codeSource.getLength());
+	}
+
 	/// Generates the common header that will be used by all AnKi shaders.
 	static void generateAnkiShaderHeader(
 		const GpuDeviceCapabilities& caps, const BindlessLimits& limits, StringAuto& header);
@@ -160,6 +262,10 @@ private:
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	StringAuto m_fname;
 	ShaderProgramFilesystemInterface* m_fsystem = nullptr;
+	ShaderProgramParserCache* m_cache = nullptr;
+
+	DynamicArrayAuto<const ShaderProgramParserFile*> m_dependencies = {m_alloc};
+	DynamicArrayAuto<ShaderProgramParserFile*> m_ownedFiles = {m_alloc}; ///< The files that are not in the cache.
 
 	StringListAuto m_codeLines = {m_alloc}; ///< The code.
 	StringAuto m_codeSource = {m_alloc};
@@ -173,18 +279,19 @@ private:
 	GpuDeviceCapabilities m_gpuCapabilities;
 	BindlessLimits m_bindlessLimits;
 
+	/// Get a file from the cache or load it.
+	ANKI_USE_RESULT Error loadFile(CString fname, const ShaderProgramParserFile*& file);
 	ANKI_USE_RESULT Error parseFile(CString fname, U32 depth);
-	ANKI_USE_RESULT Error parseLine(CString line, CString fname, Bool& foundPragmaOnce, U32 depth);
-	ANKI_USE_RESULT Error parseInclude(
-		const StringAuto* begin, const StringAuto* end, CString line, CString fname, U32 depth);
-	ANKI_USE_RESULT Error parsePragmaMutator(
-		const StringAuto* begin, const StringAuto* end, CString line, CString fname);
-	ANKI_USE_RESULT Error parsePragmaStart(const StringAuto* begin, const StringAuto* end, CString line, CString fname);
-	ANKI_USE_RESULT Error parsePragmaEnd(const StringAuto* begin, const StringAuto* end, CString line, CString fname);
+	ANKI_USE_RESULT Error parseLine(
+		CString line, ConstWeakArray<String> tokens, CString fname, Bool& foundPragmaOnce, U32 depth);
+	ANKI_USE_RESULT Error parseInclude(const String* begin, const String* end, CString line, CString fname, U32 depth);
+	ANKI_USE_RESULT Error parsePragmaMutator(const String* begin, const String* end, CString line, CString fname);
+	ANKI_USE_RESULT Error parsePragmaStart(const String* begin, const String* end, CString line, CString fname);
+	ANKI_USE_RESULT Error parsePragmaEnd(const String* begin, const String* end, CString line, CString fname);
 	ANKI_USE_RESULT Error parsePragmaRewriteMutation(
-		const StringAuto* begin, const StringAuto* end, CString line, CString fname);
+		const String* begin, const String* end, CString line, CString fname);
 
-	void tokenizeLine(CString line, DynamicArrayAuto<StringAuto>& tokens) const;
+	static void tokenizeLine(CString line, GenericMemoryPoolAllocator<U8> alloc, DynamicArray<String>& tokens);
 
 	static Bool tokenIsComment(CString token)
 	{
@@ -0,0 +1,223 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/shader_compiler/SpirvCache.h>
+#include <anki/shader_compiler/Glslang.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
+#include <anki/util/HighRezTimer.h>
+
+namespace anki
+{
+
+static const U32 SPIRV_MAGIC = 0x07230203;
+
+/// The header of the files of the entries. It's used to detect truncated or corrupted files.
+class SpirvCacheEntryHeader
+{
+public:
+	Array<U8, 8> m_magic;
+	U32 m_spirvSize;
+	U32 m_padding;
+	U64 m_spirvHash;
+};
+
+static const Array<U8, 8> ENTRY_MAGIC = {{'A', 'N', 'K', 'I', 'S', 'P', 'V', '1'}};
+
+SpirvCache::~SpirvCache()
+{
+	for(WeakArray<U8>& spirv : m_entries)
+	{
+		m_alloc.deallocate(spirv.getBegin(), spirv.getSize());
+	}
+
+	m_entries.destroy(m_alloc);
+	m_dir.destroy(m_alloc);
+}
+
+Error SpirvCache::init(GenericMemoryPoolAllocator<U8> alloc, CString cacheDir)
+{
+	m_alloc = alloc;
+
+	if(!cacheDir.isEmpty())
+	{
+		if(!directoryExists(cacheDir))
+		{
+			ANKI_CHECK(createDirectory(cacheDir));
+		}
+
+		m_dir.create(m_alloc, cacheDir);
+	}
+
+	return Error::NONE;
+}
+
+Error SpirvCache::computeKey(
+	CString source, ShaderType shaderType, GenericMemoryPoolAllocator<U8> tmpAlloc, U64& key)
+{
+	StringAuto preprocessed(tmpAlloc);
+	ANKI_CHECK(preprocessGlsl(source, preprocessed));
+	ANKI_ASSERT(!preprocessed.isEmpty());
+
+	key = computeHash(&shaderType, sizeof(shaderType));
+	key = appendHash(&GLSL_TO_SPIRV_VERSION, sizeof(GLSL_TO_SPIRV_VERSION), key);
+
+	// The preprocessor keeps the empty lines to preserve the line numbers. Skip them so adding or removing comments
+	// doesn't change the key
+	const char* line = preprocessed.cstr();
+	while(*line != '\0')
+	{
+		const char* lineEnd = line;
+		Bool empty = true;
+		while(*lineEnd != '\0' && *lineEnd != '\n')
+		{
+			empty = empty && (*lineEnd == ' ' || *lineEnd == '\t' || *lineEnd == '\r');
+			++lineEnd;
+		}
+
+		if(!empty)
+		{
+			key = appendHash(line, PtrSize(lineEnd - line) + 1, key);
+		}
+
+		line = (*lineEnd == '\n') ? lineEnd + 1 : lineEnd;
+	}
+
+	return Error::NONE;
+}
+
+void SpirvCache::getEntryFilename(U64 key, StringAuto& fname) const
+{
+	ANKI_ASSERT(!m_dir.isEmpty());
+	fname.sprintf("%s/%016" PRIx64 ".spv", m_dir.cstr(), key);
+}
+
+Bool SpirvCache::addEntry(U64 key, ConstWeakArray<U8> spirv)
+{
+	LockGuard<Mutex> lock(m_mtx);
+
+	if(m_entries.find(key) != m_entries.getEnd())
+	{
+		return false;
+	}
+
+	U8* mem = m_alloc.allocate(spirv.getSizeInBytes());
+	memcpy(mem, spirv.getBegin(), spirv.getSizeInBytes());
+	m_entries.emplace(m_alloc, key, WeakArray<U8>(mem, spirv.getSize()));
+
+	return true;
+}
+
+Error SpirvCache::find(U64 key, DynamicArrayAuto<U8>& spirv, Bool& found)
+{
+	found = false;
+	spirv.destroy();
+
+	// Check the memory first
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		auto it = m_entries.find(key);
+		if(it != m_entries.getEnd())
+		{
+			spirv.create(it->getSize());
+			memcpy(spirv.getBegin(), it->getBegin(), it->getSizeInBytes());
+			found = true;
+		}
+	}
+
+	// Then the disk
+	if(!found && !m_dir.isEmpty())
+	{
+		StringAuto fname(m_alloc);
+		getEntryFilename(key, fname);
+
+		if(fileExists(fname))
+		{
+			File file;
+			ANKI_CHECK(file.open(fname, FileOpenFlag::READ | FileOpenFlag::BINARY));
+			const PtrSize size = file.getSize();
+
+			SpirvCacheEntryHeader header;
+			if(size >= sizeof(header) + sizeof(SPIRV_MAGIC))
+			{
+				ANKI_CHECK(file.read(&header, sizeof(header)));
+			}
+			else
+			{
+				memset(&header, 0, sizeof(header));
+			}
+
+			if(memcmp(&header.m_magic[0], &ENTRY_MAGIC[0], sizeof(ENTRY_MAGIC)) == 0
+				&& header.m_spirvSize == size - sizeof(header) && (header.m_spirvSize % sizeof(U32)) == 0)
+			{
+				spirv.create(header.m_spirvSize);
+				ANKI_CHECK(file.read(spirv.getBegin(), header.m_spirvSize));
+
+				U32 magic;
+				memcpy(&magic, spirv.getBegin(), sizeof(magic));
+				found = magic == SPIRV_MAGIC && computeHash(spirv.getBegin(), spirv.getSize()) == header.m_spirvHash;
+			}
+
+			if(found)
+			{
+				addEntry(key, spirv);
+			}
+			else
+			{
+				spirv.destroy();
+				ANKI_SHADER_COMPILER_LOGW("Ignoring corrupted SPIR-V cache entry: %s", fname.cstr());
+			}
+		}
+	}
+
+	if(found)
+	{
+		m_hitCount.fetchAdd(1);
+	}
+	else
+	{
+		m_missCount.fetchAdd(1);
+	}
+
+	return Error::NONE;
+}
+
+Error SpirvCache::store(U64 key, ConstWeakArray<U8> spirv)
+{
+	ANKI_ASSERT(spirv.getSize() >= sizeof(SPIRV_MAGIC));
+
+	// Only the first one that adds the entry writes the file
+	if(addEntry(key, spirv) && !m_dir.isEmpty())
+	{
+		StringAuto fname(m_alloc);
+		getEntryFilename(key, fname);
+
+		// Write to a file only this thread knows and then move it in place. Other threads and processes will see the
+		// complete file or nothing
+		StringAuto tmpFname(m_alloc);
+		const Second time = HighRezTimer::getCurrentTime();
+		const U64 tmpId = computeHash(&time, sizeof(time), Thread::getCurrentThreadId());
+		tmpFname.sprintf("%s.%016" PRIx64 ".tmp", fname.cstr(), tmpId);
+
+		SpirvCacheEntryHeader header;
+		header.m_magic = ENTRY_MAGIC;
+		header.m_spirvSize = U32(spirv.getSizeInBytes());
+		header.m_padding = 0;
+		header.m_spirvHash = computeHash(spirv.getBegin(), spirv.getSizeInBytes());
+
+		{
+			File file;
+			ANKI_CHECK(file.open(tmpFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+			ANKI_CHECK(file.write(&header, sizeof(header)));
+			ANKI_CHECK(file.write(spirv.getBegin(), spirv.getSizeInBytes()));
+		}
+
+		ANKI_CHECK(renameFile(tmpFname, fname));
+	}
+
+	return Error::NONE;
+}
+
+} // end namespace anki
@@ -0,0 +1,78 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/shader_compiler/Common.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/WeakArray.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Thread.h>
+#include <anki/util/Atomic.h>
+#include <anki/gr/Enums.h>
+
+namespace anki
+{
+
+/// @addtogroup shader_compiler
+/// @{
+
+/// A content-addressed cache of SPIR-V. The key is the hash of the preprocessed source of a shader stage and the
+/// compiler options so identical stages are compiled once even if they belong to different programs. Every entry is
+/// a file in the cache directory. It's thread-safe.
+class SpirvCache : public NonCopyable
+{
+public:
+	SpirvCache() = default;
+
+	~SpirvCache();
+
+	/// Initialize.
+	/// @param cacheDir The directory to store the entries. If it's empty the cache will only live in memory.
+	ANKI_USE_RESULT Error init(GenericMemoryPoolAllocator<U8> alloc, CString cacheDir);
+
+	/// Compute the key of some GLSL source. It runs the preprocessor so the changes that don't affect the preprocessed
+	/// text (comments, unused macros etc) don't change the key.
+	static ANKI_USE_RESULT Error computeKey(
+		CString source, ShaderType shaderType, GenericMemoryPoolAllocator<U8> tmpAlloc, U64& key);
+
+	/// Find the SPIR-V of a key.
+	/// @param[out] spirv The SPIR-V if it's found.
+	/// @param[out] found True if it's in the cache.
+	ANKI_USE_RESULT Error find(U64 key, DynamicArrayAuto<U8>& spirv, Bool& found);
+
+	/// Add the SPIR-V of a key.
+	ANKI_USE_RESULT Error store(U64 key, ConstWeakArray<U8> spirv);
+
+	/// @name Statistics
+	/// @{
+	U32 getHitCount() const
+	{
+		return m_hitCount.load();
+	}
+
+	U32 getMissCount() const
+	{
+		return m_missCount.load();
+	}
+	/// @}
+
+private:
+	GenericMemoryPoolAllocator<U8> m_alloc;
+	String m_dir;
+	HashMap<U64, WeakArray<U8>> m_entries; ///< The entries that were used by this run.
+	Mutex m_mtx;
+	Atomic<U32> m_hitCount = {0};
+	Atomic<U32> m_missCount = {0};
+
+	void getEntryFilename(U64 key, StringAuto& fname) const;
+
+	/// Add an entry to m_entries.
+	/// @return False if it was already there.
+	Bool addEntry(U64 key, ConstWeakArray<U8> spirv);
+};
+/// @}
+
+} // end namespace anki
@@ -59,6 +59,7 @@ Error Canvas::init(FontPtr font, U32 fontHeight, U32 width, U32 height)
 	m_stackAlloc = StackAllocator<U8>(getAllocator().getMemoryPool().getAllocationCallback(),
 		getAllocator().getMemoryPool().getAllocationCallbackUserData(),
 		512_B);
+	m_stackAlloc.getMemoryPool().setMemoryTag(MemoryTag::UI);
 
 	// Create the context
 	setImAllocator();
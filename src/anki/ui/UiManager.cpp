@@ -31,6 +31,7 @@ Error UiManager::init(AllocAlignedCallback allocCallback,
 	ANKI_ASSERT(input);
 
 	m_alloc = UiAllocator(allocCallback, allocCallbackUserData);
+	m_alloc.getMemoryPool().setMemoryTag(MemoryTag::UI);
 	m_resources = resources;
 	m_gr = gr;
 	m_gpuMem = gpuMem;
@@ -0,0 +1,106 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/StdTypes.h>
+#include <anki/util/Assert.h>
+#include <anki/util/Atomic.h>
+#include <anki/util/Allocator.h>
+
+namespace anki
+{
+
+/// @addtogroup util_containers
+/// @{
+
+/// A hash map from non-zero U64 keys to pointers that is built for caches that are read a lot more than they are
+/// written. The lookups are lock-free and wait-free. The insertions are not thread-safe against each other so the user
+/// should serialize them (usually with the same lock that guards the creation of the value) but they are thread-safe
+/// against the lookups.
+///
+/// It's an open addressing table. A new element is published by writing its key last. When the table grows it's copied
+/// to a new one and the new one is published. The old tables may still be read so they are released in destroy().
+/// Because the capacity doubles the retired tables are never larger than the live one.
+template<typename T>
+class ConcurrentPointerMap : public NonCopyable
+{
+public:
+	using Value = T;
+
+	ConcurrentPointerMap() = default;
+
+	~ConcurrentPointerMap()
+	{
+		ANKI_ASSERT(m_table.getNonAtomically() == nullptr && "Forgot to call destroy()");
+	}
+
+	/// Release the memory of the map. It doesn't delete the values.
+	template<typename TAllocator>
+	void destroy(TAllocator alloc);
+
+	/// Find a value.
+	/// @note Thread-safe and lock-free.
+	Value* find(U64 key) const;
+
+	/// Add a new key. The key shouldn't be present.
+	/// @note It's thread-safe against find() but not against other insert() calls.
+	template<typename TAllocator>
+	void insert(TAllocator alloc, U64 key, Value* value);
+
+	/// Iterate all the values.
+	/// @note Not thread-safe against insert().
+	template<typename TFunc>
+	void iterate(TFunc func) const;
+
+	/// @note Not thread-safe against insert().
+	U32 getSize() const
+	{
+		return m_size;
+	}
+
+	Bool isEmpty() const
+	{
+		return m_size == 0;
+	}
+
+private:
+	class Slot
+	{
+	public:
+		Atomic<U64> m_key; ///< Zero means empty.
+		Atomic<Value*> m_value;
+	};
+
+	class Table
+	{
+	public:
+		Slot* m_slots = nullptr;
+		U32 m_capacity = 0; ///< Power of two.
+		U32 m_shift = 0; ///< 64 - log2(m_capacity).
+		Table* m_retired = nullptr; ///< The previous table.
+	};
+
+	static constexpr U32 INITIAL_CAPACITY = 16;
+
+	Atomic<Table*> m_table = {nullptr};
+	U32 m_size = 0;
+
+	/// Fibonacci hashing. It spreads keys that are not hashes (eg thread IDs).
+	static U32 slotIndex(const Table& table, U64 key)
+	{
+		return U32((key * 11400714819323198485ull) >> table.m_shift);
+	}
+
+	template<typename TAllocator>
+	Table* newTable(TAllocator alloc, U32 capacity) const;
+
+	static void insertNonAtomically(Table& table, U64 key, Value* value);
+};
+/// @}
+
+} // end namespace anki
+
+#include <anki/util/ConcurrentPointerMap.inl.h>
@@ -0,0 +1,159 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/ConcurrentPointerMap.h>
+#include <anki/util/Functions.h>
+
+namespace anki
+{
+
+template<typename T>
+template<typename TAllocator>
+void ConcurrentPointerMap<T>::destroy(TAllocator alloc)
+{
+	Table* table = m_table.getNonAtomically();
+	while(table)
+	{
+		Table* retired = table->m_retired;
+		alloc.deleteArray(table->m_slots, table->m_capacity);
+		alloc.deleteInstance(table);
+		table = retired;
+	}
+
+	m_table.setNonAtomically(nullptr);
+	m_size = 0;
+}
+
+template<typename T>
+typename ConcurrentPointerMap<T>::Value* ConcurrentPointerMap<T>::find(U64 key) const
+{
+	ANKI_ASSERT(key != 0);
+
+	const Table* table = m_table.load(AtomicMemoryOrder::ACQUIRE);
+	if(ANKI_UNLIKELY(table == nullptr))
+	{
+		return nullptr;
+	}
+
+	// The load factor is less than 1 so there is always an empty slot to stop the search
+	const U32 mask = table->m_capacity - 1;
+	for(U32 idx = slotIndex(*table, key);; idx = (idx + 1) & mask)
+	{
+		const Slot& slot = table->m_slots[idx];
+		const U64 slotKey = slot.m_key.load(AtomicMemoryOrder::ACQUIRE);
+		if(slotKey == key)
+		{
+			return slot.m_value.load(AtomicMemoryOrder::RELAXED);
+		}
+		else if(slotKey == 0)
+		{
+			return nullptr;
+		}
+	}
+}
+
+template<typename T>
+template<typename TAllocator>
+void ConcurrentPointerMap<T>::insert(TAllocator alloc, U64 key, Value* value)
+{
+	ANKI_ASSERT(key != 0);
+	ANKI_ASSERT(find(key) == nullptr && "Already inserted");
+
+	Table* table = m_table.getNonAtomically();
+
+	// Keep the load factor under 1/2
+	if(table == nullptr || (m_size + 1) * 2 > table->m_capacity)
+	{
+		Table* newt = newTable(alloc, (table) ? table->m_capacity * 2 : INITIAL_CAPACITY);
+
+		// The new table is not visible to the readers yet
+		if(table)
+		{
+			for(U32 i = 0; i < table->m_capacity; ++i)
+			{
+				const Slot& slot = table->m_slots[i];
+				if(slot.m_key.getNonAtomically())
+				{
+					insertNonAtomically(*newt, slot.m_key.getNonAtomically(), slot.m_value.getNonAtomically());
+				}
+			}
+		}
+
+		// Publish it. The readers that still hold the old one will finish their searches there
+		newt->m_retired = table;
+		m_table.store(newt, AtomicMemoryOrder::RELEASE);
+		table = newt;
+	}
+
+	// Write the value before the key. The readers check the key first
+	const U32 mask = table->m_capacity - 1;
+	U32 idx = slotIndex(*table, key);
+	while(table->m_slots[idx].m_key.getNonAtomically() != 0)
+	{
+		idx = (idx + 1) & mask;
+	}
+
+	table->m_slots[idx].m_value.store(value, AtomicMemoryOrder::RELAXED);
+	table->m_slots[idx].m_key.store(key, AtomicMemoryOrder::RELEASE);
+	++m_size;
+}
+
+template<typename T>
+template<typename TFunc>
+void ConcurrentPointerMap<T>::iterate(TFunc func) const
+{
+	const Table* table = m_table.getNonAtomically();
+	if(table)
+	{
+		for(U32 i = 0; i < table->m_capacity; ++i)
+		{
+			const Slot& slot = table->m_slots[i];
+			if(slot.m_key.getNonAtomically())
+			{
+				func(slot.m_key.getNonAtomically(), slot.m_value.getNonAtomically());
+			}
+		}
+	}
+}
+
+template<typename T>
+template<typename TAllocator>
+typename ConcurrentPointerMap<T>::Table* ConcurrentPointerMap<T>::newTable(TAllocator alloc, U32 capacity) const
+{
+	ANKI_ASSERT(isPowerOfTwo(capacity));
+
+	Table* table = alloc.template newInstance<Table>();
+	table->m_slots = alloc.template newArray<Slot>(capacity);
+	table->m_capacity = capacity;
+	table->m_shift = 64;
+	while((1u << (64 - table->m_shift)) < capacity)
+	{
+		--table->m_shift;
+	}
+
+	for(U32 i = 0; i < capacity; ++i)
+	{
+		table->m_slots[i].m_key.setNonAtomically(0);
+		table->m_slots[i].m_value.setNonAtomically(nullptr);
+	}
+
+	return table;
+}
+
+template<typename T>
+void ConcurrentPointerMap<T>::insertNonAtomically(Table& table, U64 key, Value* value)
+{
+	const U32 mask = table.m_capacity - 1;
+	U32 idx = slotIndex(table, key);
+	while(table.m_slots[idx].m_key.getNonAtomically() != 0)
+	{
+		idx = (idx + 1) & mask;
+	}
+
+	table.m_slots[idx].m_key.setNonAtomically(key);
+	table.m_slots[idx].m_value.setNonAtomically(value);
+}
+
+} // end namespace anki
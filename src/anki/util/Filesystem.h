@@ -43,6 +43,10 @@ ANKI_USE_RESULT Error removeDirectory(const CString& dir, GenericMemoryPoolAlloc
 /// Equivalent to: mkdir dir
 ANKI_USE_RESULT Error createDirectory(const CString& dir);
 
+/// Equivalent to: mv oldFilename newFilename
+/// If newFilename exists it's replaced atomically so the readers see either the old or the new file, never a part.
+ANKI_USE_RESULT Error renameFile(const CString& oldFilename, const CString& newFilename);
+
 /// Get the home directory.
 /// Write the home directory to @a buff. The @a buffSize is the size of the @a buff. If the @buffSize is not enough the
 /// function will throw an exception.
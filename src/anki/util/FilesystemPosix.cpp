@@ -12,6 +12,7 @@
 #include <anki/util/Assert.h>
 #include <anki/util/Thread.h>
 #include <cstring>
+#include <cstdio>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
@@ -196,6 +197,17 @@ Error createDirectory(const CString& dir)
 	return err;
 }
 
+Error renameFile(const CString& oldFilename, const CString& newFilename)
+{
+	if(rename(oldFilename.cstr(), newFilename.cstr()))
+	{
+		ANKI_UTIL_LOGE("%s : %s -> %s", strerror(errno), oldFilename.cstr(), newFilename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	return Error::NONE;
+}
+
 Error getHomeDirectory(StringAuto& out)
 {
 	const char* home = getenv("HOME");
@@ -66,6 +66,17 @@ Error createDirectory(const CString& dir)
 	return err;
 }
 
+Error renameFile(const CString& oldFilename, const CString& newFilename)
+{
+	if(MoveFileExA(oldFilename.cstr(), newFilename.cstr(), MOVEFILE_REPLACE_EXISTING) == 0)
+	{
+		ANKI_UTIL_LOGE("Failed to rename %s to %s", oldFilename.cstr(), newFilename.cstr());
+		return Error::FUNCTION_FAILED;
+	}
+
+	return Error::NONE;
+}
+
 Error getHomeDirectory(StringAuto& out)
 {
 	char path[MAX_PATH];
@@ -7,6 +7,7 @@
 
 #include <anki/util/Allocator.h>
 #include <anki/util/Functions.h>
+#include <anki/util/Hash.h>
 #include <anki/util/NonCopyable.h>
 #include <anki/util/SparseArray.h>
 
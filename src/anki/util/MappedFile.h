@@ -0,0 +1,59 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <anki/util/String.h>
+
+namespace anki
+{
+
+/// @addtogroup util_file
+/// @{
+
+/// A regular file that is mapped to memory. The mapping is private (copy-on-write) so the memory can be written
+/// without affecting the file. Only the pages that are written are copied, the rest are shared with the OS file cache
+/// and they are read from the disk the first time they are accessed.
+class MappedFile : public NonCopyable
+{
+public:
+	MappedFile() = default;
+
+	/// Unmaps the file if it's mapped.
+	~MappedFile()
+	{
+		close();
+	}
+
+	/// Map a file. It doesn't work for files that live in archives or for the Android assets.
+	ANKI_USE_RESULT Error open(CString filename);
+
+	/// Unmap the file.
+	void close();
+
+	Bool isOpen() const
+	{
+		return m_data != nullptr;
+	}
+
+	U8* getData() const
+	{
+		ANKI_ASSERT(isOpen());
+		return static_cast<U8*>(m_data);
+	}
+
+	PtrSize getSize() const
+	{
+		ANKI_ASSERT(isOpen());
+		return m_size;
+	}
+
+private:
+	void* m_data = nullptr;
+	PtrSize m_size = 0;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,70 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/MappedFile.h>
+#include <anki/util/Logger.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace anki
+{
+
+Error MappedFile::open(CString filename)
+{
+	close();
+
+	const int fd = ::open(filename.cstr(), O_RDONLY);
+	if(fd < 0)
+	{
+		ANKI_UTIL_LOGE("Failed to open file %s: %s", filename.cstr(), strerror(errno));
+		return Error::FILE_ACCESS;
+	}
+
+	Error err = Error::NONE;
+	struct stat st;
+	if(fstat(fd, &st) != 0)
+	{
+		ANKI_UTIL_LOGE("fstat() failed for file %s: %s", filename.cstr(), strerror(errno));
+		err = Error::FILE_ACCESS;
+	}
+	else if(st.st_size == 0)
+	{
+		ANKI_UTIL_LOGE("Can't map an empty file: %s", filename.cstr());
+		err = Error::FILE_ACCESS;
+	}
+	else
+	{
+		void* data = mmap(nullptr, PtrSize(st.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+		if(data == MAP_FAILED)
+		{
+			ANKI_UTIL_LOGE("mmap() failed for file %s: %s", filename.cstr(), strerror(errno));
+			err = Error::FILE_ACCESS;
+		}
+		else
+		{
+			m_data = data;
+			m_size = PtrSize(st.st_size);
+		}
+	}
+
+	// The mapping keeps a reference to the file
+	::close(fd);
+	return err;
+}
+
+void MappedFile::close()
+{
+	if(m_data)
+	{
+		munmap(m_data, m_size);
+		m_data = nullptr;
+		m_size = 0;
+	}
+}
+
+} // end namespace anki
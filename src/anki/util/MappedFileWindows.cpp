@@ -0,0 +1,77 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/util/MappedFile.h>
+#include <anki/util/Logger.h>
+#include <anki/util/Win32Minimal.h>
+
+namespace anki
+{
+
+Error MappedFile::open(CString filename)
+{
+	close();
+
+	HANDLE file = CreateFileA(
+		filename.cstr(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		ANKI_UTIL_LOGE("CreateFileA() failed for file %s: %u", filename.cstr(), GetLastError());
+		return Error::FILE_ACCESS;
+	}
+
+	Error err = Error::NONE;
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size))
+	{
+		ANKI_UTIL_LOGE("GetFileSizeEx() failed for file %s: %u", filename.cstr(), GetLastError());
+		err = Error::FILE_ACCESS;
+	}
+	else if(size.QuadPart == 0)
+	{
+		ANKI_UTIL_LOGE("Can't map an empty file: %s", filename.cstr());
+		err = Error::FILE_ACCESS;
+	}
+	else
+	{
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if(mapping == nullptr)
+		{
+			ANKI_UTIL_LOGE("CreateFileMappingA() failed for file %s: %u", filename.cstr(), GetLastError());
+			err = Error::FILE_ACCESS;
+		}
+		else
+		{
+			m_data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+			if(m_data == nullptr)
+			{
+				ANKI_UTIL_LOGE("MapViewOfFile() failed for file %s: %u", filename.cstr(), GetLastError());
+				err = Error::FILE_ACCESS;
+			}
+			else
+			{
+				m_size = PtrSize(size.QuadPart);
+			}
+
+			// The view keeps a reference to the mapping
+			CloseHandle(mapping);
+		}
+	}
+
+	CloseHandle(file);
+	return err;
+}
+
+void MappedFile::close()
+{
+	if(m_data)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = nullptr;
+		m_size = 0;
+	}
+}
+
+} // end namespace anki
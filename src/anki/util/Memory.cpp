@@ -137,9 +137,99 @@ void* allocAligned(void* userData, void* ptr, PtrSize size, PtrSize alignment)
 	return out;
 }
 
+MemoryTagStats MemoryTrackerSnapshot::getTotal() const
+{
+	MemoryTagStats total;
+	for(const MemoryTagStats& tag : m_tags)
+	{
+		total.m_memoryUsage += tag.m_memoryUsage;
+		total.m_peakMemoryUsage += tag.m_peakMemoryUsage;
+		total.m_allocationCount += tag.m_allocationCount;
+		total.m_freeCount += tag.m_freeCount;
+	}
+
+	return total;
+}
+
+static MemoryTagStatsDiff diffMemoryTagStats(const MemoryTagStats& newer, const MemoryTagStats& older)
+{
+	MemoryTagStatsDiff diff;
+	diff.m_memoryUsage = I64(newer.m_memoryUsage) - I64(older.m_memoryUsage);
+	diff.m_allocationCount = newer.m_allocationCount - older.m_allocationCount;
+	diff.m_freeCount = newer.m_freeCount - older.m_freeCount;
+	return diff;
+}
+
+MemoryTagStatsDiff MemoryTrackerSnapshot::diff(const MemoryTrackerSnapshot& older, MemoryTag tag) const
+{
+	return diffMemoryTagStats(m_tags[tag], older.m_tags[tag]);
+}
+
+MemoryTagStatsDiff MemoryTrackerSnapshot::diffTotal(const MemoryTrackerSnapshot& older) const
+{
+	return diffMemoryTagStats(getTotal(), older.getTotal());
+}
+
+void MemoryTracker::getSnapshot(MemoryTrackerSnapshot& snapshot) const
+{
+	for(MemoryTag tag = MemoryTag::FIRST; tag < MemoryTag::COUNT; ++tag)
+	{
+		const Tag& in = m_tags[tag];
+		MemoryTagStats& out = snapshot.m_tags[tag];
+
+		out.m_memoryUsage = in.m_memoryUsage.load();
+		out.m_peakMemoryUsage = in.m_peakMemoryUsage.load();
+		out.m_allocationCount = in.m_allocationCount.load();
+		out.m_freeCount = in.m_freeCount.load();
+	}
+}
+
+void MemoryTracker::resetPeaks()
+{
+	for(Tag& tag : m_tags)
+	{
+		tag.m_peakMemoryUsage.store(tag.m_memoryUsage.load());
+	}
+}
+
+void MemoryTracker::addPoolStats(MemoryTag tag, I64 memoryUsageDiff, U32 allocationCount, U32 freeCount)
+{
+	Tag& t = m_tags[tag];
+
+	if(memoryUsageDiff)
+	{
+		// Unsigned overflow does the right thing for negative diffs
+		const PtrSize prev = t.m_memoryUsage.fetchAdd(PtrSize(memoryUsageDiff));
+		t.m_peakMemoryUsage.max(prev + PtrSize(memoryUsageDiff));
+	}
+
+	if(allocationCount)
+	{
+		t.m_allocationCount.fetchAdd(allocationCount);
+	}
+
+	if(freeCount)
+	{
+		t.m_freeCount.fetchAdd(freeCount);
+	}
+}
+
+const char* MemoryTracker::getTagName(MemoryTag tag)
+{
+	static const Array<const char*, U32(MemoryTag::COUNT)> NAMES = {
+		{"Untagged", "Core", "Gr", "Resource", "Scene", "Renderer", "Physics", "Script", "Ui"}};
+	return NAMES[tag];
+}
+
+BaseMemoryPool::BaseMemoryPool(Type type)
+	: m_type(type)
+{
+}
+
 BaseMemoryPool::~BaseMemoryPool()
 {
 	ANKI_ASSERT(m_refcount.load() == 0 && "Refcount should be zero");
+	flushMemoryStats();
 }
 
 Bool BaseMemoryPool::isCreated() const
@@ -147,6 +237,50 @@ Bool BaseMemoryPool::isCreated() const
 	return m_allocCb != nullptr;
 }
 
+void BaseMemoryPool::setMemoryTag(MemoryTag tag)
+{
+	ANKI_ASSERT(tag < MemoryTag::COUNT);
+	if(tag != m_tag && MemoryTrackerSingleton::isInitialized())
+	{
+		// The stats gathered so far belong to the old tag. Then move the memory the pool holds to the new tag
+		flushMemoryStats();
+
+		MemoryTracker& tracker = MemoryTrackerSingleton::get();
+		const I64 usage = I64(m_memoryUsage.load());
+		tracker.addPoolStats(m_tag, -usage, 0, 0);
+		tracker.addPoolStats(tag, usage, 0, 0);
+	}
+
+	m_tag = tag;
+}
+
+void BaseMemoryPool::flushMemoryStats()
+{
+	// Without a tracker the stats stay in the pool for later
+	if(!MemoryTrackerSingleton::isInitialized())
+	{
+		return;
+	}
+
+	const I64 memoryUsageDiff = m_pendingMemoryUsage.exchange(0);
+	const U32 allocationCount = m_pendingAllocationCount.exchange(0);
+	const U32 freeCount = m_pendingFreeCount.exchange(0);
+	if(memoryUsageDiff || allocationCount || freeCount)
+	{
+		MemoryTrackerSingleton::get().addPoolStats(m_tag, memoryUsageDiff, allocationCount, freeCount);
+	}
+}
+
+#if ANKI_MEM_USE_HEAP_HEADERS
+class HeapMemoryPool::AllocationHeader
+{
+public:
+	PtrSize m_size; ///< The size of the whole allocation.
+	U32 m_offset; ///< The offset from the start of the allocation to the user memory.
+	AllocationSignature m_signature;
+};
+#endif
+
 HeapMemoryPool::HeapMemoryPool()
 	: BaseMemoryPool(Type::HEAP)
 {
@@ -173,16 +307,19 @@ void HeapMemoryPool::create(AllocAlignedCallback allocCb, void* allocCbUserData)
 	m_allocCbUserData = allocCbUserData;
 #if ANKI_MEM_SIGNATURES
 	m_signature = computeSignature(this);
-	m_headerSize = getAlignedRoundUp(MAX_ALIGNMENT, sizeof(Signature));
 #endif
 }
 
 void* HeapMemoryPool::allocate(PtrSize size, PtrSize alignment)
 {
 	ANKI_ASSERT(isCreated());
-#if ANKI_MEM_SIGNATURES
-	ANKI_ASSERT(alignment <= MAX_ALIGNMENT && "Wrong assumption");
-	size += m_headerSize;
+	ANKI_ASSERT(alignment > 0);
+
+#if ANKI_MEM_USE_HEAP_HEADERS
+	// The header is needed to know the size of the allocation on free
+	alignment = max<PtrSize>(alignment, alignof(AllocationHeader));
+	const PtrSize headerSize = getAlignedRoundUp(alignment, sizeof(AllocationHeader));
+	size += headerSize;
 #endif
 
 	void* mem = m_allocCb(m_allocCbUserData, nullptr, size, alignment);
@@ -190,12 +327,20 @@ void* HeapMemoryPool::allocate(PtrSize size, PtrSize alignment)
 	if(mem != nullptr)
 	{
 		m_allocationsCount.fetchAdd(1);
+		trackAllocations(1);
 
-#if ANKI_MEM_SIGNATURES
-		memset(mem, 0, m_headerSize);
-		memcpy(mem, &m_signature, sizeof(m_signature));
-		U8* memU8 = static_cast<U8*>(mem);
-		memU8 += m_headerSize;
+#if ANKI_MEM_USE_HEAP_HEADERS
+		trackMemoryAllocation(size);
+
+		U8* memU8 = static_cast<U8*>(mem) + headerSize;
+		AllocationHeader& header = *reinterpret_cast<AllocationHeader*>(memU8 - sizeof(AllocationHeader));
+		header.m_size = size;
+		header.m_offset = U32(headerSize);
+#	if ANKI_MEM_SIGNATURES
+		header.m_signature = m_signature;
+#	else
+		header.m_signature = 0;
+#	endif
 		mem = static_cast<void*>(memU8);
 #endif
 	}
@@ -216,16 +361,21 @@ void HeapMemoryPool::free(void* ptr)
 		return;
 	}
 
-#if ANKI_MEM_SIGNATURES
+#if ANKI_MEM_USE_HEAP_HEADERS
 	U8* memU8 = static_cast<U8*>(ptr);
-	memU8 -= m_headerSize;
-	if(memcmp(memU8, &m_signature, sizeof(m_signature)) != 0)
+	const AllocationHeader& header = *reinterpret_cast<const AllocationHeader*>(memU8 - sizeof(AllocationHeader));
+#	if ANKI_MEM_SIGNATURES
+	if(header.m_signature != m_signature)
 	{
 		ANKI_UTIL_LOGE("Signature missmatch on free");
 	}
+#	endif
 
-	ptr = static_cast<void*>(memU8);
+	trackMemoryFree(header.m_size);
+	ptr = memU8 - header.m_offset;
 #endif
+
+	trackFrees(1);
 	m_allocationsCount.fetchSub(1);
 	m_allocCb(m_allocCbUserData, ptr, 0, 0);
 }
@@ -246,6 +396,7 @@ StackMemoryPool::~StackMemoryPool()
 
 			invalidateMemory(ch.m_baseMem, ch.m_size);
 			m_allocCb(m_allocCbUserData, ch.m_baseMem, 0, 0);
+			trackMemoryFree(ch.m_size);
 		}
 		else
 		{
@@ -293,6 +444,7 @@ void StackMemoryPool::create(AllocAlignedCallback allocCb,
 		m_chunks[0].m_baseMem = static_cast<U8*>(mem);
 		m_chunks[0].m_mem.store(m_chunks[0].m_baseMem);
 		m_chunks[0].m_size = initialChunkSize;
+		trackMemoryAllocation(initialChunkSize);
 
 		ANKI_ASSERT(m_crntChunkIdx.load() == 0);
 	}
@@ -330,6 +482,7 @@ void* StackMemoryPool::allocate(PtrSize size, PtrSize alignment)
 
 			retry = false;
 			m_allocationsCount.fetchAdd(1);
+			trackAllocations(1);
 		}
 		else
 		{
@@ -365,6 +518,7 @@ void* StackMemoryPool::allocate(PtrSize size, PtrSize alignment)
 						crntChunk->m_baseMem = static_cast<U8*>(mem);
 						crntChunk->m_mem.store(crntChunk->m_baseMem);
 						crntChunk->m_size = newChunkSize;
+						trackMemoryAllocation(newChunkSize);
 
 						U idx = m_crntChunkIdx.fetchAdd(1);
 						ANKI_ASSERT(&m_chunks[idx] == crntChunk - 1);
@@ -411,6 +565,7 @@ void StackMemoryPool::free(void* ptr)
 	auto count = m_allocationsCount.fetchSub(1);
 	ANKI_ASSERT(count > 0);
 	(void)count;
+	trackFrees(1);
 }
 
 void StackMemoryPool::reset()
@@ -443,6 +598,9 @@ void StackMemoryPool::reset()
 	{
 		ANKI_UTIL_LOGW("Forgot to deallocate");
 	}
+
+	// The reset frees whatever is left
+	trackFrees(allocCount);
 }
 
 PtrSize StackMemoryPool::getMemoryCapacity() const
@@ -556,6 +714,7 @@ void* ChainMemoryPool::allocate(PtrSize size, PtrSize alignment)
 	}
 
 	m_allocationsCount.fetchAdd(1);
+	trackAllocations(1);
 
 	return mem;
 }
@@ -588,6 +747,7 @@ void ChainMemoryPool::free(void* ptr)
 	}
 
 	m_allocationsCount.fetchSub(1);
+	trackFrees(1);
 }
 
 PtrSize ChainMemoryPool::getChunksCount() const
@@ -670,6 +830,7 @@ ChainMemoryPool::Chunk* ChainMemoryPool::createNewChunk(PtrSize size)
 
 		chunk->m_memsize = memAllocSize;
 		chunk->m_top = chunk->m_memory;
+		trackMemoryAllocation(allocationSize);
 
 		// Register it
 		if(m_tailChunk)
@@ -746,8 +907,10 @@ void ChainMemoryPool::destroyChunk(Chunk* ch)
 		ch->m_next->m_prev = ch->m_prev;
 	}
 
-	invalidateMemory(ch, getAlignedRoundUp(m_alignmentBytes, sizeof(Chunk)) + ch->m_memsize);
+	const PtrSize allocationSize = getAlignedRoundUp(m_alignmentBytes, sizeof(Chunk)) + ch->m_memsize;
+	invalidateMemory(ch, allocationSize);
 	m_allocCb(m_allocCbUserData, ch, 0, 0);
+	trackMemoryFree(allocationSize);
 }
 
 } // end namespace anki
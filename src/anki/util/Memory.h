@@ -11,6 +11,8 @@
 #include <anki/util/Assert.h>
 #include <anki/util/Array.h>
 #include <anki/util/Thread.h>
+#include <anki/util/Enum.h>
+#include <anki/util/Singleton.h>
 #include <utility> // For forward
 
 namespace anki
@@ -18,12 +20,17 @@ namespace anki
 
 // Forward
 class SpinLock;
+class BaseMemoryPool;
 
 /// @addtogroup util_memory
 /// @{
 
 #define ANKI_MEM_USE_SIGNATURES ANKI_EXTRA_CHECKS
 
+/// HeapMemoryPool stores a header before every allocation to know its size on free. The header costs 16 bytes or the
+/// alignment of the allocation if that's bigger.
+#define ANKI_MEM_USE_HEAP_HEADERS (ANKI_ENABLE_MEMORY_TRACKING || ANKI_MEM_USE_SIGNATURES)
+
 /// Allocate aligned memory
 void* mallocAligned(PtrSize size, PtrSize alignmentBytes);
 
@@ -49,6 +56,113 @@ using AllocationSignature = U32;
 ///         returns nullptr
 void* allocAligned(void* userData, void* ptr, PtrSize size, PtrSize alignment);
 
+/// The subsystem a memory pool belongs to. Used for memory tracking.
+enum class MemoryTag : U8
+{
+	UNTAGGED,
+	CORE,
+	GR,
+	RESOURCE,
+	SCENE,
+	RENDERER,
+	PHYSICS,
+	SCRIPT,
+	UI,
+
+	COUNT,
+	FIRST = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(MemoryTag, inline)
+
+/// Memory statistics of a single MemoryTag.
+class MemoryTagStats
+{
+public:
+	PtrSize m_memoryUsage = 0; ///< Memory currently taken from the allocation callbacks.
+	PtrSize m_peakMemoryUsage = 0;
+	U64 m_allocationCount = 0; ///< Number of allocations since the start.
+	U64 m_freeCount = 0; ///< Number of frees since the start.
+};
+
+/// The difference of the MemoryTagStats between two snapshots.
+class MemoryTagStatsDiff
+{
+public:
+	I64 m_memoryUsage = 0;
+	U64 m_allocationCount = 0;
+	U64 m_freeCount = 0;
+
+	/// Allocations that happened between the two snapshots and haven't been freed.
+	I64 getLiveAllocationCount() const
+	{
+		return I64(m_allocationCount) - I64(m_freeCount);
+	}
+};
+
+/// The memory statistics of all the tags at some point in time.
+class MemoryTrackerSnapshot
+{
+public:
+	Array<MemoryTagStats, U32(MemoryTag::COUNT)> m_tags;
+
+	/// Get the sum of all tags. The peak is the sum of the peaks of the tags.
+	MemoryTagStats getTotal() const;
+
+	/// Compute the difference of a tag since an older snapshot.
+	MemoryTagStatsDiff diff(const MemoryTrackerSnapshot& older, MemoryTag tag) const;
+
+	/// Compute the difference of all tags since an older snapshot.
+	MemoryTagStatsDiff diffTotal(const MemoryTrackerSnapshot& older) const;
+};
+
+/// Gathers the memory statistics of all memory pools per MemoryTag. It's thread safe. The pools gather their stats
+/// locally and pass them to the tracker every few allocations so the snapshots may lag a bit behind. Create it at
+/// startup with MemoryTrackerSingleton::init(). The pools keep their stats until it's created.
+class MemoryTracker
+{
+public:
+	/// The tags are over-aligned so the singleton needs an aligned allocation.
+	static void* operator new(size_t size)
+	{
+		return mallocAligned(size, alignof(MemoryTracker));
+	}
+
+	static void operator delete(void* ptr)
+	{
+		freeAligned(ptr);
+	}
+
+	/// Get the current stats of all tags. The peaks are updated when the pools pass their stats so they are a bit
+	/// lower than the real ones.
+	void getSnapshot(MemoryTrackerSnapshot& snapshot) const;
+
+	/// Set the peak of every tag to the current memory usage.
+	void resetPeaks();
+
+	static const char* getTagName(MemoryTag tag);
+
+private:
+	friend class BaseMemoryPool;
+
+	/// Aligned to a cache line because the tags are updated from many threads.
+	class alignas(ANKI_CACHE_LINE_SIZE) Tag
+	{
+	public:
+		Atomic<PtrSize> m_memoryUsage = {0};
+		Atomic<PtrSize> m_peakMemoryUsage = {0};
+		Atomic<U64> m_allocationCount = {0};
+		Atomic<U64> m_freeCount = {0};
+	};
+
+	Array<Tag, U32(MemoryTag::COUNT)> m_tags;
+
+	/// Add the stats a pool gathered since the last time.
+	void addPoolStats(MemoryTag tag, I64 memoryUsageDiff, U32 allocationCount, U32 freeCount);
+};
+
+/// The global MemoryTracker.
+using MemoryTrackerSingleton = SingletonInit<MemoryTracker>;
+
 /// Generic memory pool. The base of HeapMemoryPool or StackMemoryPool or ChainMemoryPool.
 class BaseMemoryPool : public NonCopyable
 {
@@ -95,6 +209,31 @@ public:
 		return m_allocationsCount.load();
 	}
 
+	/// Set the subsystem the pool belongs to. The memory the pool already holds is moved to the new tag. It's not
+	/// thread safe, set it right after the creation of the pool.
+	void setMemoryTag(MemoryTag tag);
+
+	MemoryTag getMemoryTag() const
+	{
+		return m_tag;
+	}
+
+	/// Get the memory the pool currently holds. This includes the bookkeeping of the pool.
+	PtrSize getMemoryUsage() const
+	{
+		return m_memoryUsage.load();
+	}
+
+	/// Get the maximum memory the pool held since its creation.
+	PtrSize getPeakMemoryUsage() const
+	{
+		return m_peakMemoryUsage.load();
+	}
+
+	/// Pass the stats gathered since the last call to the MemoryTracker. The pool does that every few allocations
+	/// and on destruction. Call it before a MemoryTracker snapshot that needs to be exact.
+	void flushMemoryStats();
+
 protected:
 	/// Pool type.
 	enum class Type : U8
@@ -114,24 +253,80 @@ protected:
 	/// Allocations count.
 	Atomic<U32> m_allocationsCount = {0};
 
-	BaseMemoryPool(Type type)
-		: m_type(type)
-	{
-	}
+	BaseMemoryPool(Type type);
 
 	/// Check if already created.
 	Bool isCreated() const;
 
+	/// Update the stats after taking memory from the allocation callback.
+	void trackMemoryAllocation(PtrSize size)
+	{
+		const PtrSize prev = m_memoryUsage.fetchAdd(size);
+		m_peakMemoryUsage.max(prev + size);
+		trackPendingMemory(I64(size));
+	}
+
+	/// Update the stats after giving memory back to the allocation callback.
+	void trackMemoryFree(PtrSize size)
+	{
+		m_memoryUsage.fetchSub(size);
+		trackPendingMemory(-I64(size));
+	}
+
+	/// Count allocations.
+	void trackAllocations(U32 count)
+	{
+		if(m_pendingAllocationCount.fetchAdd(count) + count >= MAX_PENDING_OPERATION_COUNT)
+		{
+			flushMemoryStats();
+		}
+	}
+
+	/// Count frees.
+	void trackFrees(U32 count)
+	{
+		if(m_pendingFreeCount.fetchAdd(count) + count >= MAX_PENDING_OPERATION_COUNT)
+		{
+			flushMemoryStats();
+		}
+	}
+
 private:
+	/// @name Pass the stats to the MemoryTracker when the pending ones reach these limits.
+	/// @{
+	static constexpr U32 MAX_PENDING_OPERATION_COUNT = 64;
+	static constexpr I64 MAX_PENDING_MEMORY = 64 * 1024;
+	/// @}
+
 	/// Refcount.
 	Atomic<U32> m_refcount = {0};
 
+	/// Memory taken from the allocation callback.
+	Atomic<PtrSize> m_memoryUsage = {0};
+	Atomic<PtrSize> m_peakMemoryUsage = {0};
+
 	/// Type.
 	Type m_type = Type::NONE;
+
+	MemoryTag m_tag = MemoryTag::UNTAGGED;
+
+	/// The stats that haven't been passed to the MemoryTracker yet.
+	Atomic<I64> m_pendingMemoryUsage = {0};
+	Atomic<U32> m_pendingAllocationCount = {0};
+	Atomic<U32> m_pendingFreeCount = {0};
+
+	void trackPendingMemory(I64 size)
+	{
+		const I64 pending = m_pendingMemoryUsage.fetchAdd(size) + size;
+		if(pending >= MAX_PENDING_MEMORY || pending <= -MAX_PENDING_MEMORY)
+		{
+			flushMemoryStats();
+		}
+	}
 };
 
 /// A dummy interface to match the StackMemoryPool and ChainMemoryPool interfaces in order to be used by the same
-/// allocator template.
+/// allocator template. Its memory usage is tracked only if ANKI_MEM_USE_HEAP_HEADERS is enabled.
 class HeapMemoryPool final : public BaseMemoryPool
 {
 public:
@@ -154,10 +349,11 @@ public:
 	void free(void* ptr);
 
 private:
+	/// It's placed right before the memory returned by allocate().
+	class AllocationHeader;
+
 #if ANKI_MEM_USE_SIGNATURES
 	AllocationSignature m_signature = 0;
-	static const U32 MAX_ALIGNMENT = 64;
-	U32 m_headerSize = 0;
 #endif
 };
 
@@ -21,24 +21,96 @@ Error BinarySerializer::doDynamicArrayBasicType(const void* arr, PtrSize size, U
 	{
 		ANKI_ASSERT(arr);
 
-		// Move file pos to the end of the file (allocate space)
-		PtrSize arrayFilePos = getAlignedRoundUp(alignment, m_eofPos);
-		m_eofPos = arrayFilePos + size;
-
-		// Store the pointer for later
+		// Store the pointer for later. Its value will be known when the array is written
 		const PtrSize structFilePos = m_structureFilePos.getBack();
 		PointerInfo pinfo;
 		pinfo.m_filePos = structFilePos + memberOffset;
-		pinfo.m_value = arrayFilePos - m_beginOfDataFilePos;
+		pinfo.m_value = MAX_PTR_SIZE;
 		m_pointerFilePositions.emplaceBack(m_alloc, pinfo);
 
+		// Write the array after all the structures
+		DeferredArray darr;
+		darr.m_array = arr;
+		darr.m_size = size;
+		darr.m_alignment = alignment;
+		darr.m_pointerIdx = U32(m_pointerFilePositions.getSize() - 1);
+		m_deferredArrays.emplaceBack(m_alloc, darr);
+	}
+
+	check();
+	return Error::NONE;
+}
+
+Error BinarySerializer::writeDeferredArrays()
+{
+	if(m_deferredArrays.getSize() == 0)
+	{
+		return Error::NONE;
+	}
+
+	m_eofPos = getAlignedRoundUp(detail::BINARY_SERIALIZER_DEFERRED_ARRAYS_ALIGNMENT, m_eofPos);
+
+	for(const DeferredArray& darr : m_deferredArrays)
+	{
+		// Move file pos to the end of the file (allocate space)
+		const PtrSize arrayFilePos = getAlignedRoundUp(darr.m_alignment, m_eofPos);
+		m_eofPos = arrayFilePos + darr.m_size;
+
+		m_pointerFilePositions[darr.m_pointerIdx].m_value = arrayFilePos - m_beginOfDataFilePos;
+
 		// Write the array
 		ANKI_CHECK(m_file->seek(arrayFilePos, FileSeekOrigin::BEGINNING));
-		ANKI_CHECK(m_file->write(arr, size));
+		ANKI_CHECK(m_file->write(darr.m_array, darr.m_size));
 	}
 
 	check();
 	return Error::NONE;
 }
 
+Error BinaryDeserializer::checkHeader(
+	const detail::BinarySerializerHeader& header, PtrSize rootStructSize, PtrSize sizeAfterHeader)
+{
+	if(memcmp(&header.m_magic[0], detail::BINARY_SERIALIZER_MAGIC, 8) != 0)
+	{
+		ANKI_UTIL_LOGE("Wrong magic work in header");
+		return Error::USER_DATA;
+	}
+
+	if(header.m_dataSize < rootStructSize)
+	{
+		ANKI_UTIL_LOGE("Wrong data size");
+		return Error::USER_DATA;
+	}
+
+	const PtrSize expectedSizeAfterHeader = header.m_dataSize + header.m_pointerCount * sizeof(void*);
+	if(expectedSizeAfterHeader > sizeAfterHeader)
+	{
+		ANKI_UTIL_LOGE("File size doesn't match expectations");
+		return Error::USER_DATA;
+	}
+
+	return Error::NONE;
+}
+
+Error BinaryDeserializer::fixPointer(U8* baseAddress, PtrSize dataSize, PtrSize offsetFromBeginOfData)
+{
+	if(offsetFromBeginOfData + sizeof(PtrSize) > dataSize)
+	{
+		ANKI_UTIL_LOGE("Corrupt pointer");
+		return Error::USER_DATA;
+	}
+
+	// Add to the location the actual base address
+	U8* ptrLocation = baseAddress + offsetFromBeginOfData;
+	PtrSize& ptrValue = *reinterpret_cast<PtrSize*>(ptrLocation);
+	if(ptrValue >= dataSize)
+	{
+		ANKI_UTIL_LOGE("Corrupt pointer");
+		return Error::USER_DATA;
+	}
+
+	ptrValue += ptrToNumber(baseAddress);
+	return Error::NONE;
+}
+
 } // end namespace anki
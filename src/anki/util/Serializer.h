@@ -11,6 +11,12 @@
 namespace anki
 {
 
+// Forward
+namespace detail
+{
+class BinarySerializerHeader;
+}
+
 /// @addtogroup util_file
 /// @{
 
@@ -73,7 +79,9 @@ public:
 	}
 };
 
-/// Serializes to binary files.
+/// Serializes to binary files. The arrays of int and float values (typically big blobs of data) are placed after all
+/// the structures. That way a memory-mapped file can be deserialized in place by writing only the pages that contain
+/// structures.
 class BinarySerializer : public NonCopyable
 {
 public:
@@ -151,12 +159,23 @@ private:
 		PtrSize m_value; ///< Where it points to. It's an offset after the header.
 	};
 
+	/// An array of int or float values that will be written after all the structures.
+	class DeferredArray
+	{
+	public:
+		const void* m_array;
+		PtrSize m_size;
+		U32 m_alignment;
+		U32 m_pointerIdx; ///< Index in m_pointerFilePositions.
+	};
+
 	File* m_file = nullptr;
 	PtrSize m_eofPos; ///< A logical end of the file. Used for allocations.
 	PtrSize m_beginOfDataFilePos; ///< Where the data are located in the file.
 	GenericMemoryPoolAllocator<U8> m_alloc;
 	DynamicArray<PointerInfo> m_pointerFilePositions; ///< Array of file positions that contain pointers.
 	DynamicArray<PtrSize> m_structureFilePos;
+	DynamicArray<DeferredArray> m_deferredArrays;
 	Error m_err = Error::NONE;
 
 	template<typename T>
@@ -167,6 +186,8 @@ private:
 
 	ANKI_USE_RESULT Error doDynamicArrayBasicType(const void* arr, PtrSize size, U32 alignment, PtrSize memberOffset);
 
+	ANKI_USE_RESULT Error writeDeferredArrays();
+
 	template<typename T>
 	ANKI_USE_RESULT Error serializeInternal(const T& x, GenericMemoryPoolAllocator<U8> tmpAllocator, File& file);
 
@@ -195,6 +216,14 @@ public:
 	template<typename T>
 	static ANKI_USE_RESULT Error deserialize(T*& x, GenericMemoryPoolAllocator<U8> allocator, File& file);
 
+	/// Deserialize a class without copying it. The pointers are patched in place so the memory should be writable and
+	/// it should outlive the class. Typically the memory is a memory-mapped file.
+	/// @param x The struct that lives inside the memory.
+	/// @param memory The whole contents of a serialized file. Should be aligned to ANKI_SAFE_ALIGNMENT.
+	/// @param memorySize The size of the memory.
+	template<typename T>
+	static ANKI_USE_RESULT Error deserializeInPlace(T*& x, void* memory, PtrSize memorySize);
+
 	/// Read a single value. Can't call this directly.
 	template<typename T>
 	void doValue(CString varName, PtrSize memberOffset, T& x)
@@ -222,6 +251,12 @@ public:
 	{
 		// Do nothing
 	}
+
+private:
+	static ANKI_USE_RESULT Error checkHeader(
+		const detail::BinarySerializerHeader& header, PtrSize rootStructSize, PtrSize sizeAfterHeader);
+
+	static ANKI_USE_RESULT Error fixPointer(U8* baseAddress, PtrSize dataSize, PtrSize offsetFromBeginOfData);
 };
 /// @}
 
@@ -22,6 +22,9 @@ public:
 
 static constexpr const char* BINARY_SERIALIZER_MAGIC = "ANKIBIN1";
 
+/// The arrays that are written after the structures start at this alignment so they don't share pages with them.
+static constexpr PtrSize BINARY_SERIALIZER_DEFERRED_ARRAYS_ALIGNMENT = 4_KB;
+
 } // end namespace detail
 
 template<typename T>
@@ -56,6 +59,9 @@ Error BinarySerializer::serializeInternal(const T& x, GenericMemoryPoolAllocator
 		return m_err;
 	}
 
+	// Write the arrays that were left for the end
+	ANKI_CHECK(writeDeferredArrays());
+
 	// Write all pointers. Do that now and not while writing the actual shader in order to avoid the file seeks
 	DynamicArrayAuto<PtrSize> pointerFilePositions(m_alloc);
 	for(const PointerInfo& pointer : m_pointerFilePositions)
@@ -71,10 +77,11 @@ Error BinarySerializer::serializeInternal(const T& x, GenericMemoryPoolAllocator
 	// Write the pointer offsets
 	if(pointerFilePositions.getSize() > 0)
 	{
-		ANKI_CHECK(m_file->seek(m_eofPos, FileSeekOrigin::BEGINNING));
+		const PtrSize pointerArrayFilePos = getAlignedRoundUp(alignof(PtrSize), m_eofPos);
+		ANKI_CHECK(m_file->seek(pointerArrayFilePos, FileSeekOrigin::BEGINNING));
 		ANKI_CHECK(m_file->write(&pointerFilePositions[0], pointerFilePositions.getSizeInBytes()));
 		header.m_pointerCount = pointerFilePositions.getSize();
-		header.m_pointerArrayFilePosition = m_eofPos;
+		header.m_pointerArrayFilePosition = pointerArrayFilePos;
 	}
 
 	// Write the header
@@ -86,6 +93,8 @@ Error BinarySerializer::serializeInternal(const T& x, GenericMemoryPoolAllocator
 	// Done
 	m_file = nullptr;
 	m_pointerFilePositions.destroy(m_alloc);
+	m_deferredArrays.destroy(m_alloc);
+	m_structureFilePos.destroy(m_alloc);
 	m_alloc = GenericMemoryPoolAllocator<U8>();
 	return Error::NONE;
 }
@@ -173,27 +182,7 @@ Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allo
 	const PtrSize dataFilePos = file.tell();
 
 	// Sanity checks
-	{
-		if(memcmp(&header.m_magic[0], detail::BINARY_SERIALIZER_MAGIC, 8) != 0)
-		{
-			ANKI_UTIL_LOGE("Wrong magic work in header");
-			return Error::USER_DATA;
-		}
-
-		if(header.m_dataSize < sizeof(T))
-		{
-			ANKI_UTIL_LOGE("Wrong data size");
-			return Error::USER_DATA;
-		}
-
-		const PtrSize expectedSizeAfterHeader = header.m_dataSize + header.m_pointerCount * sizeof(void*);
-		const PtrSize actualSizeAfterHeader = file.getSize() - dataFilePos;
-		if(expectedSizeAfterHeader > actualSizeAfterHeader)
-		{
-			ANKI_UTIL_LOGE("File size doesn't match expectations");
-			return Error::USER_DATA;
-		}
-	}
+	ANKI_CHECK(checkHeader(header, sizeof(T), file.getSize() - dataFilePos));
 
 	// Allocate & read data
 	U8* const baseAddress =
@@ -209,22 +198,48 @@ Error BinaryDeserializer::deserialize(T*& x, GenericMemoryPoolAllocator<U8> allo
 			// Read the location of the pointer
 			PtrSize offsetFromBeginOfData;
 			ANKI_CHECK(file.read(&offsetFromBeginOfData, sizeof(offsetFromBeginOfData)));
-			if(offsetFromBeginOfData >= header.m_dataSize)
-			{
-				ANKI_UTIL_LOGE("Corrupt pointer");
-				return Error::USER_DATA;
-			}
-
-			// Add to the location the actual base address
-			U8* ptrLocation = baseAddress + offsetFromBeginOfData;
-			PtrSize& ptrValue = *reinterpret_cast<PtrSize*>(ptrLocation);
-			if(ptrValue >= header.m_dataSize)
-			{
-				ANKI_UTIL_LOGE("Corrupt pointer");
-				return Error::USER_DATA;
-			}
-
-			ptrValue += ptrToNumber(baseAddress);
+			ANKI_CHECK(fixPointer(baseAddress, header.m_dataSize, offsetFromBeginOfData));
+		}
+	}
+
+	// Done
+	x = reinterpret_cast<T*>(baseAddress);
+	return Error::NONE;
+}
+
+template<typename T>
+Error BinaryDeserializer::deserializeInPlace(T*& x, void* memory, PtrSize memorySize)
+{
+	ANKI_ASSERT(memory && isAligned(ANKI_SAFE_ALIGNMENT, memory));
+	x = nullptr;
+
+	if(memorySize < sizeof(detail::BinarySerializerHeader))
+	{
+		ANKI_UTIL_LOGE("Wrong data size");
+		return Error::USER_DATA;
+	}
+
+	const detail::BinarySerializerHeader& header = *static_cast<const detail::BinarySerializerHeader*>(memory);
+	ANKI_CHECK(checkHeader(header, sizeof(T), memorySize - sizeof(header)));
+
+	U8* const baseAddress = static_cast<U8*>(memory) + sizeof(header);
+
+	// Fix pointers. Only the pages that contain pointers will be written
+	if(header.m_pointerCount)
+	{
+		if(header.m_pointerArrayFilePosition + header.m_pointerCount * sizeof(PtrSize) > memorySize)
+		{
+			ANKI_UTIL_LOGE("Corrupt pointer array");
+			return Error::USER_DATA;
+		}
+
+		const U8* pointerArray = static_cast<const U8*>(memory) + header.m_pointerArrayFilePosition;
+		for(PtrSize i = 0; i < header.m_pointerCount; ++i)
+		{
+			// Older files might have an unaligned array
+			PtrSize offsetFromBeginOfData;
+			memcpy(&offsetFromBeginOfData, pointerArray + i * sizeof(PtrSize), sizeof(PtrSize));
+			ANKI_CHECK(fixPointer(baseAddress, header.m_dataSize, offsetFromBeginOfData));
 		}
 	}
 
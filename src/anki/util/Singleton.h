@@ -82,12 +82,19 @@ public:
 		return *m_instance;
 	}
 
+	/// Check if init() was called.
+	static Bool isInitialized()
+	{
+		return m_instance != nullptr;
+	}
+
 	/// Cleanup
 	static void destroy()
 	{
 		if(m_instance)
 		{
 			delete m_instance;
+			m_instance = nullptr;
 		}
 	}
 
@@ -14,9 +14,11 @@ int main(int argc, char** argv)
 
 	// Call a few singletons to avoid memory leak confusion
 	LoggerSingleton::get();
+	MemoryTrackerSingleton::init();
 
 	int exitcode = getTesterSingleton().run(argc, argv);
 
+	MemoryTrackerSingleton::destroy();
 	LoggerSingleton::destroy();
 
 	deleteTesterSingleton();
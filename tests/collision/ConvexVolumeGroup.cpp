@@ -0,0 +1,90 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/Collision.h>
+#include <random>
+
+namespace anki
+{
+
+/// Distance of the AABB corner that is the furthest along the plane's normal.
+static F32 maxCornerDistance(const Plane& plane, const Aabb& aabb)
+{
+	F32 dist = -plane.getOffset();
+	for(U32 i = 0; i < 3; ++i)
+	{
+		dist += max(plane.getNormal()[i] * aabb.getMin()[i], plane.getNormal()[i] * aabb.getMax()[i]);
+	}
+
+	return dist;
+}
+
+ANKI_TEST(Collision, ConvexVolumeGroup)
+{
+	// Use a fixed seed to have reproducible results
+	std::mt19937 gen(0xA2B3C4D5u);
+	auto randomRange = [&](F32 min, F32 max) { return std::uniform_real_distribution<F32>(min, max)(gen); };
+
+	const U32 volumeCount = 3; // Leave one volume empty
+	Array<Array<Plane, ConvexVolumeGroup::MAX_PLANES>, volumeCount> planes;
+
+	ConvexVolumeGroup group;
+	for(U32 v = 0; v < volumeCount; ++v)
+	{
+		for(Plane& plane : planes[v])
+		{
+			Vec4 normal(randomRange(-1.0f, 1.0f), randomRange(-1.0f, 1.0f), randomRange(-1.0f, 1.0f), 0.0f);
+			normal.normalize();
+			plane = Plane(normal, randomRange(-50.0f, 10.0f));
+		}
+
+		// Only some planes for the last volume
+		const U32 planeCount = (v == volumeCount - 1) ? 3 : ConvexVolumeGroup::MAX_PLANES;
+		group.setVolume(v, ConstWeakArray<Plane>(&planes[v][0], planeCount));
+	}
+
+	for(U32 i = 0; i < 1000; ++i)
+	{
+		const Vec4 min(
+			randomRange(-100.0f, 100.0f), randomRange(-100.0f, 100.0f), randomRange(-100.0f, 100.0f), 0.0f);
+		const Vec4 size(
+			randomRange(0.1f, 20.0f), randomRange(0.1f, 20.0f), randomRange(0.1f, 20.0f), 0.0f);
+		const Aabb aabb(min, min + size);
+
+		// Ignore the volumes that the AABB touches within an epsilon. The SIMD and the scalar paths may disagree there
+		const F32 epsilon = 0.001f;
+		U32 expectedMask = 0;
+		U32 ambiguousMask = 0;
+		for(U32 v = 0; v < volumeCount; ++v)
+		{
+			const U32 planeCount = (v == volumeCount - 1) ? 3 : ConvexVolumeGroup::MAX_PLANES;
+			Bool outside = false;
+			Bool ambiguous = false;
+			for(U32 p = 0; p < planeCount && !outside; ++p)
+			{
+				const F32 dist = maxCornerDistance(planes[v][p], aabb);
+				outside = dist < -epsilon;
+				ambiguous = ambiguous || absolute(dist) <= epsilon;
+			}
+
+			if(!outside)
+			{
+				if(ambiguous)
+				{
+					ambiguousMask |= 1u << v;
+				}
+				else
+				{
+					expectedMask |= 1u << v;
+				}
+			}
+		}
+
+		ANKI_TEST_EXPECT_EQ(group.testAabb(aabb) & ~ambiguousMask, expectedMask);
+	}
+}
+
+} // end namespace anki
@@ -202,4 +202,193 @@ ANKI_TEST(Gr, ClassGpuAllocator)
 	}
 }
 
+ANKI_TEST(Gr, ClassGpuAllocatorStats)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	Interface iface;
+
+	ClassGpuAllocator calloc;
+	calloc.init(alloc, &iface);
+	ANKI_TEST_EXPECT_EQ(calloc.getClassCount(), iface.m_classes.size());
+
+	// 64 slots per chunk in the first class
+	const U32 COUNT = 64 * 4;
+	std::vector<ClassGpuAllocatorHandle> handles;
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		ClassGpuAllocatorHandle handle;
+		ANKI_TEST_EXPECT_NO_ERR(calloc.allocate(200, 1, handle));
+		handles.push_back(handle);
+	}
+
+	ClassGpuAllocatorStats stats;
+	calloc.getStats(0, stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_slotSize, 256);
+	ANKI_TEST_EXPECT_EQ(stats.m_chunkCount, 4);
+	ANKI_TEST_EXPECT_EQ(stats.m_slotCount, COUNT);
+	ANKI_TEST_EXPECT_EQ(stats.m_usedSlotCount, COUNT);
+	ANKI_TEST_EXPECT_EQ(stats.m_sparseChunkCount, 0);
+	ANKI_TEST_EXPECT_EQ(stats.getUnusedMemory(), 0);
+
+	// Free 3 out of 4 allocations
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		if(i % 4)
+		{
+			calloc.free(handles[i]);
+		}
+	}
+
+	calloc.getStats(0, stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_chunkCount, 4);
+	ANKI_TEST_EXPECT_EQ(stats.m_usedSlotCount, COUNT / 4);
+	ANKI_TEST_EXPECT_EQ(stats.m_sparseChunkCount, 4);
+	ANKI_TEST_EXPECT_EQ(stats.getUnusedMemory(), (COUNT - COUNT / 4) * 256);
+	ANKI_TEST_EXPECT_NEAR(stats.getFragmentation(), 0.75f, 0.0001f);
+
+	ClassGpuAllocatorStats otherStats;
+	calloc.getStats(1, otherStats);
+	ANKI_TEST_EXPECT_EQ(otherStats.m_chunkCount, 0);
+	ANKI_TEST_EXPECT_EQ(otherStats.getFragmentation(), 0.0f);
+
+	for(U32 i = 0; i < COUNT; i += 4)
+	{
+		calloc.free(handles[i]);
+	}
+
+	ANKI_TEST_EXPECT_EQ(iface.m_crntSize, 0);
+}
+
+/// Copies the allocations like a GPU copy would do and updates the handles of their owners.
+class Relocator final : public ClassGpuAllocatorRelocator
+{
+public:
+	ClassGpuAllocator* m_calloc = nullptr;
+	std::vector<ClassGpuAllocatorHandle>* m_handles = nullptr;
+	PtrSize m_size = 0;
+	U32 m_pinnedEvery = 0; ///< Refuse to move some of the allocations.
+
+	Bool relocate(const ClassGpuAllocatorHandle& from, const ClassGpuAllocatorHandle& to)
+	{
+		auto it = std::find_if(m_handles->begin(), m_handles->end(), [&](const ClassGpuAllocatorHandle& h) {
+			return h.m_memory == from.m_memory && h.m_offset == from.m_offset;
+		});
+		ANKI_TEST_EXPECT_NEQ(it, m_handles->end());
+
+		// The allocator is not locked, it would deadlock otherwise
+		ClassGpuAllocatorHandle tmp;
+		ANKI_TEST_EXPECT_NO_ERR(m_calloc->allocate(m_size, 1, tmp));
+		m_calloc->free(tmp);
+
+		const U8* src = static_cast<U8*>(static_cast<Mem*>(from.m_memory)->m_mem) + from.m_offset;
+		if(m_pinnedEvery && (src[0] % m_pinnedEvery) == 0)
+		{
+			return false;
+		}
+
+		U8* dst = static_cast<U8*>(static_cast<Mem*>(to.m_memory)->m_mem) + to.m_offset;
+		memcpy(dst, src, m_size);
+		*it = to;
+		return true;
+	}
+};
+
+ANKI_TEST(Gr, ClassGpuAllocatorDefragment)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	Interface iface;
+
+	ClassGpuAllocator calloc;
+	calloc.init(alloc, &iface);
+
+	std::mt19937 gen(0);
+
+	const PtrSize SIZE = 200;
+	const U32 COUNT = 64 * 20;
+
+	auto fill = [&](const ClassGpuAllocatorHandle& h, U8 val) {
+		memset(static_cast<U8*>(static_cast<Mem*>(h.m_memory)->m_mem) + h.m_offset, val, SIZE);
+	};
+
+	auto read = [&](const ClassGpuAllocatorHandle& h) -> U8 {
+		const U8* mem = static_cast<U8*>(static_cast<Mem*>(h.m_memory)->m_mem) + h.m_offset;
+		for(PtrSize i = 1; i < SIZE; ++i)
+		{
+			if(mem[i] != mem[0])
+			{
+				return 0;
+			}
+		}
+
+		return mem[0];
+	};
+
+	for(U32 pinnedEvery : {0u, 7u})
+	{
+		// Allocate and free most of the allocations randomly to leave holes in all chunks
+		std::vector<ClassGpuAllocatorHandle> handles;
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ClassGpuAllocatorHandle handle;
+			ANKI_TEST_EXPECT_NO_ERR(calloc.allocate(SIZE, 1, handle));
+			handles.push_back(handle);
+		}
+
+		std::shuffle(handles.begin(), handles.end(), gen);
+		for(U32 i = COUNT / 5; i < COUNT; ++i)
+		{
+			calloc.free(handles[i]);
+		}
+		handles.erase(handles.begin() + COUNT / 5, handles.end());
+
+		std::vector<U8> values;
+		for(U32 i = 0; i < handles.size(); ++i)
+		{
+			values.push_back(U8(i % 255 + 1));
+			fill(handles[i], values.back());
+		}
+
+		ClassGpuAllocatorStats before;
+		calloc.getStats(0, before);
+		ANKI_TEST_EXPECT_EQ(before.m_usedSlotCount, handles.size());
+		const PtrSize memBefore = iface.m_crntSize;
+
+		// Defragment
+		std::vector<ClassGpuAllocatorHandle> movedHandles = handles;
+		Relocator relocator;
+		relocator.m_calloc = &calloc;
+		relocator.m_handles = &movedHandles;
+		relocator.m_size = SIZE;
+		relocator.m_pinnedEvery = pinnedEvery;
+		const U32 moveCount = calloc.defragment(0.9f, relocator);
+
+		ClassGpuAllocatorStats after;
+		calloc.getStats(0, after);
+
+		ANKI_TEST_EXPECT_GT(moveCount, 0);
+		ANKI_TEST_EXPECT_EQ(after.m_usedSlotCount, before.m_usedSlotCount);
+		ANKI_TEST_EXPECT_LT(after.m_chunkCount, before.m_chunkCount);
+		ANKI_TEST_EXPECT_LT(after.getFragmentation(), before.getFragmentation());
+		ANKI_TEST_EXPECT_LT(iface.m_crntSize, memBefore);
+		ANKI_TEST_EXPECT_EQ(iface.m_crntSize, calloc.getAllocatedMemory());
+
+		// The data should have followed the allocations
+		for(U32 i = 0; i < movedHandles.size(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(read(movedHandles[i]), values[i]);
+		}
+
+		// A second pass shouldn't free more memory
+		const PtrSize memAfter = iface.m_crntSize;
+		calloc.defragment(0.9f, relocator);
+		ANKI_TEST_EXPECT_EQ(iface.m_crntSize, memAfter);
+
+		for(ClassGpuAllocatorHandle& h : movedHandles)
+		{
+			calloc.free(h);
+		}
+		ANKI_TEST_EXPECT_EQ(iface.m_crntSize, 0);
+	}
+}
+
 } // end namespace anki
@@ -0,0 +1,133 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/Config.h>
+
+#if ANKI_GR_BACKEND_VULKAN
+
+#	include <tests/framework/Framework.h>
+#	include <anki/gr/vulkan/PipelineCreationQueue.h>
+#	include <anki/core/ConfigSet.h>
+#	include <anki/util/Filesystem.h>
+#	include <anki/util/File.h>
+
+namespace anki
+{
+
+static PipelineStateDescription newPipelineStateDescription(U64 programHash, U32 variation)
+{
+	PipelineStateDescription desc;
+	desc.m_programHash = programHash;
+	desc.m_attachmentFormats[0] = VK_FORMAT_R8G8B8A8_UNORM;
+	desc.m_attachmentFormats[1] = VK_FORMAT_D24_UNORM_S8_UINT;
+	desc.m_colorAttachmentMask.set(0);
+	desc.m_hasDepthAttachment = true;
+	desc.m_hasStencilAttachment = (variation & 1) != 0;
+	desc.m_vertex.m_bindings[0].m_stride = 16 + variation;
+	return desc;
+}
+
+static Bool containsPipelineState(
+	ConstWeakArray<PipelineStateDescription> records, const PipelineStateDescription& desc)
+{
+	for(const PipelineStateDescription& record : records)
+	{
+		if(memcmp(&record, &desc, sizeof(desc)) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+ANKI_TEST(Gr, PipelineCreationQueueRecords)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	ConfigSet cfg = DefaultConfigSet::get();
+	cfg.set("gr_pipelinePrewarm", 1);
+	cfg.set("gr_asyncPipelineCreation", 0);
+	cfg.set("gr_pipelineCreationThreadCount", 1);
+
+	const CString cacheDir = "/tmp/anki_pipeline_creation_queue_test";
+	if(directoryExists(cacheDir))
+	{
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(cacheDir, alloc));
+	}
+	ANKI_TEST_EXPECT_NO_ERR(createDirectory(cacheDir));
+
+	StringAuto filename(alloc);
+	filename.sprintf("%s/vk_pipeline_states", cacheDir.cstr());
+
+	const U64 PROG_A = 0xAAAA;
+	const U64 PROG_B = 0xBBBB;
+	const U64 PROG_C = 0xCCCC;
+
+	// First run records a few states. One of them twice
+	{
+		PipelineCreationQueue queue;
+		ANKI_TEST_EXPECT_NO_ERR(queue.init(alloc, VK_NULL_HANDLE, cacheDir, cfg));
+		ANKI_TEST_EXPECT_EQ(queue.getLoadedPipelineStates(PROG_A).getSize(), 0);
+
+		queue.recordPipelineState(newPipelineStateDescription(PROG_A, 0));
+		queue.recordPipelineState(newPipelineStateDescription(PROG_A, 1));
+		queue.recordPipelineState(newPipelineStateDescription(PROG_B, 0));
+		queue.recordPipelineState(newPipelineStateDescription(PROG_A, 0));
+		queue.destroy();
+	}
+
+	// Second run loads them and records a known and a new one
+	{
+		PipelineCreationQueue queue;
+		ANKI_TEST_EXPECT_NO_ERR(queue.init(alloc, VK_NULL_HANDLE, cacheDir, cfg));
+
+		const ConstWeakArray<PipelineStateDescription> a = queue.getLoadedPipelineStates(PROG_A);
+		ANKI_TEST_EXPECT_EQ(a.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(containsPipelineState(a, newPipelineStateDescription(PROG_A, 0)), true);
+		ANKI_TEST_EXPECT_EQ(containsPipelineState(a, newPipelineStateDescription(PROG_A, 1)), true);
+
+		const ConstWeakArray<PipelineStateDescription> b = queue.getLoadedPipelineStates(PROG_B);
+		ANKI_TEST_EXPECT_EQ(b.getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(containsPipelineState(b, newPipelineStateDescription(PROG_B, 0)), true);
+
+		queue.recordPipelineState(newPipelineStateDescription(PROG_A, 1));
+		queue.recordPipelineState(newPipelineStateDescription(PROG_C, 3));
+		queue.destroy();
+	}
+
+	// Third run sees everything once
+	{
+		PipelineCreationQueue queue;
+		ANKI_TEST_EXPECT_NO_ERR(queue.init(alloc, VK_NULL_HANDLE, cacheDir, cfg));
+
+		ANKI_TEST_EXPECT_EQ(queue.getLoadedPipelineStates(PROG_A).getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(queue.getLoadedPipelineStates(PROG_B).getSize(), 1);
+
+		const ConstWeakArray<PipelineStateDescription> c = queue.getLoadedPipelineStates(PROG_C);
+		ANKI_TEST_EXPECT_EQ(c.getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(containsPipelineState(c, newPipelineStateDescription(PROG_C, 3)), true);
+		queue.destroy();
+	}
+
+	// A corrupted file is ignored
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open(filename.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		ANKI_TEST_EXPECT_NO_ERR(file.write("garbage", 7));
+		file.close();
+
+		PipelineCreationQueue queue;
+		ANKI_TEST_EXPECT_NO_ERR(queue.init(alloc, VK_NULL_HANDLE, cacheDir, cfg));
+		ANKI_TEST_EXPECT_EQ(queue.getLoadedPipelineStates(PROG_A).getSize(), 0);
+		queue.destroy();
+	}
+
+	ANKI_TEST_EXPECT_NO_ERR(removeDirectory(cacheDir, alloc));
+}
+
+} // end namespace anki
+
+#endif
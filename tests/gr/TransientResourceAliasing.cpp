@@ -0,0 +1,71 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <anki/gr/utils/TransientResourceAliasing.h>
+#include <tests/framework/Framework.h>
+
+using namespace anki;
+
+ANKI_TEST(Gr, TransientResourceAliasing)
+{
+	// 0 and 1 are compatible but overlap, 2 can take the place of 0, 3 ends in the batch that 4 starts, 5 is of
+	// another type
+	Array<TransientResourceLifetime, 6> resources;
+	resources[0].m_aliasingKey = 1;
+	resources[0].m_size = 100;
+	resources[0].m_firstUse = 0;
+	resources[0].m_lastUse = 1;
+
+	resources[1].m_aliasingKey = 1;
+	resources[1].m_size = 100;
+	resources[1].m_firstUse = 1;
+	resources[1].m_lastUse = 3;
+
+	resources[2].m_aliasingKey = 1;
+	resources[2].m_size = 100;
+	resources[2].m_firstUse = 2;
+	resources[2].m_lastUse = 4;
+
+	resources[3].m_aliasingKey = 2;
+	resources[3].m_size = 10;
+	resources[3].m_firstUse = 0;
+	resources[3].m_lastUse = 2;
+
+	resources[4].m_aliasingKey = 2;
+	resources[4].m_size = 10;
+	resources[4].m_firstUse = 2;
+	resources[4].m_lastUse = 2;
+
+	resources[5].m_aliasingKey = 3;
+	resources[5].m_size = 1;
+	resources[5].m_firstUse = 5;
+	resources[5].m_lastUse = 5;
+
+	Array<TransientResourceAllocation, 6> allocations;
+	Array<U32, 6> resourceAllocations;
+	const U32 allocationCount = planTransientResourceAliasing(resources, allocations, resourceAllocations);
+
+	ANKI_TEST_EXPECT_EQ(allocationCount, 5);
+	ANKI_TEST_EXPECT_EQ(resourceAllocations[2], resourceAllocations[0]);
+	ANKI_TEST_EXPECT_NEQ(resourceAllocations[1], resourceAllocations[0]);
+	ANKI_TEST_EXPECT_NEQ(resourceAllocations[4], resourceAllocations[3]);
+
+	ANKI_TEST_EXPECT_EQ(computeTransientResourceMemory(ConstWeakArray<TransientResourceLifetime>(resources)), 321);
+	ANKI_TEST_EXPECT_EQ(computeTransientResourceMemory(
+							ConstWeakArray<TransientResourceAllocation>(&allocations[0], allocationCount)),
+		221);
+
+	// A chain of resources that are used one after the other need a single allocation
+	for(U32 i = 0; i < resources.getSize(); ++i)
+	{
+		resources[i].m_aliasingKey = 1;
+		resources[i].m_size = 100;
+		resources[i].m_firstUse = resources[i].m_lastUse = resources.getSize() - i;
+	}
+
+	ANKI_TEST_EXPECT_EQ(planTransientResourceAliasing(resources, allocations, resourceAllocations), 1);
+	ANKI_TEST_EXPECT_EQ(computeTransientResourceMemory(ConstWeakArray<TransientResourceAllocation>(&allocations[0], 1)),
+		100);
+}
@@ -0,0 +1,490 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/renderer/ClusterBin.h>
+#include <anki/renderer/ClusterBinKernels.h>
+#include <anki/renderer/RenderQueue.h>
+#include <anki/core/ConfigSet.h>
+#include <anki/util/ThreadHive.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/System.h>
+#include <anki/Collision.h>
+
+namespace anki
+{
+
+static F32 randRange(F32 min, F32 max)
+{
+	return min + (max - min) * (F32(rand()) / F32(RAND_MAX));
+}
+
+static Vec3 randVec3(F32 min, F32 max)
+{
+	return Vec3(randRange(min, max), randRange(min, max), randRange(min, max));
+}
+
+static Euler randEuler()
+{
+	return Euler(randRange(-PI, PI), randRange(-PI, PI), randRange(-PI, PI));
+}
+
+static Plane randPlane()
+{
+	Vec4 n = randVec3(-1.0f, 1.0f).xyz0();
+	if(n.getLengthSquared() < 0.01f)
+	{
+		n = Vec4(0.0f, 1.0f, 0.0f, 0.0f);
+	}
+	return Plane(n.getNormalized(), randRange(-5.0f, 5.0f));
+}
+
+/// A camera, some lights and optionally some probes, decals and fog volumes that are used by the tests.
+class ClusterBinTestScene
+{
+public:
+	RenderQueue m_rqueue;
+	DynamicArrayAuto<PointLightQueueElement> m_pointLights;
+	DynamicArrayAuto<SpotLightQueueElement> m_spotLights;
+	DynamicArrayAuto<ReflectionProbeQueueElement> m_probes;
+	DynamicArrayAuto<GlobalIlluminationProbeQueueElement> m_giProbes;
+	DynamicArrayAuto<DecalQueueElement> m_decals;
+	DynamicArrayAuto<FogDensityQueueElement> m_fogVolumes;
+
+	ClusterBinTestScene(HeapAllocator<U8> alloc, U32 pointLightCount, U32 spotLightCount, U32 otherObjectCount = 0)
+		: m_pointLights(alloc)
+		, m_spotLights(alloc)
+		, m_probes(alloc)
+		, m_giProbes(alloc)
+		, m_decals(alloc)
+		, m_fogVolumes(alloc)
+	{
+		const F32 near = 0.1f;
+		const F32 far = 200.0f;
+		const F32 fovX = toRad(90.0f);
+		const F32 fovY = toRad(60.0f);
+
+		m_rqueue.m_cameraTransform = Mat4(Vec4(10.0f, 2.0f, 5.0f, 1.0f), Mat3(Euler(0.1f, 0.5f, 0.0f)), 1.0f);
+		m_rqueue.m_viewMatrix = m_rqueue.m_cameraTransform.getInverse();
+		m_rqueue.m_projectionMatrix = Mat4::calculatePerspectiveProjectionMatrix(fovX, fovY, near, far);
+		m_rqueue.m_viewProjectionMatrix = m_rqueue.m_projectionMatrix * m_rqueue.m_viewMatrix;
+		m_rqueue.m_previousViewProjectionMatrix = m_rqueue.m_viewProjectionMatrix;
+		m_rqueue.m_cameraNear = near;
+		m_rqueue.m_cameraFar = far;
+		m_rqueue.m_cameraFovX = fovX;
+		m_rqueue.m_cameraFovY = fovY;
+
+		// Place the lights in front of the camera
+		m_pointLights.create(pointLightCount);
+		for(PointLightQueueElement& light : m_pointLights)
+		{
+			zeroMemory(light);
+			light.m_worldPosition = randomPositionInFront();
+			light.m_radius = randRange(0.5f, 4.0f);
+		}
+
+		m_spotLights.create(spotLightCount);
+		for(SpotLightQueueElement& light : m_spotLights)
+		{
+			zeroMemory(light);
+			light.m_worldTransform = Mat4(randomPositionInFront().xyz1(), Mat3(randEuler()), 1.0f);
+			light.m_distance = randRange(1.0f, 8.0f);
+			light.m_outerAngle = randRange(toRad(10.0f), toRad(90.0f));
+			light.m_innerAngle = light.m_outerAngle / 2.0f;
+		}
+
+		m_probes.create(otherObjectCount);
+		for(ReflectionProbeQueueElement& probe : m_probes)
+		{
+			zeroMemory(probe);
+			const Vec3 center = randomPositionInFront();
+			const Vec3 extend = randVec3(1.0f, 10.0f);
+			probe.m_worldPosition = center;
+			probe.m_aabbMin = center - extend;
+			probe.m_aabbMax = center + extend;
+		}
+
+		m_giProbes.create(otherObjectCount);
+		for(GlobalIlluminationProbeQueueElement& probe : m_giProbes)
+		{
+			zeroMemory(probe);
+			const Vec3 center = randomPositionInFront();
+			const Vec3 extend = randVec3(1.0f, 10.0f);
+			probe.m_aabbMin = center - extend;
+			probe.m_aabbMax = center + extend;
+		}
+
+		m_decals.create(otherObjectCount);
+		for(DecalQueueElement& decal : m_decals)
+		{
+			zeroMemory(decal);
+			decal.m_obbCenter = randomPositionInFront();
+			decal.m_obbExtend = randVec3(0.2f, 3.0f);
+			decal.m_obbRotation = Mat3(randEuler());
+		}
+
+		m_fogVolumes.create(otherObjectCount);
+		for(U32 i = 0; i < otherObjectCount; ++i)
+		{
+			FogDensityQueueElement& fogVol = m_fogVolumes[i];
+			zeroMemory(fogVol);
+			const Vec3 center = randomPositionInFront();
+			fogVol.m_isBox = (i % 2) == 0;
+			if(fogVol.m_isBox)
+			{
+				const Vec3 extend = randVec3(1.0f, 6.0f);
+				fogVol.m_aabbMin = center - extend;
+				fogVol.m_aabbMax = center + extend;
+			}
+			else
+			{
+				fogVol.m_sphereCenter = center;
+				fogVol.m_sphereRadius = randRange(1.0f, 6.0f);
+			}
+		}
+
+		m_rqueue.m_pointLights = WeakArray<PointLightQueueElement>(m_pointLights);
+		m_rqueue.m_spotLights = WeakArray<SpotLightQueueElement>(m_spotLights);
+		m_rqueue.m_reflectionProbes = WeakArray<ReflectionProbeQueueElement>(m_probes);
+		m_rqueue.m_giProbes = WeakArray<GlobalIlluminationProbeQueueElement>(m_giProbes);
+		m_rqueue.m_decals = WeakArray<DecalQueueElement>(m_decals);
+		m_rqueue.m_fogDensityVolumes = WeakArray<FogDensityQueueElement>(m_fogVolumes);
+	}
+
+private:
+	Vec3 randomPositionInFront() const
+	{
+		const Vec4 posVSpace(randRange(-40.0f, 40.0f), randRange(-25.0f, 25.0f), randRange(-60.0f, -1.0f), 1.0f);
+		return (m_rqueue.m_cameraTransform * posVSpace).xyz();
+	}
+};
+
+ANKI_TEST(Renderer, ClusterBinKernels)
+{
+	srand(0);
+	const U32 ITERATIONS = 10000;
+
+	ConstWeakArray<Plane> planes;
+	Array<Plane, 4> planeArr;
+	for(U32 it = 0; it < ITERATIONS; ++it)
+	{
+		for(Plane& p : planeArr)
+		{
+			p = randPlane();
+		}
+		planes = ConstWeakArray<Plane>(&planeArr[0], planeArr.getSize());
+
+		// Spheres against planes
+		{
+			ClusterBinSphereBatch batch;
+			Array<Sphere, CLUSTER_BIN_BATCH_SIZE> spheres;
+			U32 refMask = 0;
+			for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+			{
+				spheres[lane] = Sphere(randVec3(-10.0f, 10.0f).xyz0(), randRange(0.1f, 5.0f));
+				batch.set(lane, spheres[lane].getCenter().xyz(), spheres[lane].getRadius());
+
+				Bool inside = true;
+				for(const Plane& p : planeArr)
+				{
+					inside = inside && testPlane(p, spheres[lane]) >= 0.0f;
+				}
+				refMask |= U32(inside) << lane;
+			}
+
+			ANKI_TEST_EXPECT_EQ(clusterBinTestPlanes(planes, batch), refMask);
+		}
+
+		// AABBs against planes
+		{
+			ClusterBinAabbBatch batch;
+			U32 refMask = 0;
+			for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+			{
+				const Vec3 center = randVec3(-10.0f, 10.0f);
+				const Vec3 extend = randVec3(0.1f, 4.0f);
+				const Aabb aabb((center - extend).xyz0(), (center + extend).xyz0());
+				batch.set(lane, center - extend, center + extend);
+
+				Bool inside = true;
+				for(const Plane& p : planeArr)
+				{
+					inside = inside && testPlane(p, aabb) >= 0.0f;
+				}
+				refMask |= U32(inside) << lane;
+			}
+
+			ANKI_TEST_EXPECT_EQ(clusterBinTestPlanes(planes, batch), refMask);
+		}
+
+		// Hulls against planes
+		{
+			ClusterBinSpotLightHullBatch batch;
+			U32 refMask = 0;
+			for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+			{
+				Array<Vec4, ClusterBinSpotLightHullBatch::POINT_COUNT> points;
+				for(Vec4& p : points)
+				{
+					p = randVec3(-10.0f, 10.0f).xyz0();
+				}
+				batch.set(lane, points);
+
+				const ConvexHullShape hull(&points[0], points.getSize());
+				Bool inside = true;
+				for(const Plane& p : planeArr)
+				{
+					inside = inside && testPlane(p, hull) >= 0.0f;
+				}
+				refMask |= U32(inside) << lane;
+			}
+
+			ANKI_TEST_EXPECT_EQ(clusterBinTestPlanes(planes, batch), refMask);
+		}
+
+		// OBBs against planes
+		{
+			ClusterBinObbBatch batch;
+			U32 refMask = 0;
+			for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+			{
+				const Vec3 center = randVec3(-10.0f, 10.0f);
+				const Vec3 extend = randVec3(0.1f, 4.0f);
+				const Mat3 rot(randEuler());
+				batch.set(lane, center, rot, extend);
+
+				const Obb obb(center.xyz0(), Mat3x4(rot), extend.xyz0());
+				Bool inside = true;
+				for(const Plane& p : planeArr)
+				{
+					inside = inside && testPlane(p, obb) >= 0.0f;
+				}
+				refMask |= U32(inside) << lane;
+			}
+
+			ANKI_TEST_EXPECT_EQ(clusterBinTestPlanes(planes, batch), refMask);
+		}
+
+		// Objects against clusters
+		{
+			ClusterBinAabbBatch boxBatch;
+			ClusterBinSphereBatch sphereBatch;
+			Array<Aabb, CLUSTER_BIN_BATCH_SIZE> boxes;
+			Array<Sphere, CLUSTER_BIN_BATCH_SIZE> spheres;
+			for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+			{
+				const Vec3 center = randVec3(-10.0f, 10.0f);
+				const Vec3 extend = randVec3(0.1f, 4.0f);
+				boxes[lane] = Aabb((center - extend).xyz0(), (center + extend).xyz0());
+				boxBatch.set(lane, center - extend, center + extend);
+
+				spheres[lane] = Sphere(center.xyz0(), extend.getLength());
+				sphereBatch.set(lane, center, extend.getLength());
+			}
+
+			const Sphere sphere(randVec3(-10.0f, 10.0f).xyz0(), randRange(0.1f, 5.0f));
+			const Vec3 aabbCenter = randVec3(-10.0f, 10.0f);
+			const Vec3 aabbExtend = randVec3(0.1f, 4.0f);
+			const Aabb aabb((aabbCenter - aabbExtend).xyz0(), (aabbCenter + aabbExtend).xyz0());
+			const Cone cone(randVec3(-10.0f, 10.0f).xyz0(),
+				randVec3(-1.0f, 1.0f).xyz0().getNormalized(),
+				randRange(1.0f, 10.0f),
+				randRange(toRad(10.0f), toRad(90.0f)));
+
+			ClusterBinCone binCone;
+			binCone.m_origin = cone.getOrigin().xyz();
+			binCone.m_direction = cone.getDirection().xyz();
+			binCone.m_length = cone.getLength();
+			binCone.m_cosHalfAngle = cos(cone.getAngle() / 2.0f);
+			binCone.m_sinHalfAngle = sin(cone.getAngle() / 2.0f);
+
+			U32 sphereRefMask = 0;
+			U32 aabbRefMask = 0;
+			U32 coneRefMask = 0;
+			for(U32 lane = 0; lane < CLUSTER_BIN_BATCH_SIZE; ++lane)
+			{
+				sphereRefMask |= U32(testCollision(sphere, boxes[lane])) << lane;
+				aabbRefMask |= U32(testCollision(aabb, boxes[lane])) << lane;
+				coneRefMask |= U32(testCollision(spheres[lane], cone)) << lane;
+			}
+
+			ANKI_TEST_EXPECT_EQ(
+				clusterBinTestCollision(sphere.getCenter().xyz(), sphere.getRadius(), boxBatch), sphereRefMask);
+			ANKI_TEST_EXPECT_EQ(
+				clusterBinTestCollision(aabb.getMin().xyz(), aabb.getMax().xyz(), boxBatch), aabbRefMask);
+			ANKI_TEST_EXPECT_EQ(clusterBinTestCollision(binCone, sphereBatch), coneRefMask);
+		}
+	}
+}
+
+ANKI_TEST(Renderer, ClusterBin)
+{
+	srand(0);
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	StackAllocator<U8> tempAlloc(allocAligned, nullptr, 1024 * 1024 * 10);
+	ThreadHive hive(4, alloc);
+
+	ConfigSet config;
+	config.set(ConfigOption::r_avgObjectsPerCluster, 256);
+
+	const UVec3 clusterCounts(16, 9, 24);
+	ClusterBin clusterBin;
+	clusterBin.init(alloc, nullptr, clusterCounts.x(), clusterCounts.y(), clusterCounts.z(), config);
+
+	ClusterBinTestScene scene(alloc, 200, 50);
+
+	ClusterBinIn in;
+	in.m_threadHive = &hive;
+	in.m_tempAlloc = tempAlloc;
+	in.m_renderQueue = &scene.m_rqueue;
+	in.m_shadowsEnabled = false;
+
+	DynamicArrayAuto<U32> clusters(alloc, clusterBin.getTotalClusterCount());
+	DynamicArrayAuto<U32> indices(alloc, clusterBin.getIndexCount());
+	ClustererMagicValues magic;
+	clusterBin.binToCpuMemory(in, WeakArray<U32>(clusters), WeakArray<U32>(indices), magic);
+
+	// The cluster that contains the center of a point light should have that light
+	for(U32 i = 0; i < scene.m_pointLights.getSize(); ++i)
+	{
+		const Vec3 pos = scene.m_pointLights[i].m_worldPosition;
+		const Vec4 clip = scene.m_rqueue.m_viewProjectionMatrix * pos.xyz1();
+		const Vec2 uv = clip.xy() / clip.w() * 0.5f + 0.5f;
+		if(uv.x() < 0.0f || uv.x() >= 1.0f || uv.y() < 0.0f || uv.y() >= 1.0f)
+		{
+			continue;
+		}
+
+		const U32 clusterIdx = computeClusterIndex(magic, uv, pos, clusterCounts.x(), clusterCounts.y());
+		ANKI_TEST_EXPECT_LT(clusterIdx, clusters.getSize());
+
+		Bool found = false;
+		for(U32 idx = clusters[clusterIdx]; indices[idx] != MAX_U32; ++idx)
+		{
+			found = found || indices[idx] == i;
+		}
+		ANKI_TEST_EXPECT_EQ(found, true);
+	}
+}
+
+ANKI_TEST(Renderer, ClusterBinHierarchical)
+{
+	srand(0);
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	StackAllocator<U8> tempAlloc(allocAligned, nullptr, 1024 * 1024 * 10);
+	ThreadHive hive(4, alloc);
+
+	const UVec3 clusterCounts(32, 26, 32);
+	ClusterBinTestScene scene(alloc, 500, 100, 50);
+
+	// Bin with and without the coarse binning
+	Array<DynamicArrayAuto<U32>, 2> clusters = {{{alloc}, {alloc}}};
+	Array<DynamicArrayAuto<U32>, 2> indices = {{{alloc}, {alloc}}};
+	for(U32 hierarchical = 0; hierarchical < 2; ++hierarchical)
+	{
+		ConfigSet config;
+		config.set(ConfigOption::r_avgObjectsPerCluster, 256);
+		config.set(ConfigOption::r_clusterBinHierarchical, hierarchical);
+
+		ClusterBin clusterBin;
+		clusterBin.init(alloc, nullptr, clusterCounts.x(), clusterCounts.y(), clusterCounts.z(), config);
+
+		ClusterBinIn in;
+		in.m_threadHive = &hive;
+		in.m_tempAlloc = tempAlloc;
+		in.m_renderQueue = &scene.m_rqueue;
+		in.m_shadowsEnabled = false;
+
+		clusters[hierarchical].create(clusterBin.getTotalClusterCount());
+		indices[hierarchical].create(clusterBin.getIndexCount());
+		ClustererMagicValues magic;
+		clusterBin.binToCpuMemory(
+			in, WeakArray<U32>(clusters[hierarchical]), WeakArray<U32>(indices[hierarchical]), magic);
+		tempAlloc.getMemoryPool().reset();
+	}
+
+	// The clusters are written in a different order by the threads so compare the objects of each cluster
+	U32 objectCount = 0;
+	for(U32 clusterIdx = 0; clusterIdx < clusters[0].getSize(); ++clusterIdx)
+	{
+		U32 idxA = clusters[0][clusterIdx];
+		U32 idxB = clusters[1][clusterIdx];
+		for(U32 typeIdx = 0; typeIdx < TYPED_OBJECT_COUNT; ++typeIdx)
+		{
+			while(indices[0][idxA] != MAX_U32)
+			{
+				ANKI_TEST_EXPECT_EQ(indices[0][idxA], indices[1][idxB]);
+				++idxA;
+				++idxB;
+				++objectCount;
+			}
+			ANKI_TEST_EXPECT_EQ(indices[1][idxB], MAX_U32);
+
+			// Skip the stop
+			++idxA;
+			++idxB;
+		}
+	}
+
+	ANKI_TEST_EXPECT_GT(objectCount, 0);
+}
+
+ANKI_TEST(Renderer, ClusterBinBench)
+{
+	srand(0);
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	StackAllocator<U8> tempAlloc(allocAligned, nullptr, 1024 * 1024 * 10);
+	ThreadHive hive(getCpuCoresCount(), alloc);
+
+	ConfigSet config;
+	config.set(ConfigOption::r_avgObjectsPerCluster, 256);
+
+	const Array<UVec3, 3> clusterCountsArr = {{UVec3(16, 9, 16), UVec3(32, 26, 32), UVec3(64, 36, 64)}};
+	const Array<U32, 3> lightCounts = {{100, 1000, 10000}};
+	const U32 ITERATIONS = 10;
+
+	for(const UVec3& clusterCounts : clusterCountsArr)
+	{
+		ClusterBin clusterBin;
+		clusterBin.init(alloc, nullptr, clusterCounts.x(), clusterCounts.y(), clusterCounts.z(), config);
+
+		DynamicArrayAuto<U32> clusters(alloc, clusterBin.getTotalClusterCount());
+		DynamicArrayAuto<U32> indices(alloc, clusterBin.getIndexCount());
+
+		for(U32 lightCount : lightCounts)
+		{
+			ClusterBinTestScene scene(alloc, lightCount, lightCount / 4);
+
+			Second totalTime = 0.0;
+			for(U32 it = 0; it < ITERATIONS; ++it)
+			{
+				tempAlloc.getMemoryPool().reset();
+
+				ClusterBinIn in;
+				in.m_threadHive = &hive;
+				in.m_tempAlloc = tempAlloc;
+				in.m_renderQueue = &scene.m_rqueue;
+				in.m_shadowsEnabled = false;
+
+				ClustererMagicValues magic;
+				HighRezTimer timer;
+				timer.start();
+				clusterBin.binToCpuMemory(in, WeakArray<U32>(clusters), WeakArray<U32>(indices), magic);
+				timer.stop();
+				totalTime += timer.getElapsedTime();
+			}
+
+			ANKI_TEST_LOGI("Clusters %ux%ux%u, point lights %u, spot lights %u: %f ms",
+				clusterCounts.x(),
+				clusterCounts.y(),
+				clusterCounts.z(),
+				lightCount,
+				lightCount / 4,
+				totalTime / F64(ITERATIONS) * 1000.0);
+		}
+	}
+}
+
+} // end namespace anki
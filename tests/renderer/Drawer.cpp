@@ -0,0 +1,150 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/renderer/Drawer.h>
+#include <anki/renderer/RenderQueue.h>
+
+namespace anki
+{
+
+static void drawerTestCallbackA(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData)
+{
+}
+
+static void drawerTestCallbackB(RenderQueueDrawContext& ctx, ConstWeakArray<void*> userData)
+{
+}
+
+ANKI_TEST(Renderer, DrawerGrouping)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	class Desc
+	{
+	public:
+		RenderQueueDrawCallback m_callback;
+		U64 m_mergeKey;
+		U8 m_lod;
+	};
+
+	const Array<Desc, 9> descs = {{{drawerTestCallbackA, 1, 0},
+		{drawerTestCallbackA, 2, 0},
+		{drawerTestCallbackA, 1, 0},
+		{drawerTestCallbackA, 0, 0},
+		{drawerTestCallbackA, 0, 0},
+		{drawerTestCallbackB, 1, 0},
+		{drawerTestCallbackA, 1, 1},
+		{drawerTestCallbackA, 2, 0},
+		{drawerTestCallbackA, 1, 0}}};
+
+	Array<RenderableQueueElement, descs.getSize()> elements;
+	Array<U8, descs.getSize()> lods;
+	for(U32 i = 0; i < descs.getSize(); ++i)
+	{
+		elements[i].m_callback = descs[i].m_callback;
+		elements[i].m_userData = nullptr;
+		elements[i].m_mergeKey = descs[i].m_mergeKey;
+		elements[i].m_distanceFromCamera = 0.0f;
+		lods[i] = descs[i].m_lod;
+	}
+
+	Array<U32, descs.getSize()> indices;
+	const U32 saved = groupRenderableQueueElements(elements, lods, alloc, indices);
+
+	// The groups are ordered by their first element. Zero merge keys, different callbacks and different LODs don't
+	// merge
+	const Array<U32, descs.getSize()> expectedIndices = {{0, 2, 8, 1, 7, 3, 4, 5, 6}};
+	for(U32 i = 0; i < indices.getSize(); ++i)
+	{
+		ANKI_TEST_EXPECT_EQ(indices[i], expectedIndices[i]);
+	}
+
+	// 9 drawcalls without grouping, 6 with
+	ANKI_TEST_EXPECT_EQ(saved, 3);
+}
+
+ANKI_TEST(Renderer, DrawerSplitByCost)
+{
+	// 8 renderables that start a drawcall followed by 64 instanced ones
+	constexpr U32 COUNT = 72;
+	Array<RenderableQueueElement, COUNT> elements;
+	for(U32 i = 0; i < COUNT; ++i)
+	{
+		elements[i].m_callback = drawerTestCallbackA;
+		elements[i].m_userData = nullptr;
+		elements[i].m_mergeKey = (i < 8) ? 0 : 1;
+		elements[i].m_distanceFromCamera = 0.0f;
+	}
+
+	Array<U32, COUNT> prefixSum;
+	const U32 initialCost = 10;
+	const U32 totalCost = computeRenderableDrawCostPrefixSum(elements, initialCost, prefixSum);
+	const U32 expectedCost = initialCost + 9 * RENDERABLE_DRAWCALL_RECORDING_COST + 63;
+	ANKI_TEST_EXPECT_EQ(totalCost, expectedCost);
+	ANKI_TEST_EXPECT_EQ(prefixSum[0], initialCost + RENDERABLE_DRAWCALL_RECORDING_COST);
+	ANKI_TEST_EXPECT_EQ(prefixSum[COUNT - 1], totalCost);
+
+	// The chunks cover everything, they don't break instanced drawcalls and the costly renderables get smaller chunks
+	for(U32 chunkCount = 1; chunkCount <= 8; ++chunkCount)
+	{
+		U32 prevEnd = 0;
+		for(U32 i = 0; i < chunkCount; ++i)
+		{
+			U32 start, end;
+			splitRenderablesByDrawCost(prefixSum, i, chunkCount, start, end);
+			ANKI_TEST_EXPECT_EQ(start, prevEnd);
+			ANKI_TEST_EXPECT_GEQ(end, start);
+			if(start > 0 && start < COUNT)
+			{
+				ANKI_TEST_EXPECT_NEQ(prefixSum[start] - prefixSum[start - 1], 1);
+			}
+			prevEnd = end;
+		}
+
+		ANKI_TEST_EXPECT_EQ(prevEnd, COUNT);
+	}
+
+	U32 start, end;
+	splitRenderablesByDrawCost(prefixSum, 0, 2, start, end);
+	ANKI_TEST_EXPECT_LT(end, COUNT / 2);
+
+	// More mergeable renderables than MAX_INSTANCES start a new drawcall
+	{
+		constexpr U32 BIG_COUNT = MAX_INSTANCES + 2;
+		Array<RenderableQueueElement, BIG_COUNT> bigElements;
+		for(RenderableQueueElement& el : bigElements)
+		{
+			el.m_callback = drawerTestCallbackA;
+			el.m_userData = nullptr;
+			el.m_mergeKey = 1;
+			el.m_distanceFromCamera = 0.0f;
+		}
+
+		Array<U32, BIG_COUNT> bigPrefixSum;
+		const U32 bigCost = computeRenderableDrawCostPrefixSum(bigElements, 0, bigPrefixSum);
+		ANKI_TEST_EXPECT_EQ(bigCost, 2 * RENDERABLE_DRAWCALL_RECORDING_COST + BIG_COUNT - 2);
+		ANKI_TEST_EXPECT_EQ(bigPrefixSum[MAX_INSTANCES] - bigPrefixSum[MAX_INSTANCES - 1],
+			RENDERABLE_DRAWCALL_RECORDING_COST);
+
+		// With many chunks only the 2 drawcalls can start a non-empty chunk
+		U32 nonEmptyChunkCount = 0;
+		for(U32 i = 0; i < 8; ++i)
+		{
+			splitRenderablesByDrawCost(bigPrefixSum, i, 8, start, end);
+			ANKI_TEST_EXPECT_EQ(start == end || start == 0 || start == MAX_INSTANCES, true);
+			nonEmptyChunkCount += (start != end) ? 1 : 0;
+		}
+
+		ANKI_TEST_EXPECT_LEQ(nonEmptyChunkCount, 2);
+	}
+
+	// Empty
+	splitRenderablesByDrawCost(ConstWeakArray<U32>(), 0, 1, start, end);
+	ANKI_TEST_EXPECT_EQ(start, 0);
+	ANKI_TEST_EXPECT_EQ(end, 0);
+}
+
+} // end namespace anki
@@ -0,0 +1,106 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/renderer/PersistentGpuObjectBuffer.h>
+
+namespace anki
+{
+
+ANKI_TEST(Renderer, PersistentGpuObjectBuffer)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	PersistentGpuObjectBuffer buff;
+	buff.init(alloc, nullptr, sizeof(Vec4), 4, "Test");
+
+	// New objects get new slots and they are written
+	buff.beginFrame();
+	const U32 slotA = buff.acquireSlot(100);
+	const U32 slotB = buff.acquireSlot(200);
+	ANKI_TEST_EXPECT_NEQ(slotA, slotB);
+	ANKI_TEST_EXPECT_EQ(buff.acquireSlot(100), slotA);
+
+	// Only the used slots are bound
+	StagingGpuMemoryToken token;
+	buff.getToken(token);
+	ANKI_TEST_EXPECT_EQ(buff.getUsedSlotRange(), 2);
+	ANKI_TEST_EXPECT_EQ(token.m_range, 2 * sizeof(Vec4));
+
+	const Vec4 a(1.0f, 2.0f, 3.0f, 4.0f);
+	Vec4 b(5.0f, 6.0f, 7.0f, 8.0f);
+	buff.writeSlot(slotA, &a);
+	buff.writeSlot(slotB, &b);
+	ANKI_TEST_EXPECT_EQ(buff.getWrittenSlotCount(), 2);
+	ANKI_TEST_EXPECT_EQ(*static_cast<const Vec4*>(buff.getSlotData(slotA)), a);
+	ANKI_TEST_EXPECT_EQ(*static_cast<const Vec4*>(buff.getSlotData(slotB)), b);
+
+	// The objects keep their slots. Every copy is written once and then the writes are skipped
+	for(U32 i = 1; i < MAX_FRAMES_IN_FLIGHT; ++i)
+	{
+		buff.beginFrame();
+		ANKI_TEST_EXPECT_EQ(buff.acquireSlot(100), slotA);
+		ANKI_TEST_EXPECT_EQ(buff.acquireSlot(200), slotB);
+		buff.writeSlot(slotA, &a);
+		buff.writeSlot(slotB, &b);
+		ANKI_TEST_EXPECT_EQ(buff.getWrittenSlotCount(), 2);
+		ANKI_TEST_EXPECT_EQ(buff.getSkippedSlotCount(), 0);
+	}
+
+	buff.beginFrame();
+	buff.acquireSlot(100);
+	buff.acquireSlot(200);
+	buff.writeSlot(slotA, &a);
+	buff.writeSlot(slotB, &b);
+	ANKI_TEST_EXPECT_EQ(buff.getWrittenSlotCount(), 0);
+	ANKI_TEST_EXPECT_EQ(buff.getSkippedSlotCount(), 2);
+
+	// Change one object. All the copies need to be written again
+	b.x() = 10.0f;
+	for(U32 i = 0; i < MAX_FRAMES_IN_FLIGHT + 1; ++i)
+	{
+		buff.beginFrame();
+		buff.acquireSlot(100);
+		buff.acquireSlot(200);
+		buff.writeSlot(slotA, &a);
+		buff.writeSlot(slotB, &b);
+		ANKI_TEST_EXPECT_EQ(buff.getWrittenSlotCount(), (i < MAX_FRAMES_IN_FLIGHT) ? 1 : 0);
+		ANKI_TEST_EXPECT_EQ(*static_cast<const Vec4*>(buff.getSlotData(slotB)), b);
+	}
+
+	// Fill the rest of the slots
+	buff.beginFrame();
+	const U32 slotC = buff.acquireSlot(300);
+	const U32 slotD = buff.acquireSlot(400);
+	ANKI_TEST_EXPECT_NEQ(slotC, MAX_U32);
+	ANKI_TEST_EXPECT_NEQ(slotD, MAX_U32);
+	ANKI_TEST_EXPECT_EQ(buff.getUsedSlotRange(), 4);
+	buff.acquireSlot(100);
+
+	// All the slots are used in this frame so it should fail
+	buff.acquireSlot(200);
+	ANKI_TEST_EXPECT_EQ(buff.acquireSlot(500), MAX_U32);
+
+	// In the next frame it should evict the least recently used
+	buff.beginFrame();
+	buff.acquireSlot(100);
+	buff.acquireSlot(300);
+	buff.acquireSlot(400);
+	const U32 slotE = buff.acquireSlot(500);
+	ANKI_TEST_EXPECT_EQ(slotE, slotB);
+	ANKI_TEST_EXPECT_EQ(buff.getEvictedSlotCount(), 1);
+
+	// The new object should be written even if it has the same data
+	buff.writeSlot(slotE, &b);
+	ANKI_TEST_EXPECT_EQ(buff.getWrittenSlotCount(), 1);
+
+	// The evicted object gets the slot of the least recently used one
+	buff.beginFrame();
+	buff.acquireSlot(500);
+	ANKI_TEST_EXPECT_EQ(buff.acquireSlot(200), slotA);
+	ANKI_TEST_EXPECT_EQ(buff.getEvictedSlotCount(), 1);
+}
+
+} // end namespace anki
@@ -0,0 +1,71 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/renderer/ShadowMapping.h>
+
+namespace anki
+{
+
+ANKI_TEST(Renderer, ShadowMappingTileReuse)
+{
+	using TileUpdate = ShadowMapping::TileUpdate;
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	TileAllocator talloc;
+	talloc.init(alloc, 8, 8, 3, true);
+
+	const U64 lightUuid = 1;
+	const U32 lod = 1;
+	Array<U32, 4> viewport;
+
+	// The atlas tile is keyed by the timestamp and the count of the static casters
+	Timestamp frame = 1;
+	Bool hadDynamicCasters = false;
+	auto update = [&](Timestamp staticTimestamp, U32 staticCount, Bool hasDynamicCasters) {
+		const TileAllocatorResult res =
+			talloc.allocate(frame, staticTimestamp, lightUuid, 0, staticCount, lod, viewport);
+		ANKI_TEST_EXPECT_NEQ(res, TileAllocatorResult::ALLOCATION_FAILED);
+
+		const TileUpdate tileUpdate = ShadowMapping::chooseTileUpdate(true, res, hasDynamicCasters, hadDynamicCasters);
+		hadDynamicCasters = hasDynamicCasters;
+		++frame;
+		return tileUpdate;
+	};
+
+	// First time everything is rendered
+	ANKI_TEST_EXPECT_EQ(update(1, 10, false), TileUpdate::STATIC_AND_DYNAMIC_CASTERS);
+
+	// Nothing changed, the tile is reused
+	ANKI_TEST_EXPECT_EQ(update(1, 10, false), TileUpdate::NONE);
+	ANKI_TEST_EXPECT_EQ(update(1, 10, false), TileUpdate::NONE);
+
+	// A static caster starts moving. The static casters need to be rendered again
+	ANKI_TEST_EXPECT_EQ(update(1, 9, true), TileUpdate::STATIC_AND_DYNAMIC_CASTERS);
+
+	// It keeps moving. Only the dynamic casters are rendered
+	ANKI_TEST_EXPECT_EQ(update(1, 9, true), TileUpdate::DYNAMIC_CASTERS);
+
+	// It became static. The static casters are rendered again
+	ANKI_TEST_EXPECT_EQ(update(frame, 10, false), TileUpdate::STATIC_AND_DYNAMIC_CASTERS);
+	const Timestamp staticTimestamp = frame - 1;
+	ANKI_TEST_EXPECT_EQ(update(staticTimestamp, 10, false), TileUpdate::NONE);
+
+	// A dynamic caster passes by without touching the static casters
+	ANKI_TEST_EXPECT_EQ(update(staticTimestamp, 10, true), TileUpdate::DYNAMIC_CASTERS);
+
+	// It's gone but it's still in the tile, resolve once more to remove it
+	ANKI_TEST_EXPECT_EQ(update(staticTimestamp, 10, false), TileUpdate::DYNAMIC_CASTERS);
+	ANKI_TEST_EXPECT_EQ(update(staticTimestamp, 10, false), TileUpdate::NONE);
+
+	// Without the static cache there is no partial update
+	ANKI_TEST_EXPECT_EQ(ShadowMapping::chooseTileUpdate(false, TileAllocatorResult::CACHED, true, true),
+		TileUpdate::NONE);
+	ANKI_TEST_EXPECT_EQ(ShadowMapping::chooseTileUpdate(false, TileAllocatorResult::ALLOCATION_SUCCEEDED, false, false),
+		TileUpdate::ALL_CASTERS);
+}
+
+} // end namespace anki
@@ -0,0 +1,119 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/resource/GpuMemoryBudget.h>
+
+namespace anki
+{
+
+namespace
+{
+
+class FakeStreamedResource final : public GpuMemoryEvictable
+{
+public:
+	PtrSize m_size = 0;
+	PtrSize* m_usedMemory = nullptr;
+	U32 m_evictionCount = 0;
+
+	PtrSize getEvictableGpuMemory() const override
+	{
+		return m_size;
+	}
+
+	void evict() override
+	{
+		ANKI_TEST_EXPECT_EQ(isRegistered(), false);
+		*m_usedMemory -= m_size;
+		++m_evictionCount;
+	}
+};
+
+} // end anonymous namespace
+
+ANKI_TEST(Resource, GpuMemoryBudget)
+{
+	const U32 COUNT = 8;
+	const PtrSize SIZE = 16_MB;
+
+	PtrSize usedMemory = 0;
+	Array<FakeStreamedResource, COUNT> rsrcs;
+	for(FakeStreamedResource& r : rsrcs)
+	{
+		r.m_size = SIZE;
+		r.m_usedMemory = &usedMemory;
+	}
+
+	// Under budget nothing is evicted
+	{
+		GpuMemoryBudget budget;
+		budget.init(COUNT * SIZE, 1);
+
+		for(FakeStreamedResource& r : rsrcs)
+		{
+			budget.registerEvictable(r);
+			usedMemory += SIZE;
+		}
+
+		ANKI_TEST_EXPECT_EQ(budget.getEvictableGpuMemory(), COUNT * SIZE);
+
+		for(U32 frame = 0; frame < 4; ++frame)
+		{
+			ANKI_TEST_EXPECT_EQ(budget.endFrame(usedMemory), 0);
+		}
+
+		for(FakeStreamedResource& r : rsrcs)
+		{
+			ANKI_TEST_EXPECT_EQ(r.m_evictionCount, 0);
+			budget.unregisterEvictable(r);
+			usedMemory -= SIZE;
+		}
+
+		ANKI_TEST_EXPECT_EQ(budget.getEvictableGpuMemory(), 0);
+	}
+
+	// Over budget the least recently used are evicted
+	{
+		GpuMemoryBudget budget;
+		budget.init(4 * SIZE, 1);
+
+		for(FakeStreamedResource& r : rsrcs)
+		{
+			budget.registerEvictable(r);
+			usedMemory += SIZE;
+		}
+
+		// Everything is too recent to be evicted
+		ANKI_TEST_EXPECT_EQ(budget.endFrame(usedMemory), 0);
+
+		// Use the odd ones in the next frames
+		for(U32 frame = 0; frame < 2; ++frame)
+		{
+			for(U32 i = 1; i < COUNT; i += 2)
+			{
+				budget.touch(rsrcs[i]);
+			}
+
+			budget.endFrame(usedMemory);
+		}
+
+		ANKI_TEST_EXPECT_EQ(usedMemory, 4 * SIZE);
+		ANKI_TEST_EXPECT_EQ(budget.getEvictionCount(), 4);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(rsrcs[i].m_evictionCount, (i & 1) ? 0u : 1u);
+			ANKI_TEST_EXPECT_EQ(rsrcs[i].isRegistered(), (i & 1) != 0);
+		}
+
+		// Unregistering the evicted ones is harmless
+		for(FakeStreamedResource& r : rsrcs)
+		{
+			budget.unregisterEvictable(r);
+		}
+	}
+}
+
+} // end namespace anki
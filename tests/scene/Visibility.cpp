@@ -0,0 +1,68 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/scene/VisibilityInternal.h>
+
+namespace anki
+{
+
+ANKI_TEST(Scene, StaticShadowCasters)
+{
+	const Timestamp lightTimestamp = 2;
+
+	// The last time the casters changed. The 2nd moves at frame 10
+	Array<Timestamp, 3> casterTimestamps = {{1, 1, 1}};
+
+	Timestamp prevStaticSetTimestamp = 0;
+	U32 prevStaticCount = 0;
+	for(Timestamp frame = 5; frame < 30; ++frame)
+	{
+		if(frame == 10)
+		{
+			casterTimestamps[1] = frame;
+		}
+
+		// Classify the casters the way the visibility tests do
+		Timestamp staticSetTimestamp = lightTimestamp;
+		U32 staticCount = 0;
+		for(Timestamp casterTimestamp : casterTimestamps)
+		{
+			if(isStaticShadowCaster(casterTimestamp, frame))
+			{
+				staticSetTimestamp = max(staticSetTimestamp, computeStaticShadowCasterTimestamp(casterTimestamp));
+				++staticCount;
+			}
+		}
+
+		// A caster that changed stays dynamic for a few frames
+		const Bool movedRecently = frame >= 10 && frame < 10 + STATIC_SHADOW_CASTER_FRAME_COUNT;
+		ANKI_TEST_EXPECT_EQ(staticCount, (movedRecently) ? 2u : 3u);
+
+		if(frame == 10)
+		{
+			// The caster that started moving lowers the count. That's enough to invalidate the cached tile
+			ANKI_TEST_EXPECT_EQ(staticSetTimestamp, prevStaticSetTimestamp);
+			ANKI_TEST_EXPECT_LT(staticCount, prevStaticCount);
+		}
+		else if(frame == 10 + STATIC_SHADOW_CASTER_FRAME_COUNT)
+		{
+			// The caster became static again. The timestamp changes even if the count is the same as before it moved
+			ANKI_TEST_EXPECT_EQ(staticSetTimestamp, frame);
+			ANKI_TEST_EXPECT_GT(staticSetTimestamp, prevStaticSetTimestamp);
+		}
+		else if(frame > 5)
+		{
+			// Nothing changed, the tile can be reused
+			ANKI_TEST_EXPECT_EQ(staticSetTimestamp, prevStaticSetTimestamp);
+			ANKI_TEST_EXPECT_EQ(staticCount, prevStaticCount);
+		}
+
+		prevStaticSetTimestamp = staticSetTimestamp;
+		prevStaticCount = staticCount;
+	}
+}
+
+} // end namespace anki
@@ -6,6 +6,7 @@
 #include <tests/framework/Framework.h>
 #include <anki/shader_compiler/ShaderProgramCompiler.h>
 #include <anki/util/ThreadHive.h>
+#include <anki/util/Filesystem.h>
 
 ANKI_TEST(ShaderCompiler, ShaderProgramCompilerSimple)
 {
@@ -345,3 +346,370 @@ void main()
 	ANKI_LOGI("Binary disassembly:\n%s\n", dis.cstr());
 #endif
 }
+
+ANKI_TEST(ShaderCompiler, ShaderProgramBatchCompiler)
+{
+	const CString sourceCodeA = R"(
+#pragma anki mutator COLOR 0 1 2
+
+#pragma anki start comp
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout(set = 0, binding = 0) uniform writeonly image2D u_img;
+
+void main()
+{
+	imageStore(u_img, IVec2(gl_GlobalInvocationID.xy), Vec4(F32(COLOR)));
+}
+#pragma anki end
+	)";
+
+	const CString sourceCodeB = R"(
+#pragma anki start vert
+out gl_PerVertex
+{
+	Vec4 gl_Position;
+};
+
+void main()
+{
+	gl_Position = Vec4(gl_VertexID);
+}
+#pragma anki end
+
+#pragma anki start frag
+layout(location = 0) out Vec3 out_color;
+
+void main()
+{
+	out_color = Vec3(1.0);
+}
+#pragma anki end
+	)";
+
+	// Write the files
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("testA.glslp", FileOpenFlag::WRITE));
+		ANKI_TEST_EXPECT_NO_ERR(file.writeText(sourceCodeA));
+	}
+
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("testB.glslp", FileOpenFlag::WRITE));
+		ANKI_TEST_EXPECT_NO_ERR(file.writeText(sourceCodeB));
+	}
+
+	class Fsystem : public ShaderProgramFilesystemInterface
+	{
+	public:
+		Error readAllText(CString filename, StringAuto& txt) final
+		{
+			File file;
+			ANKI_CHECK(file.open(filename, FileOpenFlag::READ));
+			ANKI_CHECK(file.readAllText(txt));
+			return Error::NONE;
+		}
+	} fsystem;
+
+	class PostCompile : public ShaderProgramPostCompileInterface
+	{
+	public:
+		U32 m_count = 0;
+
+		Error programCompiled(const ShaderProgramBinaryWrapper& binary) final
+		{
+			++m_count;
+			return Error::NONE;
+		}
+	} postCompile;
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	ShaderProgramBinaryWrapper binaryA(alloc);
+	ShaderProgramBinaryWrapper binaryB(alloc);
+	BindlessLimits bindlessLimits;
+	GpuDeviceCapabilities gpuCapabilities;
+
+	{
+		ShaderProgramBatchCompiler compiler(fsystem, alloc, gpuCapabilities, bindlessLimits);
+		ANKI_TEST_EXPECT_NO_ERR(compiler.addProgram("testA.glslp", nullptr, &postCompile, binaryA));
+		ANKI_TEST_EXPECT_NO_ERR(compiler.addProgram("testB.glslp", nullptr, &postCompile, binaryB));
+		ANKI_TEST_EXPECT_NO_ERR(compiler.compile(nullptr));
+	}
+
+	ANKI_TEST_EXPECT_EQ(postCompile.m_count, 2);
+
+	ANKI_TEST_EXPECT_EQ(binaryA.getBinary().m_variants.getSize(), 3);
+	ANKI_TEST_EXPECT_EQ(binaryA.getBinary().m_mutations.getSize(), 3);
+	ANKI_TEST_EXPECT_EQ(binaryA.getBinary().m_codeBlocks.getSize(), 3);
+
+	ANKI_TEST_EXPECT_EQ(binaryB.getBinary().m_variants.getSize(), 1);
+	ANKI_TEST_EXPECT_EQ(binaryB.getBinary().m_codeBlocks.getSize(), 2);
+	ANKI_TEST_EXPECT_NEQ(binaryB.getBinary().m_variants[0].m_codeBlockIndices[ShaderType::VERTEX], MAX_U32);
+	ANKI_TEST_EXPECT_NEQ(binaryB.getBinary().m_variants[0].m_codeBlockIndices[ShaderType::FRAGMENT], MAX_U32);
+	ANKI_TEST_EXPECT_EQ(binaryB.getBinary().m_variants[0].m_codeBlockIndices[ShaderType::COMPUTE], MAX_U32);
+
+	// Overwriting a binary doesn't break the processes that have it mapped
+	const CString binFname = "testAB.ankiprogbin";
+	ANKI_TEST_EXPECT_NO_ERR(binaryA.serializeToFile(binFname));
+	{
+		ShaderProgramBinaryWrapper mapped(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(mapped.deserializeFromFile(binFname));
+
+		ANKI_TEST_EXPECT_NO_ERR(binaryB.serializeToFile(binFname));
+		ANKI_TEST_EXPECT_EQ(mapped.getBinary().m_variants.getSize(), 3);
+		ANKI_TEST_EXPECT_EQ(mapped.getBinary().m_codeBlocks.getSize(), 3);
+
+		ShaderProgramBinaryWrapper newer(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(newer.deserializeFromFile(binFname));
+		ANKI_TEST_EXPECT_EQ(newer.getBinary().m_variants.getSize(), 1);
+	}
+
+	// A failed load can be followed by a good one
+	{
+		ShaderProgramBinaryWrapper wrapper(alloc);
+
+		const CString garbageFname = "testGarbage.ankiprogbin";
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(garbageFname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+			ANKI_TEST_EXPECT_NO_ERR(file.writeText("Not a shader binary"));
+		}
+
+		ANKI_TEST_EXPECT_ANY_ERR(wrapper.deserializeFromFile(garbageFname));
+		ANKI_TEST_EXPECT_NO_ERR(wrapper.deserializeFromFile(binFname));
+		ANKI_TEST_EXPECT_EQ(wrapper.getBinary().m_variants.getSize(), 1);
+	}
+}
+
+ANKI_TEST(ShaderCompiler, ShaderProgramFallbackMutation)
+{
+	// A program with 3 mutators where only a few variants were compiled
+	Array<MutatorValue, 2> values01 = {{0, 1}};
+	Array<ShaderProgramBinaryMutator, 3> mutators;
+	for(ShaderProgramBinaryMutator& m : mutators)
+	{
+		m.m_values = values01;
+	}
+
+	Array<Array<MutatorValue, 3>, 4> mutationValues = {{{{0, 0, 0}}, {{0, 1, 1}}, {{1, 0, 1}}, {{1, 1, 0}}}};
+	Array<ShaderProgramBinaryMutation, 4> mutations;
+	for(U32 i = 0; i < mutations.getSize(); ++i)
+	{
+		mutations[i].m_values = mutationValues[i];
+		mutations[i].m_variantIndex = (i == 3) ? MAX_U32 : i; // The last was skipped
+		mutations[i].m_hash = i + 1;
+	}
+
+	Array<ShaderProgramBinaryVariant, 3> variants;
+
+	ShaderProgramBinary binary;
+	binary.m_mutators = mutators;
+	binary.m_mutations = mutations;
+	binary.m_variants = variants;
+
+	BitSet<64, U64> noExact(false);
+	BitSet<64, U64> exactFirst(false);
+	exactFirst.set(0);
+	BitSet<64, U64> exactSecond(false);
+	exactSecond.set(1);
+
+	// The first mutators are the most important
+	{
+		Array<MutatorValue, 3> mutation = {{1, 1, 1}};
+		const ShaderProgramBinaryMutation* m = findShaderProgramFallbackMutation(binary, mutation, noExact);
+		ANKI_TEST_EXPECT_EQ(m, &mutations[2]);
+	}
+
+	// The exact mutators win over the order
+	{
+		Array<MutatorValue, 3> mutation = {{1, 1, 1}};
+		const ShaderProgramBinaryMutation* m = findShaderProgramFallbackMutation(binary, mutation, exactSecond);
+		ANKI_TEST_EXPECT_EQ(m, &mutations[1]);
+	}
+
+	// The skipped variants are never used
+	{
+		Array<MutatorValue, 3> mutation = {{1, 1, 0}};
+		const ShaderProgramBinaryMutation* m = findShaderProgramFallbackMutation(binary, mutation, exactFirst);
+		ANKI_TEST_EXPECT_EQ(m, &mutations[2]);
+	}
+
+	// No variant matches the exact mutators
+	{
+		mutations[2].m_variantIndex = MAX_U32;
+		Array<MutatorValue, 3> mutation = {{1, 1, 1}};
+		const ShaderProgramBinaryMutation* m = findShaderProgramFallbackMutation(binary, mutation, exactFirst);
+		ANKI_TEST_EXPECT_EQ(m, nullptr);
+	}
+}
+
+ANKI_TEST(ShaderCompiler, ShaderProgramUsedMutations)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const CString dir = "/tmp/anki_used_mutations_test";
+	if(directoryExists(dir))
+	{
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir, alloc));
+	}
+	ANKI_TEST_EXPECT_NO_ERR(createDirectory(dir));
+
+	StringAuto fname(alloc);
+	fname.sprintf("%s/variants", dir.cstr());
+
+	// Missing file
+	{
+		ShaderProgramUsedMutations record(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(record.load(fname));
+		ANKI_TEST_EXPECT_EQ(record.getMutationHashes().getSize(), 0);
+
+		ANKI_TEST_EXPECT_EQ(record.add(123), true);
+		ANKI_TEST_EXPECT_EQ(record.add(456), true);
+		ANKI_TEST_EXPECT_EQ(record.add(123), false);
+		ANKI_TEST_EXPECT_EQ(record.getMutationHashes().getSize(), 2);
+		ANKI_TEST_EXPECT_NO_ERR(record.save(fname));
+	}
+
+	// Load it back
+	{
+		ShaderProgramUsedMutations record(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(record.load(fname));
+		ANKI_TEST_EXPECT_EQ(record.getMutationHashes().getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(record.contains(123), true);
+		ANKI_TEST_EXPECT_EQ(record.contains(456), true);
+		ANKI_TEST_EXPECT_EQ(record.contains(789), false);
+	}
+
+	// A corrupted file is ignored
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open(fname, FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		ANKI_TEST_EXPECT_NO_ERR(file.write("garbage", 7));
+	}
+
+	{
+		ShaderProgramUsedMutations record(alloc);
+		ANKI_TEST_EXPECT_NO_ERR(record.load(fname));
+		ANKI_TEST_EXPECT_EQ(record.getMutationHashes().getSize(), 0);
+	}
+
+	ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir, alloc));
+}
+
+ANKI_TEST(ShaderCompiler, ShaderProgramCompilerLazyVariants)
+{
+	const CString sourceCode = R"(
+#pragma anki mutator ANKI_PASS 0 1
+#pragma anki mutator COLOR 0 1 2
+
+#pragma anki start comp
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout(set = 0, binding = 0) uniform writeonly image2D u_img;
+
+void main()
+{
+	imageStore(u_img, IVec2(gl_GlobalInvocationID.xy), Vec4(F32(COLOR + ANKI_PASS)));
+}
+#pragma anki end
+	)";
+
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("testLazy.glslp", FileOpenFlag::WRITE));
+		ANKI_TEST_EXPECT_NO_ERR(file.writeText(sourceCode));
+	}
+
+	class Fsystem : public ShaderProgramFilesystemInterface
+	{
+	public:
+		Error readAllText(CString filename, StringAuto& txt) final
+		{
+			File file;
+			ANKI_CHECK(file.open(filename, FileOpenFlag::READ));
+			ANKI_CHECK(file.readAllText(txt));
+			return Error::NONE;
+		}
+	} fsystem;
+
+	class PostParse : public ShaderProgramPostParseInterface
+	{
+	public:
+		ShaderProgramUsedMutations* m_record = nullptr;
+
+		Bool skipCompilation(U64 programHash) final
+		{
+			return false;
+		}
+
+		Bool skipVariant(U64 mutationHash) final
+		{
+			return !m_record->contains(mutationHash);
+		}
+	};
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	BindlessLimits bindlessLimits;
+	GpuDeviceCapabilities gpuCapabilities;
+
+	// Compile everything to get the mutations
+	ShaderProgramBinaryWrapper fullBinary(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgram(
+		"testLazy.glslp", fsystem, nullptr, nullptr, alloc, gpuCapabilities, bindlessLimits, fullBinary));
+	ANKI_TEST_EXPECT_EQ(fullBinary.getBinary().m_mutations.getSize(), 6);
+
+	// Record the use of 2 of them and compile only those
+	ShaderProgramUsedMutations record(alloc);
+	const ShaderProgramBinaryMutation* skippedMutation = nullptr;
+	for(const ShaderProgramBinaryMutation& mutation : fullBinary.getBinary().m_mutations)
+	{
+		if(mutation.m_values[0] == 0 && mutation.m_values[1] != 2)
+		{
+			record.add(mutation.m_hash);
+		}
+		else if(mutation.m_values[0] == 0)
+		{
+			skippedMutation = &mutation;
+		}
+	}
+	ANKI_TEST_EXPECT_EQ(record.getMutationHashes().getSize(), 2);
+	ANKI_TEST_EXPECT_NEQ(skippedMutation, nullptr);
+
+	PostParse postParse;
+	postParse.m_record = &record;
+	ShaderProgramBinaryWrapper binary(alloc);
+	{
+		ShaderProgramBatchCompiler compiler(fsystem, alloc, gpuCapabilities, bindlessLimits);
+		ANKI_TEST_EXPECT_NO_ERR(compiler.addProgram("testLazy.glslp", &postParse, nullptr, binary));
+		ANKI_TEST_EXPECT_NO_ERR(compiler.compile(nullptr));
+	}
+
+	ANKI_TEST_EXPECT_EQ(binary.getBinary().m_variants.getSize(), 2);
+	ANKI_TEST_EXPECT_EQ(binary.getBinary().m_mutations.getSize(), 6);
+
+	// The fallback of a skipped variant should have the same pass
+	BitSet<64, U64> exactMutators(false);
+	exactMutators.set(0);
+	const ShaderProgramBinaryMutation* fallback =
+		findShaderProgramFallbackMutation(binary.getBinary(), skippedMutation->m_values, exactMutators);
+	ANKI_TEST_EXPECT_NEQ(fallback, nullptr);
+	ANKI_TEST_EXPECT_EQ(fallback->m_values[0], 0);
+	ANKI_TEST_EXPECT_NEQ(fallback->m_variantIndex, MAX_U32);
+
+	// There is no variant for the other pass
+	Array<MutatorValue, 2> otherPass = {{1, 0}};
+	ANKI_TEST_EXPECT_EQ(findShaderProgramFallbackMutation(binary.getBinary(), otherPass, exactMutators), nullptr);
+
+	// Compile the skipped variant on demand
+	ShaderProgramBinaryWrapper variantBinary(alloc);
+	ANKI_TEST_EXPECT_NO_ERR(compileShaderProgramVariant("testLazy.glslp",
+		skippedMutation->m_hash,
+		binary.getBinary(),
+		fsystem,
+		alloc,
+		gpuCapabilities,
+		bindlessLimits,
+		variantBinary));
+	ANKI_TEST_EXPECT_EQ(variantBinary.getBinary().m_variants.getSize(), 1);
+}
@@ -63,3 +63,73 @@ ANKI_TEST(ShaderCompiler, ShaderCompilerParser)
 
 	// printf("%s\n", variant.getSource(ShaderType::VERTEX).cstr());
 }
+
+ANKI_TEST(ShaderCompiler, ShaderProgramParserCache)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	class FilesystemInterface : public ShaderProgramFilesystemInterface
+	{
+	public:
+		U32 m_readCount = 0;
+
+		Error readAllText(CString filename, StringAuto& txt) final
+		{
+			++m_readCount;
+
+			if(filename == "common.glsl")
+			{
+				txt = R"(
+#pragma once
+#define COMMON 1
+				)";
+			}
+			else if(filename == "prog0.ankiprog" || filename == "prog1.ankiprog")
+			{
+				txt = R"(
+#include <common.glsl>
+#pragma anki mutator M0 1 2
+#pragma anki start comp
+#include "common.glsl"
+#pragma anki end
+				)";
+			}
+			else
+			{
+				return Error::FUNCTION_FAILED;
+			}
+
+			return Error::NONE;
+		}
+	} interface;
+
+	BindlessLimits bindlessLimits;
+	GpuDeviceCapabilities gpuCapabilities;
+	ShaderProgramParserCache cache(alloc);
+
+	{
+		ShaderProgramParser parser("prog0.ankiprog", &interface, alloc, gpuCapabilities, bindlessLimits, &cache);
+		ANKI_TEST_EXPECT_NO_ERR(parser.parse());
+
+		ANKI_TEST_EXPECT_EQ(parser.getDependencies().getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(parser.getDependencies()[0]->getFilename(), "prog0.ankiprog");
+		ANKI_TEST_EXPECT_EQ(parser.getDependencies()[1]->getFilename(), "common.glsl");
+		ANKI_TEST_EXPECT_NEQ(parser.getDependencies()[0]->getHash(), 0);
+
+		// The second include was served by the cache
+		ANKI_TEST_EXPECT_EQ(interface.m_readCount, 2);
+		ANKI_TEST_EXPECT_EQ(cache.getMissCount(), 2);
+		ANKI_TEST_EXPECT_EQ(cache.getHitCount(), 1);
+	}
+
+	{
+		ShaderProgramParser parser("prog1.ankiprog", &interface, alloc, gpuCapabilities, bindlessLimits, &cache);
+		ANKI_TEST_EXPECT_NO_ERR(parser.parse());
+		ANKI_TEST_EXPECT_EQ(parser.getDependencies().getSize(), 2);
+
+		// Only the new program was loaded
+		ANKI_TEST_EXPECT_EQ(interface.m_readCount, 3);
+		ANKI_TEST_EXPECT_EQ(cache.getMissCount(), 3);
+		ANKI_TEST_EXPECT_EQ(cache.getHitCount(), 3);
+	}
+}
@@ -0,0 +1,159 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/shader_compiler/SpirvCache.h>
+#include <anki/util/Filesystem.h>
+#include <anki/util/File.h>
+
+ANKI_TEST(ShaderCompiler, SpirvCache)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	const CString cacheDir = "./spirv_cache";
+	if(directoryExists(cacheDir))
+	{
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(cacheDir, alloc));
+	}
+
+	// Some fake SPIR-V
+	Array<U32, 4> spirvA = {{0x07230203, 1, 2, 3}};
+	Array<U32, 3> spirvB = {{0x07230203, 4, 5}};
+	const ConstWeakArray<U8> spirvABytes(reinterpret_cast<const U8*>(&spirvA[0]), spirvA.getSizeInBytes());
+	const ConstWeakArray<U8> spirvBBytes(reinterpret_cast<const U8*>(&spirvB[0]), spirvB.getSizeInBytes());
+
+	// Store
+	{
+		SpirvCache cache;
+		ANKI_TEST_EXPECT_NO_ERR(cache.init(alloc, cacheDir));
+
+		DynamicArrayAuto<U8> spirv(alloc);
+		Bool found;
+		ANKI_TEST_EXPECT_NO_ERR(cache.find(123, spirv, found));
+		ANKI_TEST_EXPECT_EQ(found, false);
+
+		ANKI_TEST_EXPECT_NO_ERR(cache.store(123, spirvABytes));
+		ANKI_TEST_EXPECT_NO_ERR(cache.store(456, spirvBBytes));
+
+		ANKI_TEST_EXPECT_NO_ERR(cache.find(123, spirv, found));
+		ANKI_TEST_EXPECT_EQ(found, true);
+		ANKI_TEST_EXPECT_EQ(spirv.getSizeInBytes(), spirvA.getSizeInBytes());
+		ANKI_TEST_EXPECT_EQ(memcmp(&spirv[0], &spirvA[0], spirvA.getSizeInBytes()), 0);
+
+		ANKI_TEST_EXPECT_EQ(cache.getHitCount(), 1);
+		ANKI_TEST_EXPECT_EQ(cache.getMissCount(), 1);
+	}
+
+	// A new cache should find the entries on the disk
+	{
+		SpirvCache cache;
+		ANKI_TEST_EXPECT_NO_ERR(cache.init(alloc, cacheDir));
+
+		DynamicArrayAuto<U8> spirv(alloc);
+		Bool found;
+		ANKI_TEST_EXPECT_NO_ERR(cache.find(456, spirv, found));
+		ANKI_TEST_EXPECT_EQ(found, true);
+		ANKI_TEST_EXPECT_EQ(spirv.getSizeInBytes(), spirvB.getSizeInBytes());
+		ANKI_TEST_EXPECT_EQ(memcmp(&spirv[0], &spirvB[0], spirvB.getSizeInBytes()), 0);
+
+		ANKI_TEST_EXPECT_NO_ERR(cache.find(789, spirv, found));
+		ANKI_TEST_EXPECT_EQ(found, false);
+	}
+
+	// Corrupted and truncated entries are ignored
+	{
+		StringAuto fname(alloc);
+		fname.sprintf("%s/%016" PRIx64 ".spv", cacheDir.cstr(), U64(456));
+		DynamicArrayAuto<U8> data(alloc);
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(fname.toCString(), FileOpenFlag::READ | FileOpenFlag::BINARY));
+			data.create(U32(file.getSize()));
+			ANKI_TEST_EXPECT_NO_ERR(file.read(&data[0], data.getSize()));
+		}
+
+		// Flip a byte of the SPIR-V
+		data.getBack() ^= 0xFF;
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(fname.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+			ANKI_TEST_EXPECT_NO_ERR(file.write(&data[0], data.getSize()));
+		}
+
+		SpirvCache cache;
+		ANKI_TEST_EXPECT_NO_ERR(cache.init(alloc, cacheDir));
+		DynamicArrayAuto<U8> spirv(alloc);
+		Bool found;
+		ANKI_TEST_EXPECT_NO_ERR(cache.find(456, spirv, found));
+		ANKI_TEST_EXPECT_EQ(found, false);
+
+		// Drop the last word
+		data.getBack() ^= 0xFF;
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(fname.toCString(), FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+			ANKI_TEST_EXPECT_NO_ERR(file.write(&data[0], data.getSize() - sizeof(U32)));
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(cache.find(456, spirv, found));
+		ANKI_TEST_EXPECT_EQ(found, false);
+
+		// Storing it again fixes it
+		ANKI_TEST_EXPECT_NO_ERR(cache.store(456, spirvBBytes));
+	}
+
+	{
+		SpirvCache cache;
+		ANKI_TEST_EXPECT_NO_ERR(cache.init(alloc, cacheDir));
+		DynamicArrayAuto<U8> spirv(alloc);
+		Bool found;
+		ANKI_TEST_EXPECT_NO_ERR(cache.find(456, spirv, found));
+		ANKI_TEST_EXPECT_EQ(found, true);
+		ANKI_TEST_EXPECT_EQ(memcmp(&spirv[0], &spirvB[0], spirvB.getSizeInBytes()), 0);
+	}
+
+	ANKI_TEST_EXPECT_NO_ERR(removeDirectory(cacheDir, alloc));
+}
+
+ANKI_TEST(ShaderCompiler, SpirvCacheKey)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const CString sourceA = R"(#version 450 core
+#define FOO 1
+void main()
+{
+	gl_Position = vec4(FOO);
+}
+)";
+
+	// Only a comment and an unused macro are different
+	const CString sourceB = R"(#version 450 core
+#define FOO 1
+#define UNUSED 2
+// A comment
+void main()
+{
+	gl_Position = vec4(FOO);
+}
+)";
+
+	const CString sourceC = R"(#version 450 core
+#define FOO 2
+void main()
+{
+	gl_Position = vec4(FOO);
+}
+)";
+
+	U64 keyA, keyB, keyC, keyD;
+	ANKI_TEST_EXPECT_NO_ERR(SpirvCache::computeKey(sourceA, ShaderType::VERTEX, alloc, keyA));
+	ANKI_TEST_EXPECT_NO_ERR(SpirvCache::computeKey(sourceB, ShaderType::VERTEX, alloc, keyB));
+	ANKI_TEST_EXPECT_NO_ERR(SpirvCache::computeKey(sourceC, ShaderType::VERTEX, alloc, keyC));
+	ANKI_TEST_EXPECT_NO_ERR(SpirvCache::computeKey(sourceA, ShaderType::FRAGMENT, alloc, keyD));
+
+	ANKI_TEST_EXPECT_EQ(keyA, keyB);
+	ANKI_TEST_EXPECT_NEQ(keyA, keyC);
+	ANKI_TEST_EXPECT_NEQ(keyA, keyD);
+}
@@ -0,0 +1,284 @@
+// Copyright (C) 2009-2020, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <tests/framework/Framework.h>
+#include <anki/util/ConcurrentPointerMap.h>
+#include <anki/util/HashMap.h>
+#include <anki/util/DynamicArray.h>
+#include <anki/util/Thread.h>
+#include <anki/util/HighRezTimer.h>
+#include <anki/util/Hash.h>
+#include <anki/util/System.h>
+
+namespace anki
+{
+
+namespace
+{
+
+class CpmValue
+{
+public:
+	U64 m_key;
+};
+
+class CpmHasher
+{
+public:
+	U64 operator()(U64 x)
+	{
+		return x;
+	}
+};
+
+/// The keys of a few frames of drawcalls. A few hundred pipelines, some of them are used a lot more than the others.
+static void recordHashStream(U32 distinctCount, U32 length, DynamicArrayAuto<U64>& stream)
+{
+	stream.create(length);
+	U32 seed = 0x1234;
+	for(U32 i = 0; i < length; ++i)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		const U32 r = seed >> 8;
+
+		// Square it to make the small indices more common
+		const U32 idx = U32((U64(r % distinctCount) * (r % distinctCount)) / distinctCount);
+		stream[i] = computeHash(&idx, sizeof(idx));
+	}
+}
+
+class CpmBenchContext
+{
+public:
+	const DynamicArrayAuto<U64>* m_stream = nullptr;
+	ConcurrentPointerMap<CpmValue>* m_lockFreeMap = nullptr;
+	HashMap<U64, CpmValue*, CpmHasher>* m_map = nullptr;
+	SpinLock m_spinLock;
+	RWMutex m_rwMutex;
+	U32 m_mode = 0;
+	U32 m_repeat = 0;
+	Barrier* m_barrier = nullptr;
+	Atomic<U64> m_checksum = {0};
+	Atomic<U64> m_totalNs = {0};
+};
+
+static Error cpmBenchThread(ThreadCallbackInfo& info)
+{
+	CpmBenchContext& ctx = *static_cast<CpmBenchContext*>(info.m_userData);
+	const DynamicArrayAuto<U64>& stream = *ctx.m_stream;
+
+	ctx.m_barrier->wait();
+
+	U64 checksum = 0;
+	const Second begin = HighRezTimer::getCurrentTime();
+	for(U32 r = 0; r < ctx.m_repeat; ++r)
+	{
+		for(U64 key : stream)
+		{
+			const CpmValue* val;
+			if(ctx.m_mode == 0)
+			{
+				val = ctx.m_lockFreeMap->find(key);
+			}
+			else if(ctx.m_mode == 1)
+			{
+				LockGuard<SpinLock> lock(ctx.m_spinLock);
+				val = *ctx.m_map->find(key);
+			}
+			else
+			{
+				RLockGuard<RWMutex> lock(ctx.m_rwMutex);
+				val = *ctx.m_map->find(key);
+			}
+
+			checksum += val->m_key;
+		}
+	}
+	const Second end = HighRezTimer::getCurrentTime();
+
+	ctx.m_checksum.fetchAdd(checksum);
+	ctx.m_totalNs.fetchAdd(U64((end - begin) * 1000000000.0));
+	return Error::NONE;
+}
+
+} // end anonymous namespace
+
+ANKI_TEST(Util, ConcurrentPointerMap)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Insert, find and grow
+	{
+		const U32 COUNT = 1000;
+		DynamicArrayAuto<CpmValue> vals(alloc);
+		vals.create(COUNT);
+
+		ConcurrentPointerMap<CpmValue> map;
+		ANKI_TEST_EXPECT_EQ(map.find(123), nullptr);
+
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			vals[i].m_key = (i + 1) * 7;
+			map.insert(alloc, vals[i].m_key, &vals[i]);
+		}
+
+		ANKI_TEST_EXPECT_EQ(map.getSize(), COUNT);
+
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(map.find((i + 1) * 7), &vals[i]);
+			ANKI_TEST_EXPECT_EQ(map.find((i + 1) * 7 + 1), nullptr);
+		}
+
+		U32 count = 0;
+		map.iterate([&](U64 key, CpmValue* val) {
+			ANKI_TEST_EXPECT_EQ(key, val->m_key);
+			++count;
+		});
+		ANKI_TEST_EXPECT_EQ(count, COUNT);
+
+		map.destroy(alloc);
+	}
+
+	// Readers while inserting
+	{
+		const U32 COUNT = 20000;
+		const U32 READER_COUNT = 3;
+
+		class Ctx
+		{
+		public:
+			ConcurrentPointerMap<CpmValue> m_map;
+			DynamicArrayAuto<CpmValue> m_vals;
+			Atomic<U32> m_published = {0};
+			Atomic<U32> m_errors = {0};
+
+			Ctx(HeapAllocator<U8> alloc)
+				: m_vals(alloc)
+			{
+			}
+		} ctx(alloc);
+
+		ctx.m_vals.create(COUNT);
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ctx.m_vals[i].m_key = i + 1;
+		}
+
+		Array<Thread*, READER_COUNT> readers;
+		for(Thread*& thread : readers)
+		{
+			thread = alloc.newInstance<Thread>("Reader");
+			thread->start(&ctx, [](ThreadCallbackInfo& info) -> Error {
+				Ctx& ctx = *static_cast<Ctx*>(info.m_userData);
+				U32 published;
+				do
+				{
+					published = ctx.m_published.load(AtomicMemoryOrder::ACQUIRE);
+
+					// Everything that is published should be found and be correct
+					for(U32 i = 0; i < published; i += 7)
+					{
+						const CpmValue* val = ctx.m_map.find(i + 1);
+						if(val == nullptr || val->m_key != i + 1)
+						{
+							ctx.m_errors.fetchAdd(1);
+						}
+					}
+				} while(published < COUNT);
+
+				return Error::NONE;
+			});
+		}
+
+		for(U32 i = 0; i < COUNT; ++i)
+		{
+			ctx.m_map.insert(alloc, i + 1, &ctx.m_vals[i]);
+			ctx.m_published.store(i + 1, AtomicMemoryOrder::RELEASE);
+		}
+
+		for(Thread* thread : readers)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(thread->join());
+			alloc.deleteInstance(thread);
+		}
+
+		ANKI_TEST_EXPECT_EQ(ctx.m_errors.load(), 0);
+		ctx.m_map.destroy(alloc);
+	}
+}
+
+/// Replays a stream of cache hits from many threads, like the pipeline and descriptor set caches get from the parallel
+/// command buffer recording. Compares the lock-free lookups with the locked ones.
+ANKI_TEST(Util, ConcurrentPointerMapBench)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	const U32 DISTINCT_COUNT = 512;
+	const U32 STREAM_LENGTH = 64 * 1024;
+	const U32 REPEAT = 16;
+	const U32 THREAD_COUNT = max<U32>(2, min<U32>(8, getCpuCoresCount()));
+
+	DynamicArrayAuto<U64> stream(alloc);
+	recordHashStream(DISTINCT_COUNT, STREAM_LENGTH, stream);
+
+	// Populate the maps with all the keys of the stream
+	ConcurrentPointerMap<CpmValue> lockFreeMap;
+	HashMap<U64, CpmValue*, CpmHasher> map;
+	DynamicArrayAuto<CpmValue> vals(alloc);
+	vals.create(DISTINCT_COUNT);
+	U32 valCount = 0;
+	for(U64 key : stream)
+	{
+		if(lockFreeMap.find(key) == nullptr)
+		{
+			ANKI_TEST_EXPECT_LT(valCount, DISTINCT_COUNT);
+			CpmValue* val = &vals[valCount++];
+			val->m_key = key;
+			lockFreeMap.insert(alloc, key, val);
+			map.emplace(alloc, key, val);
+		}
+	}
+
+	const Array<const char*, 3> names = {{"Lock-free", "SpinLock", "RWMutex read lock"}};
+	for(U32 mode = 0; mode < 3; ++mode)
+	{
+		CpmBenchContext ctx;
+		ctx.m_stream = &stream;
+		ctx.m_lockFreeMap = &lockFreeMap;
+		ctx.m_map = &map;
+		ctx.m_mode = mode;
+		ctx.m_repeat = REPEAT;
+
+		Barrier barrier(THREAD_COUNT);
+		ctx.m_barrier = &barrier;
+
+		DynamicArrayAuto<Thread*> threads(alloc);
+		threads.create(THREAD_COUNT);
+		for(Thread*& thread : threads)
+		{
+			thread = alloc.newInstance<Thread>("Bench");
+			thread->start(&ctx, cpmBenchThread);
+		}
+
+		for(Thread* thread : threads)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(thread->join());
+			alloc.deleteInstance(thread);
+		}
+
+		const F64 lookupCount = F64(STREAM_LENGTH) * REPEAT * THREAD_COUNT;
+		ANKI_TEST_LOGI("%s: %u threads, %.2fns per hit (checksum %" PRIu64 ")",
+			names[mode],
+			THREAD_COUNT,
+			F64(ctx.m_totalNs.load()) / lookupCount,
+			ctx.m_checksum.load());
+	}
+
+	lockFreeMap.destroy(alloc);
+	map.destroy(alloc);
+}
+
+} // end namespace anki
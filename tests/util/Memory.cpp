@@ -218,3 +218,132 @@ ANKI_TEST(Util, ChainMemoryPool)
 		ANKI_TEST_EXPECT_EQ(pool.getChunksCount(), 0);
 	}
 }
+
+ANKI_TEST(Util, MemoryTracker)
+{
+	MemoryTracker& tracker = MemoryTrackerSingleton::get();
+
+	// Heap
+	{
+		MemoryTrackerSnapshot before;
+		tracker.getSnapshot(before);
+
+		HeapMemoryPool pool;
+		pool.create(allocAligned, nullptr);
+		pool.setMemoryTag(MemoryTag::SCENE);
+
+		void* a = pool.allocate(100, 64);
+		ANKI_TEST_EXPECT_NEQ(a, nullptr);
+		ANKI_TEST_EXPECT_EQ(isAligned(64, a), true);
+		void* b = pool.allocate(1000, 1);
+#if ANKI_MEM_USE_HEAP_HEADERS
+		ANKI_TEST_EXPECT_GEQ(pool.getMemoryUsage(), 1100);
+#endif
+
+		pool.flushMemoryStats();
+		MemoryTrackerSnapshot middle;
+		tracker.getSnapshot(middle);
+		MemoryTagStatsDiff diff = middle.diff(before, MemoryTag::SCENE);
+		ANKI_TEST_EXPECT_EQ(diff.m_memoryUsage, I64(pool.getMemoryUsage()));
+		ANKI_TEST_EXPECT_EQ(diff.m_allocationCount, 2);
+		ANKI_TEST_EXPECT_EQ(diff.m_freeCount, 0);
+		ANKI_TEST_EXPECT_GEQ(middle.m_tags[MemoryTag::SCENE].m_peakMemoryUsage, pool.getMemoryUsage());
+
+		const PtrSize peak = pool.getMemoryUsage();
+		pool.free(a);
+		pool.free(b);
+		ANKI_TEST_EXPECT_EQ(pool.getMemoryUsage(), 0);
+		ANKI_TEST_EXPECT_EQ(pool.getPeakMemoryUsage(), peak);
+
+		pool.flushMemoryStats();
+		MemoryTrackerSnapshot after;
+		tracker.getSnapshot(after);
+		diff = after.diff(before, MemoryTag::SCENE);
+		ANKI_TEST_EXPECT_EQ(diff.m_memoryUsage, 0);
+		ANKI_TEST_EXPECT_EQ(diff.getLiveAllocationCount(), 0);
+	}
+
+	// Stack and re-tagging
+	{
+		MemoryTrackerSnapshot before;
+		tracker.getSnapshot(before);
+
+		StackMemoryPool pool;
+		pool.create(allocAligned, nullptr, 1024, 1.0, 0, true, 16);
+		ANKI_TEST_EXPECT_EQ(pool.getMemoryUsage(), 1024);
+
+		pool.setMemoryTag(MemoryTag::RENDERER);
+		void* a = pool.allocate(800, 16);
+		void* b = pool.allocate(800, 16);
+		ANKI_TEST_EXPECT_NEQ(a, nullptr);
+		ANKI_TEST_EXPECT_NEQ(b, nullptr);
+		ANKI_TEST_EXPECT_EQ(pool.getMemoryUsage(), 2048);
+
+		pool.flushMemoryStats();
+		MemoryTrackerSnapshot middle;
+		tracker.getSnapshot(middle);
+		ANKI_TEST_EXPECT_EQ(middle.diff(before, MemoryTag::RENDERER).m_memoryUsage, 2048);
+		ANKI_TEST_EXPECT_EQ(middle.diff(before, MemoryTag::RENDERER).m_allocationCount, 2);
+		ANKI_TEST_EXPECT_EQ(middle.diff(before, MemoryTag::UNTAGGED).m_memoryUsage, 0);
+		ANKI_TEST_EXPECT_EQ(middle.diffTotal(before).m_memoryUsage, 2048);
+
+		pool.reset();
+		pool.flushMemoryStats();
+		MemoryTrackerSnapshot afterReset;
+		tracker.getSnapshot(afterReset);
+		ANKI_TEST_EXPECT_EQ(afterReset.diff(before, MemoryTag::RENDERER).getLiveAllocationCount(), 0);
+	}
+
+	// The counts of a pool that is destroyed before a snapshot are not lost
+	{
+		MemoryTrackerSnapshot before;
+		tracker.getSnapshot(before);
+
+		{
+			HeapMemoryPool pool;
+			pool.create(allocAligned, nullptr);
+			pool.setMemoryTag(MemoryTag::PHYSICS);
+			void* a = pool.allocate(10, 1);
+			void* b = pool.allocate(10, 1);
+			pool.free(a);
+			pool.setMemoryTag(MemoryTag::SCRIPT);
+			pool.free(b);
+		}
+
+		MemoryTrackerSnapshot after;
+		tracker.getSnapshot(after);
+		ANKI_TEST_EXPECT_EQ(after.diff(before, MemoryTag::PHYSICS).m_allocationCount, 2);
+		ANKI_TEST_EXPECT_EQ(after.diff(before, MemoryTag::PHYSICS).m_freeCount, 1);
+		ANKI_TEST_EXPECT_EQ(after.diff(before, MemoryTag::SCRIPT).m_allocationCount, 0);
+		ANKI_TEST_EXPECT_EQ(after.diff(before, MemoryTag::SCRIPT).m_freeCount, 1);
+		ANKI_TEST_EXPECT_EQ(after.diffTotal(before).m_memoryUsage, 0);
+	}
+
+	// The pools pass their stats to the tracker on their own every few allocations
+	{
+		MemoryTrackerSnapshot before;
+		tracker.getSnapshot(before);
+
+		HeapMemoryPool pool;
+		pool.create(allocAligned, nullptr);
+		pool.setMemoryTag(MemoryTag::UI);
+
+		Array<void*, 100> ptrs;
+		for(void*& ptr : ptrs)
+		{
+			ptr = pool.allocate(8, 8);
+		}
+
+		MemoryTrackerSnapshot middle;
+		tracker.getSnapshot(middle);
+		ANKI_TEST_EXPECT_GEQ(middle.diff(before, MemoryTag::UI).m_allocationCount, 64);
+		ANKI_TEST_EXPECT_LEQ(middle.diff(before, MemoryTag::UI).m_allocationCount, ptrs.getSize());
+
+		for(void* ptr : ptrs)
+		{
+			pool.free(ptr);
+		}
+	}
+
+	ANKI_TEST_EXPECT_EQ(strcmp(MemoryTracker::getTagName(MemoryTag::RENDERER), "Renderer"), 0);
+}
@@ -5,6 +5,7 @@
 
 #include <tests/framework/Framework.h>
 #include <anki/util/Serializer.h>
+#include <anki/util/MappedFile.h>
 #include <tests/util/SerializerTest.h>
 
 ANKI_TEST(Util, BinarySerializer)
@@ -67,3 +68,51 @@ ANKI_TEST(Util, BinarySerializer)
 		alloc.deleteInstance(pa);
 	}
 }
+
+ANKI_TEST(Util, BinarySerializerInPlace)
+{
+	Array<U32, 3> bDarr = {{0xFF12EE34, 0xAA12BB34, 0xCC12DD34}};
+	Array<ClassB, 1> b = {};
+	b[0].m_array[2] = 4;
+	b[0].m_darray = bDarr;
+
+	ClassA a = {};
+	a.m_u64 = 0x123456789ABCDEFF;
+	a.m_darray = b;
+
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+
+	// Serialize
+	{
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin", FileOpenFlag::WRITE | FileOpenFlag::BINARY));
+		BinarySerializer serializer;
+
+		ANKI_TEST_EXPECT_NO_ERR(serializer.serialize(a, alloc, file));
+	}
+
+	// Deserialize
+	{
+		MappedFile file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("serialized.bin"));
+
+		ClassA* pa;
+		ANKI_TEST_EXPECT_NO_ERR(BinaryDeserializer::deserializeInPlace(pa, file.getData(), file.getSize()));
+
+		// The struct lives in the file
+		ANKI_TEST_EXPECT_GEQ(ptrToNumber(pa), ptrToNumber(file.getData()));
+		ANKI_TEST_EXPECT_LEQ(ptrToNumber(pa + 1), ptrToNumber(file.getData() + file.getSize()));
+
+		ANKI_TEST_EXPECT_EQ(pa->m_u64, a.m_u64);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray.getSize(), 1);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_array[2], 4);
+		ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_darray.getSize(), bDarr.getSize());
+		for(U32 j = 0; j < bDarr.getSize(); ++j)
+		{
+			ANKI_TEST_EXPECT_EQ(pa->m_darray[0].m_darray[j], bDarr[j]);
+		}
+
+		// The arrays of basic types are after the structures
+		ANKI_TEST_EXPECT_GT(ptrToNumber(&pa->m_darray[0].m_darray[0]), ptrToNumber(&pa->m_darray[0]));
+	}
+}
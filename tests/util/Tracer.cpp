@@ -6,6 +6,7 @@
 #include <tests/framework/Framework.h>
 #include <anki/util/Tracer.h>
 #include <anki/core/CoreTracer.h>
+#include <anki/core/CoreProfiler.h>
 #include <anki/util/HighRezTimer.h>
 
 #if ANKI_ENABLE_TRACE
@@ -54,3 +55,65 @@ ANKI_TEST(Util, Tracer)
 	tracer.flushFrame(4);
 }
 #endif
+
+ANKI_TEST(Util, TracerProfiler)
+{
+	HeapAllocator<U8> alloc(allocAligned, nullptr);
+	CoreProfiler profiler;
+	ANKI_TEST_EXPECT_NO_ERR(profiler.init(alloc, 4));
+
+	// Feed a few frames of a FRAME -> (UPDATE -> PHYSICS, RENDER) hierarchy and a root in a different thread
+	for(U32 frame = 0; frame < 8; ++frame)
+	{
+		const Second base = 10.0 * Second(frame);
+		const Second renderTime = 1.0 + Second(frame);
+
+		Array<TracerEvent, 4> events;
+		events[0].m_name = "PHYSICS";
+		events[0].m_start = base + 0.5;
+		events[0].m_duration = 1.0;
+		events[1].m_name = "UPDATE";
+		events[1].m_start = base;
+		events[1].m_duration = 2.0;
+		events[2].m_name = "RENDER";
+		events[2].m_start = base + 2.0;
+		events[2].m_duration = renderTime;
+		events[3].m_name = "FRAME";
+		events[3].m_start = base;
+		events[3].m_duration = 9.0;
+		profiler.addEvents(1, WeakArray<TracerEvent>(events));
+
+		Array<TracerEvent, 1> workerEvents;
+		workerEvents[0].m_name = "TASK";
+		workerEvents[0].m_start = base + 1.0;
+		workerEvents[0].m_duration = 0.5;
+		profiler.addEvents(2, WeakArray<TracerEvent>(workerEvents));
+
+		profiler.endFrame(frame);
+	}
+
+	ANKI_TEST_EXPECT_EQ(profiler.getScopeCount(), 5);
+
+	U32 idx;
+	ANKI_TEST_EXPECT_EQ(profiler.findScope("FRAME/UPDATE/PHYSICS", idx), true);
+	CoreProfilerScopeStats stats;
+	profiler.getScopeStats(idx, stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_depth, 2);
+	ANKI_TEST_EXPECT_NEAR(stats.m_avg, 1.0, 0.0001);
+
+	ANKI_TEST_EXPECT_EQ(profiler.findScope("FRAME/RENDER", idx), true);
+	profiler.getScopeStats(idx, stats);
+	ANKI_TEST_EXPECT_EQ(stats.m_sampleCount, 4);
+	ANKI_TEST_EXPECT_NEAR(stats.m_min, 5.0, 0.0001);
+	ANKI_TEST_EXPECT_NEAR(stats.m_max, 8.0, 0.0001);
+	ANKI_TEST_EXPECT_NEAR(stats.m_avg, 6.5, 0.0001);
+	ANKI_TEST_EXPECT_NEAR(stats.m_p99, 8.0, 0.0001);
+	ANKI_TEST_EXPECT_NEAR(stats.m_lastFrame, 8.0, 0.0001);
+
+	ANKI_TEST_EXPECT_EQ(profiler.findScope("TASK", idx), true);
+	ANKI_TEST_EXPECT_EQ(profiler.findScope("FRAME/TASK", idx), false);
+
+	StringAuto report(alloc);
+	profiler.getReport(report);
+	ANKI_TEST_EXPECT_EQ(report.isEmpty(), false);
+}